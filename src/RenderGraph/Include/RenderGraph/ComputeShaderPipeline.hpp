@@ -38,6 +38,9 @@ public:
         std::vector<VkAttachmentReference>     attachmentReferences;
         std::vector<VkAttachmentReference>     inputAttachmentReferences;
         std::vector<VkAttachmentDescription>   attachmentDescriptions;
+
+        // bound as set 1 when the shader uses bindless textures
+        RG::MovablePtr<VkDescriptorSetLayout> bindlessLayout;
     };
 
     struct RENDERGRAPH_DLL_EXPORT CompileResult {
@@ -61,7 +64,7 @@ public:
 
     void IterateShaders (const std::function<void(const RG::ShaderModule&)> iterator) const;
 
-    std::unique_ptr<RG::DescriptorSetLayout> CreateDescriptorSetLayout (VkDevice device) const;
+    std::vector<VkDescriptorSetLayoutBinding> GetDescriptorSetLayoutBindings () const;
 };
 
 } // namespace RG
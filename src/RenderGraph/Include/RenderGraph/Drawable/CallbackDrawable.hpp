@@ -0,0 +1,32 @@
+#ifndef DRAWRECORDABLECALLBACK_HPP
+#define DRAWRECORDABLECALLBACK_HPP
+
+#include "RenderGraph/Drawable/Drawable.hpp"
+#include "RenderGraph/RenderGraphExport.hpp"
+
+#include <functional>
+
+namespace RG {
+
+// records whatever the callback records, resourceIndex is the frame being recorded
+// with GraphSettings::recordEveryFrame the callback runs on every Submit, so the draws may change from frame to frame,
+// otherwise it runs once per frame in flight when the graph is compiled
+class RENDERGRAPH_DLL_EXPORT CallbackDrawable : public Drawable {
+public:
+    using RecordCallback = std::function<void (RG::CommandBuffer&, uint32_t)>;
+
+    const RecordCallback recordCallback;
+
+    CallbackDrawable (RecordCallback recordCallback);
+
+    virtual ~CallbackDrawable () override;
+
+    // records for the first frame
+    virtual void Record (RG::CommandBuffer& commandBuffer) const override;
+
+    virtual void Record (RG::CommandBuffer& commandBuffer, uint32_t resourceIndex) const override;
+};
+
+} // namespace RG
+
+#endif
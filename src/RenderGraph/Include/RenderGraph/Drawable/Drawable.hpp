@@ -3,9 +3,16 @@
 
 #include "RenderGraph/RenderGraphExport.hpp"
 
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
 
 namespace RG {
 class CommandBuffer;
+class DeviceExtra;
+class Resource;
 }
 
 
@@ -15,7 +22,16 @@ class RENDERGRAPH_DLL_EXPORT Drawable {
 public:
     virtual ~Drawable ();
 
+    // called when the operation is compiled, throws when the recorded commands need a device feature that is not enabled
+    virtual void CheckDeviceSupport (const DeviceExtra&) const {}
+
     virtual void Record (RG::CommandBuffer&) const = 0;
+
+    // drawables reading per frame resources override this, resourceIndex is the frame being recorded
+    virtual void Record (RG::CommandBuffer& commandBuffer, uint32_t /* resourceIndex */) const { Record (commandBuffer); }
+
+    // true when draw parameters are read from the resource, the graph makes prior writes to it visible to indirect command reads
+    virtual bool ReadsIndirectCommands (const Resource&) const { return false; }
 };
 
 } // namespace RG
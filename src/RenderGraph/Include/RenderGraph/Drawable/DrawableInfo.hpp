@@ -4,6 +4,8 @@
 #include "RenderGraph/Drawable/Drawable.hpp"
 #include "RenderGraph/RenderGraphExport.hpp"
 
+#include "RenderGraph/Utils/Assert.hpp"
+
 #include "RenderGraph/VulkanWrapper/CommandBuffer.hpp"
 #include "RenderGraph/VulkanWrapper/Utils/BufferTransferable.hpp"
 
@@ -62,6 +64,15 @@ public:
     const uint32_t indexCount;
     const VkBuffer indexBuffer;
 
+    // per instance attributes, bound to VertexInputInfo::InstanceBinding
+    const VkBuffer instanceBuffer;
+
+    // lets several draws share the same vertex and index buffers, counted in vertices and indices
+    // firstVertex is used without an index buffer, firstIndex and vertexOffset with one
+    const uint32_t firstVertex  = 0;
+    const uint32_t firstIndex   = 0;
+    const int32_t  vertexOffset = 0;
+
     DrawableInfo (const uint32_t instanceCount,
                   uint32_t       vertexCount,
                   VkBuffer       vertexBuffer                                                       = VK_NULL_HANDLE,
@@ -74,6 +85,7 @@ public:
         , vertexBuffer ((vertexBuffer == VK_NULL_HANDLE) ? std::vector<VkBuffer> {} : std::vector<VkBuffer> { vertexBuffer })
         , indexCount (indexCount)
         , indexBuffer (indexBuffer)
+        , instanceBuffer (VK_NULL_HANDLE)
     {
     }
 
@@ -85,6 +97,7 @@ public:
         , vertexBuffer ({ vertexBuffer.buffer.GetBufferToBind () })
         , indexCount (static_cast<uint32_t> (indexBuffer.data.size ()))
         , indexBuffer (indexBuffer.buffer.GetBufferToBind ())
+        , instanceBuffer (VK_NULL_HANDLE)
     {
     }
 
@@ -95,6 +108,7 @@ public:
         , vertexBuffer ({ vertexBuffer.buffer.GetBufferToBind () })
         , indexCount (0)
         , indexBuffer (VK_NULL_HANDLE)
+        , instanceBuffer (VK_NULL_HANDLE)
     {
     }
 
@@ -108,6 +122,56 @@ public:
         , vertexBuffer (vertexBuffers.GetHandles ())
         , indexCount (indexCount)
         , indexBuffer (indexBuffer)
+        , instanceBuffer (VK_NULL_HANDLE)
+    {
+    }
+
+    DrawableInfo (const uint32_t                              instanceCount,
+                  const RG::VertexBufferTransferableUntyped& vertexBuffer,
+                  const RG::IndexBufferTransferable&         indexBuffer,
+                  const RG::VertexBufferTransferableUntyped& instanceBuffer)
+        : instanceCount (instanceCount)
+        , vertexCount (static_cast<uint32_t> (vertexBuffer.data.size ()))
+        , vertexBuffer ({ vertexBuffer.buffer.GetBufferToBind () })
+        , indexCount (static_cast<uint32_t> (indexBuffer.data.size ()))
+        , indexBuffer (indexBuffer.buffer.GetBufferToBind ())
+        , instanceBuffer (instanceBuffer.buffer.GetBufferToBind ())
+    {
+        RG_ASSERT (instanceBuffer.info.bindings[0].inputRate == VK_VERTEX_INPUT_RATE_INSTANCE);
+    }
+
+    DrawableInfo (const uint32_t   instanceCount,
+                  uint32_t         vertexCount,
+                  VertexBufferList vertexBuffers,
+                  uint32_t         indexCount,
+                  VkBuffer         indexBuffer,
+                  VkBuffer         instanceBuffer)
+        : instanceCount (instanceCount)
+        , vertexCount (vertexCount)
+        , vertexBuffer (vertexBuffers.GetHandles ())
+        , indexCount (indexCount)
+        , indexBuffer (indexBuffer)
+        , instanceBuffer (instanceBuffer)
+    {
+    }
+
+    DrawableInfo (const uint32_t   instanceCount,
+                  uint32_t         vertexCount,
+                  VertexBufferList vertexBuffers,
+                  uint32_t         indexCount,
+                  VkBuffer         indexBuffer,
+                  uint32_t         firstVertex,
+                  uint32_t         firstIndex,
+                  int32_t          vertexOffset)
+        : instanceCount (instanceCount)
+        , vertexCount (vertexCount)
+        , vertexBuffer (vertexBuffers.GetHandles ())
+        , indexCount (indexCount)
+        , indexBuffer (indexBuffer)
+        , instanceBuffer (VK_NULL_HANDLE)
+        , firstVertex (firstVertex)
+        , firstIndex (firstIndex)
+        , vertexOffset (vertexOffset)
     {
     }
 
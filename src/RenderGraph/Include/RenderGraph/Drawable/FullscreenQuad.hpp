@@ -2,6 +2,7 @@
 #define DR_FULLSCREENQUAD_HPP
 
 #include "RenderGraph/VulkanWrapper/DeviceExtra.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/UploadBatch.hpp"
 #include "RenderGraph/Drawable/DrawableInfo.hpp"
 
 #include <glm/glm.hpp>
@@ -24,6 +25,21 @@ public:
     FullscreenQuad (const RG::DeviceExtra& device)
         : vertexBuffer (device, 4, { VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32_SFLOAT }, VK_VERTEX_INPUT_RATE_VERTEX)
         , indexBuffer (device, 6)
+    {
+        RG::UploadBatch batch (device);
+        Upload (batch);
+        batch.Wait ();
+    }
+
+    FullscreenQuad (const RG::DeviceExtra& device, RG::UploadBatch& batch)
+        : vertexBuffer (device, 4, { VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32_SFLOAT }, VK_VERTEX_INPUT_RATE_VERTEX)
+        , indexBuffer (device, 6)
+    {
+        Upload (batch);
+    }
+
+private:
+    void Upload (RG::UploadBatch& batch)
     {
         vertexBuffer = std::vector<Vertex> {
             { glm::vec2 (-1.f, -1.f), glm::vec2 (0.f, 0.f) },
@@ -34,8 +50,8 @@ public:
 
         indexBuffer = { 0, 1, 2, 0, 3, 2 };
 
-        vertexBuffer.Flush ();
-        indexBuffer.Flush ();
+        vertexBuffer.Flush (batch);
+        indexBuffer.Flush (batch);
 
         info = std::make_unique<DrawableInfo> (1, vertexBuffer, indexBuffer);
     }
@@ -0,0 +1,67 @@
+#ifndef DRAWRECORDABLEINDIRECT_HPP
+#define DRAWRECORDABLEINDIRECT_HPP
+
+#include "RenderGraph/Drawable/Drawable.hpp"
+#include "RenderGraph/Drawable/DrawableInfo.hpp"
+#include "RenderGraph/RenderGraphExport.hpp"
+
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace RG {
+class GPUBufferResource;
+}
+
+
+namespace RG {
+
+// draws with parameters read from the gpu, e.g. written by a culling ComputeOperation earlier in the graph
+// drawCommands holds tightly packed VkDrawIndexedIndirectCommand records, drawCount a single uint32_t
+// the resources have to be connected as inputs of the RenderOperation, so the graph can synchronize with their writers
+// without drawCount all maxDrawCount records are drawn, more than one needs VkPhysicalDeviceFeatures::multiDrawIndirect
+// with drawCount VkPhysicalDeviceVulkan12Features::drawIndirectCount is required
+class RENDERGRAPH_DLL_EXPORT IndirectDrawable : public Drawable {
+public:
+    const std::vector<VkBuffer> vertexBuffer;
+    const VkBuffer              indexBuffer;
+
+    const std::shared_ptr<GPUBufferResource> drawCommands;
+    const std::shared_ptr<GPUBufferResource> drawCount;
+    const uint32_t                           maxDrawCount;
+
+    IndirectDrawable (VertexBufferList                   vertexBuffers,
+                      VkBuffer                           indexBuffer,
+                      std::shared_ptr<GPUBufferResource> drawCommands,
+                      uint32_t                           maxDrawCount,
+                      std::shared_ptr<GPUBufferResource> drawCount = nullptr);
+
+    IndirectDrawable (const RG::VertexBufferTransferableUntyped& vertexBuffer,
+                      const RG::IndexBufferTransferable&         indexBuffer,
+                      std::shared_ptr<GPUBufferResource>         drawCommands,
+                      uint32_t                                   maxDrawCount,
+                      std::shared_ptr<GPUBufferResource>         drawCount = nullptr);
+
+    virtual ~IndirectDrawable () override;
+
+    virtual void CheckDeviceSupport (const DeviceExtra& device) const override;
+
+    // records with the buffers of the first frame
+    virtual void Record (RG::CommandBuffer& commandBuffer) const override;
+
+    virtual void Record (RG::CommandBuffer& commandBuffer, uint32_t resourceIndex) const override;
+
+    virtual bool ReadsIndirectCommands (const Resource& resource) const override;
+
+private:
+    IndirectDrawable (std::vector<VkBuffer>              vertexBuffers,
+                      VkBuffer                           indexBuffer,
+                      std::shared_ptr<GPUBufferResource> drawCommands,
+                      uint32_t                           maxDrawCount,
+                      std::shared_ptr<GPUBufferResource> drawCount);
+};
+
+} // namespace RG
+
+#endif
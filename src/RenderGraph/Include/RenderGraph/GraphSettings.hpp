@@ -115,6 +115,12 @@ public:
     const RG::DeviceExtra* device;
     uint32_t                framesInFlight;
 
+    // command buffers are recorded on every Submit from transient per-frame pools instead of once in Compile
+    bool recordEveryFrame;
+
+    // independent operations of a pass are recorded sorted by Operation::StateKey, so operations sharing a pipeline follow each other
+    bool sortOperations;
+
     GraphSettings (const RG::DeviceExtra& device, ConnectionSet&& connectionSet, uint32_t framesInFlight);
     GraphSettings (const RG::DeviceExtra& device, uint32_t framesInFlight);
 
@@ -19,13 +19,14 @@
 #include <filesystem>
 #include <memory>
 #include <optional>
+#include <set>
+#include <string>
 #include <vector>
 
 
 namespace RG {
 class DeviceExtra;
-class DescriptorPool;
-class DescriptorSet;
+class DescriptorAllocation;
 class DescriptorSetLayout;
 class Framebuffer;
 class ImageView2D;
@@ -46,9 +47,30 @@ namespace RG {
 class RENDERGRAPH_DLL_EXPORT Operation : public Node {
 public:
     struct RENDERGRAPH_DLL_EXPORT Descriptors {
-        std::unique_ptr<RG::DescriptorPool>             descriptorPool;
-        std::unique_ptr<RG::DescriptorSetLayout>        descriptorSetLayout;
-        std::vector<std::unique_ptr<RG::DescriptorSet>> descriptorSets;
+        const RG::DescriptorSetLayout*            descriptorSetLayout   = nullptr;        // owned by the DescriptorAllocator of the device
+        std::unique_ptr<RG::DescriptorAllocation> descriptorSets;                         // one set per frame in flight, empty if the layout has no bindings
+        const RG::DescriptorSetLayout*            bindlessLayout        = nullptr;        // set when a shader samples from the bindless texture table
+        VkDescriptorSet                           bindlessDescriptorSet = VK_NULL_HANDLE; // bound as set 1, owned by the bindless texture table
+    };
+
+    // the state an operation binds when recorded, independent operations of a pass are recorded sorted by it
+    // pipelines and render passes are created per operation, so they are identified by what makes them interchangeable
+    // operations with equal keys bind the same pipeline (see ShareState), the command buffer skips the repeated binds
+    struct RENDERGRAPH_DLL_EXPORT StateKey {
+        VkPipelineBindPoint   bindPoint                   = VK_PIPELINE_BIND_POINT_MAX_ENUM; // operations without a pipeline keep the default
+        size_t                renderPass                  = 0;                               // hash of attachment formats and sample counts, equal for compatible render passes
+        size_t                pipeline                    = 0;                               // hash of shader binaries and fixed function state
+        VkDescriptorSetLayout descriptorSetLayout         = VK_NULL_HANDLE;
+        VkDescriptorSetLayout bindlessDescriptorSetLayout = VK_NULL_HANDLE;
+
+        // the values the hashes are computed from, compared after the hashes so colliding keys never share a pipeline
+        std::vector<uint64_t> renderPassState;
+        std::vector<uint64_t> pipelineState;
+
+        bool HasPipeline () const { return bindPoint != VK_PIPELINE_BIND_POINT_MAX_ENUM; }
+
+        bool operator< (const StateKey& other) const;
+        bool operator== (const StateKey& other) const;
     };
 
     virtual ~Operation () override = default;
@@ -66,6 +88,20 @@ public:
     virtual VkImageLayout GetImageLayoutAtEndForInputs (Resource&)    = 0;
     virtual VkImageLayout GetImageLayoutAtStartForOutputs (Resource&) = 0;
     virtual VkImageLayout GetImageLayoutAtEndForOutputs (Resource&)   = 0;
+
+    // accesses of recorded commands to buffer inputs that do not go through descriptors, e.g. indirect draw parameters
+    // the graph makes prior writes to these buffers visible before the operation
+    virtual VkAccessFlags GetBufferAccessForInputs (Resource&) { return 0; }
+
+    // valid after compiling
+    virtual StateKey GetStateKey () const { return {}; }
+
+    // called after compiling with an operation recorded earlier that has an equal StateKey
+    // the operation binds the pipeline of other from then on, until it is compiled again
+    virtual void ShareState (const Operation& /* other */) {}
+
+    // stages of the recorded commands, barriers around the operation wait for and block only these
+    virtual VkPipelineStageFlags GetPipelineStages () const { return VK_PIPELINE_STAGE_ALL_COMMANDS_BIT; }
 };
 
 
@@ -85,6 +121,7 @@ public:
 
     struct RENDERGRAPH_DLL_EXPORT CompileResult {
         Descriptors descriptors;
+        VkPipeline  boundPipeline = VK_NULL_HANDLE; // the pipeline of the operation, or of another one after ShareState
     };
 
     CompileSettings compileSettings;
@@ -104,6 +141,11 @@ public:
 
     virtual void Record (const ConnectionSet& connectionSet, uint32_t resourceIndex, RG::CommandBuffer& commandBuffer) override;
 
+    virtual StateKey GetStateKey () const override;
+    virtual void     ShareState (const Operation& other) override;
+
+    virtual VkPipelineStageFlags GetPipelineStages () const override { return VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT; }
+
     virtual VkImageLayout GetImageLayoutAtStartForInputs (Resource&) override
     {
         RG_BREAK ();
@@ -129,14 +171,28 @@ public:
 
 class RENDERGRAPH_DLL_EXPORT RenderOperation : public Operation {
 public:
+    // one draw of the operation, every item is recorded into the same render pass
+    struct RENDERGRAPH_DLL_EXPORT DrawItem {
+        std::unique_ptr<Drawable> drawable;
+
+        // optional, entries replace the ones of the operation with the same name for this draw, e.g. per object uniform buffers
+        // items with their own descriptors get their own descriptor sets
+        std::unique_ptr<RG::FromShaderReflection::DescriptorWriteInfoTable> descriptorWriteProvider;
+
+        // only used with CompileSettings::sortDrawItems, items with equal keys keep the order they were added in
+        // e.g. a material or mesh index, so draws binding the same buffers and sets end up next to each other
+        uint64_t sortKey = 0;
+    };
+
     class RENDERGRAPH_DLL_EXPORT Builder {
     private:
         VkDevice                           device;
-        std::unique_ptr<Drawable>          drawable;
+        std::vector<DrawItem>              drawItems;
         std::unique_ptr<ShaderPipeline>    shaderPipiline;
         std::optional<VkPrimitiveTopology> topology;
         std::optional<glm::vec4>           clearColor;
         std::optional<bool>                blendEnabled;
+        std::optional<bool>                sortDrawItems;
         std::optional<std::string>         name;
 
     public:
@@ -147,8 +203,11 @@ public:
         Builder& SetFragmentShader (const std::string& value);
         Builder& SetVertexShader (const std::filesystem::path& value);
         Builder& SetFragmentShader (const std::filesystem::path& value);
+        Builder& SetInstancedInputs (const std::set<std::string>& value);
         Builder& SetVertices (std::unique_ptr<Drawable>&& value);
+        Builder& AddDrawable (std::unique_ptr<Drawable>&& value, std::unique_ptr<RG::FromShaderReflection::DescriptorWriteInfoTable>&& descriptorWriteProvider = nullptr, uint64_t sortKey = 0);
         Builder& SetBlendEnabled (bool value = true);
+        Builder& SetSortDrawItems (bool value = true);
         Builder& SetClearColor (const glm::vec4& value);
         Builder& SetName (const std::string& value);
 
@@ -159,13 +218,17 @@ public:
     };
 
     struct RENDERGRAPH_DLL_EXPORT CompileSettings {
-        std::unique_ptr<Drawable>       drawable;
+        std::vector<DrawItem>           drawItems;
         std::unique_ptr<ShaderPipeline> pipeline;
         VkPrimitiveTopology             topology;
 
         std::optional<glm::vec4> clearColor;   // (0, 0, 0, 1) by default
         std::optional<bool>      blendEnabled; // true by default
 
+        // draws are recorded in the order they were added unless set, then they are ordered by DrawItem::sortKey
+        // only for draws that do not depend on each other, e.g. opaque geometry with depth testing
+        bool sortDrawItems = false;
+
         std::unique_ptr<RG::FromShaderReflection::DescriptorWriteInfoTable> descriptorWriteProvider;
         std::unique_ptr<RG::FromShaderReflection::AttachmentDataTable>      attachmentProvider;
     };
@@ -175,12 +238,17 @@ public:
         uint32_t                                       height;
         Descriptors                                    descriptors;
         std::vector<std::unique_ptr<RG::Framebuffer>> framebuffers;
+        std::vector<VkClearValue>                      clearValues; // one per color output, computed once so recording stays cheap
+        std::vector<Descriptors>                       drawItemDescriptors; // parallel to drawItems, empty for items using the sets of the operation
+        std::vector<size_t>                            drawOrder;           // drawItems indices in recording order
+        VkPipeline                                     boundPipeline = VK_NULL_HANDLE; // the pipeline of the operation, or of another one after ShareState
     };
 
     CompileSettings compileSettings;
     CompileResult   compileResult;
 
     RenderOperation (std::unique_ptr<Drawable>&& drawable, std::unique_ptr<ShaderPipeline>&& shaderPipiline, VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+    RenderOperation (std::vector<DrawItem>&& drawItems, std::unique_ptr<ShaderPipeline>&& shaderPipiline, VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
 
     virtual ~RenderOperation () override = default;
 
@@ -188,6 +256,11 @@ public:
     virtual void CompileWithExtent (const GraphSettings&, uint32_t width, uint32_t height) override;
     virtual void Record (const ConnectionSet& connectionSet, uint32_t imageIndex, RG::CommandBuffer& commandBuffer) override;
 
+    virtual StateKey GetStateKey () const override;
+    virtual void     ShareState (const Operation& other) override;
+
+    virtual VkPipelineStageFlags GetPipelineStages () const override { return VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT; }
+
     const std::unique_ptr<ShaderPipeline>& GetShaderPipeline () const { return compileSettings.pipeline; }
 
 private:
@@ -195,6 +268,7 @@ private:
     virtual VkImageLayout GetImageLayoutAtEndForInputs (Resource&) override;
     virtual VkImageLayout GetImageLayoutAtStartForOutputs (Resource&) override;
     virtual VkImageLayout GetImageLayoutAtEndForOutputs (Resource&) override;
+    virtual VkAccessFlags GetBufferAccessForInputs (Resource&) override;
 };
 
 
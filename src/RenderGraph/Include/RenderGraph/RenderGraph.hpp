@@ -9,6 +9,12 @@
 
 #include "RenderGraph/GraphSettings.hpp"
 #include "RenderGraph/RenderGraphPass.hpp"
+#include "RenderGraph/VulkanWrapper/Command.hpp"
+#include "RenderGraph/VulkanWrapper/CommandPool.hpp"
+#include "RenderGraph/VulkanWrapper/Event.hpp"
+#include "RenderGraph/VulkanWrapper/Fence.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/CommandCapture.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/MemoryUsage.hpp"
 
 #include <set>
 #include <unordered_set>
@@ -29,6 +35,49 @@ class GraphSettings;
 namespace RG {
 
 class RENDERGRAPH_DLL_EXPORT RenderGraph final : public Noncopyable {
+public:
+    struct NodeMemoryUsage {
+        std::string  name;
+        std::string  uuid;
+        VkDeviceSize deviceLocalBytes = 0;
+        VkDeviceSize hostBytes        = 0;
+        size_t       allocationCount  = 0;
+    };
+
+    // memory of the graph resources, the heaps include every allocation made through the allocator
+    struct MemoryReport {
+        std::vector<NodeMemoryUsage> nodes;
+        std::vector<RG::HeapUsage>   heaps;
+        size_t                       dedicatedAllocationCount = 0; // among the allocations of the nodes
+    };
+
+private:
+    // everything needed to record a frame, gathered once in Compile
+    // the barriers of every operation in a pass are recorded in a single batch before the pass
+    // the batch is a pipeline barrier, or a wait on the events set after the operations the pass depends on (split barrier)
+    struct RecordedPass {
+        std::vector<Operation*>            operations;
+        std::vector<VkEvent>               eventsToSet;  // parallel to operations, VK_NULL_HANDLE if no later pass waits on the operation
+        std::vector<VkEvent>               eventsToWait; // empty if the pass starts with a pipeline barrier
+        VkPipelineStageFlags               srcStageMask;
+        VkPipelineStageFlags               dstStageMask;
+        VkMemoryBarrier                    memoryBarrier;
+        std::vector<VkImageMemoryBarrier>  imageBarriers;  // one per image subresource
+        std::vector<VkBufferMemoryBarrier> bufferBarriers; // one per buffer range
+    };
+
+    struct FrameRecording {
+        std::vector<RecordedPass>               passes;
+        std::vector<VkImageMemoryBarrier>       finalImageBarriers;
+        std::vector<std::unique_ptr<VW::Event>> events; // reset at the end of the frame
+    };
+
+    std::vector<FrameRecording> frameRecordings;
+
+    // only used when recording every frame, declared before the command buffers allocated from them
+    std::vector<std::unique_ptr<RG::CommandPool>> frameCommandPools;
+    std::vector<std::unique_ptr<RG::Fence>>       frameFences;
+
 public:// TODO
     bool                       compiled;
     std::vector<Pass>          passes;
@@ -49,16 +98,42 @@ public:
 
     uint32_t GetPassCount () const;
 
+    // redundant binds skipped while recording, summed over every frame in flight
+    size_t GetElidedCommandCount () const;
+
+    // pipeline binds and render pass begins in the last recording of every frame in flight, summed
+    // compare graphs compiled with and without GraphSettings::sortOperations to see what sorting saves
+    RG::CommandStatistics GetCommandStatistics () const;
+
+    // passes of a frame waiting on events instead of starting with a pipeline barrier
+    size_t GetSplitBarrierCount () const;
+
+    // allocations of the resources are named after their nodes in Compile, see RG::GetAllocationName
+    MemoryReport GetMemoryReport () const;
+
+    bool IsRecordingEveryFrame () const { return graphSettings.recordEveryFrame; }
+
+    // command buffers of every frame in flight with the images and buffers of the graph resources
+    // commands have to be retained (see CommandBuffer::SetRetainRecordedCommands)
+    RG::CommandCapture CaptureCommandStream ();
+
     RG::ConnectionSet& GetConnectionSet () { return graphSettings.connectionSet; }
 
 private:
     void CompileResources ();
+    void NameResourceAllocations ();
     void CompileOperations ();
     Pass GetNextPass (const Pass& lastPass) const;
     Pass GetFirstPass () const;
     void CreatePasses ();
     void SeparatePasses ();
+    void SortPassOperations ();
+    void ShareOperationStates ();
     void DebugPrint ();
+    void DebugPrintMemoryReport () const;
+    void CreateFrameRecordings ();
+    void CreatePassSynchronization (FrameRecording& frameRecording);
+    void RecordFrame (uint32_t frameIndex, RG::CommandBuffer& commandBuffer, VkCommandBufferUsageFlags usageFlags) const;
 };
 
 
@@ -3,6 +3,7 @@
 
 #include "RenderGraph/RenderGraphExport.hpp"
 
+#include <functional>
 #include <vector>
 
 namespace RG {
@@ -47,6 +48,9 @@ public:
 
     bool IsEmpty () const;
 
+    // operations of a pass are independent, they can be recorded in any order
+    void SortOperations (const std::function<bool (const Operation*, const Operation*)>& less);
+
 private:
     bool RemoveIfEmpty (Operation* op);
     bool RemoveIfEmpty (Resource* res);
@@ -6,7 +6,6 @@
 #include "RenderGraph/Utils/Event.hpp"
 #include "RenderGraph/Utils/Timer.hpp"
 
-#include "RenderGraph/VulkanWrapper/Event.hpp"
 #include "RenderGraph/VulkanWrapper/GraphicsPipeline.hpp"
 #include "RenderGraph/VulkanWrapper/Utils/BufferTransferable.hpp"
 
@@ -34,6 +33,11 @@ class Sampler;
 class ImageTransferable;
 class BufferTransferable;
 class InheritedImage;
+class AsyncReadback;
+class UploadBatch;
+class ImageFile;
+class CompressedImageData;
+class BindlessTextureTable;
 }
 
 namespace RG {
@@ -48,6 +52,9 @@ public:
 
     virtual void Compile (const GraphSettings&) = 0;
 
+    // device memory owned by the resource after Compile, named and accounted by the render graph
+    virtual std::vector<VmaAllocation> GetAllocations () const { return {}; }
+
     virtual void OnPreRead (uint32_t /* resourceIndex */, RG::CommandBuffer&) {};
     virtual void OnPreWrite (uint32_t /* resourceIndex */, RG::CommandBuffer&) {};
     virtual void OnPostWrite (uint32_t /* resourceIndex */, RG::CommandBuffer&) {};
@@ -130,6 +137,8 @@ public:
 
     virtual void Compile (const GraphSettings& graphSettings) override;
 
+    virtual std::vector<VmaAllocation> GetAllocations () const override;
+
     // overriding ImageResource
     virtual VkImageLayout GetInitialLayout () const override;
 
@@ -148,20 +157,12 @@ public:
 };
 
 
+// reads and writes are synchronized by the graph like for any other resource
 class RENDERGRAPH_DLL_EXPORT SingleWritableImageResource : public WritableImageResource {
-private:
-    std::unique_ptr<VW::Event> readWriteSync;
-
 public:
     using WritableImageResource::WritableImageResource;
 
     virtual void Compile (const GraphSettings& graphSettings) override;
-
-    virtual void OnPreRead (uint32_t resourceIndex, RG::CommandBuffer& commandBuffer) override;
-
-    virtual void OnPreWrite (uint32_t resourceIndex, RG::CommandBuffer& commandBuffer) override;
-
-    virtual void OnPostWrite (uint32_t resourceIndex, RG::CommandBuffer& commandBuffer) override;
 };
 
 
@@ -178,6 +179,8 @@ public:
 
     virtual void Compile (const GraphSettings& settings) override;
 
+    virtual std::vector<VmaAllocation> GetAllocations () const override;
+
     // overriding DescriptorBindableImage
     virtual VkBuffer GetBufferForFrame (uint32_t) override;
 
@@ -188,6 +191,11 @@ public:
     void TransferFromGPUToCPU (uint32_t resourceIndex) const;
 
     void TransferFromGPUToCPU (uint32_t resourceIndex, VkDeviceSize size, VkDeviceSize offset) const;
+
+    // the returned readback owns the copied data, bufferCPU of the resource is not touched
+    std::unique_ptr<RG::AsyncReadback> TransferFromGPUToCPUAsync (uint32_t resourceIndex) const;
+
+    std::unique_ptr<RG::AsyncReadback> TransferFromGPUToCPUAsync (uint32_t resourceIndex, VkDeviceSize size, VkDeviceSize offset) const;
 };
 
 
@@ -204,6 +212,13 @@ public:
     const uint32_t depth;
     const uint32_t layerCount;
 
+private:
+    RG::TransferableUsage     usage;
+    bool                      bindlessEnabled;
+    RG::BindlessTextureTable* bindlessTable;
+    std::optional<uint32_t>   bindlessIndex;
+    bool                      mipLevelsEnabled;
+
 public:
     ReadOnlyImageResource (VkFormat format, VkFilter filter, uint32_t width, uint32_t height = 1, uint32_t depth = 1, uint32_t layerCount = 1);
 
@@ -214,6 +229,8 @@ public:
     // overriding OneTimeCompileResource
     virtual void CompileOnce (const GraphSettings& settings) override;
 
+    virtual std::vector<VmaAllocation> GetAllocations () const override;
+
     // overriding ImageResource
     virtual VkImageLayout GetInitialLayout () const override;
     virtual VkImageLayout GetFinalLayout () const override;
@@ -228,6 +245,22 @@ public:
     virtual VkImageView GetImageViewForFrame (uint32_t, uint32_t) override;
     virtual VkSampler   GetSampler () override;
 
+    // images are static by default, dynamic ones keep host visible staging memory for frequent updates
+    void SetUsage (RG::TransferableUsage value);
+
+    // registers the image into the bindless texture table of the device on compile
+    // shaders access it with the index from GetBindlessIndex, usually passed in through a uniform
+    void EnableBindless ();
+
+    bool     IsBindless () const { return bindlessIndex.has_value (); }
+    uint32_t GetBindlessIndex () const;
+
+    // allocates the full mip chain on compile, uploads to level 0 regenerate the other levels on the GPU
+    // formats without blit support keep a single level
+    void EnableMipLevels ();
+
+    uint32_t GetMipLevels () const;
+
     template<typename T>
     void CopyTransitionTransfer (const std::vector<T>& pixelData)
     {
@@ -239,6 +272,44 @@ public:
     {
         image->CopyLayer (VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, pixelData.data (), pixelData.size () * sizeof (T), layerIndex, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     }
+
+    template<typename T>
+    void CopyTransitionTransfer (RG::UploadBatch& batch, const std::vector<T>& pixelData)
+    {
+        CopyLayer (batch, pixelData, 0);
+    }
+
+    template<typename T>
+    void CopyLayer (RG::UploadBatch& batch, const std::vector<T>& pixelData, uint32_t layerIndex)
+    {
+        image->CopyLayer (batch, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, pixelData.data (), pixelData.size () * sizeof (T), layerIndex, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+
+    // decodes the file straight into staging memory of the batch
+    bool CopyLayer (RG::UploadBatch& batch, const RG::ImageFile& file, uint32_t layerIndex);
+
+    // the resource has to have the block compressed format and the size of the data
+    void CopyLayer (RG::UploadBatch& batch, const RG::CompressedImageData& compressed, uint32_t layerIndex);
+
+    // updates a brick of the image, pixelData holds its texels tightly packed
+    template<typename T>
+    void CopyRegion (const std::vector<T>& pixelData, VkOffset3D offset, VkExtent3D extent, uint32_t layerIndex = 0)
+    {
+        image->CopyRegion (VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, pixelData.data (), pixelData.size () * sizeof (T), offset, extent, layerIndex, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+
+    template<typename T>
+    void CopyRegion (RG::UploadBatch& batch, const std::vector<T>& pixelData, VkOffset3D offset, VkExtent3D extent, uint32_t layerIndex = 0)
+    {
+        image->CopyRegion (batch, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, pixelData.data (), pixelData.size () * sizeof (T), offset, extent, layerIndex, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+
+    // several bricks sourced from one array, see ImageTransferable::CopyRegions
+    template<typename T>
+    void CopyRegions (RG::UploadBatch& batch, const std::vector<T>& pixelData, const std::vector<VkBufferImageCopy>& regions)
+    {
+        image->CopyRegions (batch, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, pixelData.data (), pixelData.size () * sizeof (T), regions, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
 };
 
 
@@ -275,11 +346,13 @@ public:
 class RENDERGRAPH_DLL_EXPORT CPUBufferResource : public DescriptorBindableBufferResource {
 public:
     const uint32_t                                   size;
+    const RG::MemoryLocation                         location;
     std::vector<std::unique_ptr<RG::Buffer>>        buffers;
     std::vector<std::unique_ptr<RG::MemoryMapping>> mappings;
 
 public:
-    CPUBufferResource (uint32_t size);
+    // location has to be host visible, e.g. RG::MemoryLocation::GPUHostVisible for uniforms written every frame
+    CPUBufferResource (uint32_t size, RG::MemoryLocation location = RG::MemoryLocation::CPU);
 
 public:
     virtual ~CPUBufferResource ();
@@ -287,6 +360,8 @@ public:
     // overriding Resource
     virtual void Compile (const GraphSettings& graphSettings) override;
 
+    virtual std::vector<VmaAllocation> GetAllocations () const override;
+
     // overriding DescriptorBindableBuffer
     virtual VkBuffer GetBufferForFrame (uint32_t resourceIndex) override;
     virtual size_t GetBufferSize () override;
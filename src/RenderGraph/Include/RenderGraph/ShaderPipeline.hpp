@@ -10,6 +10,7 @@
 #include <optional>
 #include <memory>
 #include <filesystem>
+#include <set>
 #include <string>
 
 #include <vulkan/vulkan.h>
@@ -37,6 +38,8 @@ private:
     std::unique_ptr<RG::ShaderModule> tessellationControlShader;
     std::unique_ptr<RG::ShaderModule> computeShader;
 
+    std::set<std::string> instancedInputs;
+
     std::unique_ptr<RG::ShaderModule>& GetShaderByIndex (uint32_t index);
     std::unique_ptr<RG::ShaderModule>& GetShaderByExtension (const std::string& extension);
     std::unique_ptr<RG::ShaderModule>& GetShaderByKind (RG::ShaderKind kind);
@@ -52,6 +55,9 @@ public:
         VkPrimitiveTopology                    topology;
 
         std::optional<bool> blendEnabled;
+
+        // bound as set 1 when the shaders use bindless textures
+        RG::MovablePtr<VkDescriptorSetLayout> bindlessLayout;
     };
 
 
@@ -81,6 +87,13 @@ public:
     void SetShaderFromSourceFile (const std::filesystem::path& shaderPath);
     void SetShadersFromSourceFiles (const std::vector<std::filesystem::path>& shaderPath);
 
+    // vertex shader inputs read once per instance from a separate binding
+    // inputs named with the "instance" prefix (e.g. instanceOffset) are per instance without being listed here
+    void SetInstancedInputs (const std::set<std::string>& names);
+    bool IsInputInstanced (const std::string& name) const;
+
+    const std::set<std::string>& GetInstancedInputs () const { return instancedInputs; }
+
     void Compile (CompileSettings&& settings);
 
     void Reload ();
@@ -89,7 +102,7 @@ public:
 
     std::vector<VkPipelineShaderStageCreateInfo> GetShaderStages () const;
 
-    std::unique_ptr<RG::DescriptorSetLayout> CreateDescriptorSetLayout (VkDevice device) const;
+    std::vector<VkDescriptorSetLayoutBinding> GetDescriptorSetLayoutBindings () const;
 
     const RG::ShaderModuleReflection& GetReflection (RG::ShaderKind kind);
 };
@@ -74,6 +74,11 @@ void WriteDescriptors (const RG::ShaderModuleReflection& reflection,
 RENDERGRAPH_DLL_EXPORT
 std::vector<VkDescriptorSetLayoutBinding> GetLayout (const RG::ShaderModuleReflection& reflection, RG::ShaderKind shaderKind);
 
+
+// samplers declared in BindlessDescriptorSet are read from the device level bindless texture table
+RENDERGRAPH_DLL_EXPORT
+bool UsesBindlessTextures (const RG::ShaderModuleReflection& reflection);
+
 } // namespace FromShaderReflection
 } // namespace RG
 
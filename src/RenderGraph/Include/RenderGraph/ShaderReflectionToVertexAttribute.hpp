@@ -15,6 +15,7 @@
 namespace RG {
 namespace FromShaderReflection {
 
+// per vertex inputs are read from VertexInputInfo::VertexBinding, instanced ones from VertexInputInfo::InstanceBinding
 RENDERGRAPH_DLL_EXPORT
 std::vector<VkVertexInputAttributeDescription> GetVertexAttributes (const RG::ShaderModuleReflection& reflection, const std::function<bool (const std::string&)>& instanceNameProvider);
 
@@ -0,0 +1,41 @@
+#ifndef UTILS_MAPPEDFILE_HPP
+#define UTILS_MAPPEDFILE_HPP
+
+#include "RenderGraph/RenderGraphExport.hpp"
+
+#include "RenderGraph/Utils/Noncopyable.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+
+namespace RG {
+
+// read only memory mapping of a whole file, pages are loaded by the OS on first access
+class RENDERGRAPH_DLL_EXPORT MappedFile final : public Noncopyable {
+private:
+    const uint8_t* data;
+    size_t         size;
+
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+
+public:
+    MappedFile (const std::filesystem::path& filePath);
+
+    virtual ~MappedFile () override;
+
+    // false when the file does not exist, could not be mapped or is empty
+    bool IsValid () const { return data != nullptr; }
+
+    const uint8_t* GetData () const { return data; }
+    size_t         GetSize () const { return size; }
+};
+
+
+} // namespace RG
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+// selected at compile time, AVX2 is only used when the target enables it (/arch:AVX2 or -mavx2)
+// SIMD_SSE2 is defined together with SIMD_AVX2 so wide kernels can handle their tails with 128 bit code
+
+#if defined(__AVX2__)
+#define SIMD_AVX2
+#define SIMD_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SIMD_NEON
+#endif
+
+#if defined(SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(SIMD_SSE2)
+#include <emmintrin.h>
+#elif defined(SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+#endif
@@ -63,8 +63,10 @@ public:
     std::unique_ptr<RG::Queue>               graphicsQueue;
     std::unique_ptr<RG::Queue>               presentQueue;
     std::unique_ptr<RG::CommandPool>         commandPool;
+    std::unique_ptr<RG::Queue>               transferQueue;       // only when a transfer-only family exists
+    std::unique_ptr<RG::CommandPool>         transferCommandPool; // only when a transfer-only family exists
+    std::unique_ptr<RG::Allocator>           allocator;   // must outlive the buffers owned by deviceExtra
     std::unique_ptr<RG::DeviceExtra>         deviceExtra;
-    std::unique_ptr<RG::Allocator>           allocator;
 
     VulkanEnvironment (std::optional<RG::DebugUtilsMessenger::Callback> callback           = defaultDebugCallback,
                        const std::vector<const char*>&              instanceExtensions = {},
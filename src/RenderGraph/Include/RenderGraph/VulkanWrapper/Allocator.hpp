@@ -17,7 +17,8 @@ private:
     RG::MovablePtr<VmaAllocator> handle;
 
 public:
-    Allocator (VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device);
+    // memoryBudgetEnabled requires VK_EXT_memory_budget to be enabled on the device
+    Allocator (VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device, bool memoryBudgetEnabled = false);
     Allocator (Allocator&&) = default;
     Allocator& operator= (Allocator&&) = default;
 
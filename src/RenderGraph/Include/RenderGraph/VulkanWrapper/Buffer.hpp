@@ -5,6 +5,7 @@
 
 #include "RenderGraph/Utils/Assert.hpp"
 #include "RenderGraph/Utils/MovablePtr.hpp"
+#include "MemoryLocation.hpp"
 #include "VulkanObject.hpp"
 
 #pragma warning (push, 0)
@@ -14,17 +15,17 @@
 namespace RG {
 
 class RENDERGRAPH_DLL_EXPORT Buffer : public VulkanObject {
+public:
+    using MemoryLocation = RG::MemoryLocation;
+
 private:
     VmaAllocator                   allocator;
     RG::MovablePtr<VkBuffer>      handle;
     RG::MovablePtr<VmaAllocation> allocationHandle;
     size_t                         size;
+    MemoryLocation                 memoryLocation;
 
 public:
-    enum class MemoryLocation {
-        GPU,
-        CPU
-    };
 
     Buffer (VmaAllocator allocator, size_t bufferSize, VkBufferUsageFlags usageFlags, MemoryLocation loc);
     Buffer (Buffer&&) = default;
@@ -38,6 +39,11 @@ public:
 
     operator VkBuffer () const { return handle; }
 
+    size_t GetSize () const { return size; }
+
+    // differs from the requested location when the buffer was allocated from a fallback
+    MemoryLocation GetMemoryLocation () const { return memoryLocation; }
+
     operator VmaAllocation () const { return allocationHandle; }
 };
 
@@ -3,11 +3,53 @@
 
 #include "RenderGraph/RenderGraphExport.hpp"
 
+#include <vulkan/vulkan.h>
+
+#include <map>
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace RG {
 
 class CommandBuffer;
+class CommandStreamWriter;
+
+
+// state bound by the commands recorded so far into a command buffer
+class RENDERGRAPH_DLL_EXPORT CommandBoundState {
+public:
+    struct DescriptorSetBinding {
+        VkPipelineLayout layout;
+        VkDescriptorSet  descriptorSet;
+    };
+
+    struct VertexBufferBinding {
+        VkBuffer     buffer;
+        VkDeviceSize offset;
+    };
+
+    struct IndexBufferBinding {
+        VkBuffer     buffer;
+        VkDeviceSize offset;
+        VkIndexType  indexType;
+    };
+
+    std::map<VkPipelineBindPoint, VkPipeline>                                       pipelines;
+    std::map<VkPipelineBindPoint, std::vector<std::optional<DescriptorSetBinding>>> descriptorSets;
+    std::vector<std::optional<VertexBufferBinding>>                                 vertexBuffers;
+    std::optional<IndexBufferBinding>                                               indexBuffer;
+
+    void Clear ();
+};
+
+
+// state changing commands recorded into a command buffer, elided commands are not counted
+struct RENDERGRAPH_DLL_EXPORT CommandStatistics {
+    size_t pipelineBinds    = 0;
+    size_t renderPassBegins = 0;
+};
+
 
 class RENDERGRAPH_DLL_EXPORT Command {
 private:
@@ -21,8 +63,18 @@ public:
     virtual void        Record (CommandBuffer&)             = 0;
     virtual bool        IsEquivalent (const Command& other) = 0;
     virtual std::string ToString () const { return ""; }
+
+    // true if recording the command would not change the bound state
+    virtual bool IsRedundant (const CommandBoundState&) const { return false; }
+
+    virtual void UpdateBoundState (CommandBoundState&) const {}
+
+    virtual void UpdateStatistics (CommandStatistics&) const {}
+
+    // writes the command id and parameters, returns false for commands that cannot be captured
+    virtual bool Serialize (CommandStreamWriter&) const { return false; }
 };
 
 } // namespace RG
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,108 @@
+#ifndef VULKANWRAPPER_COMMANDARENA_HPP
+#define VULKANWRAPPER_COMMANDARENA_HPP
+
+#include "RenderGraph/RenderGraphExport.hpp"
+
+#include "RenderGraph/Utils/Noncopyable.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace RG {
+
+// fixed size array whose elements live in a CommandArena
+template<typename T>
+class CommandArray {
+private:
+    const T* elements;
+    uint32_t count;
+
+public:
+    CommandArray ()
+        : elements (nullptr)
+        , count (0)
+    {
+    }
+
+    CommandArray (const T* elements, uint32_t count)
+        : elements (elements)
+        , count (count)
+    {
+    }
+
+    const T* data () const { return elements; }
+    size_t   size () const { return count; }
+    bool     empty () const { return count == 0; }
+    const T* begin () const { return elements; }
+    const T* end () const { return elements + count; }
+
+    const T& operator[] (size_t index) const { return elements[index]; }
+
+    bool operator== (const CommandArray& other) const { return std::equal (begin (), end (), other.begin (), other.end ()); }
+    bool operator!= (const CommandArray& other) const { return !(*this == other); }
+};
+
+
+// linear allocator for recorded commands and their payloads
+// nothing is freed individually, Reset rewinds the whole arena while keeping its blocks
+class RENDERGRAPH_DLL_EXPORT CommandArena final : public Noncopyable {
+public:
+    struct Marker {
+        size_t blockIndex;
+        size_t used;
+    };
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> memory;
+        size_t                       size;
+        size_t                       used;
+    };
+
+    const size_t       blockSize;
+    std::vector<Block> blocks;
+    size_t             currentBlock;
+    size_t             allocationCount;
+
+public:
+    CommandArena (size_t blockSize = 16 * 1024);
+
+    virtual ~CommandArena () override;
+
+    void* Allocate (size_t size, size_t alignment);
+
+    template<typename T>
+    CommandArray<T> CopyArray (const std::vector<T>& source)
+    {
+        static_assert (std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value, "arena arrays are never destructed");
+
+        if (source.empty ()) {
+            return {};
+        }
+
+        T* elements = static_cast<T*> (Allocate (sizeof (T) * source.size (), alignof (T)));
+        std::copy (source.begin (), source.end (), elements);
+        return CommandArray<T> (elements, static_cast<uint32_t> (source.size ()));
+    }
+
+    Marker GetMarker () const;
+
+    // frees everything allocated after the marker
+    void Rewind (const Marker& marker);
+
+    // keeps the first block for the next recording, the rest is freed when releaseMemory is set
+    void Reset (bool releaseMemory = false);
+
+    size_t GetAllocationCount () const { return allocationCount; }
+    size_t GetUsedBytes () const;
+    size_t GetReservedBytes () const;
+    size_t GetBlockCount () const { return blocks.size (); }
+};
+
+} // namespace RG
+
+#endif
@@ -7,6 +7,12 @@
 #include "RenderGraph/Utils/MovablePtr.hpp"
 #include "RenderGraph/VulkanWrapper/VulkanObject.hpp"
 #include "RenderGraph/VulkanWrapper/Command.hpp"
+#include "RenderGraph/VulkanWrapper/CommandArena.hpp"
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
 
 namespace RG {
 
@@ -20,16 +26,31 @@ private:
     RG::MovablePtr<VkCommandBuffer> handle;
 
     bool canRecordCommands;
+    bool retainRecordedCommands;
+    bool elideRedundantCommands;
+
+    // binds matching this state are not recorded
+    CommandBoundState boundState;
+    size_t            elidedCommandCount;
+    CommandStatistics statistics;
+
+    // recorded commands and their variable length data, released on Begin, Reset and destruction
+    std::unique_ptr<CommandArena> arena;
+
+    // a command that is not retained (or was elided) is kept alive until the next Record so it can still be named
+    Command*             lastUnretainedCommand;
+    CommandArena::Marker lastUnretainedMarker;
 
 public:
-    std::vector<std::unique_ptr<Command>> recordedAbstractCommands;
+    // empty when retaining commands is turned off
+    std::vector<Command*> recordedAbstractCommands;
 
 public:
     CommandBuffer (VkDevice device, VkCommandPool commandPool);
     CommandBuffer (const DeviceExtra& device);
 
-    CommandBuffer (CommandBuffer&&) = default;
-    CommandBuffer& operator= (CommandBuffer&&) = default;
+    CommandBuffer (CommandBuffer&&);
+    CommandBuffer& operator= (CommandBuffer&&);
 
     virtual ~CommandBuffer () override;
     
@@ -43,15 +64,54 @@ public:
 
     void Reset (bool releaseResources = true);
 
-    Command& RecordCommand (std::unique_ptr<Command>&& command);
+    // retained commands can be inspected after recording (see Command::IsEquivalent)
+    // can be turned off with --discardRecordedCommands in release builds
+    void SetRetainRecordedCommands (bool value);
+    bool IsRetainingRecordedCommands () const { return retainRecordedCommands; }
+
+    const CommandArena& GetArena () const { return *arena; }
 
+    // pipeline, descriptor set, vertex and index buffer binds that would not change the bound state are skipped
+    void   SetElideRedundantCommands (bool value) { elideRedundantCommands = value; }
+    size_t GetElidedCommandCount () const { return elidedCommandCount; }
+
+    // pipeline binds and render pass begins recorded since Begin
+    const CommandStatistics& GetStatistics () const { return statistics; }
+
+    // call after recording into the handle directly
+    void InvalidateBoundState () { boundState.Clear (); }
+
+    // commands that take a CommandArena& as their first constructor parameter store their arrays in the arena
     template<typename CommandType, typename... CommandParameters>
     Command& Record (CommandParameters&&... parameters)
     {
-        return RecordCommand (std::make_unique<CommandType> (std::forward<CommandParameters> (parameters)...));
+        static_assert (std::is_base_of<Command, CommandType>::value, "only commands can be recorded");
+
+        ReleaseUnretainedCommand ();
+
+        const CommandArena::Marker marker = arena->GetMarker ();
+
+        void*        memory  = arena->Allocate (sizeof (CommandType), alignof (CommandType));
+        CommandType* command = nullptr;
+        if constexpr (std::is_constructible<CommandType, CommandArena&, CommandParameters&&...>::value) {
+            command = new (memory) CommandType (*arena, std::forward<CommandParameters> (parameters)...);
+        } else {
+            command = new (memory) CommandType (std::forward<CommandParameters> (parameters)...);
+        }
+
+        return RecordCommand (*command, marker);
     }
 
     VkCommandBuffer GetHandle () const { return handle; }
+
+private:
+    Command& RecordCommand (Command& command, const CommandArena::Marker& marker);
+
+    void ReleaseUnretainedCommand ();
+
+    Command& KeepUntilNextRecord (Command& command, const CommandArena::Marker& marker);
+
+    void DestroyRecordedCommands (bool releaseMemory);
 };
 
 
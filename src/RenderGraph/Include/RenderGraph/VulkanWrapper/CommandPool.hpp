@@ -18,14 +18,14 @@ private:
     RG::MovablePtr<VkCommandPool> handle;
 
 public:
-    CommandPool (VkDevice device, uint32_t queueIndex)
+    CommandPool (VkDevice device, uint32_t queueIndex, VkCommandPoolCreateFlags flags = 0)
         : device (device)
         , handle (VK_NULL_HANDLE)
     {
         VkCommandPoolCreateInfo commandPoolInfo = {};
         commandPoolInfo.sType                   = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
         commandPoolInfo.queueFamilyIndex        = queueIndex;
-        commandPoolInfo.flags                   = 0;
+        commandPoolInfo.flags                   = flags;
         if (RG_ERROR (vkCreateCommandPool (device, &commandPoolInfo, nullptr, &handle) != VK_SUCCESS)) {
             throw std::runtime_error ("failed to create commandpool");
         }
@@ -45,6 +45,15 @@ public:
     {
         return handle;
     }
+
+    // returns every command buffer allocated from this pool to the initial state
+    // none of them may be pending execution
+    void Reset (VkCommandPoolResetFlags flags = 0) const
+    {
+        if (RG_ERROR (vkResetCommandPool (device, handle, flags) != VK_SUCCESS)) {
+            throw std::runtime_error ("failed to reset commandpool");
+        }
+    }
 };
 
 } // namespace RG
@@ -0,0 +1,199 @@
+#ifndef VULKANWRAPPER_COMMANDSTREAM_HPP
+#define VULKANWRAPPER_COMMANDSTREAM_HPP
+
+#include "RenderGraph/RenderGraphExport.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace RG {
+
+class CommandBuffer;
+
+
+// identifies a serialized command, values are part of the capture format
+enum class CommandId : uint16_t {
+    BindVertexBuffers        = 1,
+    PipelineBarrier          = 2,
+    DrawIndexed              = 3,
+    Draw                     = 4,
+    BindIndexBuffer          = 5,
+    EndRenderPass            = 6,
+    BeginRenderPass          = 7,
+    BindPipeline             = 8,
+    BindDescriptorSets       = 9,
+    CopyImage                = 10,
+    CopyImageToBuffer        = 11,
+    CopyBufferToImage        = 12,
+    CopyBuffer               = 13,
+    Dispatch                 = 14,
+    DispatchBase             = 15,
+    DispatchIndirect         = 16,
+    DrawIndexedIndirect      = 17,
+    DrawIndexedIndirectCount = 18,
+    BlitImage                = 19,
+};
+
+
+// handles are stored as 64 bit ids, they are only meaningful together with the resource table of a capture
+template<typename HandleType>
+uint64_t HandleToId (HandleType handle)
+{
+    if constexpr (std::is_pointer<HandleType>::value) {
+        return static_cast<uint64_t> (reinterpret_cast<uintptr_t> (handle));
+    } else {
+        return static_cast<uint64_t> (handle);
+    }
+}
+
+
+template<typename HandleType>
+HandleType IdToHandle (uint64_t id)
+{
+    if constexpr (std::is_pointer<HandleType>::value) {
+        return reinterpret_cast<HandleType> (static_cast<uintptr_t> (id));
+    } else {
+        return static_cast<HandleType> (id);
+    }
+}
+
+
+// appends values in native byte order, structs containing pointers have to be written field by field
+class RENDERGRAPH_DLL_EXPORT CommandStreamWriter {
+private:
+    std::vector<uint8_t>& data;
+
+public:
+    CommandStreamWriter (std::vector<uint8_t>& data)
+        : data (data)
+    {
+    }
+
+    template<typename T>
+    void Write (const T& value)
+    {
+        static_assert (std::is_trivially_copyable<T>::value, "only trivially copyable values can be written");
+
+        const size_t offset = data.size ();
+        data.resize (offset + sizeof (T));
+        std::memcpy (data.data () + offset, &value, sizeof (T));
+    }
+
+    template<typename T>
+    void WriteArray (const T* values, size_t count)
+    {
+        static_assert (std::is_trivially_copyable<T>::value, "only trivially copyable values can be written");
+
+        Write (static_cast<uint32_t> (count));
+
+        const size_t offset = data.size ();
+        data.resize (offset + sizeof (T) * count);
+        if (count > 0) {
+            std::memcpy (data.data () + offset, values, sizeof (T) * count);
+        }
+    }
+
+    template<typename HandleType>
+    void WriteHandle (HandleType handle)
+    {
+        Write (HandleToId (handle));
+    }
+
+    void WriteImageBarrier (const VkImageMemoryBarrier& barrier);
+    void WriteBufferBarrier (const VkBufferMemoryBarrier& barrier);
+};
+
+
+// reads what CommandStreamWriter wrote, handles are translated through the given map
+// a handle missing from the map reads as VK_NULL_HANDLE and marks the reader unresolved
+class RENDERGRAPH_DLL_EXPORT CommandStreamReader {
+private:
+    const uint8_t*                                data;
+    size_t                                        size;
+    size_t                                        position;
+    const std::unordered_map<uint64_t, uint64_t>* handleMap;
+    bool                                          unresolvedHandle;
+
+public:
+    CommandStreamReader (const uint8_t* data, size_t size, const std::unordered_map<uint64_t, uint64_t>* handleMap = nullptr)
+        : data (data)
+        , size (size)
+        , position (0)
+        , handleMap (handleMap)
+        , unresolvedHandle (false)
+    {
+    }
+
+    template<typename T>
+    T Read ()
+    {
+        static_assert (std::is_trivially_copyable<T>::value, "only trivially copyable values can be read");
+
+        T result;
+        std::memcpy (&result, Advance (sizeof (T)), sizeof (T));
+        return result;
+    }
+
+    template<typename T>
+    std::vector<T> ReadArray ()
+    {
+        static_assert (std::is_trivially_copyable<T>::value, "only trivially copyable values can be read");
+
+        const uint32_t count = Read<uint32_t> ();
+
+        std::vector<T> result (count);
+        if (count > 0) {
+            std::memcpy (result.data (), Advance (sizeof (T) * count), sizeof (T) * count);
+        }
+        return result;
+    }
+
+    template<typename HandleType>
+    HandleType ReadHandle ()
+    {
+        return IdToHandle<HandleType> (ReadHandleId ());
+    }
+
+    const uint8_t* Advance (size_t byteCount);
+
+    VkImageMemoryBarrier  ReadImageBarrier ();
+    VkBufferMemoryBarrier ReadBufferBarrier ();
+
+    bool   IsAtEnd () const { return position == size; }
+    size_t GetPosition () const { return position; }
+
+    bool HasUnresolvedHandle () const { return unresolvedHandle; }
+    void ClearUnresolvedHandle () { unresolvedHandle = false; }
+
+private:
+    uint64_t ReadHandleId ();
+};
+
+
+// what a replayed stream has bound so far, commands depending on skipped state are skipped as well
+class RENDERGRAPH_DLL_EXPORT CommandReplayState {
+public:
+    std::set<VkPipelineBindPoint> boundPipelines;
+    std::set<VkPipelineBindPoint> incompleteBindPoints;
+    std::set<uint64_t>            transitionedImages;
+    bool                          renderPassActive = false;
+
+    void Clear ();
+};
+
+
+// reads one serialized command and records it into commandBuffer
+// returns false when the command was skipped because of unresolved handles or skipped state
+RENDERGRAPH_DLL_EXPORT
+bool RecordSerializedCommand (CommandStreamReader& reader, CommandReplayState& state, CommandBuffer& commandBuffer);
+
+} // namespace RG
+
+#endif
@@ -2,7 +2,9 @@
 #define VULKANWRAPPER_COMMANDS_HPP
 
 #include "RenderGraph/RenderGraphExport.hpp"
+#include "RenderGraph/VulkanWrapper/CommandArena.hpp"
 #include "RenderGraph/VulkanWrapper/CommandBuffer.hpp"
+#include "RenderGraph/VulkanWrapper/CommandStream.hpp"
 #include "RenderGraph/VulkanWrapper/Image.hpp"
 
 #include <vector>
@@ -13,20 +15,21 @@ namespace RG {
 
 class RENDERGRAPH_DLL_EXPORT CommandBindVertexBuffers : public Command {
 private:
-    const uint32_t                  firstBinding;
-    const uint32_t                  bindingCount;
-    const std::vector<VkBuffer>     pBuffers;
-    const std::vector<VkDeviceSize> pOffsets;
+    const uint32_t                   firstBinding;
+    const uint32_t                   bindingCount;
+    const CommandArray<VkBuffer>     pBuffers;
+    const CommandArray<VkDeviceSize> pOffsets;
 
 public:
-    CommandBindVertexBuffers (const uint32_t                  firstBinding,
-                              const uint32_t                  bindingCount,
-                              const std::vector<VkBuffer>     pBuffers,
-                              const std::vector<VkDeviceSize> pOffsets)
+    CommandBindVertexBuffers (CommandArena&                    arena,
+                              const uint32_t                   firstBinding,
+                              const uint32_t                   bindingCount,
+                              const std::vector<VkBuffer>&     pBuffers,
+                              const std::vector<VkDeviceSize>& pOffsets)
         : firstBinding (firstBinding)
         , bindingCount (bindingCount)
-        , pBuffers (pBuffers)
-        , pOffsets (pOffsets)
+        , pBuffers (arena.CopyArray (pBuffers))
+        , pOffsets (arena.CopyArray (pOffsets))
     {
     }
 
@@ -45,59 +48,38 @@ public:
     }
 
     virtual std::string ToString () const override;
+
+    virtual bool IsRedundant (const CommandBoundState& state) const override;
+
+    virtual void UpdateBoundState (CommandBoundState& state) const override;
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
 };
 
 
 class RENDERGRAPH_DLL_EXPORT CommandPipelineBarrier : public Command {
 private:
-    VkPipelineStageFlags               srcStageMask;
-    VkPipelineStageFlags               dstStageMask;
-    std::vector<VkMemoryBarrier>       memoryBarriers;
-    std::vector<VkBufferMemoryBarrier> bufferMemoryBarriers;
-    std::vector<VkImageMemoryBarrier>  imageMemoryBarriers;
+    VkPipelineStageFlags                srcStageMask;
+    VkPipelineStageFlags                dstStageMask;
+    CommandArray<VkMemoryBarrier>       memoryBarriers;
+    CommandArray<VkBufferMemoryBarrier> bufferMemoryBarriers;
+    CommandArray<VkImageMemoryBarrier>  imageMemoryBarriers;
 
 public:
-    CommandPipelineBarrier (const VkPipelineStageFlags               srcStageMask,
-                            const VkPipelineStageFlags               dstStageMask,
-                            const std::vector<VkMemoryBarrier>       memoryBarriers       = {},
-                            const std::vector<VkBufferMemoryBarrier> bufferMemoryBarriers = {},
-                            const std::vector<VkImageMemoryBarrier>  imageMemoryBarriers  = {})
+    CommandPipelineBarrier (CommandArena&                             arena,
+                            const VkPipelineStageFlags                srcStageMask,
+                            const VkPipelineStageFlags                dstStageMask,
+                            const std::vector<VkMemoryBarrier>&       memoryBarriers       = {},
+                            const std::vector<VkBufferMemoryBarrier>& bufferMemoryBarriers = {},
+                            const std::vector<VkImageMemoryBarrier>&  imageMemoryBarriers  = {})
         : srcStageMask (srcStageMask)
         , dstStageMask (dstStageMask)
-        , memoryBarriers (memoryBarriers)
-        , bufferMemoryBarriers (bufferMemoryBarriers)
-        , imageMemoryBarriers (imageMemoryBarriers)
-    {
-    }
-
-#pragma warning(disable : 26815)
-
-    CommandPipelineBarrier& AddMemoryBarrier (const std::vector<VkMemoryBarrier>& barriers)
-    {
-        memoryBarriers.insert (memoryBarriers.end (), barriers.begin (), barriers.end ());
-        return *this;
-    }
-
-    CommandPipelineBarrier& AddMemoryBarrier (const VkMemoryBarrier& barrier)
-    {
-        memoryBarriers.push_back (barrier);
-        return *this;
-    }
-
-    CommandPipelineBarrier& AddImageMemoryBarrier (const std::vector<VkImageMemoryBarrier>& barriers)
-    {
-        imageMemoryBarriers.insert (imageMemoryBarriers.end (), barriers.begin (), barriers.end ());
-        return *this;
-    }
-
-    CommandPipelineBarrier& AddImageMemoryBarrier (const VkImageMemoryBarrier& barrier)
+        , memoryBarriers (arena.CopyArray (memoryBarriers))
+        , bufferMemoryBarriers (arena.CopyArray (bufferMemoryBarriers))
+        , imageMemoryBarriers (arena.CopyArray (imageMemoryBarriers))
     {
-        imageMemoryBarriers.push_back (barrier);
-        return *this;
     }
 
-#pragma warning(default : 26815)
-
     virtual void Record (CommandBuffer&) override;
 
 
@@ -149,6 +131,8 @@ public:
 
         return false;
     }
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
 };
 
 
@@ -157,8 +141,9 @@ private:
     static const VkAccessFlags flushAll;
 
 public:
-    CommandPipelineBarrierFull ()
-        : CommandPipelineBarrier (VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+    CommandPipelineBarrierFull (CommandArena& arena)
+        : CommandPipelineBarrier (arena,
+                                  VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
                                   VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
                                   std::vector<VkMemoryBarrier> { flushAll },
                                   std::vector<VkBufferMemoryBarrier> {},
@@ -168,6 +153,116 @@ public:
 };
 
 
+// first half of a split barrier, signals event after the commands recorded before it reached stageMask
+class RENDERGRAPH_DLL_EXPORT CommandSetEvent : public Command {
+private:
+    VkEvent              event;
+    VkPipelineStageFlags stageMask;
+
+public:
+    CommandSetEvent (VkEvent event, VkPipelineStageFlags stageMask)
+        : event (event)
+        , stageMask (stageMask)
+    {
+    }
+
+    virtual void Record (CommandBuffer& commandBuffer) override
+    {
+        vkCmdSetEvent (commandBuffer.GetHandle (), event, stageMask);
+    }
+
+    virtual bool IsEquivalent (const Command& other) override
+    {
+        if (auto otherCommand = dynamic_cast<const CommandSetEvent*> (&other)) {
+            return event == otherCommand->event && stageMask == otherCommand->stageMask;
+        }
+
+        return false;
+    }
+
+    // replayed as the pipeline barrier of the matching CommandWaitEvents
+    virtual bool Serialize (CommandStreamWriter&) const override { return true; }
+};
+
+
+class RENDERGRAPH_DLL_EXPORT CommandResetEvent : public Command {
+private:
+    VkEvent              event;
+    VkPipelineStageFlags stageMask;
+
+public:
+    CommandResetEvent (VkEvent event, VkPipelineStageFlags stageMask)
+        : event (event)
+        , stageMask (stageMask)
+    {
+    }
+
+    virtual void Record (CommandBuffer& commandBuffer) override
+    {
+        vkCmdResetEvent (commandBuffer.GetHandle (), event, stageMask);
+    }
+
+    virtual bool IsEquivalent (const Command& other) override
+    {
+        if (auto otherCommand = dynamic_cast<const CommandResetEvent*> (&other)) {
+            return event == otherCommand->event && stageMask == otherCommand->stageMask;
+        }
+
+        return false;
+    }
+
+    virtual bool Serialize (CommandStreamWriter&) const override { return true; }
+};
+
+
+// second half of a split barrier, srcStageMask has to be the union of the stage masks the events were set with
+class RENDERGRAPH_DLL_EXPORT CommandWaitEvents : public Command {
+private:
+    CommandArray<VkEvent>               events;
+    VkPipelineStageFlags                srcStageMask;
+    VkPipelineStageFlags                dstStageMask;
+    CommandArray<VkMemoryBarrier>       memoryBarriers;
+    CommandArray<VkBufferMemoryBarrier> bufferMemoryBarriers;
+    CommandArray<VkImageMemoryBarrier>  imageMemoryBarriers;
+
+public:
+    CommandWaitEvents (CommandArena&                             arena,
+                       const std::vector<VkEvent>&               events,
+                       const VkPipelineStageFlags                srcStageMask,
+                       const VkPipelineStageFlags                dstStageMask,
+                       const std::vector<VkMemoryBarrier>&       memoryBarriers       = {},
+                       const std::vector<VkBufferMemoryBarrier>& bufferMemoryBarriers = {},
+                       const std::vector<VkImageMemoryBarrier>&  imageMemoryBarriers  = {})
+        : events (arena.CopyArray (events))
+        , srcStageMask (srcStageMask)
+        , dstStageMask (dstStageMask)
+        , memoryBarriers (arena.CopyArray (memoryBarriers))
+        , bufferMemoryBarriers (arena.CopyArray (bufferMemoryBarriers))
+        , imageMemoryBarriers (arena.CopyArray (imageMemoryBarriers))
+    {
+    }
+
+    virtual void Record (CommandBuffer&) override;
+
+    virtual bool IsEquivalent (const Command& other) override
+    {
+        if (auto otherCommand = dynamic_cast<const CommandWaitEvents*> (&other)) {
+            return events == otherCommand->events &&
+                   srcStageMask == otherCommand->srcStageMask &&
+                   dstStageMask == otherCommand->dstStageMask &&
+                   memoryBarriers.size () == otherCommand->memoryBarriers.size () &&
+                   bufferMemoryBarriers.size () == otherCommand->bufferMemoryBarriers.size () &&
+                   imageMemoryBarriers.size () == otherCommand->imageMemoryBarriers.size ();
+        }
+
+        return false;
+    }
+
+    // captured as a pipeline barrier with the same stages and barriers
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
+};
+
+
 class RENDERGRAPH_DLL_EXPORT CommandTranstionImage : public Command {
 private:
     VkImageMemoryBarrier imageMemoryBarrier;
@@ -198,6 +293,9 @@ public:
 
         return false;
     }
+
+    // the barrier recorded by this command is captured on its own
+    virtual bool Serialize (CommandStreamWriter&) const override { return true; }
 };
 
 class RENDERGRAPH_DLL_EXPORT CommandGeneric : public Command {
@@ -223,6 +321,12 @@ public:
 
         return false;
     }
+
+    // the callback can bind anything
+    virtual void UpdateBoundState (CommandBoundState& state) const override
+    {
+        state.Clear ();
+    }
 };
 
 
@@ -261,9 +365,91 @@ public:
 
         return false;
     }
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
 };
 
 
+class RENDERGRAPH_DLL_EXPORT CommandDrawIndexedIndirect : public Command {
+private:
+    VkBuffer     buffer;
+    VkDeviceSize offset;
+    uint32_t     drawCount;
+    uint32_t     stride;
+
+public:
+    CommandDrawIndexedIndirect (VkBuffer     buffer,
+                                VkDeviceSize offset,
+                                uint32_t     drawCount,
+                                uint32_t     stride)
+        : buffer (buffer)
+        , offset (offset)
+        , drawCount (drawCount)
+        , stride (stride)
+    {
+    }
+
+    virtual void Record (CommandBuffer& commandBuffer) override
+    {
+        vkCmdDrawIndexedIndirect (commandBuffer.GetHandle (), buffer, offset, drawCount, stride);
+    }
+
+    virtual bool IsEquivalent (const Command& other) override
+    {
+        if (auto otherCommand = dynamic_cast<const CommandDrawIndexedIndirect*> (&other)) {
+            return buffer == otherCommand->buffer && offset == otherCommand->offset && drawCount == otherCommand->drawCount && stride == otherCommand->stride;
+        }
+
+        return false;
+    }
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
+};
+
+
+// the draw count is read from countBuffer on the gpu, capped at maxDrawCount
+class RENDERGRAPH_DLL_EXPORT CommandDrawIndexedIndirectCount : public Command {
+private:
+    VkBuffer     buffer;
+    VkDeviceSize offset;
+    VkBuffer     countBuffer;
+    VkDeviceSize countBufferOffset;
+    uint32_t     maxDrawCount;
+    uint32_t     stride;
+
+public:
+    CommandDrawIndexedIndirectCount (VkBuffer     buffer,
+                                     VkDeviceSize offset,
+                                     VkBuffer     countBuffer,
+                                     VkDeviceSize countBufferOffset,
+                                     uint32_t     maxDrawCount,
+                                     uint32_t     stride)
+        : buffer (buffer)
+        , offset (offset)
+        , countBuffer (countBuffer)
+        , countBufferOffset (countBufferOffset)
+        , maxDrawCount (maxDrawCount)
+        , stride (stride)
+    {
+    }
+
+    virtual void Record (CommandBuffer& commandBuffer) override
+    {
+        vkCmdDrawIndexedIndirectCount (commandBuffer.GetHandle (), buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+    }
+
+    virtual bool IsEquivalent (const Command& other) override
+    {
+        if (auto otherCommand = dynamic_cast<const CommandDrawIndexedIndirectCount*> (&other)) {
+            return buffer == otherCommand->buffer && offset == otherCommand->offset && countBuffer == otherCommand->countBuffer && countBufferOffset == otherCommand->countBufferOffset && maxDrawCount == otherCommand->maxDrawCount && stride == otherCommand->stride;
+        }
+
+        return false;
+    }
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
+};
+
 class RENDERGRAPH_DLL_EXPORT CommandDraw : public Command {
 private:
     uint32_t vertexCount;
@@ -296,6 +482,8 @@ public:
 
         return false;
     }
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
 };
 
 
@@ -329,6 +517,21 @@ public:
 
         return false;
     }
+
+    virtual bool IsRedundant (const CommandBoundState& state) const override
+    {
+        return state.indexBuffer.has_value () &&
+               state.indexBuffer->buffer == buffer &&
+               state.indexBuffer->offset == offset &&
+               state.indexBuffer->indexType == indexType;
+    }
+
+    virtual void UpdateBoundState (CommandBoundState& state) const override
+    {
+        state.indexBuffer = CommandBoundState::IndexBufferBinding { buffer, offset, indexType };
+    }
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
 };
 
 
@@ -349,24 +552,27 @@ public:
 
         return false;
     }
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
 };
 
 
 class RENDERGRAPH_DLL_EXPORT CommandBeginRenderPass : public Command {
 private:
-    VkRenderPassBeginInfo     renderPassBegin;
-    VkSubpassContents         contents;
-    std::vector<VkClearValue> clearValues;
+    VkRenderPassBeginInfo      renderPassBegin;
+    VkSubpassContents          contents;
+    CommandArray<VkClearValue> clearValues;
 
 public:
-    CommandBeginRenderPass (VkRenderPass                     renderPass,
+    CommandBeginRenderPass (CommandArena&                    arena,
+                            VkRenderPass                     renderPass,
                             VkFramebuffer                    framebuffer,
                             VkRect2D                         renderArea,
                             const std::vector<VkClearValue>& clearValues_,
                             VkSubpassContents                contents = VK_SUBPASS_CONTENTS_INLINE)
         : renderPassBegin ({})
         , contents (contents)
-        , clearValues (clearValues_)
+        , clearValues (arena.CopyArray (clearValues_))
     {
         renderPassBegin.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
         renderPassBegin.pNext           = nullptr;
@@ -391,6 +597,13 @@ public:
 
         return false;
     }
+
+    virtual void UpdateStatistics (CommandStatistics& statistics) const override
+    {
+        ++statistics.renderPassBegins;
+    }
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
 };
 
 
@@ -421,19 +634,38 @@ public:
 
         return false;
     }
+
+    virtual bool IsRedundant (const CommandBoundState& state) const override
+    {
+        auto found = state.pipelines.find (pipelineBindPoint);
+        return found != state.pipelines.end () && found->second == pipeline;
+    }
+
+    virtual void UpdateBoundState (CommandBoundState& state) const override
+    {
+        state.pipelines[pipelineBindPoint] = pipeline;
+    }
+
+    virtual void UpdateStatistics (CommandStatistics& statistics) const override
+    {
+        ++statistics.pipelineBinds;
+    }
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
 };
 
 
 class RENDERGRAPH_DLL_EXPORT CommandBindDescriptorSets : public Command {
 private:
-    VkPipelineBindPoint          pipelineBindPoint;
-    VkPipelineLayout             layout;
-    uint32_t                     firstSet;
-    std::vector<VkDescriptorSet> descriptorSets;
-    std::vector<uint32_t>        dynamicOffsets;
+    VkPipelineBindPoint           pipelineBindPoint;
+    VkPipelineLayout              layout;
+    uint32_t                      firstSet;
+    CommandArray<VkDescriptorSet> descriptorSets;
+    CommandArray<uint32_t>        dynamicOffsets;
 
 public:
-    CommandBindDescriptorSets (VkPipelineBindPoint                 pipelineBindPoint,
+    CommandBindDescriptorSets (CommandArena&                       arena,
+                               VkPipelineBindPoint                 pipelineBindPoint,
                                VkPipelineLayout                    layout,
                                uint32_t                            firstSet,
                                const std::vector<VkDescriptorSet>& descriptorSets,
@@ -441,8 +673,8 @@ public:
         : pipelineBindPoint (pipelineBindPoint)
         , layout (layout)
         , firstSet (firstSet)
-        , descriptorSets (descriptorSets)
-        , dynamicOffsets (dynamicOffsets)
+        , descriptorSets (arena.CopyArray (descriptorSets))
+        , dynamicOffsets (arena.CopyArray (dynamicOffsets))
     {
     }
 
@@ -464,18 +696,25 @@ public:
 
         return false;
     }
+
+    virtual bool IsRedundant (const CommandBoundState& state) const override;
+
+    virtual void UpdateBoundState (CommandBoundState& state) const override;
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
 };
 
 class RENDERGRAPH_DLL_EXPORT CommandCopyImage : public Command {
 private:
-    VkImage                  srcImage;
-    VkImageLayout            srcImageLayout;
-    VkImage                  dstImage;
-    VkImageLayout            dstImageLayout;
-    std::vector<VkImageCopy> regions;
+    VkImage                   srcImage;
+    VkImageLayout             srcImageLayout;
+    VkImage                   dstImage;
+    VkImageLayout             dstImageLayout;
+    CommandArray<VkImageCopy> regions;
 
 public:
-    CommandCopyImage (VkImage                         srcImage,
+    CommandCopyImage (CommandArena&                   arena,
+                      VkImage                         srcImage,
                       VkImageLayout                   srcImageLayout,
                       VkImage                         dstImage,
                       VkImageLayout                   dstImageLayout,
@@ -484,7 +723,7 @@ public:
         , srcImageLayout (srcImageLayout)
         , dstImage (dstImage)
         , dstImageLayout (dstImageLayout)
-        , regions (regions)
+        , regions (arena.CopyArray (regions))
     {
     }
 
@@ -503,24 +742,73 @@ public:
 
         return false;
     }
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
+};
+
+class RENDERGRAPH_DLL_EXPORT CommandBlitImage : public Command {
+private:
+    VkImage                   srcImage;
+    VkImageLayout             srcImageLayout;
+    VkImage                   dstImage;
+    VkImageLayout             dstImageLayout;
+    CommandArray<VkImageBlit> regions;
+    VkFilter                  filter;
+
+public:
+    CommandBlitImage (CommandArena&                   arena,
+                      VkImage                         srcImage,
+                      VkImageLayout                   srcImageLayout,
+                      VkImage                         dstImage,
+                      VkImageLayout                   dstImageLayout,
+                      const std::vector<VkImageBlit>& regions,
+                      VkFilter                        filter)
+        : srcImage (srcImage)
+        , srcImageLayout (srcImageLayout)
+        , dstImage (dstImage)
+        , dstImageLayout (dstImageLayout)
+        , regions (arena.CopyArray (regions))
+        , filter (filter)
+    {
+    }
+
+    virtual void Record (CommandBuffer& commandBuffer) override
+    {
+        vkCmdBlitImage (commandBuffer.GetHandle (), srcImage, srcImageLayout, dstImage, dstImageLayout, static_cast<uint32_t> (regions.size ()), regions.data (), filter);
+    }
+
+    virtual bool IsEquivalent (const Command& other) override
+    {
+        if (auto otherCommand = dynamic_cast<const CommandBlitImage*> (&other)) {
+            // ignore VkImage, VkImageBlit
+            return srcImageLayout == otherCommand->srcImageLayout &&
+                   dstImageLayout == otherCommand->dstImageLayout &&
+                   filter == otherCommand->filter;
+        }
+
+        return false;
+    }
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
 };
 
 class RENDERGRAPH_DLL_EXPORT CommandCopyImageToBuffer : public Command {
 private:
-    VkImage                        srcImage;
-    VkImageLayout                  srcImageLayout;
-    VkBuffer                       dstBuffer;
-    std::vector<VkBufferImageCopy> regions;
+    VkImage                         srcImage;
+    VkImageLayout                   srcImageLayout;
+    VkBuffer                        dstBuffer;
+    CommandArray<VkBufferImageCopy> regions;
 
 public:
-    CommandCopyImageToBuffer (VkImage                               srcImage,
+    CommandCopyImageToBuffer (CommandArena&                         arena,
+                              VkImage                               srcImage,
                               VkImageLayout                         srcImageLayout,
                               VkBuffer                              dstBuffer,
                               const std::vector<VkBufferImageCopy>& regions)
         : srcImage (srcImage)
         , srcImageLayout (srcImageLayout)
         , dstBuffer (dstBuffer)
-        , regions (regions)
+        , regions (arena.CopyArray (regions))
     {
     }
 
@@ -543,25 +831,28 @@ public:
 
         return false;
     }
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
 };
 
 
 class RENDERGRAPH_DLL_EXPORT CommandCopyBufferToImage : public Command {
 private:
-    VkBuffer                       srcBuffer;
-    VkImage                        dstImage;
-    VkImageLayout                  dstImageLayout;
-    std::vector<VkBufferImageCopy> regions;
+    VkBuffer                        srcBuffer;
+    VkImage                         dstImage;
+    VkImageLayout                   dstImageLayout;
+    CommandArray<VkBufferImageCopy> regions;
 
 public:
-    CommandCopyBufferToImage (VkBuffer                       srcBuffer,
-                              VkImage                        dstImage,
-                              VkImageLayout                  dstImageLayout,
-                              std::vector<VkBufferImageCopy> regions)
+    CommandCopyBufferToImage (CommandArena&                         arena,
+                              VkBuffer                              srcBuffer,
+                              VkImage                               dstImage,
+                              VkImageLayout                         dstImageLayout,
+                              const std::vector<VkBufferImageCopy>& regions)
         : srcBuffer (srcBuffer)
         , dstImage (dstImage)
         , dstImageLayout (dstImageLayout)
-        , regions (regions)
+        , regions (arena.CopyArray (regions))
     {
         RG_ASSERT (dstImageLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL || dstImageLayout == VK_IMAGE_LAYOUT_GENERAL);
     }
@@ -580,22 +871,25 @@ public:
 
         return false;
     }
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
 };
 
 
 class RENDERGRAPH_DLL_EXPORT CommandCopyBuffer : public Command {
 private:
-    VkBuffer                  srcBuffer;
-    VkBuffer                  dstBuffer;
-    std::vector<VkBufferCopy> regions;
+    VkBuffer                   srcBuffer;
+    VkBuffer                   dstBuffer;
+    CommandArray<VkBufferCopy> regions;
 
 public:
-    CommandCopyBuffer (VkBuffer                         srcBuffer,
+    CommandCopyBuffer (CommandArena&                    arena,
+                       VkBuffer                         srcBuffer,
                        VkBuffer                         dstBuffer,
                        const std::vector<VkBufferCopy>& regions)
         : srcBuffer (srcBuffer)
         , dstBuffer (dstBuffer)
-        , regions (regions)
+        , regions (arena.CopyArray (regions))
     {
     }
 
@@ -613,6 +907,8 @@ public:
 
         return false;
     }
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
 };
 
 
@@ -647,6 +943,8 @@ public:
 
         return false;
     }
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
 };
 
 
@@ -693,6 +991,8 @@ public:
 
         return false;
     }
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
 };
 
 
@@ -723,6 +1023,8 @@ public:
 
         return false;
     }
+
+    virtual bool Serialize (CommandStreamWriter& writer) const override;
 };
 
 } // namespace RG
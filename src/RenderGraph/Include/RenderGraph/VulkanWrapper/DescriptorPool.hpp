@@ -15,7 +15,7 @@ private:
     VkDescriptorPool handle;
 
 public:
-    DescriptorPool (VkDevice device, std::vector<VkDescriptorPoolSize> poolSizes, uint32_t maxSets)
+    DescriptorPool (VkDevice device, std::vector<VkDescriptorPoolSize> poolSizes, uint32_t maxSets, VkDescriptorPoolCreateFlags flags = 0)
         : device (device)
         , handle (VK_NULL_HANDLE)
     {
@@ -28,6 +28,7 @@ public:
         poolInfo.poolSizeCount              = static_cast<uint32_t> (poolSizes.size ());
         poolInfo.pPoolSizes                 = poolSizes.data ();
         poolInfo.maxSets                    = maxSets;
+        poolInfo.flags                      = flags;
 
         if (RG_ERROR (vkCreateDescriptorPool (device, &poolInfo, nullptr, &handle) != VK_SUCCESS)) {
             throw std::runtime_error ("failed to create descriptor pool");
@@ -17,7 +17,7 @@ private:
     std::vector<VkDescriptorSetLayoutBinding> bindings;
 
 public:
-    DescriptorSetLayout (VkDevice device, const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+    DescriptorSetLayout (VkDevice device, const std::vector<VkDescriptorSetLayoutBinding>& bindings, VkDescriptorSetLayoutCreateFlags flags = 0, const std::vector<VkDescriptorBindingFlags>& bindingFlags = {})
         : device (device)
         , handle (VK_NULL_HANDLE)
         , bindings (bindings)
@@ -30,8 +30,17 @@ public:
             }
         }
 
+        RG_ASSERT (bindingFlags.empty () || bindingFlags.size () == bindings.size ());
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {};
+        bindingFlagsInfo.sType                                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        bindingFlagsInfo.bindingCount                                = static_cast<uint32_t> (bindingFlags.size ());
+        bindingFlagsInfo.pBindingFlags                               = bindingFlags.data ();
+
         VkDescriptorSetLayoutCreateInfo layoutInfo = {};
         layoutInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.pNext                           = bindingFlags.empty () ? nullptr : &bindingFlagsInfo;
+        layoutInfo.flags                           = flags;
         layoutInfo.bindingCount                    = static_cast<uint32_t> (bindings.size ());
         layoutInfo.pBindings                       = bindings.data ();
 
@@ -29,6 +29,10 @@ class RENDERGRAPH_DLL_EXPORT DeviceObject : public VulkanObject, public Device {
 private:
     VkPhysicalDevice          physicalDevice;
     RG::MovablePtr<VkDevice> handle;
+    uint32_t                  bindlessTextureCapacity;
+    bool                      multiDrawIndirectSupported;
+    bool                      drawIndirectCountSupported;
+    bool                      memoryBudgetSupported;
 
 public:
     DeviceObject (VkPhysicalDevice physicalDevice, std::vector<uint32_t> queueFamilyIndices, std::vector<const char*> requestedDeviceExtensions);
@@ -49,6 +53,18 @@ public:
         vkDeviceWaitIdle (handle);
     }
 
+    // 0 when descriptor indexing is not available
+    uint32_t GetBindlessTextureCapacity () const { return bindlessTextureCapacity; }
+
+    // indirect draws with more than one record need the multiDrawIndirect feature
+    bool SupportsMultiDrawIndirect () const { return multiDrawIndirectSupported; }
+
+    // vkCmdDrawIndexedIndirectCount needs the 1.2 drawIndirectCount feature
+    bool SupportsDrawIndirectCount () const { return drawIndirectCountSupported; }
+
+    // VK_EXT_memory_budget is enabled whenever it is available, the allocator has to be told about it
+    bool SupportsMemoryBudget () const { return memoryBudgetSupported; }
+
 private:
     uint32_t FindMemoryType (uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
 };
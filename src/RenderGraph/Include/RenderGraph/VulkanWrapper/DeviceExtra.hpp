@@ -7,6 +7,9 @@
 #include "CommandPool.hpp"
 #include "Device.hpp"
 #include "Queue.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/BindlessTextureTable.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/DescriptorAllocator.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/StagingBufferPool.hpp"
 
 #pragma warning (push, 0)
 #include "vk_mem_alloc.h"
@@ -23,6 +26,29 @@ public:
     Queue&       presentationQueue;
     VmaAllocator allocator;
 
+    // persistently mapped buffers reused by readbacks and batched uploads
+    std::unique_ptr<StagingBufferPool> readbackPool;
+    std::unique_ptr<StagingBufferPool> uploadPool;
+
+    // shared by every graph compiled on this device
+    std::unique_ptr<DescriptorAllocator> descriptorAllocator;
+
+    // set only when the device supports descriptor indexing
+    std::unique_ptr<BindlessTextureTable> bindlessTextures;
+
+    // set only when the device has a transfer-only queue family, except the graphics family index
+    Queue*       transferQueue;
+    CommandPool* transferCommandPool;
+    uint32_t     graphicsQueueFamilyIndex;
+    uint32_t     transferQueueFamilyIndex;
+
+    // format support queries report no features until it is set
+    VkPhysicalDevice physicalDevice;
+
+    // optional features enabled on the device, indirect draws needing them are rejected when compiled
+    bool multiDrawIndirect;
+    bool drawIndirectCount;
+
     DeviceExtra (Instance& instance, Device& device, CommandPool& commandPool, VmaAllocator allocator, Queue& graphicsQueue, Queue& presentationQueue = dummyQueue)
         : instance (instance)
         , device (device)
@@ -30,7 +56,46 @@ public:
         , graphicsQueue (graphicsQueue)
         , presentationQueue (presentationQueue)
         , allocator (allocator)
+        , readbackPool (std::make_unique<StagingBufferPool> (allocator, VK_BUFFER_USAGE_TRANSFER_DST_BIT, MemoryLocation::CPUReadback))
+        , uploadPool (std::make_unique<StagingBufferPool> (allocator, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, MemoryLocation::CPUStreaming))
+        , descriptorAllocator (std::make_unique<DescriptorAllocator> (device))
+        , transferQueue (nullptr)
+        , transferCommandPool (nullptr)
+        , graphicsQueueFamilyIndex (VK_QUEUE_FAMILY_IGNORED)
+        , transferQueueFamilyIndex (VK_QUEUE_FAMILY_IGNORED)
+        , physicalDevice (VK_NULL_HANDLE)
+        , multiDrawIndirect (false)
+        , drawIndirectCount (false)
+    {
+    }
+
+    void SetPhysicalDevice (VkPhysicalDevice value)
+    {
+        physicalDevice = value;
+    }
+
+    void SetGraphicsQueueFamilyIndex (uint32_t graphicsFamilyIndex)
+    {
+        graphicsQueueFamilyIndex = graphicsFamilyIndex;
+    }
+
+    void SetDedicatedTransferQueue (Queue& queue, CommandPool& pool, uint32_t transferFamilyIndex, uint32_t graphicsFamilyIndex)
     {
+        transferQueue            = &queue;
+        transferCommandPool      = &pool;
+        transferQueueFamilyIndex = transferFamilyIndex;
+        graphicsQueueFamilyIndex = graphicsFamilyIndex;
+    }
+
+    void SetIndirectDrawFeatures (bool multiDrawIndirectEnabled, bool drawIndirectCountEnabled)
+    {
+        multiDrawIndirect = multiDrawIndirectEnabled;
+        drawIndirectCount = drawIndirectCountEnabled;
+    }
+
+    void EnableBindlessTextures (uint32_t capacity)
+    {
+        bindlessTextures = std::make_unique<BindlessTextureTable> (device, capacity);
     }
 
     virtual ~DeviceExtra () override;
@@ -41,6 +106,33 @@ public:
     const Queue&       GetGraphicsQueue () const { return graphicsQueue; }
     const Queue&       GetPresentationQueue () const { return presentationQueue; }
     VmaAllocator       GetAllocator () const { return allocator; }
+    StagingBufferPool& GetReadbackPool () const { return *readbackPool; }
+    StagingBufferPool& GetUploadPool () const { return *uploadPool; }
+
+    DescriptorAllocator& GetDescriptorAllocator () const { return *descriptorAllocator; }
+
+    bool                  HasBindlessTextures () const { return bindlessTextures != nullptr; }
+    BindlessTextureTable& GetBindlessTextureTable () const { return *bindlessTextures; }
+
+    bool SupportsMultiDrawIndirect () const { return multiDrawIndirect; }
+    bool SupportsDrawIndirectCount () const { return drawIndirectCount; }
+
+    bool               HasDedicatedTransferQueue () const { return transferQueue != nullptr; }
+    const Queue&       GetTransferQueue () const { return HasDedicatedTransferQueue () ? *transferQueue : graphicsQueue; }
+    const CommandPool& GetTransferCommandPool () const { return HasDedicatedTransferQueue () ? *transferCommandPool : commandPool; }
+    uint32_t           GetGraphicsQueueFamilyIndex () const { return graphicsQueueFamilyIndex; }
+    uint32_t           GetTransferQueueFamilyIndex () const { return transferQueueFamilyIndex; }
+
+    VkFormatFeatureFlags GetOptimalTilingFeatures (VkFormat format) const
+    {
+        if (physicalDevice == VK_NULL_HANDLE) {
+            return 0;
+        }
+
+        VkFormatProperties properties = {};
+        vkGetPhysicalDeviceFormatProperties (physicalDevice, format, &properties);
+        return properties.optimalTilingFeatures;
+    }
 
     Instance&    GetInstance () { return instance; }
     Device&      GetDevice () { return device; }
@@ -29,6 +29,9 @@ public:
 
     void Wait () const;
 
+    // does not block
+    bool IsSignaled () const;
+
     void Reset () const;
 
 private:
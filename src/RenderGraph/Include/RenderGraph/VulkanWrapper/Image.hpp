@@ -2,6 +2,7 @@
 #define IMAGE_HPP
 
 #include "RenderGraph/Utils/MovablePtr.hpp"
+#include "MemoryLocation.hpp"
 #include "VulkanObject.hpp"
 
 #pragma warning (push, 0)
@@ -25,10 +26,7 @@ public:
     static constexpr VkFormat RGB  = VK_FORMAT_R8G8B8_UINT;
     static constexpr VkFormat RGBA = VK_FORMAT_R8G8B8A8_UINT;
 
-    enum class MemoryLocation {
-        GPU,
-        CPU
-    };
+    using MemoryLocation = RG::MemoryLocation;
 
 protected:
     RG::MovablePtr<VkImage> handle;
@@ -38,15 +36,19 @@ private:
     VmaAllocator  allocator;
     VmaAllocation allocationHandle;
 
-    VkFormat format;
-    uint32_t width;
-    uint32_t height;
-    uint32_t depth;
-    uint32_t arrayLayers;
+    VkFormat          format;
+    VkImageUsageFlags usage;
+    uint32_t          width;
+    uint32_t          height;
+    uint32_t          depth;
+    uint32_t          arrayLayers;
+    uint32_t          mipLevels;
+
+    MemoryLocation memoryLocation;
 
 protected:
     // for InheritedImage
-    Image (VkImage handle, VkDevice device, uint32_t width, uint32_t height, uint32_t depth, VkFormat format, uint32_t arrayLayers);
+    Image (VkImage handle, VkDevice device, uint32_t width, uint32_t height, uint32_t depth, VkFormat format, uint32_t arrayLayers, VkImageUsageFlags usage);
 
 public:
     Image (VmaAllocator      allocator,
@@ -58,7 +60,8 @@ public:
            VkImageTiling     tiling,
            VkImageUsageFlags usage,
            uint32_t          arrayLayers,
-           MemoryLocation    loc);
+           MemoryLocation    loc,
+           uint32_t          mipLevels = 1);
 
     Image (ImageBuilder&);
 
@@ -71,21 +74,38 @@ public:
 
     virtual VkObjectType GetObjectTypeForName () const override { return VK_OBJECT_TYPE_IMAGE; }
 
-    VkFormat GetFormat () const { return format; }
-    uint32_t GetArrayLayers () const { return arrayLayers; }
-    uint32_t GetWidth () const { return width; }
-    uint32_t GetHeight () const { return height; }
-    uint32_t GetDepth () const { return depth; }
+    VkFormat          GetFormat () const { return format; }
+    VkImageUsageFlags GetUsage () const { return usage; }
+    uint32_t          GetArrayLayers () const { return arrayLayers; }
+    uint32_t          GetWidth () const { return width; }
+    uint32_t          GetHeight () const { return height; }
+    uint32_t          GetDepth () const { return depth; }
+    uint32_t          GetMipLevels () const { return mipLevels; }
+
+    // levels down to 1x1x1
+    static uint32_t GetFullMipLevelCount (uint32_t width, uint32_t height, uint32_t depth);
+
+    // differs from the requested location when the image was allocated from a fallback
+    MemoryLocation GetMemoryLocation () const { return memoryLocation; }
 
     operator VkImage () const { return handle; }
     operator VmaAllocation () const { return allocationHandle; }
 
     VkBufferImageCopy GetFullBufferImageCopy () const;
     VkBufferImageCopy GetFullBufferImageCopyLayer (uint32_t layerIndex) const;
+    VkBufferImageCopy GetBufferImageCopyRegion (VkOffset3D offset, VkExtent3D extent, uint32_t layerIndex) const;
+
+    // whether the image subresource and the offset and extent of region are inside the image
+    // for block compressed formats also whether the region is aligned to the 4x4 blocks
+    bool IsInside (const VkBufferImageCopy& region) const;
+
+    // bytes the region reads from its buffer starting at bufferOffset, respecting bufferRowLength and bufferImageHeight
+    size_t GetBufferImageCopySize (const VkBufferImageCopy& region) const;
 
     VkImageMemoryBarrier GetBarrier (VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask) const;
     VkImageMemoryBarrier GetBarrier (VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, uint32_t layerIndex) const;
     VkImageMemoryBarrier GetBarrier (VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, uint32_t baseArrayLayer, uint32_t layerCount) const;
+    VkImageMemoryBarrier GetBarrier (VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, const VkImageSubresourceRange& subresourceRange) const;
 
     void CmdCopyToBuffer (CommandBuffer& commandBuffer, VkBuffer buffer) const;
     void CmdCopyLayerToBuffer (CommandBuffer& commandBuffer, uint32_t layerIndex, VkBuffer buffer) const;
@@ -93,14 +113,19 @@ public:
     void CmdCopyBufferToImage (CommandBuffer& commandBuffer, VkBuffer buffer) const;
 
     void CmdCopyBufferPartToImage (CommandBuffer& commandBuffer, VkBuffer buffer, VkBufferImageCopy region) const;
+
+    // fills every level above 0 of the layers by blitting each level from the previous one
+    // level 0 has to be in levelZeroLayout, the other levels are discarded, every level ends up in finalLayout
+    // the image needs VK_IMAGE_USAGE_TRANSFER_SRC_BIT and VK_IMAGE_USAGE_TRANSFER_DST_BIT
+    void CmdGenerateMipLevels (CommandBuffer& commandBuffer, uint32_t baseArrayLayer, uint32_t layerCount, VkImageLayout levelZeroLayout, VkImageLayout finalLayout, VkFilter filter) const;
 };
 
 
 // used for handling swapchain images as Image
 class RENDERGRAPH_DLL_EXPORT InheritedImage : public Image {
 public:
-    InheritedImage (VkImage handle, uint32_t width, uint32_t height, uint32_t depth, VkFormat format, uint32_t arrayLayers)
-        : Image (handle, VK_NULL_HANDLE, width, height, depth, format, arrayLayers)
+    InheritedImage (VkImage handle, uint32_t width, uint32_t height, uint32_t depth, VkFormat format, uint32_t arrayLayers, VkImageUsageFlags usage)
+        : Image (handle, VK_NULL_HANDLE, width, height, depth, format, arrayLayers, usage)
     {
     }
 
@@ -124,10 +149,12 @@ public:
     VkImageUsageFlags                    usage;
     std::optional<uint32_t>              arrayLayers;
     std::optional<Image::MemoryLocation> loc;
+    uint32_t                             mipLevels;
 
     ImageBuilder (VmaAllocator allocator)
         : allocator (allocator)
         , usage (0)
+        , mipLevels (1)
     {
     }
 
@@ -158,6 +185,8 @@ public:
 
     ImageBuilder& SetLayers (uint32_t value) { arrayLayers = value; return *this; }
 
+    ImageBuilder& SetMipLevels (uint32_t value) { mipLevels = value; return *this; }
+
 #pragma warning(default:26815)
 
     // clang-format on
@@ -168,8 +197,8 @@ public:
 
 class RENDERGRAPH_DLL_EXPORT Image1D : public Image {
 public:
-    Image1D (VmaAllocator allocator, MemoryLocation loc, uint32_t width, VkFormat format, VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL, VkImageUsageFlags usage = 0, uint32_t arrayLayers = 1)
-        : Image (allocator, VK_IMAGE_TYPE_1D, width, 1, 1, format, tiling, usage, arrayLayers, loc)
+    Image1D (VmaAllocator allocator, MemoryLocation loc, uint32_t width, VkFormat format, VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL, VkImageUsageFlags usage = 0, uint32_t arrayLayers = 1, uint32_t mipLevels = 1)
+        : Image (allocator, VK_IMAGE_TYPE_1D, width, 1, 1, format, tiling, usage, arrayLayers, loc, mipLevels)
     {
     }
 };
@@ -177,8 +206,8 @@ public:
 
 class RENDERGRAPH_DLL_EXPORT Image2D : public Image {
 public:
-    Image2D (VmaAllocator allocator, MemoryLocation loc, uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL, VkImageUsageFlags usage = 0, uint32_t arrayLayers = 1)
-        : Image (allocator, VK_IMAGE_TYPE_2D, width, height, 1, format, tiling, usage, arrayLayers, loc)
+    Image2D (VmaAllocator allocator, MemoryLocation loc, uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL, VkImageUsageFlags usage = 0, uint32_t arrayLayers = 1, uint32_t mipLevels = 1)
+        : Image (allocator, VK_IMAGE_TYPE_2D, width, height, 1, format, tiling, usage, arrayLayers, loc, mipLevels)
     {
     }
 };
@@ -186,8 +215,8 @@ public:
 
 class RENDERGRAPH_DLL_EXPORT Image3D : public Image {
 public:
-    Image3D (VmaAllocator allocator, MemoryLocation loc, uint32_t width, uint32_t height, uint32_t depth, VkFormat format, VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL, VkImageUsageFlags usage = 0)
-        : Image (allocator, VK_IMAGE_TYPE_3D, width, height, depth, format, tiling, usage, 1, loc)
+    Image3D (VmaAllocator allocator, MemoryLocation loc, uint32_t width, uint32_t height, uint32_t depth, VkFormat format, VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL, VkImageUsageFlags usage = 0, uint32_t mipLevels = 1)
+        : Image (allocator, VK_IMAGE_TYPE_3D, width, height, depth, format, tiling, usage, 1, loc, mipLevels)
     {
     }
 };
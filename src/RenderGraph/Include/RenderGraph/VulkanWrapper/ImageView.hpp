@@ -17,7 +17,8 @@ private:
     RG::MovablePtr<VkImageView> handle;
 
 public:
-    ImageViewBase (VkDevice device, VkImage image, VkFormat format, VkImageViewType viewType, uint32_t layerIndex = 0, uint32_t layerCount = 1);
+    // views created from an Image cover all of its mip levels
+    ImageViewBase (VkDevice device, VkImage image, VkFormat format, VkImageViewType viewType, uint32_t layerIndex = 0, uint32_t layerCount = 1, uint32_t levelCount = 1);
     ImageViewBase (VkDevice device, const Image2D& image, VkImageViewType viewType, uint32_t layerIndex = 0);
 
     ImageViewBase (ImageViewBase&&) = default;
@@ -0,0 +1,40 @@
+#ifndef MEMORYLOCATION_HPP
+#define MEMORYLOCATION_HPP
+
+#include "RenderGraph/RenderGraphExport.hpp"
+
+#pragma warning (push, 0)
+#include "vk_mem_alloc.h"
+#pragma warning(pop)
+
+#include <optional>
+
+namespace RG {
+
+// where the memory of a buffer or image is placed, see GetFallbackMemoryLocation when the preferred memory is not available
+enum class MemoryLocation {
+    GPU,                // device local, not accessible from the host
+    CPU,                // host visible, e.g. staging
+    GPUHostVisible,     // device local, host visible and coherent (resizable BAR), written by the host and read directly by the device
+    CPUStreaming,       // host visible and coherent, written sequentially by the host every frame
+    CPUReadback,        // host visible and cached if possible, written by the device and read randomly by the host
+    GPULazilyAllocated, // for transient attachments, the image usage has to contain VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT
+};
+
+
+RENDERGRAPH_DLL_EXPORT
+VmaAllocationCreateInfo GetAllocationCreateInfo (MemoryLocation location);
+
+// the location to retry with when allocating from location failed
+RENDERGRAPH_DLL_EXPORT
+std::optional<MemoryLocation> GetFallbackMemoryLocation (MemoryLocation location);
+
+RENDERGRAPH_DLL_EXPORT
+bool IsHostVisible (MemoryLocation location);
+
+RENDERGRAPH_DLL_EXPORT
+const char* MemoryLocationToString (MemoryLocation location);
+
+} // namespace RG
+
+#endif
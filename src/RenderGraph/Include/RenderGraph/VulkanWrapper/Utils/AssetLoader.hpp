@@ -0,0 +1,113 @@
+#ifndef ASSETLOADER_HPP
+#define ASSETLOADER_HPP
+
+#include "RenderGraph/RenderGraphExport.hpp"
+
+#include "RenderGraph/Utils/Event.hpp"
+#include "RenderGraph/Utils/Noncopyable.hpp"
+
+#include "RenderGraph/VulkanWrapper/DeviceExtra.hpp"
+#include "RenderGraph/VulkanWrapper/Image.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace RG {
+
+class UploadBatch;
+
+// loads image files into images on worker threads
+// each worker maps and decodes its file straight into staging memory of the open upload batch,
+// a batch is closed once it holds batchSize bytes or no more files are queued, and submitted as soon as all of its files are decoded,
+// so the GPU copies of earlier assets overlap with reading and decoding later ones
+// all Vulkan submissions happen on the thread calling Update and Wait, assetLoaded is notified there as well
+class RENDERGRAPH_DLL_EXPORT AssetLoader final : public Noncopyable {
+public:
+    using AssetId = size_t;
+
+    enum class AssetState {
+        Pending,  // waiting for a worker or for its batch to finish
+        Uploaded, // the copy into the image finished
+        Failed,   // the file could not be read or decoded, the image content is undefined
+    };
+
+    // the asset and whether it was uploaded successfully
+    RG::Event<AssetId, bool> assetLoaded;
+
+private:
+    struct Job {
+        AssetId                      id;
+        std::filesystem::path        filePath;
+        const Image*                 image;
+        uint32_t                     layerIndex;
+        VkImageLayout                currentLayout;
+        std::optional<VkImageLayout> nextLayout;
+    };
+
+    struct PendingBatch {
+        std::unique_ptr<UploadBatch> batch;
+        std::vector<AssetId>         assets;
+        size_t                       reservedBytes;
+        uint32_t                     unfinishedDecodes;
+        bool                         closed;
+        bool                         submitted;
+    };
+
+    const DeviceExtra& device;
+    const size_t       batchSize;
+
+    mutable std::mutex                         mutex;
+    std::condition_variable                    jobAvailable;
+    std::condition_variable                    decodeFinished;
+    std::deque<Job>                            jobs;
+    std::vector<AssetState>                    states;
+    std::vector<AssetId>                       failedAssets;
+    std::vector<std::unique_ptr<PendingBatch>> batches;
+    PendingBatch*                              openBatch;
+    uint32_t                                   runningJobs;
+    bool                                       stopping;
+
+    std::vector<std::thread> workers;
+
+public:
+    static constexpr size_t DefaultBatchSize = 32 * 1024 * 1024;
+
+    AssetLoader (const DeviceExtra& device, uint32_t threadCount = std::thread::hardware_concurrency (), size_t batchSize = DefaultBatchSize);
+
+    // waits for every queued asset
+    virtual ~AssetLoader () override;
+
+    // the image has to be an 8 bit format matching the size of the file, it has to stay alive until the asset is loaded
+    AssetId LoadImageFile (const std::filesystem::path& filePath, const Image& image, uint32_t layerIndex, VkImageLayout currentLayout, std::optional<VkImageLayout> nextLayout = std::nullopt);
+
+    // submits batches whose files are all decoded and reports finished assets, does not block
+    // calling it repeatedly is enough to get every queued asset loaded
+    void Update ();
+
+    // blocks until the asset is uploaded or failed
+    void Wait (AssetId id);
+
+    // blocks until every queued asset is uploaded or failed
+    void Wait ();
+
+    AssetState GetState (AssetId id) const;
+
+private:
+    void WorkerThread ();
+
+    void RunJob (const Job& job);
+
+    PendingBatch* FindBatch (AssetId id) const;
+
+    bool IsPending (AssetId id) const;
+};
+
+} // namespace RG
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef ASYNCREADBACK_HPP
+#define ASYNCREADBACK_HPP
+
+#include "RenderGraph/RenderGraphExport.hpp"
+
+#include "RenderGraph/Utils/Noncopyable.hpp"
+
+#include "RenderGraph/VulkanWrapper/CommandBuffer.hpp"
+#include "RenderGraph/VulkanWrapper/DeviceExtra.hpp"
+#include "RenderGraph/VulkanWrapper/Fence.hpp"
+#include "RenderGraph/VulkanWrapper/Image.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/StagingBufferPool.hpp"
+
+#include <functional>
+#include <memory>
+#include <optional>
+
+namespace RG {
+
+// GPU to CPU copy that is submitted immediately but only waited for when the data is accessed
+// the copied bytes are read directly from the mapped staging buffer, which returns to the pool on destruction
+class RENDERGRAPH_DLL_EXPORT AsyncReadback final : public Noncopyable {
+public:
+    using Recorder = std::function<void (CommandBuffer&, VkBuffer)>;
+
+private:
+    const DeviceExtra&                                device;
+    StagingBufferPool&                                pool;
+    std::unique_ptr<StagingBufferPool::StagingBuffer> stagingBuffer;
+    std::unique_ptr<CommandBuffer>                    commandBuffer;
+    std::unique_ptr<Fence>                            fence;
+    const size_t                                      size;
+    mutable bool                                      completed;
+    std::unique_ptr<Image>                            conversionImage;
+
+public:
+    AsyncReadback (const DeviceExtra& device, StagingBufferPool& pool, size_t size, const Recorder& recorder);
+
+    virtual ~AsyncReadback () override;
+
+    bool IsReady () const;
+
+    void Wait () const;
+
+    // waits for the copy to finish
+    const void* Get () const;
+
+    template<typename T>
+    const T* GetAs () const
+    {
+        return reinterpret_cast<const T*> (Get ());
+    }
+
+    size_t GetSize () const { return size; }
+
+    void CopyTo (void* destination, size_t destinationSize) const;
+
+    static std::unique_ptr<AsyncReadback> FromBuffer (const DeviceExtra& device, VkBuffer buffer, VkDeviceSize size, VkDeviceSize offset = 0);
+
+    static std::unique_ptr<AsyncReadback> FromImageLayer (const DeviceExtra& device, const Image& image, uint32_t layerIndex, std::optional<VkImageLayout> currentLayout = std::nullopt);
+
+    // whether FromImageLayerConverted can blit between the formats
+    static bool CanConvert (const DeviceExtra& device, VkFormat sourceFormat, VkFormat targetFormat);
+
+    // blits the layer into a temporary 2D image of targetFormat and reads that back in the same submission
+    // the blit converts channel order, sRGB encoding and component types, e.g. BGRA swapchain images to RGBA
+    static std::unique_ptr<AsyncReadback> FromImageLayerConverted (const DeviceExtra& device, const Image& image, uint32_t layerIndex, VkFormat targetFormat, std::optional<VkImageLayout> currentLayout = std::nullopt);
+};
+
+} // namespace RG
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef BINDLESSTEXTURETABLE_HPP
+#define BINDLESSTEXTURETABLE_HPP
+
+#include "RenderGraph/RenderGraphExport.hpp"
+
+#include "RenderGraph/Utils/Noncopyable.hpp"
+
+#include "RenderGraph/VulkanWrapper/DescriptorPool.hpp"
+#include "RenderGraph/VulkanWrapper/DescriptorSet.hpp"
+#include "RenderGraph/VulkanWrapper/DescriptorSetLayout.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace RG {
+
+// shaders declare the bindless texture array in this set, at binding 0:
+//     layout (set = 1, binding = 0) uniform sampler2D textures[];
+static constexpr uint32_t BindlessDescriptorSet = 1;
+
+// device level update-after-bind array of combined image samplers
+// textures are written once on registration, operations only bind the single set
+class RENDERGRAPH_DLL_EXPORT BindlessTextureTable final : public Noncopyable {
+private:
+    VkDevice                             device;
+    const uint32_t                       capacity;
+    std::unique_ptr<DescriptorSetLayout> layout;
+    std::unique_ptr<DescriptorPool>      pool;
+    std::unique_ptr<DescriptorSet>       descriptorSet;
+
+    std::mutex            mutex;
+    std::vector<uint32_t> freeIndices;
+    uint32_t              nextIndex;
+    uint32_t              registeredCount;
+
+public:
+    BindlessTextureTable (VkDevice device, uint32_t capacity);
+
+    virtual ~BindlessTextureTable () override;
+
+    // returns the index shaders use to access the texture
+    // the image must be in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL when sampled
+    uint32_t Register (VkImageView imageView, VkSampler sampler);
+
+    // the slot is reused by later registrations, must not be sampled by pending commands
+    void Unregister (uint32_t index);
+
+    const DescriptorSetLayout& GetLayout () const { return *layout; }
+    VkDescriptorSet            GetDescriptorSet () const { return *descriptorSet; }
+    uint32_t                   GetCapacity () const { return capacity; }
+    uint32_t                   GetRegisteredCount ();
+};
+
+} // namespace RG
+
+#endif
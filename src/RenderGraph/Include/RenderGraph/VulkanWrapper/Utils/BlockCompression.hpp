@@ -0,0 +1,53 @@
+#ifndef BLOCKCOMPRESSION_HPP
+#define BLOCKCOMPRESSION_HPP
+
+#include "RenderGraph/RenderGraphExport.hpp"
+
+#include "RenderGraph/VulkanWrapper/Image.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/ImageData.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace RG {
+
+class UploadBatch;
+
+// a BC1, BC4, BC5 or BC7 image, blocks are stored row by row in the layout the GPU expects
+// BC4 encodes the first component, BC5 the first two, BC1 and BC7 all of them
+// BC1 RGBA formats use the punch-through mode for blocks with alpha below 128
+class RENDERGRAPH_DLL_EXPORT CompressedImageData {
+public:
+    VkFormat             format;
+    uint32_t             width;
+    uint32_t             height;
+    std::vector<uint8_t> blocks;
+
+    CompressedImageData ();
+
+    // image has to be 8 bit per component, missing components read as 0 and missing alpha as 255
+    // partial blocks on the edges repeat the last row and column
+    // block rows are distributed between threadCount threads
+    static CompressedImageData Encode (const ImageData& image, VkFormat format, uint32_t threadCount = std::thread::hardware_concurrency ());
+
+    // 4 component 8 bit texels, BC7 only decodes the single subset mode written by Encode
+    ImageData Decode () const;
+
+    bool SaveToFile (const std::filesystem::path& filePath) const;
+
+    static std::optional<CompressedImageData> LoadFromFile (const std::filesystem::path& filePath);
+
+    // loads cachePath if it is newer than sourcePath and has the requested format
+    // otherwise encodes sourcePath and writes the result to cachePath
+    static std::optional<CompressedImageData> LoadCached (const std::filesystem::path& sourcePath, const std::filesystem::path& cachePath, VkFormat format, uint32_t threadCount = std::thread::hardware_concurrency ());
+
+    // the image has to have the same format and size
+    void UploadTo (UploadBatch& batch, const Image& image, VkImageLayout currentLayout, uint32_t layerIndex = 0, std::optional<VkImageLayout> nextLayout = std::nullopt) const;
+};
+
+} // namespace RG
+
+#endif
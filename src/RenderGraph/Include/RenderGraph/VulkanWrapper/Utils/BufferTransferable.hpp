@@ -6,41 +6,56 @@
 #include "RenderGraph/VulkanWrapper/Buffer.hpp"
 #include "RenderGraph/VulkanWrapper/DeviceExtra.hpp"
 #include "RenderGraph/VulkanWrapper/Image.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/AsyncReadback.hpp"
 #include "RenderGraph/VulkanWrapper/Utils/MemoryMapping.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/UploadBatch.hpp"
 #include <memory>
 
 #include <cstring>
 
 namespace RG {
 
+// static data is uploaded through the transient staging memory of an UploadBatch
+// dynamic data keeps a mapped host visible copy for frequent updates, it is also the destination of readbacks
+enum class TransferableUsage {
+    Static,
+    Dynamic
+};
+
+
 class RENDERGRAPH_DLL_EXPORT BufferTransferable final {
 public:
     const DeviceExtra& device;
 
     size_t bufferSize;
 
-    Buffer        bufferGPU;
-    Buffer        bufferCPU;
-    MemoryMapping bufferCPUMapping;
+    Buffer                         bufferGPU;
+    std::unique_ptr<Buffer>        bufferCPU;        // only for TransferableUsage::Dynamic
+    std::unique_ptr<MemoryMapping> bufferCPUMapping; // only for TransferableUsage::Dynamic
 
-    BufferTransferable (const DeviceExtra& device, size_t bufferSize, VkBufferUsageFlags usageFlags)
-        : device (device)
-        , bufferSize (bufferSize)
-        , bufferGPU (device.GetAllocator (), bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usageFlags, Buffer::MemoryLocation::GPU)
-        , bufferCPU (device.GetAllocator (), bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | usageFlags, Buffer::MemoryLocation::CPU)
-        , bufferCPUMapping (device.GetAllocator (), bufferCPU)
-    {
-    }
+    BufferTransferable (const DeviceExtra& device, size_t bufferSize, VkBufferUsageFlags usageFlags, TransferableUsage usage = TransferableUsage::Static);
 
     void TransferFromCPUToGPU (const void* data, size_t size) const;
+    void TransferFromCPUToGPU (UploadBatch& batch, const void* data, size_t size) const;
 
+    // the data is copied to bufferCPU, static buffers can only be read back with TransferFromGPUToCPUAsync
     void TransferFromGPUToCPU () const;
     void TransferFromGPUToCPU (VkDeviceSize size, VkDeviceSize offset) const;
 
+    std::unique_ptr<AsyncReadback> TransferFromGPUToCPUAsync () const;
+    std::unique_ptr<AsyncReadback> TransferFromGPUToCPUAsync (VkDeviceSize size, VkDeviceSize offset) const;
+
     VkBuffer GetBufferToBind () const
     {
         return bufferGPU;
     }
+
+    bool IsDynamic () const
+    {
+        return bufferCPU != nullptr;
+    }
+
+    std::vector<VmaAllocation> GetAllocations () const;
 };
 
 
@@ -48,19 +63,14 @@ class RENDERGRAPH_DLL_EXPORT ImageTransferable {
 private:
     const DeviceExtra& device;
 
-    Buffer        bufferCPU;
-    MemoryMapping bufferCPUMapping;
+    std::unique_ptr<Buffer>        bufferCPU;
+    std::unique_ptr<MemoryMapping> bufferCPUMapping;
 
 public:
     std::unique_ptr<Image> imageGPU;
 
 protected:
-    ImageTransferable (const DeviceExtra& device, size_t bufferSize)
-        : device (device)
-        , bufferCPU (device.GetAllocator (), bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, Buffer::MemoryLocation::CPU)
-        , bufferCPUMapping (device.GetAllocator (), bufferCPU)
-    {
-    }
+    ImageTransferable (const DeviceExtra& device, size_t bufferSize, TransferableUsage usage);
 
 public:
     virtual ~ImageTransferable () = default;
@@ -71,44 +81,64 @@ public:
     }
 
     void CopyLayer (VkImageLayout currentImageLayout, const void* data, size_t size, uint32_t layerIndex, std::optional<VkImageLayout> nextLayout = std::nullopt) const;
+    void CopyLayer (UploadBatch& batch, VkImageLayout currentImageLayout, const void* data, size_t size, uint32_t layerIndex, std::optional<VkImageLayout> nextLayout = std::nullopt) const;
+
+    // data holds the texels of the region tightly packed, only the touched layer is transitioned
+    void CopyRegion (VkImageLayout currentImageLayout, const void* data, size_t size, VkOffset3D offset, VkExtent3D extent, uint32_t layerIndex, std::optional<VkImageLayout> nextLayout = std::nullopt) const;
+    void CopyRegion (UploadBatch& batch, VkImageLayout currentImageLayout, const void* data, size_t size, VkOffset3D offset, VkExtent3D extent, uint32_t layerIndex, std::optional<VkImageLayout> nextLayout = std::nullopt) const;
+
+    // bufferOffset, bufferRowLength and bufferImageHeight of the regions describe where their texels are in data
+    void CopyRegions (UploadBatch& batch, VkImageLayout currentImageLayout, const void* data, size_t size, const std::vector<VkBufferImageCopy>& regions, std::optional<VkImageLayout> nextLayout = std::nullopt) const;
 
     VkImage GetImageToBind () const
     {
         return *imageGPU;
     }
+
+    bool IsDynamic () const
+    {
+        return bufferCPU != nullptr;
+    }
+
+    std::vector<VmaAllocation> GetAllocations () const;
 };
 
 
+// with more than one mip level, uploads to level 0 regenerate the other levels, usageFlags has to contain VK_IMAGE_USAGE_TRANSFER_SRC_BIT
 class RENDERGRAPH_DLL_EXPORT Image1DTransferable final : public ImageTransferable {
 public:
-    Image1DTransferable (const DeviceExtra& device, VkFormat format, uint32_t width, VkImageUsageFlags usageFlags);
+    Image1DTransferable (const DeviceExtra& device, VkFormat format, uint32_t width, VkImageUsageFlags usageFlags, TransferableUsage usage = TransferableUsage::Static, uint32_t mipLevels = 1);
     virtual ~Image1DTransferable () override = default;
 };
 
 
 class RENDERGRAPH_DLL_EXPORT Image2DTransferable final : public ImageTransferable {
 public:
-    Image2DTransferable (const DeviceExtra& device, VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usageFlags, uint32_t arrayLayers = 1);
+    Image2DTransferable (const DeviceExtra& device, VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usageFlags, uint32_t arrayLayers = 1, TransferableUsage usage = TransferableUsage::Static, uint32_t mipLevels = 1);
     virtual ~Image2DTransferable () override = default;
 };
 
 
 class RENDERGRAPH_DLL_EXPORT Image2DTransferableLinear final : public ImageTransferable {
 public:
-    Image2DTransferableLinear (const DeviceExtra& device, VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usageFlags, uint32_t arrayLayers = 1);
+    Image2DTransferableLinear (const DeviceExtra& device, VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usageFlags, uint32_t arrayLayers = 1, TransferableUsage usage = TransferableUsage::Static);
     virtual ~Image2DTransferableLinear () override = default;
 };
 
 
 class RENDERGRAPH_DLL_EXPORT Image3DTransferable final : public ImageTransferable {
 public:
-    Image3DTransferable (const DeviceExtra& device, VkFormat format, uint32_t width, uint32_t height, uint32_t depth, VkImageUsageFlags usageFlags);
+    Image3DTransferable (const DeviceExtra& device, VkFormat format, uint32_t width, uint32_t height, uint32_t depth, VkImageUsageFlags usageFlags, TransferableUsage usage = TransferableUsage::Static, uint32_t mipLevels = 1);
     virtual ~Image3DTransferable () override = default;
 };
 
 
 class RENDERGRAPH_DLL_EXPORT VertexInputInfo final {
 public:
+    // per vertex and per instance data is bound to separate bindings, matching the pipelines built from shader reflection
+    static constexpr uint32_t VertexBinding   = 0;
+    static constexpr uint32_t InstanceBinding = 1;
+
     uint32_t                                       size;
     std::vector<VkVertexInputAttributeDescription> attributes;
     std::vector<VkVertexInputBindingDescription>   bindings;
@@ -124,9 +154,9 @@ public:
     const BufferTransferable buffer;
     const uint32_t           vertexSize;
 
-    VertexBufferTransferableUntyped (const DeviceExtra& device, uint32_t vertexSize, uint32_t maxVertexCount, const std::vector<VkFormat>& vertexInputFormats, VkVertexInputRate inputRate)
+    VertexBufferTransferableUntyped (const DeviceExtra& device, uint32_t vertexSize, uint32_t maxVertexCount, const std::vector<VkFormat>& vertexInputFormats, VkVertexInputRate inputRate, TransferableUsage usage = TransferableUsage::Static)
         : info (vertexInputFormats, inputRate)
-        , buffer (device, info.size * maxVertexCount, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
+        , buffer (device, info.size * maxVertexCount, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, usage)
         , vertexSize (vertexSize)
     {
         data.resize (vertexSize * maxVertexCount);
@@ -137,6 +167,11 @@ public:
         buffer.TransferFromCPUToGPU (data.data (), data.size ());
     }
 
+    void Flush (UploadBatch& batch) const
+    {
+        buffer.TransferFromCPUToGPU (batch, data.data (), data.size ());
+    }
+
     void Bind (VkCommandBuffer commandBuffer) const
     {
         VkBuffer buffers[1] = { buffer.GetBufferToBind () };
@@ -152,8 +187,9 @@ public:
     VertexBufferTransferable (const DeviceExtra&           device,
                               uint32_t                     maxVertexCount,
                               const std::vector<VkFormat>& vertexInputFormats,
-                              VkVertexInputRate            inputRate)
-        : VertexBufferTransferableUntyped (device, sizeof (VertexType), maxVertexCount, vertexInputFormats, inputRate)
+                              VkVertexInputRate            inputRate,
+                              TransferableUsage            usage = TransferableUsage::Static)
+        : VertexBufferTransferableUntyped (device, sizeof (VertexType), maxVertexCount, vertexInputFormats, inputRate, usage)
     {
     }
 
@@ -172,8 +208,8 @@ public:
     std::vector<IndexType>   data;
     const BufferTransferable buffer;
 
-    IndexBufferTransferableBase (const DeviceExtra& device, uint32_t maxIndexCount)
-        : buffer (device, sizeof (IndexType) * maxIndexCount, VK_BUFFER_USAGE_INDEX_BUFFER_BIT)
+    IndexBufferTransferableBase (const DeviceExtra& device, uint32_t maxIndexCount, TransferableUsage usage = TransferableUsage::Static)
+        : buffer (device, sizeof (IndexType) * maxIndexCount, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, usage)
     {
         data.resize (maxIndexCount);
     }
@@ -183,6 +219,11 @@ public:
         buffer.TransferFromCPUToGPU (data.data (), sizeof (IndexType) * data.size ());
     }
 
+    void Flush (UploadBatch& batch) const
+    {
+        buffer.TransferFromCPUToGPU (batch, data.data (), sizeof (IndexType) * data.size ());
+    }
+
     void operator= (const std::vector<IndexType>& copiedData)
     {
         RG_ASSERT (copiedData.size () == data.size ());
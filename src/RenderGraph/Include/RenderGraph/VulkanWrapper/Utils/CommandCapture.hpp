@@ -0,0 +1,101 @@
+#ifndef COMMANDCAPTURE_HPP
+#define COMMANDCAPTURE_HPP
+
+#include "RenderGraph/RenderGraphExport.hpp"
+
+#include "RenderGraph/Utils/Noncopyable.hpp"
+
+#include "RenderGraph/VulkanWrapper/Buffer.hpp"
+#include "RenderGraph/VulkanWrapper/CommandBuffer.hpp"
+#include "RenderGraph/VulkanWrapper/DeviceExtra.hpp"
+#include "RenderGraph/VulkanWrapper/Image.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace RG {
+
+// recorded command streams together with the images and buffers they reference
+// the binary form is in native byte order, it is meant to be replayed on the same platform
+class RENDERGRAPH_DLL_EXPORT CommandCapture {
+public:
+    struct ImageDescriptor {
+        uint64_t          handle;
+        VkFormat          format;
+        VkImageUsageFlags usage;
+        uint32_t          width;
+        uint32_t          height;
+        uint32_t          depth;
+        uint32_t          arrayLayers;
+        uint32_t          mipLevels;
+    };
+
+    struct BufferDescriptor {
+        uint64_t     handle;
+        VkDeviceSize size;
+    };
+
+    struct Stream {
+        uint32_t             commandCount;
+        uint32_t             uncapturedCommandCount; // commands without a serialized form, e.g. CommandGeneric
+        std::vector<uint8_t> data;
+    };
+
+    std::vector<ImageDescriptor>  images;
+    std::vector<BufferDescriptor> buffers;
+    std::vector<Stream>           streams;
+
+    void AddImage (const Image& image);
+    void AddBuffer (VkBuffer buffer, VkDeviceSize size);
+
+    // the command buffer has to retain its recorded commands
+    void AddCommandBuffer (const CommandBuffer& commandBuffer);
+
+    std::vector<uint8_t> Serialize () const;
+
+    static CommandCapture Deserialize (const std::vector<uint8_t>& data);
+
+    bool SaveToFile (const std::filesystem::path& filePath) const;
+
+    static std::optional<CommandCapture> LoadFromFile (const std::filesystem::path& filePath);
+};
+
+
+// recreates the captured images and buffers and records the transfer and synchronization commands of every stream into its own command buffer
+// pipelines, render passes and descriptor sets are not part of a capture, so render passes, draws, dispatches and binds are skipped
+// a replay reproduces the copies, clears and barriers of a frame, not its rendered content
+class RENDERGRAPH_DLL_EXPORT TransferCommandReplayer final : public Noncopyable {
+private:
+    const DeviceExtra&                          device;
+    std::vector<std::unique_ptr<Image>>         images;
+    std::vector<std::unique_ptr<Buffer>>        buffers;
+    std::unordered_map<uint64_t, uint64_t>      handleMap;
+    std::vector<std::unique_ptr<CommandBuffer>> commandBuffers;
+
+    size_t replayedCommandCount;
+    size_t skippedCommandCount;
+
+public:
+    TransferCommandReplayer (const DeviceExtra& device, const CommandCapture& capture);
+
+    virtual ~TransferCommandReplayer () override;
+
+    void Submit (uint32_t streamIndex, VkFence fenceToSignal = VK_NULL_HANDLE) const;
+
+    // the recreated resources start with undefined contents, fill them before submitting to replay meaningful copies
+    // returns nullptr for handles that were not part of the capture
+    const Image*  GetReplayedImage (VkImage capturedImage) const;
+    const Buffer* GetReplayedBuffer (VkBuffer capturedBuffer) const;
+
+    size_t GetStreamCount () const { return commandBuffers.size (); }
+    size_t GetReplayedCommandCount () const { return replayedCommandCount; }
+    size_t GetSkippedCommandCount () const { return skippedCommandCount; }
+};
+
+} // namespace RG
+
+#endif
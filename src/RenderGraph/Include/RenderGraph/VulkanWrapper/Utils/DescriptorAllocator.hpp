@@ -0,0 +1,95 @@
+#ifndef DESCRIPTORALLOCATOR_HPP
+#define DESCRIPTORALLOCATOR_HPP
+
+#include "RenderGraph/RenderGraphExport.hpp"
+
+#include "RenderGraph/Utils/Noncopyable.hpp"
+
+#include "RenderGraph/VulkanWrapper/DescriptorPool.hpp"
+#include "RenderGraph/VulkanWrapper/DescriptorSetLayout.hpp"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace RG {
+
+class DescriptorAllocation;
+
+// device level cache of descriptor set layouts and pools
+// identical bindings share one layout, sets of the same layout share pools that grow on demand
+class RENDERGRAPH_DLL_EXPORT DescriptorAllocator final : public Noncopyable {
+private:
+    friend class DescriptorAllocation;
+
+    struct Pool {
+        std::unique_ptr<DescriptorPool> descriptorPool;
+        uint32_t                        capacity;
+        uint32_t                        allocatedSets;
+        uint32_t                        liveAllocations;
+    };
+
+    struct LayoutEntry {
+        std::vector<VkDescriptorSetLayoutBinding> bindings;
+        std::unique_ptr<DescriptorSetLayout>      layout;
+        std::vector<VkDescriptorPoolSize>         poolSizesPerSet;
+        std::vector<std::unique_ptr<Pool>>        pools;
+    };
+
+    VkDevice device;
+
+    std::mutex                                                    mutex;
+    std::unordered_multimap<size_t, std::unique_ptr<LayoutEntry>> layoutsByHash;
+    std::unordered_map<VkDescriptorSetLayout, LayoutEntry*>       layoutsByHandle;
+
+    size_t layoutRequestCount;
+    size_t createdPoolCount;
+    size_t poolResetCount;
+
+public:
+    DescriptorAllocator (VkDevice device);
+
+    virtual ~DescriptorAllocator () override;
+
+    // the returned layout lives as long as the allocator
+    const DescriptorSetLayout& GetLayout (const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+
+    // allocates all sets with a single vkAllocateDescriptorSets call
+    // layout must come from GetLayout of the same allocator
+    std::unique_ptr<DescriptorAllocation> Allocate (const DescriptorSetLayout& layout, uint32_t count);
+
+    size_t GetLayoutCount ();
+    size_t GetLayoutRequestCount ();
+    size_t GetPoolCount ();
+    size_t GetCreatedPoolCount ();
+    size_t GetPoolResetCount ();
+
+private:
+    void Release (Pool& pool);
+};
+
+
+// descriptor sets allocated together from the same pool
+// the pool is reset and reused once every allocation made from it is released
+class RENDERGRAPH_DLL_EXPORT DescriptorAllocation final : public Noncopyable {
+private:
+    DescriptorAllocator&         allocator;
+    DescriptorAllocator::Pool&   pool;
+    std::vector<VkDescriptorSet> descriptorSets;
+
+public:
+    DescriptorAllocation (DescriptorAllocator& allocator, DescriptorAllocator::Pool& pool, std::vector<VkDescriptorSet>&& descriptorSets);
+
+    virtual ~DescriptorAllocation () override;
+
+    size_t GetSize () const { return descriptorSets.size (); }
+
+    VkDescriptorSet operator[] (size_t index) const { return descriptorSets[index]; }
+
+    const std::vector<VkDescriptorSet>& GetDescriptorSets () const { return descriptorSets; }
+};
+
+} // namespace RG
+
+#endif
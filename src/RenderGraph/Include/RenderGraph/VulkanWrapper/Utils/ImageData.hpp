@@ -3,6 +3,7 @@
 
 #include <cstdlib>
 #include <filesystem>
+#include <limits>
 #include <optional>
 #include <vector>
 #include <memory>
@@ -12,6 +13,9 @@
 
 namespace RG {
 
+class AsyncReadback;
+class UploadBatch;
+
 class RENDERGRAPH_DLL_EXPORT ImageData {
 public:
     static const ImageData Empty;
@@ -28,23 +32,49 @@ public:
     size_t               components;
     size_t               width;
     size_t               height;
+    // slices of a 3D image are stored one after the other, 1 for everything else
+    size_t               depth;
     std::vector<uint8_t> data;
 
     ImageData (const DeviceExtra& device, const Image& image, uint32_t layerIndex, std::optional<VkImageLayout> currentLayout = std::nullopt);
+    // readback must come from AsyncReadback::FromImageLayer on the same image, waits for it
+    ImageData (const AsyncReadback& readback, const Image& image);
     ImageData (const std::filesystem::path& path, const uint32_t components = 4);
     
     static void FillBuffer (const DeviceExtra& device, const Image& image, uint32_t layerIndex, std::optional<VkImageLayout> currentLayout, uint8_t* buffer, size_t bufferSize);
 
     static ImageData FromDataUint (const std::vector<uint8_t>& data, uint32_t width, uint32_t height, uint32_t components);
+    // clamped to [0, 1] and rounded to the nearest 8 bit value
     static ImageData FromDataFloat (const std::vector<float>& data, uint32_t width, uint32_t height, uint32_t components);
 
+    // converted to targetFormat by a blit on the GPU before the readback
+    // without blit support only BGRA to RGBA is possible, that is swapped on the CPU
+    static ImageData FromImageLayerConverted (const DeviceExtra& device, const Image& image, uint32_t layerIndex, VkFormat targetFormat, std::optional<VkImageLayout> currentLayout = std::nullopt);
+
     bool operator== (const ImageData& other) const;
 
+    struct ComparisonSettings {
+        // a pixel mismatches when its component differences sum to more than this
+        uint32_t tolerance       = 1;
+        bool     createDiffImage = true;
+        // without a diff image and metrics the comparison stops at the first mismatching pixels,
+        // the metrics of the result only cover the compared part then
+        bool     computeMetrics  = true;
+        // false forces the scalar path, used for verification and benchmarks
+        bool     useSIMD         = true;
+    };
+
     struct ComparisonResult {
-        bool                       equal = false;
+        bool                       equal         = false;
+        uint32_t                   maxAbsError   = 0;
+        size_t                     mismatchCount = 0;
+        // over all components, infinite when no component differs
+        double                     psnr          = std::numeric_limits<double>::infinity ();
+        // mismatching pixels are red with the largest component difference, only created when the data differs
         std::unique_ptr<ImageData> diffImage;
     };
-    ComparisonResult CompareTo (const ImageData& diff) const;
+    ComparisonResult CompareTo (const ImageData& other) const;
+    ComparisonResult CompareTo (const ImageData& other, const ComparisonSettings& settings) const;
 
     uint32_t GetByteCount () const;
 
@@ -52,6 +82,7 @@ public:
 
     void SaveTo (const std::filesystem::path& path) const;
     void UploadTo (const DeviceExtra& device, const Image& image, std::optional<VkImageLayout> currentLayout = std::nullopt) const;
+    void UploadTo (UploadBatch& batch, const Image& image, std::optional<VkImageLayout> currentLayout = std::nullopt) const;
 };
 
 }
@@ -0,0 +1,54 @@
+#ifndef IMAGEFILE_HPP
+#define IMAGEFILE_HPP
+
+#include "RenderGraph/RenderGraphExport.hpp"
+
+#include "RenderGraph/Utils/MappedFile.hpp"
+#include "RenderGraph/Utils/Noncopyable.hpp"
+
+#include "RenderGraph/VulkanWrapper/Image.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+namespace RG {
+
+class UploadBatch;
+
+// an image file read through a memory mapping, decoded on demand into memory provided by the caller
+// binary PPM/PGM files matching the requested component count are copied from the mapping without decoding
+class RENDERGRAPH_DLL_EXPORT ImageFile final : public Noncopyable {
+private:
+    MappedFile            file;
+    uint32_t              width;
+    uint32_t              height;
+    uint32_t              fileComponents;
+    std::optional<size_t> rawPixelsOffset;
+
+public:
+    ImageFile (const std::filesystem::path& filePath);
+
+    virtual ~ImageFile () override;
+
+    bool IsValid () const { return width > 0 && height > 0; }
+
+    uint32_t GetWidth () const { return width; }
+    uint32_t GetHeight () const { return height; }
+    uint32_t GetFileComponents () const { return fileComponents; }
+
+    // 8 bit per component
+    size_t GetDecodedSize (uint32_t components) const;
+
+    bool IsRaw (uint32_t components) const;
+
+    // destination has to hold GetDecodedSize (components) bytes
+    bool DecodeTo (void* destination, size_t destinationSize, uint32_t components) const;
+
+    // decodes straight into the staging memory of the batch, the image has to be an 8 bit format of the file size
+    bool UploadTo (UploadBatch& batch, const Image& image, VkImageLayout currentLayout, uint32_t layerIndex = 0, std::optional<VkImageLayout> nextLayout = std::nullopt) const;
+};
+
+} // namespace RG
+
+#endif
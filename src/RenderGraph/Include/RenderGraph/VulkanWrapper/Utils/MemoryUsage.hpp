@@ -0,0 +1,51 @@
+#ifndef MEMORYUSAGE_HPP
+#define MEMORYUSAGE_HPP
+
+#include "RenderGraph/RenderGraphExport.hpp"
+
+#pragma warning (push, 0)
+#include "vk_mem_alloc.h"
+#pragma warning(pop)
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <vector>
+
+namespace RG {
+
+struct AllocationUsage {
+    VkDeviceSize size        = 0;
+    bool         deviceLocal = false;
+    bool         dedicated   = false; // owns its VkDeviceMemory instead of being suballocated from a block
+};
+
+
+// budget is the estimate of VK_EXT_memory_budget when the allocator was created with it, 80% of the heap size otherwise
+struct HeapUsage {
+    VkDeviceSize size            = 0;
+    bool         deviceLocal     = false;
+    VkDeviceSize blockBytes      = 0; // VkDeviceMemory allocated by the allocator
+    VkDeviceSize allocationBytes = 0; // part of the blocks occupied by allocations
+    VkDeviceSize usage           = 0; // usage of the whole process, including memory not allocated through the allocator
+    VkDeviceSize budget          = 0;
+};
+
+
+// the allocation has to be created with VMA_ALLOCATION_CREATE_USER_DATA_COPY_STRING_BIT, the name is copied
+RENDERGRAPH_DLL_EXPORT
+void SetAllocationName (VmaAllocator allocator, VmaAllocation allocation, const std::string& name);
+
+RENDERGRAPH_DLL_EXPORT
+std::string GetAllocationName (VmaAllocator allocator, VmaAllocation allocation);
+
+RENDERGRAPH_DLL_EXPORT
+AllocationUsage GetAllocationUsage (VmaAllocator allocator, VmaAllocation allocation);
+
+// one entry per memory heap
+RENDERGRAPH_DLL_EXPORT
+std::vector<HeapUsage> GetHeapUsages (VmaAllocator allocator);
+
+} // namespace RG
+
+#endif
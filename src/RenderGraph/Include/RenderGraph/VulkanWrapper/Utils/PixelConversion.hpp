@@ -0,0 +1,42 @@
+#ifndef PIXELCONVERSION_HPP
+#define PIXELCONVERSION_HPP
+
+#include "RenderGraph/RenderGraphExport.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace RG {
+
+// CPU conversions between pixel layouts, vectorized for the instruction set selected in Utils/SIMD.hpp
+// readbacks can do the same conversions on the GPU, see AsyncReadback::FromImageLayerConverted
+
+// component i of each pixel is replaced by component order[i] of the same pixel, { 2, 1, 0, 3 } swaps red and blue
+RENDERGRAPH_DLL_EXPORT
+void SwizzleRGBA8 (uint8_t* pixels, size_t pixelCount, const std::array<uint8_t, 4>& order);
+
+// clamped to [0, 1] and rounded to the nearest value, NaN becomes 0
+RENDERGRAPH_DLL_EXPORT
+void FloatToUnorm8 (const float* source, uint8_t* destination, size_t count);
+
+RENDERGRAPH_DLL_EXPORT
+void Unorm8ToFloat (const uint8_t* source, float* destination, size_t count);
+
+// the fourth component of 4 component pixels is alpha, it is converted like Unorm8ToFloat
+RENDERGRAPH_DLL_EXPORT
+void SRGB8ToLinear (const uint8_t* source, float* destination, size_t pixelCount, uint32_t components);
+
+// within 1 of the exact encoding, alpha of 4 component pixels is converted like FloatToUnorm8
+RENDERGRAPH_DLL_EXPORT
+void LinearToSRGB8 (const float* source, uint8_t* destination, size_t pixelCount, uint32_t components);
+
+RENDERGRAPH_DLL_EXPORT
+void RGB8ToRGBA8 (const uint8_t* source, uint8_t* destination, size_t pixelCount, uint8_t alpha = 255);
+
+RENDERGRAPH_DLL_EXPORT
+void RGBA8ToRGB8 (const uint8_t* source, uint8_t* destination, size_t pixelCount);
+
+} // namespace RG
+
+#endif
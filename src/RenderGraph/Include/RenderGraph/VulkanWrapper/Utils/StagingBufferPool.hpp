@@ -0,0 +1,61 @@
+#ifndef STAGINGBUFFERPOOL_HPP
+#define STAGINGBUFFERPOOL_HPP
+
+#include "RenderGraph/RenderGraphExport.hpp"
+
+#include "RenderGraph/Utils/Noncopyable.hpp"
+
+#include "RenderGraph/VulkanWrapper/Buffer.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/MemoryMapping.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace RG {
+
+// host visible buffers that stay mapped for their whole lifetime
+// released buffers are kept and handed out again for requests that fit into them, except oversized ones
+class RENDERGRAPH_DLL_EXPORT StagingBufferPool final : public Noncopyable {
+public:
+    class RENDERGRAPH_DLL_EXPORT StagingBuffer final {
+    public:
+        std::unique_ptr<Buffer>        buffer;
+        std::unique_ptr<MemoryMapping> mapping;
+        size_t                         size;
+
+        StagingBuffer (VmaAllocator allocator, size_t size, VkBufferUsageFlags usageFlags, MemoryLocation location = MemoryLocation::CPU);
+
+        void* Get () const { return mapping->Get (); }
+    };
+
+private:
+    VmaAllocator       allocator;
+    VkBufferUsageFlags usageFlags;
+    MemoryLocation     location;
+
+    std::mutex                                  mutex;
+    std::vector<std::unique_ptr<StagingBuffer>> freeBuffers;
+
+    size_t createdCount;
+
+public:
+    // MemoryLocation::CPUStreaming suits uploads, MemoryLocation::CPUReadback suits readbacks
+    StagingBufferPool (VmaAllocator allocator, VkBufferUsageFlags usageFlags, MemoryLocation location = MemoryLocation::CPU);
+
+    virtual ~StagingBufferPool () override;
+
+    std::unique_ptr<StagingBuffer> Acquire (size_t size);
+
+    void Release (std::unique_ptr<StagingBuffer>&& stagingBuffer);
+
+    // destroys every buffer that is not in use
+    void Clear ();
+
+    size_t GetFreeCount ();
+    size_t GetCreatedCount ();
+};
+
+} // namespace RG
+
+#endif
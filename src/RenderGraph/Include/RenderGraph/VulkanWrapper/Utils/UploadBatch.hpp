@@ -0,0 +1,114 @@
+#ifndef UPLOADBATCH_HPP
+#define UPLOADBATCH_HPP
+
+#include "RenderGraph/RenderGraphExport.hpp"
+
+#include "RenderGraph/Utils/Noncopyable.hpp"
+
+#include "RenderGraph/VulkanWrapper/CommandBuffer.hpp"
+#include "RenderGraph/VulkanWrapper/DeviceExtra.hpp"
+#include "RenderGraph/VulkanWrapper/Fence.hpp"
+#include "RenderGraph/VulkanWrapper/Image.hpp"
+#include "RenderGraph/VulkanWrapper/Semaphore.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/StagingBufferPool.hpp"
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace RG {
+
+// collects CPU to GPU copies and records them all at once on Submit
+// recorded copies have to be submitted explicitly, destroying a batch with unsubmitted copies is an error and drops them
+// data is copied into sub-allocated staging memory immediately, so the source can be freed after the call
+// when the device has a dedicated transfer queue the copies run there, ownership of the destination
+// resources is released to the transfer family and acquired back by the graphics family afterwards
+// uploading only level 0 of an image with several mip levels regenerates the other levels of the uploaded layers
+class RENDERGRAPH_DLL_EXPORT UploadBatch final : public Noncopyable {
+private:
+    struct StagingChunk {
+        std::unique_ptr<StagingBufferPool::StagingBuffer> stagingBuffer;
+        VkDeviceSize                                      used;
+    };
+
+    struct StagingAllocation {
+        VkBuffer     buffer;
+        VkDeviceSize offset;
+        void*        mapped;
+    };
+
+    struct BufferUpload {
+        VkBuffer     srcBuffer;
+        VkBuffer     dstBuffer;
+        VkBufferCopy region;
+    };
+
+    struct ImageUpload {
+        const Image*                 image;
+        VkImageLayout                currentLayout;
+        std::optional<VkImageLayout> nextLayout;
+        VkBuffer                     srcBuffer;
+        VkBufferImageCopy            region;
+    };
+
+    const DeviceExtra&                          device;
+    std::vector<StagingChunk>                   chunks;
+    std::vector<BufferUpload>                   bufferUploads;
+    std::vector<ImageUpload>                    imageUploads;
+    std::vector<std::unique_ptr<CommandBuffer>> commandBuffers;
+    std::vector<std::unique_ptr<Semaphore>>     semaphores;
+    std::unique_ptr<Fence>                      fence;
+
+    bool   submitted;
+    bool   completed;
+    size_t uploadedBytes;
+    size_t recordedCopies;
+
+public:
+    UploadBatch (const DeviceExtra& device);
+
+    virtual ~UploadBatch () override;
+
+    void CopyToBuffer (VkBuffer dstBuffer, const void* data, size_t size, VkDeviceSize dstOffset = 0);
+
+    // region.bufferOffset is ignored, it is set to the staging location of data
+    void CopyToImage (const Image& image, VkImageLayout currentLayout, const void* data, size_t size, const VkBufferImageCopy& region, std::optional<VkImageLayout> nextLayout = std::nullopt);
+
+    // bufferOffset of the regions is relative to data, all of them are copied from one staging allocation
+    void CopyToImage (const Image& image, VkImageLayout currentLayout, const void* data, size_t size, const std::vector<VkBufferImageCopy>& regions, std::optional<VkImageLayout> nextLayout = std::nullopt);
+
+    void CopyLayerToImage (const Image& image, VkImageLayout currentLayout, const void* data, size_t size, uint32_t layerIndex, std::optional<VkImageLayout> nextLayout = std::nullopt);
+
+    // returns staging memory of size bytes the caller has to fill before Submit, e.g. by decoding into it directly
+    void* ReserveImageUpload (const Image& image, VkImageLayout currentLayout, size_t size, const VkBufferImageCopy& region, std::optional<VkImageLayout> nextLayout = std::nullopt);
+
+    // source buffers are owned by the caller and must stay alive until the batch completes
+    void CopyBuffer (VkBuffer srcBuffer, VkBuffer dstBuffer, const VkBufferCopy& region);
+
+    void CopyBufferToImage (VkBuffer srcBuffer, const Image& image, VkImageLayout currentLayout, const VkBufferImageCopy& region, std::optional<VkImageLayout> nextLayout = std::nullopt);
+
+    void Submit ();
+
+    // submits if needed and waits for the copies, staging memory is recycled afterwards
+    void Wait ();
+
+    // returns whether the submitted copies finished without blocking, staging memory is recycled when they did
+    bool Poll ();
+
+    bool   IsEmpty () const { return recordedCopies == 0; }
+    size_t GetUploadedBytes () const { return uploadedBytes; }
+    size_t GetRecordedCopyCount () const { return recordedCopies; }
+
+private:
+    StagingAllocation Allocate (size_t size);
+    StagingAllocation Allocate (const void* data, size_t size);
+
+    CommandBuffer& CreateCommandBuffer (VkCommandPool commandPool, const char* name);
+
+    void SubmitOnGraphicsQueue ();
+    void SubmitOnTransferQueue ();
+};
+
+} // namespace RG
+
+#endif
@@ -46,6 +46,21 @@ uint32_t GetCompontentCountFromFormat (VkFormat format);
 RENDERGRAPH_DLL_EXPORT
 uint32_t GetEachCompontentSizeFromFormat (VkFormat format);
 
+// the same format with components in RGBA order, e.g. for reading back BGRA swapchain images, other formats are returned unchanged
+RENDERGRAPH_DLL_EXPORT
+VkFormat GetRGBAOrderFormat (VkFormat format);
+
+// BC1, BC4, BC5 and BC7, stored in 4x4 texel blocks, the component functions above do not apply to them
+RENDERGRAPH_DLL_EXPORT
+bool IsBlockCompressedFormat (VkFormat format);
+
+RENDERGRAPH_DLL_EXPORT
+uint32_t GetBlockByteSize (VkFormat format);
+
+// tightly packed texels, or blocks for block compressed formats
+RENDERGRAPH_DLL_EXPORT
+size_t GetImageByteSize (VkFormat format, uint32_t width, uint32_t height, uint32_t depth = 1);
+
 
 namespace ShaderTypes {
 
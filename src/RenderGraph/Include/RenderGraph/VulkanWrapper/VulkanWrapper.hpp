@@ -2,7 +2,10 @@
 #define VULKANWRAPPER_HPP
 
 // utils
+#include "RenderGraph/VulkanWrapper/Utils/BindlessTextureTable.hpp"
 #include "RenderGraph/VulkanWrapper/Utils/BufferTransferable.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/CommandCapture.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/DescriptorAllocator.hpp"
 #include "RenderGraph/VulkanWrapper/Utils/MemoryMapping.hpp"
 #include "RenderGraph/VulkanWrapper/Utils/SingleTimeCommand.hpp"
 #include "RenderGraph/VulkanWrapper/Utils/VulkanUtils.hpp"
@@ -53,7 +53,12 @@ void ComputeShaderPipeline::Compile (CompileSettings&& settings_)
     compileSettings = std::move (settings_);
     compileResult.Clear ();
 
-    compileResult.pipelineLayout = std::unique_ptr<RG::PipelineLayout> (new RG::PipelineLayout (device, { compileSettings.layout }));
+    std::vector<VkDescriptorSetLayout> setLayouts { compileSettings.layout };
+    if (compileSettings.bindlessLayout.Get () != VK_NULL_HANDLE) {
+        setLayouts.push_back (compileSettings.bindlessLayout);
+    }
+
+    compileResult.pipelineLayout = std::unique_ptr<RG::PipelineLayout> (new RG::PipelineLayout (device, setLayouts));
 
     compileResult.pipeline = std::unique_ptr<RG::ComputePipeline> (new RG::ComputePipeline (
         device,
@@ -69,9 +74,9 @@ void ComputeShaderPipeline::IterateShaders (const std::function<void(const RG::S
 }
 
 
-std::unique_ptr<RG::DescriptorSetLayout> ComputeShaderPipeline::CreateDescriptorSetLayout (VkDevice device_) const
+std::vector<VkDescriptorSetLayoutBinding> ComputeShaderPipeline::GetDescriptorSetLayoutBindings () const
 {
-    return std::make_unique<RG::DescriptorSetLayout> (device_, RG::FromShaderReflection::GetLayout (computeShader->GetReflection (), computeShader->GetShaderKind ()));
+    return RG::FromShaderReflection::GetLayout (computeShader->GetReflection (), computeShader->GetShaderKind ());
 }
 
 } // namespace RG
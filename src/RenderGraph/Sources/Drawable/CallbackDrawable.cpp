@@ -0,0 +1,29 @@
+#include "CallbackDrawable.hpp"
+
+#include "Utils/Assert.hpp"
+
+
+namespace RG {
+
+CallbackDrawable::CallbackDrawable (RecordCallback recordCallback)
+    : recordCallback (recordCallback)
+{
+    RG_ASSERT (this->recordCallback != nullptr);
+}
+
+
+CallbackDrawable::~CallbackDrawable () = default;
+
+
+void CallbackDrawable::Record (RG::CommandBuffer& commandBuffer) const
+{
+    Record (commandBuffer, 0);
+}
+
+
+void CallbackDrawable::Record (RG::CommandBuffer& commandBuffer, uint32_t resourceIndex) const
+{
+    recordCallback (commandBuffer, resourceIndex);
+}
+
+} // namespace RG
@@ -12,14 +12,19 @@ void DrawableInfo::Record (RG::CommandBuffer& commandBuffer) const
         commandBuffer.Record<RG::CommandBindVertexBuffers> (0, static_cast<uint32_t> (vertexBuffer.size ()), vertexBuffer, offsets).SetName ("DrawableInfo");
     }
 
+    if (instanceBuffer != VK_NULL_HANDLE) {
+        RG_ASSERT (vertexBuffer.size () <= VertexInputInfo::InstanceBinding);
+        commandBuffer.Record<RG::CommandBindVertexBuffers> (VertexInputInfo::InstanceBinding, 1, std::vector<VkBuffer> { instanceBuffer }, std::vector<VkDeviceSize> { 0 }).SetName ("DrawableInfo - Instances");
+    }
+
     if (indexBuffer != VK_NULL_HANDLE) {
         commandBuffer.Record<RG::CommandBindIndexBuffer> (indexBuffer, 0, VK_INDEX_TYPE_UINT16).SetName ("DrawableInfo");
     }
 
     if (indexBuffer != VK_NULL_HANDLE) {
-        commandBuffer.Record<RG::CommandDrawIndexed> (indexCount, instanceCount, 0, 0, 0).SetName ("DrawableInfo");
+        commandBuffer.Record<RG::CommandDrawIndexed> (indexCount, instanceCount, firstIndex, vertexOffset, 0).SetName ("DrawableInfo");
     } else {
-        commandBuffer.Record<RG::CommandDraw> (vertexCount, instanceCount, 0, 0).SetName ("DrawableInfo");
+        commandBuffer.Record<RG::CommandDraw> (vertexCount, instanceCount, firstVertex, 0).SetName ("DrawableInfo");
     }
 }
 
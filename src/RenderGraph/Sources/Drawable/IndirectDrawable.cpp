@@ -0,0 +1,102 @@
+#include "IndirectDrawable.hpp"
+
+#include "Resource.hpp"
+
+#include "Utils/Assert.hpp"
+
+#include "VulkanWrapper/Commands.hpp"
+#include "VulkanWrapper/DeviceExtra.hpp"
+
+#include <stdexcept>
+
+
+namespace RG {
+
+static constexpr uint32_t IndirectCommandStride = static_cast<uint32_t> (sizeof (VkDrawIndexedIndirectCommand));
+
+
+IndirectDrawable::IndirectDrawable (std::vector<VkBuffer>              vertexBuffers,
+                                    VkBuffer                           indexBuffer,
+                                    std::shared_ptr<GPUBufferResource> drawCommands,
+                                    uint32_t                           maxDrawCount,
+                                    std::shared_ptr<GPUBufferResource> drawCount)
+    : vertexBuffer (vertexBuffers)
+    , indexBuffer (indexBuffer)
+    , drawCommands (drawCommands)
+    , drawCount (drawCount)
+    , maxDrawCount (maxDrawCount)
+{
+    RG_ASSERT (this->drawCommands != nullptr);
+    RG_ASSERT (this->drawCommands->GetBufferSize () >= static_cast<size_t> (maxDrawCount) * IndirectCommandStride);
+    RG_ASSERT (this->drawCount == nullptr || this->drawCount->GetBufferSize () >= sizeof (uint32_t));
+}
+
+
+IndirectDrawable::IndirectDrawable (VertexBufferList                   vertexBuffers,
+                                    VkBuffer                           indexBuffer,
+                                    std::shared_ptr<GPUBufferResource> drawCommands,
+                                    uint32_t                           maxDrawCount,
+                                    std::shared_ptr<GPUBufferResource> drawCount)
+    : IndirectDrawable (vertexBuffers.GetHandles (), indexBuffer, drawCommands, maxDrawCount, drawCount)
+{
+}
+
+
+IndirectDrawable::IndirectDrawable (const RG::VertexBufferTransferableUntyped& vertexBuffer,
+                                    const RG::IndexBufferTransferable&         indexBuffer,
+                                    std::shared_ptr<GPUBufferResource>         drawCommands,
+                                    uint32_t                                   maxDrawCount,
+                                    std::shared_ptr<GPUBufferResource>         drawCount)
+    : IndirectDrawable (std::vector<VkBuffer> { vertexBuffer.buffer.GetBufferToBind () }, indexBuffer.buffer.GetBufferToBind (), drawCommands, maxDrawCount, drawCount)
+{
+}
+
+
+IndirectDrawable::~IndirectDrawable () = default;
+
+
+void IndirectDrawable::CheckDeviceSupport (const DeviceExtra& device) const
+{
+    if (drawCount != nullptr) {
+        if (RG_ERROR (!device.SupportsDrawIndirectCount ())) {
+            throw std::runtime_error ("indirect draw with a draw count, but the device does not support drawIndirectCount");
+        }
+    } else if (maxDrawCount > 1) {
+        if (RG_ERROR (!device.SupportsMultiDrawIndirect ())) {
+            throw std::runtime_error ("indirect draw with more than one record, but the device does not support multiDrawIndirect");
+        }
+    }
+}
+
+
+void IndirectDrawable::Record (RG::CommandBuffer& commandBuffer) const
+{
+    Record (commandBuffer, 0);
+}
+
+
+void IndirectDrawable::Record (RG::CommandBuffer& commandBuffer, uint32_t resourceIndex) const
+{
+    if (!vertexBuffer.empty ()) {
+        std::vector<VkDeviceSize> offsets (vertexBuffer.size (), 0);
+        commandBuffer.Record<RG::CommandBindVertexBuffers> (0, static_cast<uint32_t> (vertexBuffer.size ()), vertexBuffer, offsets).SetName ("IndirectDrawable");
+    }
+
+    commandBuffer.Record<RG::CommandBindIndexBuffer> (indexBuffer, 0, VK_INDEX_TYPE_UINT16).SetName ("IndirectDrawable");
+
+    const VkBuffer drawCommandsBuffer = drawCommands->GetBufferForFrame (resourceIndex);
+
+    if (drawCount != nullptr) {
+        commandBuffer.Record<RG::CommandDrawIndexedIndirectCount> (drawCommandsBuffer, 0, drawCount->GetBufferForFrame (resourceIndex), 0, maxDrawCount, IndirectCommandStride).SetName ("IndirectDrawable");
+    } else {
+        commandBuffer.Record<RG::CommandDrawIndexedIndirect> (drawCommandsBuffer, 0, maxDrawCount, IndirectCommandStride).SetName ("IndirectDrawable");
+    }
+}
+
+
+bool IndirectDrawable::ReadsIndirectCommands (const Resource& resource) const
+{
+    return &resource == drawCommands.get () || (drawCount != nullptr && &resource == drawCount.get ());
+}
+
+} // namespace RG
@@ -15,6 +15,8 @@ ConnectionSet::~ConnectionSet () = default;
 GraphSettings::GraphSettings (const RG::DeviceExtra& device, ConnectionSet&& connectionSet, uint32_t framesInFlight)
     : device (&device)
     , framesInFlight (framesInFlight)
+    , recordEveryFrame (false)
+    , sortOperations (true)
     , connectionSet (std::move (connectionSet))
 {
 }
@@ -23,6 +25,8 @@ GraphSettings::GraphSettings (const RG::DeviceExtra& device, ConnectionSet&& con
 GraphSettings::GraphSettings (const RG::DeviceExtra& device, uint32_t framesInFlight)
     : device (&device)
     , framesInFlight (framesInFlight)
+    , recordEveryFrame (false)
+    , sortOperations (true)
 {
 }
 
@@ -30,6 +34,8 @@ GraphSettings::GraphSettings (const RG::DeviceExtra& device, uint32_t framesInFl
 GraphSettings::GraphSettings ()
     : device (nullptr)
     , framesInFlight (0)
+    , recordEveryFrame (false)
+    , sortOperations (true)
 {
 }
 
@@ -56,6 +62,8 @@ GraphSettings::GraphSettings (GraphSettings&& other) noexcept
     : connectionSet (std::move (other.connectionSet))
     , device (other.device)
     , framesInFlight (other.framesInFlight)
+    , recordEveryFrame (other.recordEveryFrame)
+    , sortOperations (other.sortOperations)
 {
     other.device         = nullptr;
     other.framesInFlight = 0;
@@ -65,9 +73,11 @@ GraphSettings::GraphSettings (GraphSettings&& other) noexcept
 GraphSettings& GraphSettings::operator= (GraphSettings&& other) noexcept
 {
     if (this != &other) {
-        connectionSet  = std::move (other.connectionSet);
-        device         = other.device;
-        framesInFlight = other.framesInFlight;
+        connectionSet    = std::move (other.connectionSet);
+        device           = other.device;
+        framesInFlight   = other.framesInFlight;
+        recordEveryFrame = other.recordEveryFrame;
+        sortOperations   = other.sortOperations;
 
         other.device         = nullptr;
         other.framesInFlight = 0;
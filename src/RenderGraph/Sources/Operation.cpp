@@ -10,7 +10,8 @@
 #include "VulkanWrapper/CommandBuffer.hpp"
 #include "VulkanWrapper/Commands.hpp"
 #include "VulkanWrapper/ComputePipeline.hpp"
-#include "VulkanWrapper/DescriptorSet.hpp"
+#include "VulkanWrapper/Utils/BindlessTextureTable.hpp"
+#include "VulkanWrapper/Utils/DescriptorAllocator.hpp"
 #include "VulkanWrapper/DescriptorSetLayout.hpp"
 #include "VulkanWrapper/Event.hpp"
 #include "VulkanWrapper/Framebuffer.hpp"
@@ -23,11 +24,30 @@
 
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
+#include <functional>
 #include <memory>
+#include <numeric>
+#include <tuple>
 
 
 namespace RG {
 
+// the hashes come first, the state vectors are only compared when they are equal
+bool Operation::StateKey::operator< (const StateKey& other) const
+{
+    return std::tie (bindPoint, renderPass, pipeline, descriptorSetLayout, bindlessDescriptorSetLayout, renderPassState, pipelineState) <
+           std::tie (other.bindPoint, other.renderPass, other.pipeline, other.descriptorSetLayout, other.bindlessDescriptorSetLayout, other.renderPassState, other.pipelineState);
+}
+
+
+bool Operation::StateKey::operator== (const StateKey& other) const
+{
+    return std::tie (bindPoint, renderPass, pipeline, descriptorSetLayout, bindlessDescriptorSetLayout, renderPassState, pipelineState) ==
+           std::tie (other.bindPoint, other.renderPass, other.pipeline, other.descriptorSetLayout, other.bindlessDescriptorSetLayout, other.renderPassState, other.pipelineState);
+}
+
+
 RenderOperation::Builder::Builder (VkDevice device)
     : device (device)
 {
@@ -75,9 +95,25 @@ RenderOperation::Builder& RenderOperation::Builder::SetFragmentShader (const std
 }
 
 
+RenderOperation::Builder& RenderOperation::Builder::SetInstancedInputs (const std::set<std::string>& value)
+{
+    EnsurePipelineCreated ();
+    shaderPipiline->SetInstancedInputs (value);
+    return *this;
+}
+
+
 RenderOperation::Builder& RenderOperation::Builder::SetVertices (std::unique_ptr<Drawable>&& value)
 {
-    drawable = std::move (value);
+    drawItems.clear ();
+    drawItems.push_back ({ std::move (value), nullptr });
+    return *this;
+}
+
+
+RenderOperation::Builder& RenderOperation::Builder::AddDrawable (std::unique_ptr<Drawable>&& value, std::unique_ptr<RG::FromShaderReflection::DescriptorWriteInfoTable>&& descriptorWriteProvider, uint64_t sortKey)
+{
+    drawItems.push_back ({ std::move (value), std::move (descriptorWriteProvider), sortKey });
     return *this;
 }
 
@@ -89,6 +125,13 @@ RenderOperation::Builder& RenderOperation::Builder::SetBlendEnabled (bool value)
 }
 
 
+RenderOperation::Builder& RenderOperation::Builder::SetSortDrawItems (bool value)
+{
+    sortDrawItems = value;
+    return *this;
+}
+
+
 RenderOperation::Builder& RenderOperation::Builder::SetName (const std::string& value)
 {
     name = value;
@@ -107,14 +150,15 @@ RenderOperation::Builder& RenderOperation::Builder::SetClearColor (const glm::ve
 
 std::shared_ptr<RenderOperation> RenderOperation::Builder::Build ()
 {
-    RG_ASSERT (drawable != nullptr);
+    RG_ASSERT (!drawItems.empty ());
     RG_ASSERT (shaderPipiline != nullptr);
 
-    std::shared_ptr<RenderOperation> op = std::make_shared<RenderOperation> (std::move (drawable), std::move (shaderPipiline), *topology);
+    std::shared_ptr<RenderOperation> op = std::make_shared<RenderOperation> (std::move (drawItems), std::move (shaderPipiline), *topology);
 
-    drawable                         = nullptr;
-    shaderPipiline                   = nullptr;
-    op->compileSettings.blendEnabled = blendEnabled;
+    drawItems.clear ();
+    shaderPipiline                    = nullptr;
+    op->compileSettings.blendEnabled  = blendEnabled;
+    op->compileSettings.sortDrawItems = sortDrawItems.value_or (false);
 
     if (name.has_value ())
         op->SetName (*name);
@@ -132,7 +176,14 @@ void RenderOperation::Builder::EnsurePipelineCreated ()
 
 
 RenderOperation::RenderOperation (std::unique_ptr<Drawable>&& drawable, std::unique_ptr<ShaderPipeline>&& shaderPipeline, VkPrimitiveTopology topology)
-    : compileSettings ({ std::move (drawable), std::move (shaderPipeline), topology })
+    : RenderOperation (std::vector<DrawItem> {}, std::move (shaderPipeline), topology)
+{
+    compileSettings.drawItems.push_back ({ std::move (drawable), nullptr });
+}
+
+
+RenderOperation::RenderOperation (std::vector<DrawItem>&& drawItems, std::unique_ptr<ShaderPipeline>&& shaderPipeline, VkPrimitiveTopology topology)
+    : compileSettings ({ std::move (drawItems), std::move (shaderPipeline), topology })
 {
     compileSettings.descriptorWriteProvider = std::make_unique<RG::FromShaderReflection::DescriptorWriteInfoTable> ();
     compileSettings.attachmentProvider      = std::make_unique<RG::FromShaderReflection::AttachmentDataTable> ();
@@ -141,35 +192,6 @@ RenderOperation::RenderOperation (std::unique_ptr<Drawable>&& drawable, std::uni
 
 namespace {
 
-class DescriptorCounter : public RG::FromShaderReflection::IUpdateDescriptorSets {
-public:
-    std::vector<VkDescriptorPoolSize> poolSizes;
-
-    uint32_t multiplier = 1;
-
-    virtual void UpdateDescriptorSets (const std::vector<VkWriteDescriptorSet>& writes) override
-    {
-        for (const VkWriteDescriptorSet& write : writes) {
-            VkDescriptorPoolSize& poolSize = GetPoolSizeByType (write.descriptorType);
-            poolSize.descriptorCount += write.descriptorCount * multiplier;
-        }
-    }
-
-private:
-    VkDescriptorPoolSize& GetPoolSizeByType (VkDescriptorType type)
-    {
-        for (VkDescriptorPoolSize& poolSize : poolSizes) {
-            if (poolSize.type == type) {
-                return poolSize;
-            }
-        }
-
-        poolSizes.push_back ({ type, 0 });
-        return poolSizes.back ();
-    }
-};
-
-
 class DescriptorWriter : public RG::FromShaderReflection::IUpdateDescriptorSets {
 public:
     VkDevice device = VK_NULL_HANDLE;
@@ -195,6 +217,33 @@ public:
 };
 
 
+// per draw entries replace the entries of the operation with the same name
+class OverridingDescriptorWriteInfoProvider : public RG::FromShaderReflection::IDescriptorWriteInfoProvider {
+private:
+    RG::FromShaderReflection::IDescriptorWriteInfoProvider& overrides;
+    RG::FromShaderReflection::IDescriptorWriteInfoProvider& fallback;
+
+public:
+    OverridingDescriptorWriteInfoProvider (RG::FromShaderReflection::IDescriptorWriteInfoProvider& overrides, RG::FromShaderReflection::IDescriptorWriteInfoProvider& fallback)
+        : overrides (overrides)
+        , fallback (fallback)
+    {
+    }
+
+    virtual std::vector<VkDescriptorImageInfo> GetDescriptorImageInfos (const std::string& name, RG::ShaderKind shaderKind, uint32_t layerIndex, uint32_t frameIndex) override
+    {
+        std::vector<VkDescriptorImageInfo> result = overrides.GetDescriptorImageInfos (name, shaderKind, layerIndex, frameIndex);
+        return !result.empty () ? result : fallback.GetDescriptorImageInfos (name, shaderKind, layerIndex, frameIndex);
+    }
+
+    virtual std::vector<VkDescriptorBufferInfo> GetDescriptorBufferInfos (const std::string& name, RG::ShaderKind shaderKind, uint32_t frameIndex) override
+    {
+        std::vector<VkDescriptorBufferInfo> result = overrides.GetDescriptorBufferInfos (name, shaderKind, frameIndex);
+        return !result.empty () ? result : fallback.GetDescriptorBufferInfos (name, shaderKind, frameIndex);
+    }
+};
+
+
 template<typename ShaderPipelineType>
 static Operation::Descriptors CompileOperationDescriptors (const GraphSettings&                                    graphSettings,
                                                            RG::FromShaderReflection::IDescriptorWriteInfoProvider& writeInfoProvider,
@@ -202,34 +251,87 @@ static Operation::Descriptors CompileOperationDescriptors (const GraphSettings&
 {
     Operation::Descriptors result;
 
-    result.descriptorSetLayout = shaderPipeline.CreateDescriptorSetLayout (graphSettings.GetDevice ());
+    RG::DescriptorAllocator& descriptorAllocator = graphSettings.GetDevice ().GetDescriptorAllocator ();
 
-    DescriptorCounter descriptorCounter;
-    descriptorCounter.multiplier = graphSettings.framesInFlight;
+    const std::vector<VkDescriptorSetLayoutBinding> bindings = shaderPipeline.GetDescriptorSetLayoutBindings ();
+
+    // identical shaders across operations (and recompiles) get the same layout
+    result.descriptorSetLayout = &descriptorAllocator.GetLayout (bindings);
+
+    bool usesBindlessTextures = false;
     shaderPipeline.IterateShaders ([&] (const RG::ShaderModule& shaderModule) {
-        RG::FromShaderReflection::WriteDescriptors (shaderModule.GetReflection (), VK_NULL_HANDLE, 0, shaderModule.GetShaderKind (), writeInfoProvider, descriptorCounter);
+        usesBindlessTextures = usesBindlessTextures || RG::FromShaderReflection::UsesBindlessTextures (shaderModule.GetReflection ());
     });
 
-    if (!descriptorCounter.poolSizes.empty ()) {
-        result.descriptorPool = std::make_unique<RG::DescriptorPool> (graphSettings.GetDevice (), descriptorCounter.poolSizes, graphSettings.framesInFlight);
+    if (usesBindlessTextures) {
+        if (RG_ERROR (!graphSettings.GetDevice ().HasBindlessTextures ())) {
+            throw std::runtime_error ("shader uses bindless textures, but the device does not support descriptor indexing");
+        }
+
+        const RG::BindlessTextureTable& bindlessTextures = graphSettings.GetDevice ().GetBindlessTextureTable ();
+
+        result.bindlessLayout        = &bindlessTextures.GetLayout ();
+        result.bindlessDescriptorSet = bindlessTextures.GetDescriptorSet ();
+    }
+
+    if (!bindings.empty ()) {
+        result.descriptorSets = descriptorAllocator.Allocate (*result.descriptorSetLayout, graphSettings.framesInFlight);
 
         DescriptorWriter descriptorWriter;
         descriptorWriter.device = graphSettings.GetDevice ();
 
         for (uint32_t resourceIndex = 0; resourceIndex < graphSettings.framesInFlight; ++resourceIndex) {
-            std::unique_ptr<RG::DescriptorSet> descriptorSet = std::make_unique<RG::DescriptorSet> (graphSettings.GetDevice (), *result.descriptorPool, *result.descriptorSetLayout);
+            const VkDescriptorSet descriptorSet = (*result.descriptorSets)[resourceIndex];
 
             shaderPipeline.IterateShaders ([&] (const RG::ShaderModule& shaderModule) {
-                RG::FromShaderReflection::WriteDescriptors (shaderModule.GetReflection (), *descriptorSet, resourceIndex, shaderModule.GetShaderKind (), writeInfoProvider, descriptorWriter);
+                RG::FromShaderReflection::WriteDescriptors (shaderModule.GetReflection (), descriptorSet, resourceIndex, shaderModule.GetShaderKind (), writeInfoProvider, descriptorWriter);
             });
-
-            result.descriptorSets.push_back (std::move (descriptorSet));
         }
     }
 
     return result;
 }
 
+
+static VkDescriptorSetLayout GetBindlessLayoutHandle (const Operation::Descriptors& descriptors)
+{
+    return descriptors.bindlessLayout != nullptr ? descriptors.bindlessLayout->operator VkDescriptorSetLayout () : VK_NULL_HANDLE;
+}
+
+
+static void RecordBindlessDescriptorSet (RG::CommandBuffer& commandBuffer, VkPipelineBindPoint bindPoint, const RG::PipelineLayout& pipelineLayout, const Operation::Descriptors& descriptors)
+{
+    if (descriptors.bindlessDescriptorSet == VK_NULL_HANDLE) {
+        return;
+    }
+
+    commandBuffer.Record<RG::CommandBindDescriptorSets> (
+                     bindPoint,
+                     pipelineLayout,
+                     BindlessDescriptorSet,
+                     std::vector<VkDescriptorSet> { descriptors.bindlessDescriptorSet },
+                     std::vector<uint32_t> {})
+        .SetName ("Operation - Bindless DescriptorSet");
+}
+
+
+static void AddStateKeyValue (size_t& hash, std::vector<uint64_t>& state, uint64_t value)
+{
+    hash ^= std::hash<uint64_t> {}(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    state.push_back (value);
+}
+
+
+static void AddShaderBinaryToStateKey (size_t& hash, std::vector<uint64_t>& state, const RG::ShaderModule& shaderModule)
+{
+    // the size separates the binaries of consecutive shaders
+    AddStateKeyValue (hash, state, static_cast<uint64_t> (shaderModule.GetShaderKind ()));
+    AddStateKeyValue (hash, state, shaderModule.GetBinary ().size ());
+    for (uint32_t word : shaderModule.GetBinary ()) {
+        AddStateKeyValue (hash, state, word);
+    }
+}
+
 } // namespace
 
 
@@ -242,8 +344,31 @@ void RenderOperation::Compile (const GraphSettings& /* graphSettings */)
 
 void RenderOperation::CompileWithExtent (const GraphSettings& graphSettings, uint32_t width, uint32_t height)
 {
+    // releasing the previous sets first lets their pool be reset and reused
+    compileResult.descriptors = Operation::Descriptors {};
+    compileResult.drawItemDescriptors.clear ();
     compileResult.descriptors = CompileOperationDescriptors (graphSettings, *compileSettings.descriptorWriteProvider, *compileSettings.pipeline);
 
+    for (const DrawItem& drawItem : compileSettings.drawItems) {
+        drawItem.drawable->CheckDeviceSupport (graphSettings.GetDevice ());
+
+        Descriptors& drawItemDescriptors = compileResult.drawItemDescriptors.emplace_back ();
+        if (drawItem.descriptorWriteProvider != nullptr) {
+            OverridingDescriptorWriteInfoProvider writeInfoProvider (*drawItem.descriptorWriteProvider, *compileSettings.descriptorWriteProvider);
+            drawItemDescriptors = CompileOperationDescriptors (graphSettings, writeInfoProvider, *compileSettings.pipeline);
+        }
+    }
+
+    // the order of the draws is visible with blending and without depth testing, they are only reordered on request
+    // draws with the same key end up next to each other, their redundant binds are elided by the command buffer
+    compileResult.drawOrder.resize (compileSettings.drawItems.size ());
+    std::iota (compileResult.drawOrder.begin (), compileResult.drawOrder.end (), 0);
+    if (compileSettings.sortDrawItems) {
+        std::stable_sort (compileResult.drawOrder.begin (), compileResult.drawOrder.end (), [&] (size_t first, size_t second) {
+            return compileSettings.drawItems[first].sortKey < compileSettings.drawItems[second].sortKey;
+        });
+    }
+
     std::vector<std::vector<VkImageView>> imageViews;
     for (uint32_t resourceIndex = 0; resourceIndex < graphSettings.framesInFlight; ++resourceIndex) {
         imageViews.push_back (RG::FromShaderReflection::GetImageViews (GetShaderPipeline ()->GetReflection (RG::ShaderKind::Fragment), RG::ShaderKind::Fragment, resourceIndex, *compileSettings.attachmentProvider));
@@ -260,10 +385,13 @@ void RenderOperation::CompileWithExtent (const GraphSettings& graphSettings, uin
                                                        inputAttachmentReferences,
                                                        attachmentDescriptions,
                                                        compileSettings.topology,
-                                                       compileSettings.blendEnabled };
+                                                       compileSettings.blendEnabled,
+                                                       GetBindlessLayoutHandle (compileResult.descriptors) };
 
     GetShaderPipeline ()->Compile (std::move (pipelineSettings));
 
+    compileResult.boundPipeline = *GetShaderPipeline ()->compileResult.pipeline;
+
     for (uint32_t resourceIndex = 0; resourceIndex < graphSettings.framesInFlight; ++resourceIndex) {
         compileResult.framebuffers.push_back (std::make_unique<RG::Framebuffer> (graphSettings.GetDevice (),
                                                                                   *GetShaderPipeline ()->compileResult.renderPass,
@@ -272,13 +400,6 @@ void RenderOperation::CompileWithExtent (const GraphSettings& graphSettings, uin
                                                                                   height));
     }
 
-    compileResult.width  = width;
-    compileResult.height = height;
-}
-
-
-void RenderOperation::Record (const ConnectionSet&, uint32_t resourceIndex, RG::CommandBuffer& commandBuffer)
-{
     uint32_t outputCount = 0;
     for (const auto& output : GetShaderPipeline ()->GetReflection (RG::ShaderKind::Fragment).outputs) {
         outputCount += output.arraySize;
@@ -298,38 +419,108 @@ void RenderOperation::Record (const ConnectionSet&, uint32_t resourceIndex, RG::
                        }
                                       : VkClearValue { 0.0f, 0.0f, 0.0f, 1.0f };
 
-    std::vector<VkClearValue> clearValues (outputCount, clearColor);
+    compileResult.clearValues = std::vector<VkClearValue> (outputCount, clearColor);
+
+    compileResult.width  = width;
+    compileResult.height = height;
+}
+
 
+void RenderOperation::Record (const ConnectionSet&, uint32_t resourceIndex, RG::CommandBuffer& commandBuffer)
+{
     RG_ASSERT (GetShaderPipeline () != nullptr);
 
     commandBuffer.Record<RG::CommandBeginRenderPass> (*GetShaderPipeline ()->compileResult.renderPass,
                                                        *compileResult.framebuffers[resourceIndex],
                                                        VkRect2D { { 0, 0 }, { compileResult.width, compileResult.height } },
-                                                       clearValues,
+                                                       compileResult.clearValues,
                                                        VK_SUBPASS_CONTENTS_INLINE)
         .SetName ("RenderOperation - Renderpass Begin");
 
-    commandBuffer.Record<RG::CommandBindPipeline> (VK_PIPELINE_BIND_POINT_GRAPHICS, *GetShaderPipeline ()->compileResult.pipeline).SetName ("RenderOperation - Bind");
+    commandBuffer.Record<RG::CommandBindPipeline> (VK_PIPELINE_BIND_POINT_GRAPHICS, compileResult.boundPipeline).SetName ("RenderOperation - Bind");
 
-    if (!compileResult.descriptors.descriptorSets.empty ()) {
-        VkDescriptorSet dsHandle = *compileResult.descriptors.descriptorSets[resourceIndex];
+    RecordBindlessDescriptorSet (commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *GetShaderPipeline ()->compileResult.pipelineLayout, compileResult.descriptors);
 
-        commandBuffer.Record<RG::CommandBindDescriptorSets> (
-                         VK_PIPELINE_BIND_POINT_GRAPHICS,
-                         *GetShaderPipeline ()->compileResult.pipelineLayout,
-                         0,
-                         std::vector<VkDescriptorSet> { dsHandle },
-                         std::vector<uint32_t> {})
-            .SetName ("RenderOperation - DescriptionSet");
-    }
+    // draws sharing the sets bind them once, the command buffer elides the repeated binds
+    for (size_t drawItemIndex : compileResult.drawOrder) {
+        const Descriptors& drawItemDescriptors = compileResult.drawItemDescriptors[drawItemIndex].descriptorSets != nullptr
+                                                     ? compileResult.drawItemDescriptors[drawItemIndex]
+                                                     : compileResult.descriptors;
 
-    RG_ASSERT (compileSettings.drawable != nullptr);
-    compileSettings.drawable->Record (commandBuffer);
+        if (drawItemDescriptors.descriptorSets != nullptr) {
+            VkDescriptorSet dsHandle = (*drawItemDescriptors.descriptorSets)[resourceIndex];
+
+            commandBuffer.Record<RG::CommandBindDescriptorSets> (
+                             VK_PIPELINE_BIND_POINT_GRAPHICS,
+                             *GetShaderPipeline ()->compileResult.pipelineLayout,
+                             0,
+                             std::vector<VkDescriptorSet> { dsHandle },
+                             std::vector<uint32_t> {})
+                .SetName ("RenderOperation - DescriptionSet");
+        }
+
+        const DrawItem& drawItem = compileSettings.drawItems[drawItemIndex];
+        RG_ASSERT (drawItem.drawable != nullptr);
+        drawItem.drawable->Record (commandBuffer, resourceIndex);
+    }
 
     commandBuffer.Record<RG::CommandEndRenderPass> ().SetName ("RenderOperation - Renderpass End");
 }
 
 
+Operation::StateKey RenderOperation::GetStateKey () const
+{
+    const ShaderPipeline& pipeline = *GetShaderPipeline ();
+
+    StateKey result;
+    result.bindPoint                   = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    result.descriptorSetLayout         = compileResult.descriptors.descriptorSetLayout->operator VkDescriptorSetLayout ();
+    result.bindlessDescriptorSetLayout = GetBindlessLayoutHandle (compileResult.descriptors);
+
+    // render passes are compatible when their attachments match in format and sample count and are referenced the same way
+    AddStateKeyValue (result.renderPass, result.renderPassState, pipeline.compileSettings.attachmentDescriptions.size ());
+    for (const VkAttachmentDescription& attachmentDescription : pipeline.compileSettings.attachmentDescriptions) {
+        AddStateKeyValue (result.renderPass, result.renderPassState, attachmentDescription.format);
+        AddStateKeyValue (result.renderPass, result.renderPassState, attachmentDescription.samples);
+    }
+    AddStateKeyValue (result.renderPass, result.renderPassState, pipeline.compileSettings.attachmentReferences.size ());
+    for (const VkAttachmentReference& attachmentReference : pipeline.compileSettings.attachmentReferences) {
+        AddStateKeyValue (result.renderPass, result.renderPassState, attachmentReference.attachment);
+    }
+    AddStateKeyValue (result.renderPass, result.renderPassState, pipeline.compileSettings.inputAttachmentReferences.size ());
+    for (const VkAttachmentReference& attachmentReference : pipeline.compileSettings.inputAttachmentReferences) {
+        AddStateKeyValue (result.renderPass, result.renderPassState, attachmentReference.attachment);
+    }
+
+    // everything the pipeline and its layout are created from, the pipeline can be bound in place of the one of another operation with the same key
+    result.pipeline = result.renderPass;
+    pipeline.IterateShaders ([&] (RG::ShaderModule& shaderModule) {
+        AddShaderBinaryToStateKey (result.pipeline, result.pipelineState, shaderModule);
+    });
+    for (const std::string& instancedInput : pipeline.GetInstancedInputs ()) {
+        AddStateKeyValue (result.pipeline, result.pipelineState, instancedInput.size ());
+        for (const char character : instancedInput) {
+            AddStateKeyValue (result.pipeline, result.pipelineState, static_cast<uint64_t> (character));
+        }
+    }
+    AddStateKeyValue (result.pipeline, result.pipelineState, compileSettings.topology);
+    AddStateKeyValue (result.pipeline, result.pipelineState, compileSettings.blendEnabled.value_or (true));
+    AddStateKeyValue (result.pipeline, result.pipelineState, compileResult.width);
+    AddStateKeyValue (result.pipeline, result.pipelineState, compileResult.height);
+
+    return result;
+}
+
+
+void RenderOperation::ShareState (const Operation& other)
+{
+    const RenderOperation* otherRenderOperation = dynamic_cast<const RenderOperation*> (&other);
+    RG_ASSERT (otherRenderOperation != nullptr);
+
+    compileResult.boundPipeline = *otherRenderOperation->GetShaderPipeline ()->compileResult.pipeline;
+}
+
+
 VkImageLayout RenderOperation::GetImageLayoutAtStartForInputs (Resource&)
 {
     return VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -362,6 +553,16 @@ VkImageLayout RenderOperation::GetImageLayoutAtEndForOutputs (Resource& res)
 }
 
 
+VkAccessFlags RenderOperation::GetBufferAccessForInputs (Resource& res)
+{
+    const bool readsIndirectCommands = std::any_of (compileSettings.drawItems.begin (), compileSettings.drawItems.end (), [&] (const DrawItem& drawItem) {
+        return drawItem.drawable->ReadsIndirectCommands (res);
+    });
+
+    return readsIndirectCommands ? VK_ACCESS_INDIRECT_COMMAND_READ_BIT : 0;
+}
+
+
 ComputeOperation::ComputeOperation (uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
     : groupCountX { groupCountX }
     , groupCountY { groupCountY }
@@ -374,6 +575,7 @@ ComputeOperation::ComputeOperation (uint32_t groupCountX, uint32_t groupCountY,
 
 void ComputeOperation::Compile (const GraphSettings& graphSettings)
 {
+    compileResult.descriptors = Operation::Descriptors {};
     compileResult.descriptors = CompileOperationDescriptors (graphSettings, *compileSettings.descriptorWriteProvider, *compileSettings.computeShaderPipeline);
 
     const RG::ShaderModule& computeShader = *compileSettings.computeShaderPipeline->computeShader;
@@ -385,9 +587,12 @@ void ComputeOperation::Compile (const GraphSettings& graphSettings)
     ComputeShaderPipeline::CompileSettings pipelineSettings { compileResult.descriptors.descriptorSetLayout->operator VkDescriptorSetLayout (),
                                                               attachmentReferences,
                                                               inputAttachmentReferences,
-                                                              attachmentDescriptions };
+                                                              attachmentDescriptions,
+                                                              GetBindlessLayoutHandle (compileResult.descriptors) };
 
     compileSettings.computeShaderPipeline->Compile (std::move (pipelineSettings));
+
+    compileResult.boundPipeline = *compileSettings.computeShaderPipeline->compileResult.pipeline;
 }
 
 
@@ -400,10 +605,10 @@ void ComputeOperation::CompileWithExtent (const GraphSettings&, uint32_t, uint32
 
 void ComputeOperation::Record (const ConnectionSet&, uint32_t resourceIndex, RG::CommandBuffer& commandBuffer)
 {
-    commandBuffer.Record<RG::CommandBindPipeline> (VK_PIPELINE_BIND_POINT_COMPUTE, *compileSettings.computeShaderPipeline->compileResult.pipeline).SetName ("ComputeOperation - Bind");
+    commandBuffer.Record<RG::CommandBindPipeline> (VK_PIPELINE_BIND_POINT_COMPUTE, compileResult.boundPipeline).SetName ("ComputeOperation - Bind");
 
-    if (!compileResult.descriptors.descriptorSets.empty ()) {
-        VkDescriptorSet dsHandle = *compileResult.descriptors.descriptorSets[resourceIndex];
+    if (compileResult.descriptors.descriptorSets != nullptr) {
+        VkDescriptorSet dsHandle = (*compileResult.descriptors.descriptorSets)[resourceIndex];
 
         commandBuffer.Record<RG::CommandBindDescriptorSets> (
                          VK_PIPELINE_BIND_POINT_COMPUTE,
@@ -414,8 +619,34 @@ void ComputeOperation::Record (const ConnectionSet&, uint32_t resourceIndex, RG:
             .SetName ("ComputeOperation - DescriptionSet");
     }
 
+    RecordBindlessDescriptorSet (commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, *compileSettings.computeShaderPipeline->compileResult.pipelineLayout, compileResult.descriptors);
+
     commandBuffer.Record<RG::CommandDispatch> (groupCountX, groupCountY, groupCountZ).SetName ("ComputeOperation - CommandDispatch");
 }
 
 
+Operation::StateKey ComputeOperation::GetStateKey () const
+{
+    StateKey result;
+    result.bindPoint                   = VK_PIPELINE_BIND_POINT_COMPUTE;
+    result.descriptorSetLayout         = compileResult.descriptors.descriptorSetLayout->operator VkDescriptorSetLayout ();
+    result.bindlessDescriptorSetLayout = GetBindlessLayoutHandle (compileResult.descriptors);
+
+    compileSettings.computeShaderPipeline->IterateShaders ([&] (const RG::ShaderModule& shaderModule) {
+        AddShaderBinaryToStateKey (result.pipeline, result.pipelineState, shaderModule);
+    });
+
+    return result;
+}
+
+
+void ComputeOperation::ShareState (const Operation& other)
+{
+    const ComputeOperation* otherComputeOperation = dynamic_cast<const ComputeOperation*> (&other);
+    RG_ASSERT (otherComputeOperation != nullptr);
+
+    compileResult.boundPipeline = *otherComputeOperation->compileSettings.computeShaderPipeline->compileResult.pipeline;
+}
+
+
 } // namespace RG
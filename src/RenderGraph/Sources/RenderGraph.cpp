@@ -22,8 +22,13 @@
 
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
 #include <iostream>
+#include <map>
+#include <optional>
+#include <set>
 #include <sstream>
+#include <unordered_map>
 
 
 namespace RG {
@@ -42,6 +47,19 @@ void RenderGraph::CompileResources ()
 }
 
 
+void RenderGraph::NameResourceAllocations ()
+{
+    const VmaAllocator allocator = graphSettings.GetDevice ().GetAllocator ();
+
+    RG::ForEach<Resource> (graphSettings.connectionSet.GetNodesByInsertionOrder (), [&] (std::shared_ptr<Resource>& res) {
+        const std::string allocationName = fmt::format ("{} ({})", res->GetName (), res->GetUUID ().GetValue ());
+        for (VmaAllocation allocation : res->GetAllocations ()) {
+            SetAllocationName (allocator, allocation, allocationName);
+        }
+    });
+}
+
+
 void RenderGraph::CompileOperations ()
 {
     for (Pass& pass : passes) {
@@ -229,6 +247,68 @@ void RenderGraph::SeparatePasses ()
 }
 
 
+void RenderGraph::SortPassOperations ()
+{
+    if (!graphSettings.sortOperations) {
+        return;
+    }
+
+    std::optional<Operation::StateKey> previousKey;
+
+    for (Pass& pass : passes) {
+        std::unordered_map<const Operation*, Operation::StateKey> stateKeys;
+        for (const Operation* op : pass.GetAllOperations ()) {
+            stateKeys[op] = op->GetStateKey ();
+        }
+
+        // operations continuing with the state of the previous pass go first, saving a bind at the pass boundary
+        pass.SortOperations ([&] (const Operation* first, const Operation* second) {
+            const Operation::StateKey& firstKey  = stateKeys.at (first);
+            const Operation::StateKey& secondKey = stateKeys.at (second);
+
+            const bool firstContinues  = previousKey.has_value () && firstKey == *previousKey;
+            const bool secondContinues = previousKey.has_value () && secondKey == *previousKey;
+            if (firstContinues != secondContinues) {
+                return firstContinues;
+            }
+
+            return firstKey < secondKey;
+        });
+
+        for (const Operation* op : pass.GetAllOperations ()) {
+            if (stateKeys.at (op).HasPipeline ()) {
+                previousKey = stateKeys.at (op);
+            }
+        }
+    }
+}
+
+
+void RenderGraph::ShareOperationStates ()
+{
+    // the first operation recorded with a key lends its pipeline to the later ones
+    std::map<Operation::StateKey, const Operation*> firstOperations;
+    size_t                                          sharingCount = 0;
+
+    for (const Pass& pass : passes) {
+        for (Operation* op : pass.GetAllOperations ()) {
+            const Operation::StateKey key = op->GetStateKey ();
+            if (!key.HasPipeline ()) {
+                continue;
+            }
+
+            const auto inserted = firstOperations.emplace (key, op);
+            if (!inserted.second) {
+                op->ShareState (*inserted.first->second);
+                ++sharingCount;
+            }
+        }
+    }
+
+    spdlog::debug ("RenderGraph: {} operations bind the pipeline of an earlier operation.", sharingCount);
+}
+
+
 void RenderGraph::DebugPrint ()
 {
     std::stringstream logString;
@@ -256,8 +336,172 @@ void RenderGraph::DebugPrint ()
 }
 
 
+RenderGraph::MemoryReport RenderGraph::GetMemoryReport () const
+{
+    const VmaAllocator allocator = graphSettings.GetDevice ().GetAllocator ();
+
+    MemoryReport report;
+
+    for (const std::shared_ptr<Node>& node : graphSettings.connectionSet.GetNodesByInsertionOrder ()) {
+        const Resource* res = dynamic_cast<const Resource*> (node.get ());
+        if (res == nullptr) {
+            continue;
+        }
+
+        NodeMemoryUsage& nodeUsage = report.nodes.emplace_back ();
+        nodeUsage.name             = res->GetName ();
+        nodeUsage.uuid             = res->GetUUID ().GetValue ();
+
+        for (VmaAllocation allocation : res->GetAllocations ()) {
+            const AllocationUsage allocationUsage = GetAllocationUsage (allocator, allocation);
+
+            if (allocationUsage.deviceLocal) {
+                nodeUsage.deviceLocalBytes += allocationUsage.size;
+            } else {
+                nodeUsage.hostBytes += allocationUsage.size;
+            }
+
+            if (allocationUsage.dedicated) {
+                ++report.dedicatedAllocationCount;
+            }
+
+            ++nodeUsage.allocationCount;
+        }
+    }
+
+    report.heaps = GetHeapUsages (allocator);
+
+    return report;
+}
+
+
+void RenderGraph::DebugPrintMemoryReport () const
+{
+    const MemoryReport report = GetMemoryReport ();
+
+    std::stringstream logString;
+    for (const NodeMemoryUsage& nodeUsage : report.nodes) {
+        logString << "Resource \"" << nodeUsage.name << "\" (id: " << nodeUsage.uuid << ")" << std::endl;
+        logString << "\tDevice local: " << nodeUsage.deviceLocalBytes << " bytes, host: " << nodeUsage.hostBytes << " bytes, allocations: " << nodeUsage.allocationCount << std::endl;
+    }
+
+    logString << "Dedicated allocations: " << report.dedicatedAllocationCount << std::endl;
+
+    for (size_t i = 0; i < report.heaps.size (); ++i) {
+        const RG::HeapUsage& heap = report.heaps[i];
+        logString << "Heap " << i << (heap.deviceLocal ? " (device local)" : " (host)") << ", size: " << heap.size << " bytes" << std::endl;
+        logString << "\tBlocks: " << heap.blockBytes << " bytes, allocations: " << heap.allocationBytes << " bytes, usage: " << heap.usage << " / " << heap.budget << " bytes budget" << std::endl;
+    }
+
+    spdlog::info ("======= Memory usage begin =======");
+    spdlog::info ("{}", logString.str ());
+    spdlog::info ("======= Memory usage end =========");
+}
+
+
 RG::CommandLineOnOffFlag printRenderGraphFlag { "--printRenderGraph", "Prints render graph passes, operatins, resources." };
 
+RG::CommandLineOnOffFlag printMemoryUsageFlag { "--printMemoryUsage", "Prints device memory allocated by render graph resources and heap budgets." };
+
+
+static const VkAccessFlags fullMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+                                      VK_ACCESS_INDEX_READ_BIT |
+                                      VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+                                      VK_ACCESS_UNIFORM_READ_BIT |
+                                      VK_ACCESS_INPUT_ATTACHMENT_READ_BIT |
+                                      VK_ACCESS_SHADER_READ_BIT |
+                                      VK_ACCESS_SHADER_WRITE_BIT |
+                                      VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                                      VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                      VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                                      VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                      VK_ACCESS_TRANSFER_READ_BIT |
+                                      VK_ACCESS_TRANSFER_WRITE_BIT;
+
+
+static VkMemoryBarrier GetFlushAllMemoryBarrier ()
+{
+    VkMemoryBarrier flushAllMemory = {};
+    flushAllMemory.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    flushAllMemory.srcAccessMask   = fullMask;
+    flushAllMemory.dstAccessMask   = fullMask;
+    return flushAllMemory;
+}
+
+
+static VkAccessFlags GetAccessFlagsSupportedByStages (VkPipelineStageFlags stages)
+{
+    if (stages & VK_PIPELINE_STAGE_ALL_COMMANDS_BIT) {
+        return fullMask;
+    }
+
+    VkAccessFlags result = 0;
+
+    if (stages & (VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT)) {
+        result |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    }
+    if (stages & (VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT)) {
+        result |= VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+    }
+    if (stages & (VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT)) {
+        result |= VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    }
+    if (stages & (VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT)) {
+        result |= VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+    }
+    if (stages & (VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT)) {
+        result |= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    }
+    if (stages & (VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT)) {
+        result |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    }
+    if (stages & VK_PIPELINE_STAGE_TRANSFER_BIT) {
+        result |= VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    }
+
+    return result & fullMask;
+}
+
+
+static bool IsSameSubresourceRange (const VkImageSubresourceRange& first, const VkImageSubresourceRange& second)
+{
+    return first.aspectMask == second.aspectMask &&
+           first.baseMipLevel == second.baseMipLevel &&
+           first.levelCount == second.levelCount &&
+           first.baseArrayLayer == second.baseArrayLayer &&
+           first.layerCount == second.layerCount;
+}
+
+
+// a batch may transition a subresource only once, later transitions of the same subresource are folded into the first
+static void AddImageBarrier (std::vector<VkImageMemoryBarrier>& barriers, const VkImageMemoryBarrier& barrier)
+{
+    for (VkImageMemoryBarrier& existing : barriers) {
+        if (existing.image == barrier.image && IsSameSubresourceRange (existing.subresourceRange, barrier.subresourceRange)) {
+            existing.newLayout = barrier.newLayout;
+            existing.srcAccessMask |= barrier.srcAccessMask;
+            existing.dstAccessMask |= barrier.dstAccessMask;
+            return;
+        }
+    }
+
+    barriers.push_back (barrier);
+}
+
+
+static void AddBufferBarrier (std::vector<VkBufferMemoryBarrier>& barriers, const VkBufferMemoryBarrier& barrier)
+{
+    for (VkBufferMemoryBarrier& existing : barriers) {
+        if (existing.buffer == barrier.buffer && existing.offset == barrier.offset && existing.size == barrier.size) {
+            existing.srcAccessMask |= barrier.srcAccessMask;
+            existing.dstAccessMask |= barrier.dstAccessMask;
+            return;
+        }
+    }
+
+    barriers.push_back (barrier);
+}
+
 
 void RenderGraph::Compile (GraphSettings&& graphSettings_)
 {
@@ -274,8 +518,18 @@ void RenderGraph::Compile (GraphSettings&& graphSettings_)
 
     CompileResources ();
 
+    NameResourceAllocations ();
+
+    if (printMemoryUsageFlag.IsFlagOn ()) {
+        DebugPrintMemoryReport ();
+    }
+
     CompileOperations ();
 
+    SortPassOperations ();
+
+    ShareOperationStates ();
+
     imageLayoutSequence.clear ();
 
     for (Pass& p : passes) {
@@ -291,47 +545,75 @@ void RenderGraph::Compile (GraphSettings&& graphSettings_)
         });
     }
 
-    const VkAccessFlags fullMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
-                                   VK_ACCESS_INDEX_READ_BIT |
-                                   VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
-                                   VK_ACCESS_UNIFORM_READ_BIT |
-                                   VK_ACCESS_INPUT_ATTACHMENT_READ_BIT |
-                                   VK_ACCESS_SHADER_READ_BIT |
-                                   VK_ACCESS_SHADER_WRITE_BIT |
-                                   VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
-                                   VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
-                                   VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
-                                   VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
-                                   VK_ACCESS_TRANSFER_READ_BIT |
-                                   VK_ACCESS_TRANSFER_WRITE_BIT;
-
-    VkMemoryBarrier flushAllMemory = {};
-    flushAllMemory.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
-    flushAllMemory.srcAccessMask   = fullMask;
-    flushAllMemory.dstAccessMask   = fullMask;
+    CreateFrameRecordings ();
 
+    // command buffers go first, they were allocated from the pools
     commandBuffers.clear ();
+    frameCommandPools.clear ();
+    frameFences.clear ();
 
     for (uint32_t frameIndex = 0; frameIndex < graphSettings.framesInFlight; ++frameIndex) {
-        RG::CommandBuffer& currentCmdbuffer = commandBuffers.emplace_back (graphSettings.GetDevice ());
+        if (graphSettings.recordEveryFrame) {
+            const RG::DeviceExtra& device = graphSettings.GetDevice ();
+
+            RG_ASSERT (device.GetGraphicsQueueFamilyIndex () != VK_QUEUE_FAMILY_IGNORED);
+
+            RG::CommandPool& commandPool = *frameCommandPools.emplace_back (std::make_unique<RG::CommandPool> (device, device.GetGraphicsQueueFamilyIndex (), VK_COMMAND_POOL_CREATE_TRANSIENT_BIT));
+            commandPool.SetName (device, fmt::format ("CommandPool {}/{}", frameIndex, graphSettings.framesInFlight));
+
+            RG::Fence& fence = *frameFences.emplace_back (std::make_unique<RG::Fence> (device));
+            fence.SetName (device, fmt::format ("Frame Fence {}/{}", frameIndex, graphSettings.framesInFlight));
+
+            commandBuffers.emplace_back (device, commandPool);
+        } else {
+            commandBuffers.emplace_back (graphSettings.GetDevice ());
+        }
+
+        RG::CommandBuffer& currentCmdbuffer = commandBuffers.back ();
 
         currentCmdbuffer.SetName (*graphSettings.device, fmt::format ("CommandBuffer {}/{}", frameIndex, graphSettings.framesInFlight));
 
-        currentCmdbuffer.Begin ();
+        // recorded on Submit instead
+        if (graphSettings.recordEveryFrame) {
+            continue;
+        }
+
+        RecordFrame (frameIndex, currentCmdbuffer, 0);
+
+        spdlog::debug ("RenderGraph: {} pipeline binds and {} render pass begins recorded, {} redundant binds elided in command buffer {}.",
+                       currentCmdbuffer.GetStatistics ().pipelineBinds,
+                       currentCmdbuffer.GetStatistics ().renderPassBegins,
+                       currentCmdbuffer.GetElidedCommandCount (),
+                       frameIndex);
+    }
+
+    compiled = true;
+}
+
+
+void RenderGraph::CreateFrameRecordings ()
+{
+    frameRecordings.clear ();
+
+    for (uint32_t frameIndex = 0; frameIndex < graphSettings.framesInFlight; ++frameIndex) {
+        FrameRecording& frameRecording = frameRecordings.emplace_back ();
 
         for (Pass& p : passes) {
+            RecordedPass& recordedPass = frameRecording.passes.emplace_back ();
+            recordedPass.dstStageMask  = 0;
+
             for (auto op : p.GetAllOperations ()) {
                 auto allInputs  = graphSettings.connectionSet.GetPointingHere<Resource> (op);
                 auto allOutputs = graphSettings.connectionSet.GetPointingTo<Resource> (op);
 
-                std::unique_ptr<RG::CommandPipelineBarrier> barrier = std::make_unique<RG::CommandPipelineBarrier> (VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,  // TODO maybe VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT?
-                                                                                                                      VK_PIPELINE_STAGE_ALL_COMMANDS_BIT); // TODO maybe VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT?
-                barrier->AddMemoryBarrier (flushAllMemory);
+                recordedPass.operations.push_back (op);
+                recordedPass.dstStageMask |= op->GetPipelineStages ();
+
                 RG::ForEach<ImageResource> (allInputs, [&] (const std::shared_ptr<ImageResource>& img) {
                     for (RG::Image* image : img->GetImages (frameIndex)) {
                         const VkImageLayout currentLayout = imageLayoutSequence[*image].back ();
                         const VkImageLayout newLayout     = op->GetImageLayoutAtStartForInputs (*img);
-                        barrier->AddImageMemoryBarrier (image->GetBarrier (currentLayout, newLayout, fullMask, fullMask));
+                        AddImageBarrier (recordedPass.imageBarriers, image->GetBarrier (currentLayout, newLayout, fullMask, fullMask));
                         imageLayoutSequence[*image].push_back (newLayout);
                     }
                 });
@@ -340,13 +622,29 @@ void RenderGraph::Compile (GraphSettings&& graphSettings_)
                     for (RG::Image* image : img->GetImages (frameIndex)) {
                         const VkImageLayout currentLayout = imageLayoutSequence[*image].back ();
                         const VkImageLayout newLayout     = op->GetImageLayoutAtStartForOutputs (*img);
-                        barrier->AddImageMemoryBarrier (image->GetBarrier (currentLayout, newLayout, fullMask, fullMask));
+                        AddImageBarrier (recordedPass.imageBarriers, image->GetBarrier (currentLayout, newLayout, fullMask, fullMask));
                         imageLayoutSequence[*image].push_back (newLayout);
                     }
                 });
 
-                currentCmdbuffer.RecordCommand (std::move (barrier))
-                    .SetName ("Transition for next Pass");
+                // e.g. indirect draw parameters written by a compute shader in an earlier pass
+                RG::ForEach<DescriptorBindableBufferResource> (allInputs, [&] (const std::shared_ptr<DescriptorBindableBufferResource>& buf) {
+                    const VkAccessFlags dstAccessMask = op->GetBufferAccessForInputs (*buf);
+                    if (dstAccessMask == 0) {
+                        return;
+                    }
+
+                    VkBufferMemoryBarrier barrier = {};
+                    barrier.sType                 = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                    barrier.srcAccessMask         = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+                    barrier.dstAccessMask         = dstAccessMask;
+                    barrier.srcQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.dstQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.buffer                = buf->GetBufferForFrame (frameIndex);
+                    barrier.offset                = 0;
+                    barrier.size                  = VK_WHOLE_SIZE;
+                    AddBufferBarrier (recordedPass.bufferBarriers, barrier);
+                });
 
                 RG::ForEach<ImageResource> (allInputs, [&] (const std::shared_ptr<ImageResource>& img) {
                     for (RG::Image* image : img->GetImages (frameIndex)) {
@@ -361,30 +659,170 @@ void RenderGraph::Compile (GraphSettings&& graphSettings_)
                 });
             }
 
-            for (auto op : p.GetAllOperations ()) {
-                op->Record (graphSettings.connectionSet, frameIndex, currentCmdbuffer);
+            if (recordedPass.dstStageMask == 0) {
+                recordedPass.dstStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
             }
         }
 
-        {
-            std::unique_ptr<RG::CommandPipelineBarrier> barrier = std::make_unique<RG::CommandPipelineBarrier> (VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,  // TODO maybe VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT?
-                                                                                                                  VK_PIPELINE_STAGE_ALL_COMMANDS_BIT); // TODO maybe VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT?
-            barrier->AddMemoryBarrier (flushAllMemory);
-            for (Pass& p : passes) {
-                RG::ForEach<ImageResource*> (p.GetAllInputs (), [&] (ImageResource* img) {
-                    for (RG::Image* image : img->GetImages (frameIndex)) {
-                        const VkImageLayout currentLayout = imageLayoutSequence[*image].back ();
-                        barrier->AddImageMemoryBarrier (image->GetBarrier (currentLayout, img->GetInitialLayout (), fullMask, fullMask));
-                    }
-                });
+        CreatePassSynchronization (frameRecording);
+
+        for (Pass& p : passes) {
+            RG::ForEach<ImageResource*> (p.GetAllInputs (), [&] (ImageResource* img) {
+                for (RG::Image* image : img->GetImages (frameIndex)) {
+                    const VkImageLayout currentLayout = imageLayoutSequence[*image].back ();
+                    frameRecording.finalImageBarriers.push_back (image->GetBarrier (currentLayout, img->GetInitialLayout (), fullMask, fullMask));
+                }
+            });
+        }
+    }
+}
+
+
+void RenderGraph::CreatePassSynchronization (FrameRecording& frameRecording)
+{
+    std::vector<Operation*>                                   recordedOperations;
+    std::unordered_map<const Resource*, std::set<Operation*>> resourceAccessors;
+    std::unordered_map<Operation*, VkEvent>                   operationEvents;
+    VkPipelineStageFlags                                      recordedStages = 0;
+
+    const auto GetAccessedResources = [&] (Operation* op) {
+        std::vector<std::shared_ptr<Resource>> result = graphSettings.connectionSet.GetPointingHere<Resource> (op);
+        for (const std::shared_ptr<Resource>& output : graphSettings.connectionSet.GetPointingTo<Resource> (op)) {
+            result.push_back (output);
+        }
+        return result;
+    };
+
+    for (size_t passIndex = 0; passIndex < frameRecording.passes.size (); ++passIndex) {
+        RecordedPass& recordedPass = frameRecording.passes[passIndex];
+
+        // operations of earlier passes reading or writing a resource of this pass
+        std::set<Operation*> dependencies;
+        for (Operation* op : recordedPass.operations) {
+            for (const std::shared_ptr<Resource>& res : GetAccessedResources (op)) {
+                const auto accessors = resourceAccessors.find (res.get ());
+                if (accessors != resourceAccessors.end ()) {
+                    dependencies.insert (accessors->second.begin (), accessors->second.end ());
+                }
             }
-            currentCmdbuffer.RecordCommand (std::move (barrier));
         }
 
-        currentCmdbuffer.End ();
+        // waiting on events only pays off when independent operations were recorded after the first dependency,
+        // those can still run while this pass starts
+        const auto firstDependency = std::find_if (recordedOperations.begin (), recordedOperations.end (), [&] (Operation* op) {
+            return dependencies.count (op) > 0;
+        });
+
+        const bool hasIndependentWork = std::any_of (firstDependency, recordedOperations.end (), [&] (Operation* op) {
+            return dependencies.count (op) == 0;
+        });
+
+        if (hasIndependentWork) {
+            recordedPass.srcStageMask = 0;
+
+            for (Operation* dependency : recordedOperations) {
+                if (dependencies.count (dependency) == 0) {
+                    continue;
+                }
+
+                VkEvent& event = operationEvents[dependency];
+                if (event == VK_NULL_HANDLE) {
+                    VW::Event& newEvent = *frameRecording.events.emplace_back (std::make_unique<VW::Event> (graphSettings.GetDevice ()));
+                    newEvent.SetName (graphSettings.GetDevice (), fmt::format ("Split barrier after \"{}\"", dependency->GetName ()));
+                    event = newEvent;
+                }
+
+                recordedPass.eventsToWait.push_back (event);
+                recordedPass.srcStageMask |= dependency->GetPipelineStages ();
+            }
+        } else {
+            // the first pass waits for everything submitted before the frame
+            recordedPass.srcStageMask = passIndex == 0 ? VK_PIPELINE_STAGE_ALL_COMMANDS_BIT : recordedStages;
+        }
+
+        // access masks have to be supported by the stages of the batch
+        const VkAccessFlags srcAccessMask = GetAccessFlagsSupportedByStages (recordedPass.srcStageMask);
+        const VkAccessFlags dstAccessMask = GetAccessFlagsSupportedByStages (recordedPass.dstStageMask);
+
+        recordedPass.memoryBarrier = GetFlushAllMemoryBarrier ();
+        recordedPass.memoryBarrier.srcAccessMask &= srcAccessMask;
+        recordedPass.memoryBarrier.dstAccessMask &= dstAccessMask;
+
+        for (VkImageMemoryBarrier& barrier : recordedPass.imageBarriers) {
+            barrier.srcAccessMask &= srcAccessMask;
+            barrier.dstAccessMask &= dstAccessMask;
+        }
+
+        for (VkBufferMemoryBarrier& barrier : recordedPass.bufferBarriers) {
+            barrier.srcAccessMask &= srcAccessMask;
+            barrier.dstAccessMask &= dstAccessMask;
+        }
+
+        for (Operation* op : recordedPass.operations) {
+            recordedOperations.push_back (op);
+            recordedStages |= op->GetPipelineStages ();
+            for (const std::shared_ptr<Resource>& res : GetAccessedResources (op)) {
+                resourceAccessors[res.get ()].insert (op);
+            }
+        }
     }
 
-    compiled = true;
+    for (RecordedPass& recordedPass : frameRecording.passes) {
+        for (Operation* op : recordedPass.operations) {
+            const auto event = operationEvents.find (op);
+            recordedPass.eventsToSet.push_back (event != operationEvents.end () ? event->second : VK_NULL_HANDLE);
+        }
+    }
+}
+
+
+void RenderGraph::RecordFrame (uint32_t frameIndex, RG::CommandBuffer& commandBuffer, VkCommandBufferUsageFlags usageFlags) const
+{
+    const FrameRecording& frameRecording = frameRecordings[frameIndex];
+
+    const VkMemoryBarrier flushAllMemory = GetFlushAllMemoryBarrier ();
+
+    commandBuffer.Begin (usageFlags);
+
+    for (const RecordedPass& recordedPass : frameRecording.passes) {
+        if (recordedPass.eventsToWait.empty ()) {
+            commandBuffer.Record<RG::CommandPipelineBarrier> (recordedPass.srcStageMask,
+                                                              recordedPass.dstStageMask,
+                                                              std::vector<VkMemoryBarrier> { recordedPass.memoryBarrier },
+                                                              recordedPass.bufferBarriers,
+                                                              recordedPass.imageBarriers)
+                .SetName ("Transition for next Pass");
+        } else {
+            commandBuffer.Record<RG::CommandWaitEvents> (recordedPass.eventsToWait,
+                                                         recordedPass.srcStageMask,
+                                                         recordedPass.dstStageMask,
+                                                         std::vector<VkMemoryBarrier> { recordedPass.memoryBarrier },
+                                                         recordedPass.bufferBarriers,
+                                                         recordedPass.imageBarriers)
+                .SetName ("Split barrier - Wait");
+        }
+
+        for (size_t i = 0; i < recordedPass.operations.size (); ++i) {
+            recordedPass.operations[i]->Record (graphSettings.connectionSet, frameIndex, commandBuffer);
+
+            if (recordedPass.eventsToSet[i] != VK_NULL_HANDLE) {
+                commandBuffer.Record<RG::CommandSetEvent> (recordedPass.eventsToSet[i], recordedPass.operations[i]->GetPipelineStages ()).SetName ("Split barrier - Set");
+            }
+        }
+    }
+
+    commandBuffer.Record<RG::CommandPipelineBarrier> (VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, // TODO maybe VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT?
+                                                      VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, // TODO maybe VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT?
+                                                      std::vector<VkMemoryBarrier> { flushAllMemory },
+                                                      std::vector<VkBufferMemoryBarrier> {},
+                                                      frameRecording.finalImageBarriers);
+
+    // every wait of the frame has finished after the barrier above, the next submission starts with unsignaled events
+    for (const std::unique_ptr<VW::Event>& event : frameRecording.events) {
+        commandBuffer.Record<RG::CommandResetEvent> (*event, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT).SetName ("Split barrier - Reset");
+    }
+
+    commandBuffer.End ();
 }
 
 
@@ -400,7 +838,28 @@ void RenderGraph::Submit (uint32_t frameIndex, const std::vector<VkSemaphore>& w
 
     std::vector<VkPipelineStageFlags> waitDstStageMasks (waitSemaphores.size (), VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
 
-    graphSettings.device->GetGraphicsQueue ().Submit (waitSemaphores, waitDstStageMasks, { &commandBuffers[frameIndex] }, signalSemaphores, fenceToSignal);
+    if (!graphSettings.recordEveryFrame) {
+        graphSettings.device->GetGraphicsQueue ().Submit (waitSemaphores, waitDstStageMasks, { &commandBuffers[frameIndex] }, signalSemaphores, fenceToSignal);
+        return;
+    }
+
+    // the previous submission of this frame must finish before its pool can be reset
+    const RG::Fence& frameFence = *frameFences[frameIndex];
+    frameFence.Wait ();
+    frameFence.Reset ();
+
+    frameCommandPools[frameIndex]->Reset ();
+
+    RecordFrame (frameIndex, commandBuffers[frameIndex], VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+    const RG::Queue& graphicsQueue = graphSettings.device->GetGraphicsQueue ();
+
+    graphicsQueue.Submit (waitSemaphores, waitDstStageMasks, { &commandBuffers[frameIndex] }, signalSemaphores, frameFence);
+
+    // the frame fence is owned by the graph, an empty submission signals the caller's fence after the frame finished
+    if (fenceToSignal != VK_NULL_HANDLE) {
+        graphicsQueue.Submit ({}, {}, std::vector<RG::CommandBuffer*> {}, {}, fenceToSignal);
+    }
 }
 
 
@@ -420,4 +879,64 @@ uint32_t RenderGraph::GetPassCount () const
     return static_cast<uint32_t> (passes.size ());
 }
 
+
+size_t RenderGraph::GetSplitBarrierCount () const
+{
+    RG_ASSERT (compiled);
+
+    if (frameRecordings.empty ()) {
+        return 0;
+    }
+
+    return static_cast<size_t> (std::count_if (frameRecordings[0].passes.begin (), frameRecordings[0].passes.end (), [] (const RecordedPass& recordedPass) {
+        return !recordedPass.eventsToWait.empty ();
+    }));
+}
+
+
+size_t RenderGraph::GetElidedCommandCount () const
+{
+    size_t result = 0;
+    for (const RG::CommandBuffer& commandBuffer : commandBuffers) {
+        result += commandBuffer.GetElidedCommandCount ();
+    }
+    return result;
+}
+
+
+RG::CommandStatistics RenderGraph::GetCommandStatistics () const
+{
+    RG::CommandStatistics result;
+    for (const RG::CommandBuffer& commandBuffer : commandBuffers) {
+        result.pipelineBinds    += commandBuffer.GetStatistics ().pipelineBinds;
+        result.renderPassBegins += commandBuffer.GetStatistics ().renderPassBegins;
+    }
+    return result;
+}
+
+RG::CommandCapture RenderGraph::CaptureCommandStream ()
+{
+    RG_ASSERT (compiled);
+
+    RG::CommandCapture result;
+
+    RG::ForEach<ImageResource> (graphSettings.connectionSet.GetNodesByInsertionOrder (), [&] (const std::shared_ptr<ImageResource>& img) {
+        for (RG::Image* image : img->GetImages ()) {
+            result.AddImage (*image);
+        }
+    });
+
+    RG::ForEach<DescriptorBindableBufferResource> (graphSettings.connectionSet.GetNodesByInsertionOrder (), [&] (const std::shared_ptr<DescriptorBindableBufferResource>& buf) {
+        for (uint32_t frameIndex = 0; frameIndex < graphSettings.framesInFlight; ++frameIndex) {
+            result.AddBuffer (buf->GetBufferForFrame (frameIndex), buf->GetBufferSize ());
+        }
+    });
+
+    for (const RG::CommandBuffer& commandBuffer : commandBuffers) {
+        result.AddCommandBuffer (commandBuffer);
+    }
+
+    return result;
+}
+
 } // namespace RG
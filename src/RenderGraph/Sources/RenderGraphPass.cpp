@@ -17,6 +17,7 @@
 #include "VulkanWrapper/DescriptorSet.hpp"
 #include "VulkanWrapper/DescriptorSetLayout.hpp"
 
+#include <algorithm>
 #include <optional>
 #include <set>
 
@@ -232,6 +233,14 @@ bool Pass::IsEmpty () const
 }
 
 
+void Pass::SortOperations (const std::function<bool (const Operation*, const Operation*)>& less)
+{
+    std::stable_sort (operationIOs.begin (), operationIOs.end (), [&] (const OperationIO& first, const OperationIO& second) {
+        return less (first.op, second.op);
+    });
+}
+
+
 bool Pass::RemoveIfEmpty (Operation* op)
 {
     for (size_t i = 0; i < operationIOs.size (); ++i) {
@@ -5,11 +5,15 @@
 #include "VulkanWrapper/ImageView.hpp"
 #include "VulkanWrapper/Swapchain.hpp"
 #include "VulkanWrapper/Commands.hpp"
-#include "VulkanWrapper/Event.hpp"
 #include "VulkanWrapper/Sampler.hpp"
+#include "VulkanWrapper/Utils/BindlessTextureTable.hpp"
+#include "VulkanWrapper/Utils/BlockCompression.hpp"
 #include "VulkanWrapper/Utils/BufferTransferable.hpp"
+#include "VulkanWrapper/Utils/ImageFile.hpp"
 #include "VulkanWrapper/Utils/VulkanUtils.hpp"
 
+#include "spdlog/spdlog.h"
+
 namespace RG {
 
 
@@ -95,6 +99,18 @@ void WritableImageResource::Compile (const GraphSettings& graphSettings)
 }
 
 
+std::vector<VmaAllocation> WritableImageResource::GetAllocations () const
+{
+    std::vector<VmaAllocation> result;
+
+    for (auto& img : images) {
+        result.push_back (*img->image);
+    }
+
+    return result;
+}
+
+
 VkImageLayout WritableImageResource::GetInitialLayout () const
 {
     return initialLayout;
@@ -142,48 +158,12 @@ VkSampler   WritableImageResource::GetSampler () { return *sampler; }
 
 void SingleWritableImageResource::Compile (const GraphSettings& graphSettings)
 {
-    readWriteSync = std::make_unique<VW::Event> (graphSettings.GetDevice ());
-
     sampler = std::make_unique<RG::Sampler> (graphSettings.GetDevice (), filter);
     images.clear ();
     images.push_back (std::make_unique<SingleImageResource> (graphSettings.GetDevice (), width, height, arrayLayers, GetFormat ()));
 }
 
 
-void SingleWritableImageResource::OnPreRead (uint32_t /* resourceIndex */, RG::CommandBuffer& commandBuffer)
-{
-    commandBuffer.Record<RG::CommandGeneric> ([&] (VkCommandBuffer commandBuffer) {
-        VkEvent handle = *readWriteSync;
-        vkCmdWaitEvents (commandBuffer,
-                            1,
-                            &handle,
-                            VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
-                            VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
-                            0, nullptr,
-                            0, nullptr,
-                            0, nullptr);
-    });
-}
-
-
-void SingleWritableImageResource::OnPreWrite (uint32_t /* resourceIndex */, RG::CommandBuffer& commandBuffer)
-{
-    commandBuffer.Record<RG::CommandGeneric> ([&] (VkCommandBuffer commandBuffer) {
-        VkEvent handle = *readWriteSync;
-        vkCmdResetEvent (commandBuffer, handle, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT);
-    });
-}
-
-
-void SingleWritableImageResource::OnPostWrite (uint32_t /* resourceIndex */, RG::CommandBuffer& commandBuffer)
-{
-    commandBuffer.Record<RG::CommandGeneric> ([&] (VkCommandBuffer commandBuffer) {
-        VkEvent handle = *readWriteSync;
-        vkCmdSetEvent (commandBuffer, handle, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT);
-    });
-}
-
-
 GPUBufferResource::GPUBufferResource (const size_t size)
     : size (size)
 {
@@ -197,11 +177,24 @@ void GPUBufferResource::Compile (const GraphSettings& settings)
 {
     buffers.reserve (settings.framesInFlight);
     for (uint32_t i = 0; i < settings.framesInFlight; ++i) {
-        buffers.push_back (std::make_unique<RG::BufferTransferable> (settings.GetDevice (), size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT));
+        buffers.push_back (std::make_unique<RG::BufferTransferable> (settings.GetDevice (), size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, RG::TransferableUsage::Dynamic));
     }
 }
 
 
+std::vector<VmaAllocation> GPUBufferResource::GetAllocations () const
+{
+    std::vector<VmaAllocation> result;
+
+    for (auto& buffer : buffers) {
+        const std::vector<VmaAllocation> bufferAllocations = buffer->GetAllocations ();
+        result.insert (result.end (), bufferAllocations.begin (), bufferAllocations.end ());
+    }
+
+    return result;
+}
+
+
 VkBuffer GPUBufferResource::GetBufferForFrame (uint32_t resourceIndex)
 {
     return buffers[resourceIndex]->bufferGPU;
@@ -226,6 +219,24 @@ void GPUBufferResource::TransferFromGPUToCPU (uint32_t resourceIndex) const
 }
 
 
+void GPUBufferResource::TransferFromGPUToCPU (uint32_t resourceIndex, VkDeviceSize size, VkDeviceSize offset) const
+{
+    buffers[resourceIndex]->TransferFromGPUToCPU (size, offset);
+}
+
+
+std::unique_ptr<RG::AsyncReadback> GPUBufferResource::TransferFromGPUToCPUAsync (uint32_t resourceIndex) const
+{
+    return buffers[resourceIndex]->TransferFromGPUToCPUAsync ();
+}
+
+
+std::unique_ptr<RG::AsyncReadback> GPUBufferResource::TransferFromGPUToCPUAsync (uint32_t resourceIndex, VkDeviceSize size, VkDeviceSize offset) const
+{
+    return buffers[resourceIndex]->TransferFromGPUToCPUAsync (size, offset);
+}
+
+
 ReadOnlyImageResource::ReadOnlyImageResource (VkFormat format, VkFilter filter, uint32_t width, uint32_t height, uint32_t depth, uint32_t layerCount)
     : format (format)
     , filter (filter)
@@ -233,6 +244,10 @@ ReadOnlyImageResource::ReadOnlyImageResource (VkFormat format, VkFilter filter,
     , height (height)
     , depth (depth)
     , layerCount (layerCount)
+    , usage (RG::TransferableUsage::Static)
+    , bindlessEnabled (false)
+    , bindlessTable (nullptr)
+    , mipLevelsEnabled (false)
 {
     RG_ASSERT (width > 0);
     RG_ASSERT (height > 0);
@@ -247,31 +262,132 @@ ReadOnlyImageResource::ReadOnlyImageResource (VkFormat format, uint32_t width, u
 }
 
 
-ReadOnlyImageResource::~ReadOnlyImageResource () = default;
+ReadOnlyImageResource::~ReadOnlyImageResource ()
+{
+    if (bindlessIndex.has_value ()) {
+        bindlessTable->Unregister (*bindlessIndex);
+    }
+}
 
 
 void ReadOnlyImageResource::CompileOnce (const GraphSettings& settings)
 {
+    if (bindlessEnabled && RG_ERROR (!settings.GetDevice ().HasBindlessTextures ())) {
+        throw std::runtime_error ("bindless textures are not supported by the device");
+    }
+
+    // block compressed formats depend on an optional device feature
+    if (RG::IsBlockCompressedFormat (format) && RG_ERROR ((settings.GetDevice ().GetOptimalTilingFeatures (format) & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) == 0)) {
+        throw std::runtime_error ("the block compressed format is not supported by the device");
+    }
+
     sampler = std::make_unique<RG::Sampler> (settings.GetDevice (), filter);
 
+    uint32_t          mipLevels  = 1;
+    VkImageUsageFlags usageFlags = VK_IMAGE_USAGE_SAMPLED_BIT;
+
+    if (mipLevelsEnabled) {
+        // the chain is generated with blits, every level is read back as a blit source once
+        const VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+        if ((settings.GetDevice ().GetOptimalTilingFeatures (format) & blitFeatures) == blitFeatures) {
+            mipLevels = RG::Image::GetFullMipLevelCount (width, height, depth);
+            usageFlags |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        } else {
+            spdlog::warn ("ReadOnlyImageResource: format {} can not be blitted, mip levels are not generated.", static_cast<int> (format));
+        }
+    }
+
     if (height == 1 && depth == 1) {
-        image     = std::make_unique<RG::Image1DTransferable> (settings.GetDevice (), format, width, VK_IMAGE_USAGE_SAMPLED_BIT);
+        image     = std::make_unique<RG::Image1DTransferable> (settings.GetDevice (), format, width, usageFlags, usage, mipLevels);
         imageView = std::make_unique<RG::ImageView1D> (settings.GetDevice (), *image->imageGPU);
     } else if (depth == 1) {
         if (layerCount == 1) {
-            image     = std::make_unique<RG::Image2DTransferable> (settings.GetDevice (), format, width, height, VK_IMAGE_USAGE_SAMPLED_BIT);
+            image     = std::make_unique<RG::Image2DTransferable> (settings.GetDevice (), format, width, height, usageFlags, 1, usage, mipLevels);
             imageView = std::make_unique<RG::ImageView2D> (settings.GetDevice (), *image->imageGPU, 0);
         } else {
-            image     = std::make_unique<RG::Image2DTransferable> (settings.GetDevice (), format, width, height, VK_IMAGE_USAGE_SAMPLED_BIT, layerCount);
+            image     = std::make_unique<RG::Image2DTransferable> (settings.GetDevice (), format, width, height, usageFlags, layerCount, usage, mipLevels);
             imageView = std::make_unique<RG::ImageView2DArray> (settings.GetDevice (), *image->imageGPU, 0, 1);
         }
     } else {
-        image     = std::make_unique<RG::Image3DTransferable> (settings.GetDevice (), format, width, height, depth, VK_IMAGE_USAGE_SAMPLED_BIT);
+        image     = std::make_unique<RG::Image3DTransferable> (settings.GetDevice (), format, width, height, depth, usageFlags, usage, mipLevels);
         imageView = std::make_unique<RG::ImageView3D> (settings.GetDevice (), *image->imageGPU);
     }
 
     RG::SingleTimeCommand s (settings.GetDevice ());
     s.Record<RG::CommandTranstionImage> (*image->imageGPU, RG::Image::INITIAL_LAYOUT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    if (bindlessEnabled) {
+        bindlessTable = &settings.GetDevice ().GetBindlessTextureTable ();
+        bindlessIndex = bindlessTable->Register (*imageView, *sampler);
+    }
+}
+
+
+void ReadOnlyImageResource::SetUsage (RG::TransferableUsage value)
+{
+    if (RG_ERROR (image != nullptr)) {
+        throw std::runtime_error ("the usage has to be set before compiling");
+    }
+
+    usage = value;
+}
+
+
+bool ReadOnlyImageResource::CopyLayer (RG::UploadBatch& batch, const RG::ImageFile& file, uint32_t layerIndex)
+{
+    return file.UploadTo (batch, *image->imageGPU, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, layerIndex, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+
+void ReadOnlyImageResource::CopyLayer (RG::UploadBatch& batch, const RG::CompressedImageData& compressed, uint32_t layerIndex)
+{
+    compressed.UploadTo (batch, *image->imageGPU, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, layerIndex, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+
+void ReadOnlyImageResource::EnableBindless ()
+{
+    RG_ASSERT (image == nullptr);
+
+    bindlessEnabled = true;
+}
+
+
+void ReadOnlyImageResource::EnableMipLevels ()
+{
+    RG_ASSERT (image == nullptr);
+
+    mipLevelsEnabled = true;
+}
+
+
+uint32_t ReadOnlyImageResource::GetMipLevels () const
+{
+    if (image == nullptr) {
+        return 1;
+    }
+
+    return image->imageGPU->GetMipLevels ();
+}
+
+
+uint32_t ReadOnlyImageResource::GetBindlessIndex () const
+{
+    if (RG_ERROR (!bindlessIndex.has_value ())) {
+        throw std::runtime_error ("image is not registered as a bindless texture");
+    }
+
+    return *bindlessIndex;
+}
+
+
+std::vector<VmaAllocation> ReadOnlyImageResource::GetAllocations () const
+{
+    if (image == nullptr) {
+        return {};
+    }
+
+    return image->GetAllocations ();
 }
 
 
@@ -329,7 +445,8 @@ void SwapchainImageResource::Compile (const GraphSettings& graphSettings)
             swapchainProv.GetSwapchain ().GetHeight (),
             1,
             swapchainProv.GetSwapchain ().GetImageFormat (),
-            1));
+            1,
+            RG::RealSwapchain::ImageUsage));
     }
 }
 
@@ -370,9 +487,13 @@ VkImageView SwapchainImageResource::GetImageViewForFrame (uint32_t resourceIndex
 VkSampler   SwapchainImageResource::GetSampler () { return VK_NULL_HANDLE; }
 
 
-CPUBufferResource::CPUBufferResource (uint32_t size)
+CPUBufferResource::CPUBufferResource (uint32_t size, RG::MemoryLocation location)
     : size (size)
+    , location (location)
 {
+    if (RG_ERROR (!RG::IsHostVisible (location))) {
+        throw std::runtime_error ("CPUBufferResource needs host visible memory");
+    }
 }
 
 
@@ -385,12 +506,24 @@ void CPUBufferResource::Compile (const GraphSettings& graphSettings)
     buffers.clear ();
 
     for (uint32_t i = 0; i < graphSettings.framesInFlight; ++i) {
-        buffers.push_back (std::make_unique<RG::UniformBuffer> (graphSettings.GetDevice ().GetAllocator (), size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, RG::Buffer::MemoryLocation::CPU));
+        buffers.push_back (std::make_unique<RG::UniformBuffer> (graphSettings.GetDevice ().GetAllocator (), size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, location));
         mappings.push_back (std::make_unique<RG::MemoryMapping> (graphSettings.GetDevice ().GetAllocator (), *buffers[buffers.size () - 1]));
     }
 }
 
 
+std::vector<VmaAllocation> CPUBufferResource::GetAllocations () const
+{
+    std::vector<VmaAllocation> result;
+
+    for (auto& buffer : buffers) {
+        result.push_back (*buffer);
+    }
+
+    return result;
+}
+
+
 VkBuffer CPUBufferResource::GetBufferForFrame (uint32_t resourceIndex) { return *buffers[resourceIndex]; }
 
 
@@ -170,12 +170,27 @@ void ShaderPipeline::SetShadersFromSourceFiles (const std::vector<std::filesyste
 }
 
 
+static const std::string InstancedInputPrefix = "instance";
+
+
+void ShaderPipeline::SetInstancedInputs (const std::set<std::string>& names)
+{
+    instancedInputs = names;
+}
+
+
+bool ShaderPipeline::IsInputInstanced (const std::string& name) const
+{
+    return instancedInputs.count (name) > 0 || name.rfind (InstancedInputPrefix, 0) == 0;
+}
+
+
 void ShaderPipeline::Compile (CompileSettings&& settings_)
 {
     compileSettings = std::move (settings_);
     compileResult.Clear ();
 
-    const auto instancedVertexProvider = [] (const std::string&) { return false; };
+    const auto instancedVertexProvider = [&] (const std::string& name) { return IsInputInstanced (name); };
 
     VkSubpassDescription subpass = {};
     subpass.pipelineBindPoint    = VK_PIPELINE_BIND_POINT_GRAPHICS;
@@ -210,7 +225,12 @@ void ShaderPipeline::Compile (CompileSettings&& settings_)
     dependency.dstSubpass           = VK_SUBPASS_EXTERNAL;
 
     compileResult.renderPass     = std::unique_ptr<RG::RenderPass> (new RG::RenderPass (device, compileSettings.attachmentDescriptions, { subpass }, { dependency, dependency2 }));
-    compileResult.pipelineLayout = std::unique_ptr<RG::PipelineLayout> (new RG::PipelineLayout (device, { compileSettings.layout }));
+    std::vector<VkDescriptorSetLayout> setLayouts { compileSettings.layout };
+    if (compileSettings.bindlessLayout.Get () != VK_NULL_HANDLE) {
+        setLayouts.push_back (compileSettings.bindlessLayout);
+    }
+
+    compileResult.pipelineLayout = std::unique_ptr<RG::PipelineLayout> (new RG::PipelineLayout (device, setLayouts));
 
     const std::vector<VkVertexInputAttributeDescription> attribs  = RG::FromShaderReflection::GetVertexAttributes (vertexShader->GetReflection (), instancedVertexProvider);
     const std::vector<VkVertexInputBindingDescription>   bindings = RG::FromShaderReflection::GetVertexBindings (vertexShader->GetReflection (), instancedVertexProvider);
@@ -265,7 +285,7 @@ void ShaderPipeline::IterateShaders (const std::function<void (RG::ShaderModule&
 }
 
 
-std::unique_ptr<RG::DescriptorSetLayout> ShaderPipeline::CreateDescriptorSetLayout (VkDevice device_) const
+std::vector<VkDescriptorSetLayoutBinding> ShaderPipeline::GetDescriptorSetLayoutBindings () const
 {
     std::vector<VkDescriptorSetLayoutBinding> layout;
 
@@ -281,7 +301,7 @@ std::unique_ptr<RG::DescriptorSetLayout> ShaderPipeline::CreateDescriptorSetLayo
         layout.insert (layout.end (), layoutPart.begin (), layoutPart.end ());
     });
 
-    return std::make_unique<RG::DescriptorSetLayout> (device_, layout);
+    return layout;
 }
 
 } // namespace RG
@@ -1,10 +1,13 @@
 #include "ShaderReflectionToDescriptor.hpp"
 
 #include "VulkanWrapper/ShaderReflection.hpp"
+#include "VulkanWrapper/Utils/BindlessTextureTable.hpp"
 
 #include "Utils/Assert.hpp"
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
+
 
 namespace RG {
 namespace FromShaderReflection {
@@ -63,6 +66,10 @@ static void UpdateDescriptorSetsFromSamplers (const RG::ShaderModuleReflection&
     result.reserve (1024);
 
     for (const RG::Refl::Sampler& sampler : reflection.samplers) {
+        if (sampler.descriptorSet == BindlessDescriptorSet) {
+            continue;
+        }
+
         const uint32_t layerCount = sampler.arraySize;
         for (uint32_t layerIndex = 0; layerIndex < layerCount; ++layerIndex) {
             const std::vector<VkDescriptorImageInfo> tempImgInfos = infoProvider.GetDescriptorImageInfos (sampler.name, shaderKind, layerIndex, frameIndex);
@@ -282,6 +289,10 @@ std::vector<VkDescriptorSetLayoutBinding> GetLayout (const RG::ShaderModuleRefle
     std::vector<VkDescriptorSetLayoutBinding> result;
 
     for (const RG::Refl::Sampler& sampler : reflection.samplers) {
+        if (sampler.descriptorSet == BindlessDescriptorSet) {
+            continue;
+        }
+
         VkDescriptorSetLayoutBinding bin = {};
         bin.binding                      = sampler.binding;
         bin.descriptorType               = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -324,5 +335,12 @@ std::vector<VkDescriptorSetLayoutBinding> GetLayout (const RG::ShaderModuleRefle
     return result;
 }
 
+bool UsesBindlessTextures (const RG::ShaderModuleReflection& reflection)
+{
+    return std::any_of (reflection.samplers.begin (), reflection.samplers.end (), [] (const RG::Refl::Sampler& sampler) {
+        return sampler.descriptorSet == BindlessDescriptorSet;
+    });
+}
+
 } // namespace FromShaderReflection
 } // namespace RG
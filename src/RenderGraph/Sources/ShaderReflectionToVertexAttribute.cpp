@@ -2,6 +2,8 @@
 
 #include "Utils/Assert.hpp"
 
+#include "VulkanWrapper/Utils/BufferTransferable.hpp"
+
 
 namespace RG {
 namespace FromShaderReflection {
@@ -15,15 +17,16 @@ std::vector<VkVertexInputAttributeDescription> GetVertexAttributes (const RG::Sh
 
     for (const RG::Refl::Input& input : reflection.inputs) {
         VkVertexInputAttributeDescription attrib = {};
-        attrib.binding                           = 0;
         attrib.location                          = input.location;
         attrib.format                            = FieldTypeToVkFormat (input.type);
 
         if (IsInputInstanced (input.name)) {
-            attrib.offset = currentOffsetInstance;
+            attrib.binding = VertexInputInfo::InstanceBinding;
+            attrib.offset  = currentOffsetInstance;
             currentOffsetInstance += input.sizeInBytes;
         } else {
-            attrib.offset = currentOffsetVertex;
+            attrib.binding = VertexInputInfo::VertexBinding;
+            attrib.offset  = currentOffsetVertex;
             currentOffsetVertex += input.sizeInBytes;
         }
 
@@ -53,10 +56,10 @@ std::vector<VkVertexInputBindingDescription> GetVertexBindings (const RG::Shader
         }
     }
 
-    {
+    if (fullSizeVertex > 0) {
         VkVertexInputBindingDescription bindingDescription = {};
         bindingDescription                                 = {};
-        bindingDescription.binding                         = 0;
+        bindingDescription.binding                         = VertexInputInfo::VertexBinding;
         bindingDescription.stride                          = fullSizeVertex;
         bindingDescription.inputRate                       = VK_VERTEX_INPUT_RATE_VERTEX;
         result.push_back (bindingDescription);
@@ -65,7 +68,7 @@ std::vector<VkVertexInputBindingDescription> GetVertexBindings (const RG::Shader
     if (fullSizeInstance > 0) {
         VkVertexInputBindingDescription bindingDescription = {};
         bindingDescription                                 = {};
-        bindingDescription.binding                         = 0;
+        bindingDescription.binding                         = VertexInputInfo::InstanceBinding;
         bindingDescription.stride                          = fullSizeInstance;
         bindingDescription.inputRate                       = VK_VERTEX_INPUT_RATE_INSTANCE;
         result.push_back (bindingDescription);
@@ -13,6 +13,7 @@
 #include "VulkanWrapper/PipelineLayout.hpp"
 #include "VulkanWrapper/DescriptorSet.hpp"
 #include "VulkanWrapper/DescriptorSetLayout.hpp"
+#include "VulkanWrapper/Utils/BindlessTextureTable.hpp"
 
 #include "Utils/Event.hpp"
 #include "Utils/Utils.hpp"
@@ -179,6 +180,11 @@ ImageMap CreateEmptyImageResources (RG::ConnectionSet& connectionSet, const Exte
     RG::ForEach<RG::RenderOperation> (nodes, [&] (const std::shared_ptr<RG::RenderOperation>& renderOp) {
         renderOp->GetShaderPipeline ()->IterateShaders ([&] (const RG::ShaderModule& shaderModule) {
             for (const RG::Refl::Sampler& sampler : shaderModule.GetReflection ().samplers) {
+                // bindless textures are registered by the application, not bound by name
+                if (sampler.descriptorSet == RG::BindlessDescriptorSet) {
+                    continue;
+                }
+
                 std::shared_ptr<ReadOnlyImageResource> imgRes;
 
                 const std::optional<CreateParams> providedExtent = extentProvider (sampler);
@@ -0,0 +1,105 @@
+#include "MappedFile.hpp"
+
+#include "spdlog/spdlog.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace RG {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile (const std::filesystem::path& filePath)
+    : data (nullptr)
+    , size (0)
+    , fileHandle (INVALID_HANDLE_VALUE)
+    , mappingHandle (nullptr)
+{
+    fileHandle = CreateFileW (filePath.wstring ().c_str (), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        spdlog::error ("Failed to open {}.", filePath.string ());
+        return;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx (fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+        return;
+    }
+
+    mappingHandle = CreateFileMappingW (fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr) {
+        spdlog::error ("Failed to map {}.", filePath.string ());
+        return;
+    }
+
+    data = reinterpret_cast<const uint8_t*> (MapViewOfFile (mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    size = data != nullptr ? static_cast<size_t> (fileSize.QuadPart) : 0;
+}
+
+
+MappedFile::~MappedFile ()
+{
+    if (data != nullptr) {
+        UnmapViewOfFile (data);
+    }
+
+    if (mappingHandle != nullptr) {
+        CloseHandle (mappingHandle);
+    }
+
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle (fileHandle);
+    }
+}
+
+#else
+
+MappedFile::MappedFile (const std::filesystem::path& filePath)
+    : data (nullptr)
+    , size (0)
+{
+    const int fileDescriptor = open (filePath.c_str (), O_RDONLY);
+    if (fileDescriptor < 0) {
+        spdlog::error ("Failed to open {}.", filePath.string ());
+        return;
+    }
+
+    struct stat fileStat;
+    if (fstat (fileDescriptor, &fileStat) == 0 && fileStat.st_size > 0) {
+        void* mapped = mmap (nullptr, static_cast<size_t> (fileStat.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if (mapped != MAP_FAILED) {
+            // decoders read the file front to back
+            madvise (mapped, static_cast<size_t> (fileStat.st_size), MADV_SEQUENTIAL);
+
+            data = reinterpret_cast<const uint8_t*> (mapped);
+            size = static_cast<size_t> (fileStat.st_size);
+        } else {
+            spdlog::error ("Failed to map {}.", filePath.string ());
+        }
+    }
+
+    // the mapping stays valid after the descriptor is closed
+    close (fileDescriptor);
+}
+
+
+MappedFile::~MappedFile ()
+{
+    if (data != nullptr) {
+        munmap (const_cast<uint8_t*> (data), size);
+    }
+}
+
+#endif
+
+} // namespace RG
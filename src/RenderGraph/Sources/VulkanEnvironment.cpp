@@ -235,6 +235,9 @@ void defaultDebugCallback (VkDebugUtilsMessageSeverityFlagBitsEXT      messageSe
 void VulkanEnvironment::Wait () const
 {
     graphicsQueue->Wait ();
+    if (transferQueue != nullptr) {
+        transferQueue->Wait ();
+    }
     device->Wait ();
 }
 
@@ -293,15 +296,44 @@ VulkanEnvironment::VulkanEnvironment (std::optional<RG::DebugUtilsMessenger::Cal
         vkGetPhysicalDeviceFormatProperties (*physicalDevice, VK_FORMAT_R32G32B32_SFLOAT, &props);
     }
 
-    device = std::make_unique<RG::DeviceObject> (*physicalDevice, std::vector<uint32_t> { *physicalDevice->GetQueueFamilies ().graphics }, deviceExtensions);
+    const uint32_t                graphicsFamily = *physicalDevice->GetQueueFamilies ().graphics;
+    const std::optional<uint32_t> transferFamily = physicalDevice->GetQueueFamilies ().dedicatedTransfer;
+
+    std::vector<uint32_t> queueFamilies { graphicsFamily };
+    if (transferFamily.has_value () && *transferFamily != graphicsFamily) {
+        queueFamilies.push_back (*transferFamily);
+    }
+
+    device = std::make_unique<RG::DeviceObject> (*physicalDevice, queueFamilies, deviceExtensions);
 
-    allocator = std::make_unique<RG::Allocator> (*instance, *physicalDevice, *device);
+    allocator = std::make_unique<RG::Allocator> (*instance, *physicalDevice, *device, static_cast<RG::DeviceObject*> (device.get ())->SupportsMemoryBudget ());
 
-    graphicsQueue = std::make_unique<RG::Queue> (*device, *physicalDevice->GetQueueFamilies ().graphics);
+    graphicsQueue = std::make_unique<RG::Queue> (*device, graphicsFamily);
 
-    commandPool = std::make_unique<RG::CommandPool> (*device, *physicalDevice->GetQueueFamilies ().graphics);
+    commandPool = std::make_unique<RG::CommandPool> (*device, graphicsFamily);
 
     deviceExtra = std::make_unique<RG::DeviceExtra> (*instance, *device, *commandPool, *allocator, *graphicsQueue);
+    deviceExtra->SetGraphicsQueueFamilyIndex (graphicsFamily);
+    deviceExtra->SetPhysicalDevice (*physicalDevice);
+    deviceExtra->SetIndirectDrawFeatures (static_cast<RG::DeviceObject*> (device.get ())->SupportsMultiDrawIndirect (),
+                                          static_cast<RG::DeviceObject*> (device.get ())->SupportsDrawIndirectCount ());
+
+    if (queueFamilies.size () > 1) {
+        transferQueue       = std::make_unique<RG::Queue> (*device, *transferFamily);
+        transferCommandPool = std::make_unique<RG::CommandPool> (*device, *transferFamily);
+        transferCommandPool->SetName (*deviceExtra, "VulkanEnvironment Transfer CommandPool");
+
+        deviceExtra->SetDedicatedTransferQueue (*transferQueue, *transferCommandPool, *transferFamily, graphicsFamily);
+
+        spdlog::info ("using dedicated transfer queue family {}", *transferFamily);
+    }
+
+    const uint32_t bindlessTextureCapacity = static_cast<RG::DeviceObject*> (device.get ())->GetBindlessTextureCapacity ();
+    if (bindlessTextureCapacity > 0) {
+        deviceExtra->EnableBindlessTextures (bindlessTextureCapacity);
+
+        spdlog::info ("bindless textures enabled with {} slots", bindlessTextureCapacity);
+    }
 
     commandPool->SetName (*deviceExtra, "VulkanEnvironment CommandPool");
     static_cast<RG::DeviceObject*> (device.get ())->SetName (*deviceExtra, "VulkanEnvironment DeviceObject");
@@ -10,13 +10,24 @@
 
 namespace RG {
 
-Allocator::Allocator (VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device)
+// defined in MemoryUsage.cpp, tracks the device memory of the allocator for GetAllocationUsage
+extern const VmaDeviceMemoryCallbacks DeviceMemoryCallbacks;
+
+
+Allocator::Allocator (VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device, bool memoryBudgetEnabled)
     : handle { VK_NULL_HANDLE }
 {
     VmaAllocatorCreateInfo allocatorInfo = {};
     allocatorInfo.physicalDevice         = physicalDevice;
     allocatorInfo.device                 = device;
     allocatorInfo.instance               = instance;
+    allocatorInfo.pDeviceMemoryCallbacks = &DeviceMemoryCallbacks;
+
+    // without the extension the budget is estimated from the heap sizes and the allocations made through vma
+    if (memoryBudgetEnabled) {
+        allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+        allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_1;
+    }
 
     if (RG_ERROR (vmaCreateAllocator (&allocatorInfo, &handle) != VK_SUCCESS)) {
         spdlog::critical ("VmaAllocator creation failed.");
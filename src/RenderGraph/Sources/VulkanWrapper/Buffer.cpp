@@ -11,19 +11,27 @@ Buffer::Buffer (VmaAllocator allocator, size_t bufferSize, VkBufferUsageFlags us
     , handle (VK_NULL_HANDLE)
     , allocationHandle (VK_NULL_HANDLE)
     , size (bufferSize)
+    , memoryLocation (loc)
 {
     VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
     bufferInfo.size               = bufferSize;
     bufferInfo.usage              = usageFlags;
 
-    VmaAllocationCreateInfo allocInfo = {};
-    allocInfo.usage                   = (loc == MemoryLocation::GPU) ? VMA_MEMORY_USAGE_GPU_ONLY : VMA_MEMORY_USAGE_CPU_COPY;
+    VmaAllocationCreateInfo allocInfo = GetAllocationCreateInfo (memoryLocation);
 
-    if (loc == MemoryLocation::CPU) {
-        allocInfo.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+    VkResult result = vmaCreateBuffer (allocator, &bufferInfo, &allocInfo, &handle, &allocationHandle, nullptr);
+
+    while (result != VK_SUCCESS && GetFallbackMemoryLocation (memoryLocation).has_value ()) {
+        const MemoryLocation fallbackLocation = *GetFallbackMemoryLocation (memoryLocation);
+
+        spdlog::debug ("VkBuffer allocation from {} memory failed, falling back to {}.", MemoryLocationToString (memoryLocation), MemoryLocationToString (fallbackLocation));
+
+        memoryLocation = fallbackLocation;
+        allocInfo      = GetAllocationCreateInfo (memoryLocation);
+        result         = vmaCreateBuffer (allocator, &bufferInfo, &allocInfo, &handle, &allocationHandle, nullptr);
     }
 
-    if (RG_ERROR (vmaCreateBuffer (allocator, &bufferInfo, &allocInfo, &handle, &allocationHandle, nullptr) != VK_SUCCESS)) {
+    if (RG_ERROR (result != VK_SUCCESS)) {
         spdlog::critical ("VkBuffer creation failed.");
         throw std::runtime_error ("failed to create vma buffer");
     }
@@ -0,0 +1,115 @@
+#include "CommandArena.hpp"
+
+#include "Utils/Assert.hpp"
+
+
+namespace RG {
+
+static size_t AlignUp (size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+
+CommandArena::CommandArena (size_t blockSize)
+    : blockSize (blockSize)
+    , currentBlock (0)
+    , allocationCount (0)
+{
+    RG_ASSERT (blockSize > 0);
+}
+
+
+CommandArena::~CommandArena () = default;
+
+
+void* CommandArena::Allocate (size_t size, size_t alignment)
+{
+    RG_ASSERT (alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    ++allocationCount;
+
+    // blocks are allocated with new[], which is aligned for every fundamental type
+    for (; currentBlock < blocks.size (); ++currentBlock) {
+        Block&       block  = blocks[currentBlock];
+        const size_t offset = AlignUp (block.used, alignment);
+        if (offset + size <= block.size) {
+            block.used = offset + size;
+            return block.memory.get () + offset;
+        }
+    }
+
+    Block newBlock;
+    newBlock.size   = std::max (blockSize, size);
+    newBlock.memory = std::make_unique<std::byte[]> (newBlock.size);
+    newBlock.used   = size;
+
+    blocks.push_back (std::move (newBlock));
+    currentBlock = blocks.size () - 1;
+
+    return blocks.back ().memory.get ();
+}
+
+
+CommandArena::Marker CommandArena::GetMarker () const
+{
+    if (blocks.empty ()) {
+        return { 0, 0 };
+    }
+
+    return { currentBlock, blocks[currentBlock].used };
+}
+
+
+void CommandArena::Rewind (const Marker& marker)
+{
+    if (blocks.empty ()) {
+        return;
+    }
+
+    RG_ASSERT (marker.blockIndex <= currentBlock);
+
+    for (size_t blockIndex = marker.blockIndex + 1; blockIndex <= currentBlock; ++blockIndex) {
+        blocks[blockIndex].used = 0;
+    }
+
+    blocks[marker.blockIndex].used = marker.used;
+    currentBlock                   = marker.blockIndex;
+}
+
+
+void CommandArena::Reset (bool releaseMemory)
+{
+    if (releaseMemory && blocks.size () > 1) {
+        blocks.resize (1);
+    }
+
+    for (Block& block : blocks) {
+        block.used = 0;
+    }
+
+    currentBlock    = 0;
+    allocationCount = 0;
+}
+
+
+size_t CommandArena::GetUsedBytes () const
+{
+    size_t result = 0;
+    for (const Block& block : blocks) {
+        result += block.used;
+    }
+    return result;
+}
+
+
+size_t CommandArena::GetReservedBytes () const
+{
+    size_t result = 0;
+    for (const Block& block : blocks) {
+        result += block.size;
+    }
+    return result;
+}
+
+} // namespace RG
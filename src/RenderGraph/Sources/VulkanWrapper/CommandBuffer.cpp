@@ -1,6 +1,8 @@
 #include "CommandBuffer.hpp"
 #include "Image.hpp"
 #include "Utils/Assert.hpp"
+#include "Utils/BuildType.hpp"
+#include "Utils/CommandLineFlag.hpp"
 
 #include <iostream>
 
@@ -8,12 +10,22 @@
 
 namespace RG {
 
+static CommandLineOnOffFlag discardRecordedCommandsFlag ("--discardRecordedCommands", "Recorded commands are not kept after recording (release builds only).");
+
+
     
 CommandBuffer::CommandBuffer (VkDevice device, VkCommandPool commandPool)
     : device (device)
     , commandPool (commandPool)
     , handle (VK_NULL_HANDLE)
     , canRecordCommands (false)
+    , retainRecordedCommands (IsDebugBuild || !discardRecordedCommandsFlag.IsFlagOn ())
+    , elideRedundantCommands (true)
+    , elidedCommandCount (0)
+    , statistics ()
+    , arena (std::make_unique<CommandArena> ())
+    , lastUnretainedCommand (nullptr)
+    , lastUnretainedMarker ({ 0, 0 })
 {
     VkCommandBufferAllocateInfo commandBufferAllocInfo = {};
     commandBufferAllocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -36,8 +48,66 @@ CommandBuffer::CommandBuffer (const DeviceExtra& device)
 }
 
 
+CommandBuffer::CommandBuffer (CommandBuffer&& other)
+    : VulkanObject (std::move (other))
+    , device (std::move (other.device))
+    , commandPool (std::move (other.commandPool))
+    , handle (std::move (other.handle))
+    , canRecordCommands (other.canRecordCommands)
+    , retainRecordedCommands (other.retainRecordedCommands)
+    , elideRedundantCommands (other.elideRedundantCommands)
+    , boundState (std::move (other.boundState))
+    , elidedCommandCount (other.elidedCommandCount)
+    , statistics (other.statistics)
+    , arena (std::move (other.arena))
+    , lastUnretainedCommand (other.lastUnretainedCommand)
+    , lastUnretainedMarker (other.lastUnretainedMarker)
+    , recordedAbstractCommands (std::move (other.recordedAbstractCommands))
+{
+    other.lastUnretainedCommand = nullptr;
+    other.recordedAbstractCommands.clear ();
+}
+
+
+CommandBuffer& CommandBuffer::operator= (CommandBuffer&& other)
+{
+    if (this == &other) {
+        return *this;
+    }
+
+    if (arena != nullptr) {
+        DestroyRecordedCommands (true);
+    }
+
+    VulkanObject::operator= (std::move (other));
+
+    device                   = std::move (other.device);
+    commandPool              = std::move (other.commandPool);
+    handle                   = std::move (other.handle);
+    canRecordCommands        = other.canRecordCommands;
+    retainRecordedCommands   = other.retainRecordedCommands;
+    elideRedundantCommands   = other.elideRedundantCommands;
+    boundState               = std::move (other.boundState);
+    elidedCommandCount       = other.elidedCommandCount;
+    statistics               = other.statistics;
+    arena                    = std::move (other.arena);
+    lastUnretainedCommand    = other.lastUnretainedCommand;
+    lastUnretainedMarker     = other.lastUnretainedMarker;
+    recordedAbstractCommands = std::move (other.recordedAbstractCommands);
+
+    other.lastUnretainedCommand = nullptr;
+    other.recordedAbstractCommands.clear ();
+
+    return *this;
+}
+
+
 CommandBuffer::~CommandBuffer ()
 {
+    if (arena != nullptr) {
+        DestroyRecordedCommands (true);
+    }
+
     if (handle != VK_NULL_HANDLE) {
         vkFreeCommandBuffers (device, commandPool, 1, &handle);
         handle = VK_NULL_HANDLE;
@@ -52,6 +122,13 @@ void CommandBuffer::Begin (VkCommandBufferUsageFlags flags)
     beginInfo.flags                    = flags;
     beginInfo.pInheritanceInfo         = nullptr;
 
+    // beginning implicitly resets the command buffer, the previous recording is no longer valid
+    DestroyRecordedCommands (false);
+
+    boundState.Clear ();
+    elidedCommandCount = 0;
+    statistics         = CommandStatistics {};
+
     if (RG_ERROR (vkBeginCommandBuffer (handle, &beginInfo) != VK_SUCCESS)) {
         throw std::runtime_error ("commandbuffer begin failed");
     }
@@ -76,15 +153,80 @@ void CommandBuffer::Reset (bool releaseResources)
         throw std::runtime_error ("commandbuffer reset failed");
     }
 
+    DestroyRecordedCommands (releaseResources);
+
+    boundState.Clear ();
+
     canRecordCommands = false;
 }
 
 
-Command& CommandBuffer::RecordCommand (std::unique_ptr<Command>&& command)
+void CommandBuffer::SetRetainRecordedCommands (bool value)
 {
-    command->Record (*this);
-    recordedAbstractCommands.push_back (std::move (command));
-    return *recordedAbstractCommands.back ();
+    ReleaseUnretainedCommand ();
+
+    retainRecordedCommands = value;
+}
+
+
+Command& CommandBuffer::RecordCommand (Command& command, const CommandArena::Marker& marker)
+{
+    if (elideRedundantCommands && command.IsRedundant (boundState)) {
+        ++elidedCommandCount;
+        return KeepUntilNextRecord (command, marker);
+    }
+
+    command.Record (*this);
+    command.UpdateBoundState (boundState);
+    command.UpdateStatistics (statistics);
+
+    if (retainRecordedCommands) {
+        recordedAbstractCommands.push_back (&command);
+        return command;
+    }
+
+    // commands recorded from within this one are already finished
+    ReleaseUnretainedCommand ();
+
+    return KeepUntilNextRecord (command, marker);
+}
+
+
+Command& CommandBuffer::KeepUntilNextRecord (Command& command, const CommandArena::Marker& marker)
+{
+    RG_ASSERT (lastUnretainedCommand == nullptr);
+
+    lastUnretainedCommand = &command;
+    lastUnretainedMarker  = marker;
+
+    return command;
+}
+
+
+void CommandBuffer::ReleaseUnretainedCommand ()
+{
+    if (lastUnretainedCommand == nullptr) {
+        return;
+    }
+
+    lastUnretainedCommand->~Command ();
+    lastUnretainedCommand = nullptr;
+
+    arena->Rewind (lastUnretainedMarker);
+}
+
+
+void CommandBuffer::DestroyRecordedCommands (bool releaseMemory)
+{
+    ReleaseUnretainedCommand ();
+
+    // the arena only holds memory, destructors have to be called explicitly
+    for (Command* command : recordedAbstractCommands) {
+        command->~Command ();
+    }
+    recordedAbstractCommands.clear ();
+
+    arena->Reset (releaseMemory);
 }
 
-}
\ No newline at end of file
+} // namespace RG
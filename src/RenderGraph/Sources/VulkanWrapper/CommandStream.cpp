@@ -0,0 +1,432 @@
+#include "CommandStream.hpp"
+
+#include "CommandBuffer.hpp"
+#include "Commands.hpp"
+
+#include "Utils/Assert.hpp"
+
+namespace RG {
+
+void CommandStreamWriter::WriteImageBarrier (const VkImageMemoryBarrier& barrier)
+{
+    Write (barrier.srcAccessMask);
+    Write (barrier.dstAccessMask);
+    Write (barrier.oldLayout);
+    Write (barrier.newLayout);
+    Write (barrier.srcQueueFamilyIndex);
+    Write (barrier.dstQueueFamilyIndex);
+    WriteHandle (barrier.image);
+    Write (barrier.subresourceRange);
+}
+
+
+void CommandStreamWriter::WriteBufferBarrier (const VkBufferMemoryBarrier& barrier)
+{
+    Write (barrier.srcAccessMask);
+    Write (barrier.dstAccessMask);
+    Write (barrier.srcQueueFamilyIndex);
+    Write (barrier.dstQueueFamilyIndex);
+    WriteHandle (barrier.buffer);
+    Write (barrier.offset);
+    Write (barrier.size);
+}
+
+
+const uint8_t* CommandStreamReader::Advance (size_t byteCount)
+{
+    if (RG_ERROR (byteCount > size - position)) {
+        throw std::runtime_error ("command stream ended unexpectedly");
+    }
+
+    const uint8_t* result = data + position;
+    position += byteCount;
+    return result;
+}
+
+
+VkImageMemoryBarrier CommandStreamReader::ReadImageBarrier ()
+{
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType                = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask        = Read<VkAccessFlags> ();
+    barrier.dstAccessMask        = Read<VkAccessFlags> ();
+    barrier.oldLayout            = Read<VkImageLayout> ();
+    barrier.newLayout            = Read<VkImageLayout> ();
+    barrier.srcQueueFamilyIndex  = Read<uint32_t> ();
+    barrier.dstQueueFamilyIndex  = Read<uint32_t> ();
+    barrier.image                = ReadHandle<VkImage> ();
+    barrier.subresourceRange     = Read<VkImageSubresourceRange> ();
+    return barrier;
+}
+
+
+VkBufferMemoryBarrier CommandStreamReader::ReadBufferBarrier ()
+{
+    VkBufferMemoryBarrier barrier = {};
+    barrier.sType                 = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask         = Read<VkAccessFlags> ();
+    barrier.dstAccessMask         = Read<VkAccessFlags> ();
+    barrier.srcQueueFamilyIndex   = Read<uint32_t> ();
+    barrier.dstQueueFamilyIndex   = Read<uint32_t> ();
+    barrier.buffer                = ReadHandle<VkBuffer> ();
+    barrier.offset                = Read<VkDeviceSize> ();
+    barrier.size                  = Read<VkDeviceSize> ();
+    return barrier;
+}
+
+
+uint64_t CommandStreamReader::ReadHandleId ()
+{
+    const uint64_t id = Read<uint64_t> ();
+
+    if (id == 0 || handleMap == nullptr) {
+        return id;
+    }
+
+    auto found = handleMap->find (id);
+    if (found == handleMap->end ()) {
+        unresolvedHandle = true;
+        return 0;
+    }
+
+    return found->second;
+}
+
+
+void CommandReplayState::Clear ()
+{
+    boundPipelines.clear ();
+    incompleteBindPoints.clear ();
+    transitionedImages.clear ();
+    renderPassActive = false;
+}
+
+
+static bool CanDraw (const CommandReplayState& state, VkPipelineBindPoint bindPoint)
+{
+    return state.boundPipelines.count (bindPoint) > 0 && state.incompleteBindPoints.count (bindPoint) == 0;
+}
+
+
+bool RecordSerializedCommand (CommandStreamReader& reader, CommandReplayState& state, CommandBuffer& commandBuffer)
+{
+    reader.ClearUnresolvedHandle ();
+
+    const CommandId id = reader.Read<CommandId> ();
+
+    switch (id) {
+        case CommandId::BindVertexBuffers: {
+            const uint32_t firstBinding = reader.Read<uint32_t> ();
+            const uint32_t count        = reader.Read<uint32_t> ();
+
+            std::vector<VkBuffer> buffers;
+            for (uint32_t i = 0; i < count; ++i) {
+                buffers.push_back (reader.ReadHandle<VkBuffer> ());
+            }
+            const std::vector<VkDeviceSize> offsets = reader.ReadArray<VkDeviceSize> ();
+
+            if (reader.HasUnresolvedHandle ()) {
+                return false;
+            }
+
+            commandBuffer.Record<CommandBindVertexBuffers> (firstBinding, count, buffers, offsets);
+            return true;
+        }
+
+        case CommandId::PipelineBarrier: {
+            const VkPipelineStageFlags srcStageMask = reader.Read<VkPipelineStageFlags> ();
+            const VkPipelineStageFlags dstStageMask = reader.Read<VkPipelineStageFlags> ();
+
+            std::vector<VkMemoryBarrier>       memoryBarriers;
+            std::vector<VkBufferMemoryBarrier> bufferBarriers;
+            std::vector<VkImageMemoryBarrier>  imageBarriers;
+
+            const uint32_t memoryBarrierCount = reader.Read<uint32_t> ();
+            for (uint32_t i = 0; i < memoryBarrierCount; ++i) {
+                VkMemoryBarrier barrier = {};
+                barrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                barrier.srcAccessMask   = reader.Read<VkAccessFlags> ();
+                barrier.dstAccessMask   = reader.Read<VkAccessFlags> ();
+                memoryBarriers.push_back (barrier);
+            }
+
+            // barriers of resources missing from the capture are dropped, the rest is still recorded
+            const uint32_t bufferBarrierCount = reader.Read<uint32_t> ();
+            for (uint32_t i = 0; i < bufferBarrierCount; ++i) {
+                const VkBufferMemoryBarrier barrier = reader.ReadBufferBarrier ();
+                if (barrier.buffer != VK_NULL_HANDLE) {
+                    bufferBarriers.push_back (barrier);
+                }
+            }
+
+            const uint32_t imageBarrierCount = reader.Read<uint32_t> ();
+            for (uint32_t i = 0; i < imageBarrierCount; ++i) {
+                VkImageMemoryBarrier barrier = reader.ReadImageBarrier ();
+                if (barrier.image == VK_NULL_HANDLE) {
+                    continue;
+                }
+
+                // replayed images start without content, the first transition discards
+                if (state.transitionedImages.insert (HandleToId (barrier.image)).second) {
+                    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                }
+
+                imageBarriers.push_back (barrier);
+            }
+
+            commandBuffer.Record<CommandPipelineBarrier> (srcStageMask, dstStageMask, memoryBarriers, bufferBarriers, imageBarriers);
+            return true;
+        }
+
+        case CommandId::DrawIndexed: {
+            const uint32_t indexCount    = reader.Read<uint32_t> ();
+            const uint32_t instanceCount = reader.Read<uint32_t> ();
+            const uint32_t firstIndex    = reader.Read<uint32_t> ();
+            const int32_t  vertexOffset  = reader.Read<int32_t> ();
+            const uint32_t firstInstance = reader.Read<uint32_t> ();
+
+            if (!state.renderPassActive || !CanDraw (state, VK_PIPELINE_BIND_POINT_GRAPHICS)) {
+                return false;
+            }
+
+            commandBuffer.Record<CommandDrawIndexed> (indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+            return true;
+        }
+
+        case CommandId::DrawIndexedIndirect: {
+            const VkBuffer     buffer    = reader.ReadHandle<VkBuffer> ();
+            const VkDeviceSize offset    = reader.Read<VkDeviceSize> ();
+            const uint32_t     drawCount = reader.Read<uint32_t> ();
+            const uint32_t     stride    = reader.Read<uint32_t> ();
+
+            if (reader.HasUnresolvedHandle () || !state.renderPassActive || !CanDraw (state, VK_PIPELINE_BIND_POINT_GRAPHICS)) {
+                return false;
+            }
+
+            commandBuffer.Record<CommandDrawIndexedIndirect> (buffer, offset, drawCount, stride);
+            return true;
+        }
+
+        case CommandId::DrawIndexedIndirectCount: {
+            const VkBuffer     buffer            = reader.ReadHandle<VkBuffer> ();
+            const VkDeviceSize offset            = reader.Read<VkDeviceSize> ();
+            const VkBuffer     countBuffer       = reader.ReadHandle<VkBuffer> ();
+            const VkDeviceSize countBufferOffset = reader.Read<VkDeviceSize> ();
+            const uint32_t     maxDrawCount      = reader.Read<uint32_t> ();
+            const uint32_t     stride            = reader.Read<uint32_t> ();
+
+            if (reader.HasUnresolvedHandle () || !state.renderPassActive || !CanDraw (state, VK_PIPELINE_BIND_POINT_GRAPHICS)) {
+                return false;
+            }
+
+            commandBuffer.Record<CommandDrawIndexedIndirectCount> (buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+            return true;
+        }
+
+        case CommandId::Draw: {
+            const uint32_t vertexCount   = reader.Read<uint32_t> ();
+            const uint32_t instanceCount = reader.Read<uint32_t> ();
+            const uint32_t firstVertex   = reader.Read<uint32_t> ();
+            const uint32_t firstInstance = reader.Read<uint32_t> ();
+
+            if (!state.renderPassActive || !CanDraw (state, VK_PIPELINE_BIND_POINT_GRAPHICS)) {
+                return false;
+            }
+
+            commandBuffer.Record<CommandDraw> (vertexCount, instanceCount, firstVertex, firstInstance);
+            return true;
+        }
+
+        case CommandId::BindIndexBuffer: {
+            const VkBuffer     buffer    = reader.ReadHandle<VkBuffer> ();
+            const VkDeviceSize offset    = reader.Read<VkDeviceSize> ();
+            const VkIndexType  indexType = reader.Read<VkIndexType> ();
+
+            if (reader.HasUnresolvedHandle ()) {
+                return false;
+            }
+
+            commandBuffer.Record<CommandBindIndexBuffer> (buffer, offset, indexType);
+            return true;
+        }
+
+        case CommandId::EndRenderPass: {
+            if (!state.renderPassActive) {
+                return false;
+            }
+
+            commandBuffer.Record<CommandEndRenderPass> ();
+            state.renderPassActive = false;
+            return true;
+        }
+
+        case CommandId::BeginRenderPass: {
+            const VkRenderPass              renderPass  = reader.ReadHandle<VkRenderPass> ();
+            const VkFramebuffer             framebuffer = reader.ReadHandle<VkFramebuffer> ();
+            const VkRect2D                  renderArea  = reader.Read<VkRect2D> ();
+            const VkSubpassContents         contents    = reader.Read<VkSubpassContents> ();
+            const std::vector<VkClearValue> clearValues = reader.ReadArray<VkClearValue> ();
+
+            if (reader.HasUnresolvedHandle ()) {
+                return false;
+            }
+
+            commandBuffer.Record<CommandBeginRenderPass> (renderPass, framebuffer, renderArea, clearValues, contents);
+            state.renderPassActive = true;
+            return true;
+        }
+
+        case CommandId::BindPipeline: {
+            const VkPipelineBindPoint bindPoint = reader.Read<VkPipelineBindPoint> ();
+            const VkPipeline          pipeline  = reader.ReadHandle<VkPipeline> ();
+
+            if (reader.HasUnresolvedHandle ()) {
+                state.boundPipelines.erase (bindPoint);
+                return false;
+            }
+
+            commandBuffer.Record<CommandBindPipeline> (bindPoint, pipeline);
+            state.boundPipelines.insert (bindPoint);
+            return true;
+        }
+
+        case CommandId::BindDescriptorSets: {
+            const VkPipelineBindPoint bindPoint = reader.Read<VkPipelineBindPoint> ();
+            const VkPipelineLayout    layout    = reader.ReadHandle<VkPipelineLayout> ();
+            const uint32_t            firstSet  = reader.Read<uint32_t> ();
+            const uint32_t            count     = reader.Read<uint32_t> ();
+
+            std::vector<VkDescriptorSet> descriptorSets;
+            for (uint32_t i = 0; i < count; ++i) {
+                descriptorSets.push_back (reader.ReadHandle<VkDescriptorSet> ());
+            }
+            const std::vector<uint32_t> dynamicOffsets = reader.ReadArray<uint32_t> ();
+
+            if (reader.HasUnresolvedHandle ()) {
+                state.incompleteBindPoints.insert (bindPoint);
+                return false;
+            }
+
+            commandBuffer.Record<CommandBindDescriptorSets> (bindPoint, layout, firstSet, descriptorSets, dynamicOffsets);
+            return true;
+        }
+
+        case CommandId::CopyImage: {
+            const VkImage                  srcImage       = reader.ReadHandle<VkImage> ();
+            const VkImageLayout            srcImageLayout = reader.Read<VkImageLayout> ();
+            const VkImage                  dstImage       = reader.ReadHandle<VkImage> ();
+            const VkImageLayout            dstImageLayout = reader.Read<VkImageLayout> ();
+            const std::vector<VkImageCopy> regions        = reader.ReadArray<VkImageCopy> ();
+
+            if (reader.HasUnresolvedHandle ()) {
+                return false;
+            }
+
+            commandBuffer.Record<CommandCopyImage> (srcImage, srcImageLayout, dstImage, dstImageLayout, regions);
+            return true;
+        }
+
+        case CommandId::BlitImage: {
+            const VkImage                  srcImage       = reader.ReadHandle<VkImage> ();
+            const VkImageLayout            srcImageLayout = reader.Read<VkImageLayout> ();
+            const VkImage                  dstImage       = reader.ReadHandle<VkImage> ();
+            const VkImageLayout            dstImageLayout = reader.Read<VkImageLayout> ();
+            const std::vector<VkImageBlit> regions        = reader.ReadArray<VkImageBlit> ();
+            const VkFilter                 filter         = reader.Read<VkFilter> ();
+
+            if (reader.HasUnresolvedHandle ()) {
+                return false;
+            }
+
+            commandBuffer.Record<CommandBlitImage> (srcImage, srcImageLayout, dstImage, dstImageLayout, regions, filter);
+            return true;
+        }
+
+        case CommandId::CopyImageToBuffer: {
+            const VkImage                        srcImage       = reader.ReadHandle<VkImage> ();
+            const VkImageLayout                  srcImageLayout = reader.Read<VkImageLayout> ();
+            const VkBuffer                       dstBuffer      = reader.ReadHandle<VkBuffer> ();
+            const std::vector<VkBufferImageCopy> regions        = reader.ReadArray<VkBufferImageCopy> ();
+
+            if (reader.HasUnresolvedHandle ()) {
+                return false;
+            }
+
+            commandBuffer.Record<CommandCopyImageToBuffer> (srcImage, srcImageLayout, dstBuffer, regions);
+            return true;
+        }
+
+        case CommandId::CopyBufferToImage: {
+            const VkBuffer                       srcBuffer      = reader.ReadHandle<VkBuffer> ();
+            const VkImage                        dstImage       = reader.ReadHandle<VkImage> ();
+            const VkImageLayout                  dstImageLayout = reader.Read<VkImageLayout> ();
+            const std::vector<VkBufferImageCopy> regions        = reader.ReadArray<VkBufferImageCopy> ();
+
+            if (reader.HasUnresolvedHandle ()) {
+                return false;
+            }
+
+            commandBuffer.Record<CommandCopyBufferToImage> (srcBuffer, dstImage, dstImageLayout, regions);
+            return true;
+        }
+
+        case CommandId::CopyBuffer: {
+            const VkBuffer                  srcBuffer = reader.ReadHandle<VkBuffer> ();
+            const VkBuffer                  dstBuffer = reader.ReadHandle<VkBuffer> ();
+            const std::vector<VkBufferCopy> regions   = reader.ReadArray<VkBufferCopy> ();
+
+            if (reader.HasUnresolvedHandle ()) {
+                return false;
+            }
+
+            commandBuffer.Record<CommandCopyBuffer> (srcBuffer, dstBuffer, regions);
+            return true;
+        }
+
+        case CommandId::Dispatch: {
+            const uint32_t groupCountX = reader.Read<uint32_t> ();
+            const uint32_t groupCountY = reader.Read<uint32_t> ();
+            const uint32_t groupCountZ = reader.Read<uint32_t> ();
+
+            if (state.renderPassActive || !CanDraw (state, VK_PIPELINE_BIND_POINT_COMPUTE)) {
+                return false;
+            }
+
+            commandBuffer.Record<CommandDispatch> (groupCountX, groupCountY, groupCountZ);
+            return true;
+        }
+
+        case CommandId::DispatchBase: {
+            const uint32_t baseGroupX  = reader.Read<uint32_t> ();
+            const uint32_t baseGroupY  = reader.Read<uint32_t> ();
+            const uint32_t baseGroupZ  = reader.Read<uint32_t> ();
+            const uint32_t groupCountX = reader.Read<uint32_t> ();
+            const uint32_t groupCountY = reader.Read<uint32_t> ();
+            const uint32_t groupCountZ = reader.Read<uint32_t> ();
+
+            if (state.renderPassActive || !CanDraw (state, VK_PIPELINE_BIND_POINT_COMPUTE)) {
+                return false;
+            }
+
+            commandBuffer.Record<CommandDispatchBase> (baseGroupX, baseGroupY, baseGroupZ, groupCountX, groupCountY, groupCountZ);
+            return true;
+        }
+
+        case CommandId::DispatchIndirect: {
+            const VkBuffer     buffer = reader.ReadHandle<VkBuffer> ();
+            const VkDeviceSize offset = reader.Read<VkDeviceSize> ();
+
+            if (reader.HasUnresolvedHandle () || state.renderPassActive || !CanDraw (state, VK_PIPELINE_BIND_POINT_COMPUTE)) {
+                return false;
+            }
+
+            commandBuffer.Record<CommandDispatchIndirect> (buffer, offset);
+            return true;
+        }
+    }
+
+    RG_BREAK ();
+    throw std::runtime_error ("unknown command in command stream");
+}
+
+} // namespace RG
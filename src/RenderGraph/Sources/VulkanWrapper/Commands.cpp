@@ -17,6 +17,15 @@ const VkAccessFlags CommandPipelineBarrierFull::flushAll = VK_ACCESS_INDIRECT_CO
                                                            VK_ACCESS_TRANSFER_WRITE_BIT;
 
 
+void CommandBoundState::Clear ()
+{
+    pipelines.clear ();
+    descriptorSets.clear ();
+    vertexBuffers.clear ();
+    indexBuffer.reset ();
+}
+
+
 void CommandBindVertexBuffers::Record (CommandBuffer& commandBuffer)
 {
     vkCmdBindVertexBuffers (commandBuffer.GetHandle (), firstBinding, bindingCount, pBuffers.data (), pOffsets.data ());
@@ -29,6 +38,35 @@ std::string CommandBindVertexBuffers::ToString () const
 }
 
 
+bool CommandBindVertexBuffers::IsRedundant (const CommandBoundState& state) const
+{
+    if (firstBinding + bindingCount > state.vertexBuffers.size ()) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < bindingCount; ++i) {
+        const std::optional<CommandBoundState::VertexBufferBinding>& bound = state.vertexBuffers[firstBinding + i];
+        if (!bound.has_value () || bound->buffer != pBuffers[i] || bound->offset != pOffsets[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void CommandBindVertexBuffers::UpdateBoundState (CommandBoundState& state) const
+{
+    if (firstBinding + bindingCount > state.vertexBuffers.size ()) {
+        state.vertexBuffers.resize (firstBinding + bindingCount);
+    }
+
+    for (uint32_t i = 0; i < bindingCount; ++i) {
+        state.vertexBuffers[firstBinding + i] = CommandBoundState::VertexBufferBinding { pBuffers[i], pOffsets[i] };
+    }
+}
+
+
 void CommandPipelineBarrier::Record (CommandBuffer& commandBuffer)
 {
     vkCmdPipelineBarrier (
@@ -41,4 +79,306 @@ void CommandPipelineBarrier::Record (CommandBuffer& commandBuffer)
         static_cast<uint32_t> (imageMemoryBarriers.size ()), imageMemoryBarriers.data ());
 }
 
+
+void CommandWaitEvents::Record (CommandBuffer& commandBuffer)
+{
+    vkCmdWaitEvents (
+        commandBuffer.GetHandle (),
+        static_cast<uint32_t> (events.size ()), events.data (),
+        srcStageMask,
+        dstStageMask,
+        static_cast<uint32_t> (memoryBarriers.size ()), memoryBarriers.data (),
+        static_cast<uint32_t> (bufferMemoryBarriers.size ()), bufferMemoryBarriers.data (),
+        static_cast<uint32_t> (imageMemoryBarriers.size ()), imageMemoryBarriers.data ());
+}
+
+
+bool CommandBindDescriptorSets::IsRedundant (const CommandBoundState& state) const
+{
+    // dynamic offsets are not tracked
+    if (!dynamicOffsets.empty ()) {
+        return false;
+    }
+
+    auto found = state.descriptorSets.find (pipelineBindPoint);
+    if (found == state.descriptorSets.end () || firstSet + descriptorSets.size () > found->second.size ()) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < descriptorSets.size (); ++i) {
+        const std::optional<CommandBoundState::DescriptorSetBinding>& bound = found->second[firstSet + i];
+        if (!bound.has_value () || bound->layout != layout || bound->descriptorSet != descriptorSets[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void CommandBindDescriptorSets::UpdateBoundState (CommandBoundState& state) const
+{
+    std::vector<std::optional<CommandBoundState::DescriptorSetBinding>>& bound = state.descriptorSets[pipelineBindPoint];
+
+    // sets bound with another layout may be disturbed when the layouts are incompatible, they are not tracked further
+    bound.resize (firstSet + descriptorSets.size ());
+    for (uint32_t i = 0; i < firstSet; ++i) {
+        if (bound[i].has_value () && bound[i]->layout != layout) {
+            bound[i].reset ();
+        }
+    }
+
+    for (uint32_t i = 0; i < descriptorSets.size (); ++i) {
+        if (dynamicOffsets.empty ()) {
+            bound[firstSet + i] = CommandBoundState::DescriptorSetBinding { layout, descriptorSets[i] };
+        } else {
+            bound[firstSet + i].reset ();
+        }
+    }
+}
+
+bool CommandBindVertexBuffers::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::BindVertexBuffers);
+    writer.Write (firstBinding);
+    writer.Write (bindingCount);
+    for (uint32_t i = 0; i < bindingCount; ++i) {
+        writer.WriteHandle (pBuffers[i]);
+    }
+    writer.WriteArray (pOffsets.data (), pOffsets.size ());
+    return true;
+}
+
+
+static void WritePipelineBarrier (CommandStreamWriter&                       writer,
+                                  VkPipelineStageFlags                       srcStageMask,
+                                  VkPipelineStageFlags                       dstStageMask,
+                                  const CommandArray<VkMemoryBarrier>&       memoryBarriers,
+                                  const CommandArray<VkBufferMemoryBarrier>& bufferMemoryBarriers,
+                                  const CommandArray<VkImageMemoryBarrier>&  imageMemoryBarriers)
+{
+    writer.Write (CommandId::PipelineBarrier);
+    writer.Write (srcStageMask);
+    writer.Write (dstStageMask);
+
+    writer.Write (static_cast<uint32_t> (memoryBarriers.size ()));
+    for (const VkMemoryBarrier& barrier : memoryBarriers) {
+        writer.Write (barrier.srcAccessMask);
+        writer.Write (barrier.dstAccessMask);
+    }
+
+    writer.Write (static_cast<uint32_t> (bufferMemoryBarriers.size ()));
+    for (const VkBufferMemoryBarrier& barrier : bufferMemoryBarriers) {
+        writer.WriteBufferBarrier (barrier);
+    }
+
+    writer.Write (static_cast<uint32_t> (imageMemoryBarriers.size ()));
+    for (const VkImageMemoryBarrier& barrier : imageMemoryBarriers) {
+        writer.WriteImageBarrier (barrier);
+    }
+}
+
+
+bool CommandPipelineBarrier::Serialize (CommandStreamWriter& writer) const
+{
+    WritePipelineBarrier (writer, srcStageMask, dstStageMask, memoryBarriers, bufferMemoryBarriers, imageMemoryBarriers);
+    return true;
+}
+
+
+bool CommandWaitEvents::Serialize (CommandStreamWriter& writer) const
+{
+    WritePipelineBarrier (writer, srcStageMask, dstStageMask, memoryBarriers, bufferMemoryBarriers, imageMemoryBarriers);
+    return true;
+}
+
+
+bool CommandDrawIndexed::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::DrawIndexed);
+    writer.Write (indexCount);
+    writer.Write (instanceCount);
+    writer.Write (firstIndex);
+    writer.Write (vertexOffset);
+    writer.Write (firstInstance);
+    return true;
+}
+
+
+bool CommandDrawIndexedIndirect::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::DrawIndexedIndirect);
+    writer.WriteHandle (buffer);
+    writer.Write (offset);
+    writer.Write (drawCount);
+    writer.Write (stride);
+    return true;
+}
+
+
+bool CommandDrawIndexedIndirectCount::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::DrawIndexedIndirectCount);
+    writer.WriteHandle (buffer);
+    writer.Write (offset);
+    writer.WriteHandle (countBuffer);
+    writer.Write (countBufferOffset);
+    writer.Write (maxDrawCount);
+    writer.Write (stride);
+    return true;
+}
+
+
+bool CommandDraw::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::Draw);
+    writer.Write (vertexCount);
+    writer.Write (instanceCount);
+    writer.Write (firstVertex);
+    writer.Write (firstInstance);
+    return true;
+}
+
+
+bool CommandBindIndexBuffer::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::BindIndexBuffer);
+    writer.WriteHandle (buffer);
+    writer.Write (offset);
+    writer.Write (indexType);
+    return true;
+}
+
+
+bool CommandEndRenderPass::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::EndRenderPass);
+    return true;
+}
+
+
+bool CommandBeginRenderPass::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::BeginRenderPass);
+    writer.WriteHandle (renderPassBegin.renderPass);
+    writer.WriteHandle (renderPassBegin.framebuffer);
+    writer.Write (renderPassBegin.renderArea);
+    writer.Write (contents);
+    writer.WriteArray (clearValues.data (), clearValues.size ());
+    return true;
+}
+
+
+bool CommandBindPipeline::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::BindPipeline);
+    writer.Write (pipelineBindPoint);
+    writer.WriteHandle (pipeline);
+    return true;
+}
+
+
+bool CommandBindDescriptorSets::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::BindDescriptorSets);
+    writer.Write (pipelineBindPoint);
+    writer.WriteHandle (layout);
+    writer.Write (firstSet);
+    writer.Write (static_cast<uint32_t> (descriptorSets.size ()));
+    for (VkDescriptorSet descriptorSet : descriptorSets) {
+        writer.WriteHandle (descriptorSet);
+    }
+    writer.WriteArray (dynamicOffsets.data (), dynamicOffsets.size ());
+    return true;
+}
+
+
+bool CommandCopyImage::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::CopyImage);
+    writer.WriteHandle (srcImage);
+    writer.Write (srcImageLayout);
+    writer.WriteHandle (dstImage);
+    writer.Write (dstImageLayout);
+    writer.WriteArray (regions.data (), regions.size ());
+    return true;
+}
+
+
+bool CommandBlitImage::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::BlitImage);
+    writer.WriteHandle (srcImage);
+    writer.Write (srcImageLayout);
+    writer.WriteHandle (dstImage);
+    writer.Write (dstImageLayout);
+    writer.WriteArray (regions.data (), regions.size ());
+    writer.Write (filter);
+    return true;
+}
+
+
+bool CommandCopyImageToBuffer::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::CopyImageToBuffer);
+    writer.WriteHandle (srcImage);
+    writer.Write (srcImageLayout);
+    writer.WriteHandle (dstBuffer);
+    writer.WriteArray (regions.data (), regions.size ());
+    return true;
+}
+
+
+bool CommandCopyBufferToImage::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::CopyBufferToImage);
+    writer.WriteHandle (srcBuffer);
+    writer.WriteHandle (dstImage);
+    writer.Write (dstImageLayout);
+    writer.WriteArray (regions.data (), regions.size ());
+    return true;
+}
+
+
+bool CommandCopyBuffer::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::CopyBuffer);
+    writer.WriteHandle (srcBuffer);
+    writer.WriteHandle (dstBuffer);
+    writer.WriteArray (regions.data (), regions.size ());
+    return true;
+}
+
+
+bool CommandDispatch::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::Dispatch);
+    writer.Write (groupCountX);
+    writer.Write (groupCountY);
+    writer.Write (groupCountZ);
+    return true;
+}
+
+
+bool CommandDispatchBase::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::DispatchBase);
+    writer.Write (baseGroupX);
+    writer.Write (baseGroupY);
+    writer.Write (baseGroupZ);
+    writer.Write (groupCountX);
+    writer.Write (groupCountY);
+    writer.Write (groupCountZ);
+    return true;
+}
+
+
+bool CommandDispatchIndirect::Serialize (CommandStreamWriter& writer) const
+{
+    writer.Write (CommandId::DispatchIndirect);
+    writer.WriteHandle (buffer);
+    writer.Write (offset);
+    return true;
+}
+
 } // namespace RG
@@ -1,15 +1,97 @@
 #include "Device.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <optional>
 #include <vector>
 #include <stdexcept>
 
 
 namespace RG {
 
+static const uint32_t MaxBindlessTextures = 4096;
+
 
 Device::~Device () = default;
 
 
+// the 1.2 features are queried and enabled through one struct, it can not be chained together with the per feature structs
+static std::optional<VkPhysicalDeviceVulkan12Features> GetSupportedVulkan12Features (VkPhysicalDevice physicalDevice)
+{
+    VkPhysicalDeviceProperties properties = {};
+    vkGetPhysicalDeviceProperties (physicalDevice, &properties);
+
+    if (properties.apiVersion < VK_API_VERSION_1_2) {
+        return std::nullopt;
+    }
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+    vulkan12Features.sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceFeatures2 features = {};
+    features.sType                     = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext                     = &vulkan12Features;
+    vkGetPhysicalDeviceFeatures2 (physicalDevice, &features);
+
+    vulkan12Features.pNext = nullptr;
+
+    return vulkan12Features;
+}
+
+
+// descriptor indexing is core since 1.2, older devices fall back to regular descriptors
+static uint32_t GetSupportedBindlessTextureCapacity (VkPhysicalDevice physicalDevice)
+{
+    const std::optional<VkPhysicalDeviceVulkan12Features> vulkan12Features = GetSupportedVulkan12Features (physicalDevice);
+    if (!vulkan12Features.has_value ()) {
+        return 0;
+    }
+
+    if (!vulkan12Features->runtimeDescriptorArray ||
+        !vulkan12Features->descriptorBindingPartiallyBound ||
+        !vulkan12Features->descriptorBindingSampledImageUpdateAfterBind ||
+        !vulkan12Features->shaderSampledImageArrayNonUniformIndexing) {
+        return 0;
+    }
+
+    VkPhysicalDeviceDescriptorIndexingProperties indexingProperties = {};
+    indexingProperties.sType                                        = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties2 = {};
+    properties2.sType                       = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext                       = &indexingProperties;
+    vkGetPhysicalDeviceProperties2 (physicalDevice, &properties2);
+
+    return std::min ({ MaxBindlessTextures,
+                       indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+                       indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+                       indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                       indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers });
+}
+
+
+// the allocator queries the budget through vkGetPhysicalDeviceMemoryProperties2, which is core since 1.1
+static bool IsMemoryBudgetSupported (VkPhysicalDevice physicalDevice)
+{
+    VkPhysicalDeviceProperties properties = {};
+    vkGetPhysicalDeviceProperties (physicalDevice, &properties);
+
+    if (properties.apiVersion < VK_API_VERSION_1_1) {
+        return false;
+    }
+
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties (physicalDevice, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> extensions (extensionCount);
+    vkEnumerateDeviceExtensionProperties (physicalDevice, nullptr, &extensionCount, extensions.data ());
+
+    return std::any_of (extensions.begin (), extensions.end (), [] (const VkExtensionProperties& extension) {
+        return std::strcmp (extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0;
+    });
+}
+
+
 uint32_t DeviceObject::FindMemoryType (uint32_t typeFilter, VkMemoryPropertyFlags properties) const
 {
     VkPhysicalDeviceMemoryProperties memProperties = {};
@@ -28,6 +110,10 @@ uint32_t DeviceObject::FindMemoryType (uint32_t typeFilter, VkMemoryPropertyFlag
 DeviceObject::DeviceObject (VkPhysicalDevice physicalDevice, std::vector<uint32_t> queueFamilyIndices, std::vector<const char*> requestedDeviceExtensions)
     : physicalDevice (physicalDevice)
     , handle (VK_NULL_HANDLE)
+    , bindlessTextureCapacity (GetSupportedBindlessTextureCapacity (physicalDevice))
+    , multiDrawIndirectSupported (false)
+    , drawIndirectCountSupported (false)
+    , memoryBudgetSupported (IsMemoryBudgetSupported (physicalDevice))
 {
     const float queuePriority = 1.0f;
     
@@ -42,11 +128,46 @@ DeviceObject::DeviceObject (VkPhysicalDevice physicalDevice, std::vector<uint32_
         queueCreateInfos.push_back (queueCreateInfo);
     }
 
-    VkPhysicalDeviceFeatures deviceFeatures = {};
-    deviceFeatures.shaderInt64 = VK_TRUE;
+    VkPhysicalDeviceFeatures supportedFeatures = {};
+    vkGetPhysicalDeviceFeatures (physicalDevice, &supportedFeatures);
+
+    // block compressed formats report no features unless textureCompressionBC is enabled
+    VkPhysicalDeviceFeatures deviceFeatures  = {};
+    deviceFeatures.shaderInt64               = VK_TRUE;
+    deviceFeatures.multiDrawIndirect         = supportedFeatures.multiDrawIndirect;
+    deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+    deviceFeatures.textureCompressionBC      = supportedFeatures.textureCompressionBC;
+
+    multiDrawIndirectSupported = supportedFeatures.multiDrawIndirect == VK_TRUE;
+
+    const std::optional<VkPhysicalDeviceVulkan12Features> supportedVulkan12Features = GetSupportedVulkan12Features (physicalDevice);
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+    vulkan12Features.sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    if (bindlessTextureCapacity > 0) {
+        vulkan12Features.runtimeDescriptorArray                       = VK_TRUE;
+        vulkan12Features.descriptorBindingPartiallyBound              = VK_TRUE;
+        vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        vulkan12Features.shaderSampledImageArrayNonUniformIndexing    = VK_TRUE;
+    }
+
+    if (supportedVulkan12Features.has_value ()) {
+        vulkan12Features.drawIndirectCount = supportedVulkan12Features->drawIndirectCount;
+        drawIndirectCountSupported         = supportedVulkan12Features->drawIndirectCount == VK_TRUE;
+    }
+
+    const bool memoryBudgetRequested = std::any_of (requestedDeviceExtensions.begin (), requestedDeviceExtensions.end (), [] (const char* extensionName) {
+        return std::strcmp (extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0;
+    });
+
+    if (memoryBudgetSupported && !memoryBudgetRequested) {
+        requestedDeviceExtensions.push_back (VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
 
     VkDeviceCreateInfo createInfo      = {};
     createInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext                   = supportedVulkan12Features.has_value () ? &vulkan12Features : nullptr;
     createInfo.queueCreateInfoCount    = static_cast<uint32_t> (queueCreateInfos.size ());
     createInfo.pQueueCreateInfos       = queueCreateInfos.data ();
     createInfo.pEnabledFeatures        = &deviceFeatures;
@@ -61,6 +61,12 @@ void Fence::Wait () const
 }
 
 
+bool Fence::IsSignaled () const
+{
+    return vkGetFenceStatus (device, handle) == VK_SUCCESS;
+}
+
+
 void Fence::Reset () const
 {
     vkResetFences (device, 1, &handle);
@@ -1,24 +1,30 @@
 #include "Image.hpp"
 #include "Commands.hpp"
+#include "VulkanUtils.hpp"
 
 #include "Utils/Assert.hpp"
 
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
+
 namespace RG {
 
 const VkImageLayout Image::INITIAL_LAYOUT = VK_IMAGE_LAYOUT_UNDEFINED;
 
-Image::Image (VkImage handle, VkDevice device, uint32_t width, uint32_t height, uint32_t depth, VkFormat format, uint32_t arrayLayers)
+Image::Image (VkImage handle, VkDevice device, uint32_t width, uint32_t height, uint32_t depth, VkFormat format, uint32_t arrayLayers, VkImageUsageFlags usage)
     : handle (handle)
     , allocator (VK_NULL_HANDLE)
     , allocationHandle (VK_NULL_HANDLE)
     , device (device)
     , format (format)
+    , usage (usage)
     , width (width)
     , height (height)
     , depth (depth)
     , arrayLayers (arrayLayers)
+    , mipLevels (1)
+    , memoryLocation (MemoryLocation::GPU)
 {
 }
 
@@ -32,17 +38,23 @@ Image::Image (VmaAllocator      allocator,
               VkImageTiling     tiling,
               VkImageUsageFlags usage,
               uint32_t          arrayLayers,
-              MemoryLocation    loc)
+              MemoryLocation    loc,
+              uint32_t          mipLevels)
     : device (VK_NULL_HANDLE)
     , handle (VK_NULL_HANDLE)
     , allocator (allocator)
     , allocationHandle (VK_NULL_HANDLE)
     , format (format)
+    , usage (usage)
     , width (width)
     , height (height)
     , depth (depth)
     , arrayLayers (arrayLayers)
+    , mipLevels (mipLevels)
+    , memoryLocation (loc)
 {
+    RG_ASSERT (mipLevels >= 1 && mipLevels <= GetFullMipLevelCount (width, height, depth));
+
     VkImageCreateInfo imageInfo = {};
     imageInfo.sType             = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     imageInfo.flags             = 0;
@@ -50,7 +62,7 @@ Image::Image (VmaAllocator      allocator,
     imageInfo.extent.width      = width;
     imageInfo.extent.height     = height;
     imageInfo.extent.depth      = depth;
-    imageInfo.mipLevels         = 1;
+    imageInfo.mipLevels         = mipLevels;
     imageInfo.arrayLayers       = arrayLayers;
     imageInfo.format            = format;
     imageInfo.tiling            = tiling;
@@ -59,14 +71,21 @@ Image::Image (VmaAllocator      allocator,
     imageInfo.samples           = VK_SAMPLE_COUNT_1_BIT;
     imageInfo.sharingMode       = VK_SHARING_MODE_EXCLUSIVE;
 
-    VmaAllocationCreateInfo allocInfo = {};
-    allocInfo.usage                   = (loc == MemoryLocation::GPU) ? VMA_MEMORY_USAGE_GPU_ONLY : VMA_MEMORY_USAGE_CPU_COPY;
-    
-    if (loc == MemoryLocation::CPU) {
-        allocInfo.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+    VmaAllocationCreateInfo allocInfo = GetAllocationCreateInfo (memoryLocation);
+
+    VkResult result = vmaCreateImage (allocator, &imageInfo, &allocInfo, &handle, &allocationHandle, nullptr);
+
+    while (result != VK_SUCCESS && GetFallbackMemoryLocation (memoryLocation).has_value ()) {
+        const MemoryLocation fallbackLocation = *GetFallbackMemoryLocation (memoryLocation);
+
+        spdlog::debug ("VkImage allocation from {} memory failed, falling back to {}.", MemoryLocationToString (memoryLocation), MemoryLocationToString (fallbackLocation));
+
+        memoryLocation = fallbackLocation;
+        allocInfo      = GetAllocationCreateInfo (memoryLocation);
+        result         = vmaCreateImage (allocator, &imageInfo, &allocInfo, &handle, &allocationHandle, nullptr);
     }
 
-    if (RG_ERROR (vmaCreateImage (allocator, &imageInfo, &allocInfo, &handle, &allocationHandle, nullptr) != VK_SUCCESS)) {
+    if (RG_ERROR (result != VK_SUCCESS)) {
         spdlog::critical ("VkImage creation failed.");
         throw std::runtime_error ("failed to create image!");
     }
@@ -85,8 +104,23 @@ Image::Image (ImageBuilder& imageBuilder)
              *imageBuilder.tiling,
              imageBuilder.usage,
              *imageBuilder.arrayLayers,
-             *imageBuilder.loc)
+             *imageBuilder.loc,
+             imageBuilder.mipLevels)
+{
+}
+
+
+uint32_t Image::GetFullMipLevelCount (uint32_t width, uint32_t height, uint32_t depth)
 {
+    uint32_t largestDimension = std::max ({ width, height, depth });
+
+    uint32_t result = 1;
+    while (largestDimension > 1) {
+        largestDimension >>= 1;
+        ++result;
+    }
+
+    return result;
 }
 
 
@@ -119,21 +153,30 @@ VkImageMemoryBarrier Image::GetBarrier (VkImageLayout oldLayout, VkImageLayout n
 
 VkImageMemoryBarrier Image::GetBarrier (VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, uint32_t baseArrayLayer, uint32_t layerCount) const
 {
-    VkImageMemoryBarrier barrier            = {};
-    barrier.pNext                           = nullptr;
-    barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout                       = oldLayout;
-    barrier.newLayout                       = newLayout;
-    barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image                           = handle;
-    barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseMipLevel   = 0;
-    barrier.subresourceRange.levelCount     = 1;
-    barrier.subresourceRange.baseArrayLayer = baseArrayLayer;
-    barrier.subresourceRange.layerCount     = layerCount;
-    barrier.srcAccessMask                   = srcAccessMask;
-    barrier.dstAccessMask                   = dstAccessMask;
+    VkImageSubresourceRange subresourceRange = {};
+    subresourceRange.aspectMask              = VK_IMAGE_ASPECT_COLOR_BIT;
+    subresourceRange.baseMipLevel            = 0;
+    subresourceRange.levelCount              = mipLevels;
+    subresourceRange.baseArrayLayer          = baseArrayLayer;
+    subresourceRange.layerCount              = layerCount;
+
+    return GetBarrier (oldLayout, newLayout, srcAccessMask, dstAccessMask, subresourceRange);
+}
+
+
+VkImageMemoryBarrier Image::GetBarrier (VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, const VkImageSubresourceRange& subresourceRange) const
+{
+    VkImageMemoryBarrier barrier = {};
+    barrier.pNext                = nullptr;
+    barrier.sType                = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout            = oldLayout;
+    barrier.newLayout            = newLayout;
+    barrier.srcQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image                = handle;
+    barrier.subresourceRange     = subresourceRange;
+    barrier.srcAccessMask        = srcAccessMask;
+    barrier.dstAccessMask        = dstAccessMask;
     return barrier;
 }
 
@@ -170,6 +213,81 @@ VkBufferImageCopy Image::GetFullBufferImageCopyLayer (uint32_t layer) const
 }
 
 
+VkBufferImageCopy Image::GetBufferImageCopyRegion (VkOffset3D offset, VkExtent3D extent, uint32_t layerIndex) const
+{
+    VkBufferImageCopy result = GetFullBufferImageCopyLayer (layerIndex);
+    result.imageOffset       = offset;
+    result.imageExtent       = extent;
+    return result;
+}
+
+
+bool Image::IsInside (const VkBufferImageCopy& region) const
+{
+    const VkImageSubresourceLayers& subresource = region.imageSubresource;
+    if (subresource.mipLevel >= mipLevels || subresource.baseArrayLayer + subresource.layerCount > arrayLayers) {
+        return false;
+    }
+
+    if (region.imageOffset.x < 0 || region.imageOffset.y < 0 || region.imageOffset.z < 0) {
+        return false;
+    }
+
+    const uint32_t mipWidth  = std::max<uint32_t> (width >> subresource.mipLevel, 1);
+    const uint32_t mipHeight = std::max<uint32_t> (height >> subresource.mipLevel, 1);
+    const uint32_t mipDepth  = std::max<uint32_t> (depth >> subresource.mipLevel, 1);
+
+    const uint32_t endX = static_cast<uint32_t> (region.imageOffset.x) + region.imageExtent.width;
+    const uint32_t endY = static_cast<uint32_t> (region.imageOffset.y) + region.imageExtent.height;
+    const uint32_t endZ = static_cast<uint32_t> (region.imageOffset.z) + region.imageExtent.depth;
+
+    if (endX > mipWidth || endY > mipHeight || endZ > mipDepth) {
+        return false;
+    }
+
+    // regions of block compressed images start on a block and end on a block or on the edge of the level
+    if (IsBlockCompressedFormat (format)) {
+        const bool alignedStart = region.imageOffset.x % 4 == 0 && region.imageOffset.y % 4 == 0;
+        const bool alignedEndX  = endX % 4 == 0 || endX == mipWidth;
+        const bool alignedEndY  = endY % 4 == 0 || endY == mipHeight;
+        const bool alignedRows  = region.bufferRowLength % 4 == 0 && region.bufferImageHeight % 4 == 0;
+        return alignedStart && alignedEndX && alignedEndY && alignedRows;
+    }
+
+    return true;
+}
+
+
+size_t Image::GetBufferImageCopySize (const VkBufferImageCopy& region) const
+{
+    const VkExtent3D& extent = region.imageExtent;
+    if (extent.width == 0 || extent.height == 0 || extent.depth == 0 || region.imageSubresource.layerCount == 0) {
+        return 0;
+    }
+
+    size_t rowLength   = region.bufferRowLength != 0 ? region.bufferRowLength : extent.width;
+    size_t imageHeight = region.bufferImageHeight != 0 ? region.bufferImageHeight : extent.height;
+    size_t rowCount    = extent.height;
+    size_t rowSize     = extent.width;
+    size_t elementSize = 0;
+
+    // block compressed rows and images are counted in 4x4 blocks
+    if (IsBlockCompressedFormat (format)) {
+        rowLength   = (rowLength + 3) / 4;
+        imageHeight = (imageHeight + 3) / 4;
+        rowCount    = (rowCount + 3) / 4;
+        rowSize     = (rowSize + 3) / 4;
+        elementSize = GetBlockByteSize (format);
+    } else {
+        elementSize = static_cast<size_t> (GetCompontentCountFromFormat (format)) * GetEachCompontentSizeFromFormat (format);
+    }
+
+    // the last row of the last slice does not have to be padded to rowLength
+    const size_t sliceCount = static_cast<size_t> (extent.depth) * region.imageSubresource.layerCount;
+    return ((sliceCount - 1) * imageHeight * rowLength + (rowCount - 1) * rowLength + rowSize) * elementSize;
+}
+
+
 void Image::CmdCopyToBuffer (CommandBuffer& commandBuffer, VkBuffer buffer) const
 {
     VkBufferImageCopy region = GetFullBufferImageCopy ();
@@ -212,6 +330,84 @@ void Image::CmdCopyBufferPartToImage (CommandBuffer& commandBuffer, VkBuffer buf
 }
 
 
+void Image::CmdGenerateMipLevels (CommandBuffer& commandBuffer, uint32_t baseArrayLayer, uint32_t layerCount, VkImageLayout levelZeroLayout, VkImageLayout finalLayout, VkFilter filter) const
+{
+    VkImageSubresourceRange levelRange = {};
+    levelRange.aspectMask              = VK_IMAGE_ASPECT_COLOR_BIT;
+    levelRange.baseMipLevel            = 0;
+    levelRange.levelCount              = 1;
+    levelRange.baseArrayLayer          = baseArrayLayer;
+    levelRange.layerCount              = layerCount;
+
+    VkImageLayout previousLevelLayout = levelZeroLayout;
+
+    for (uint32_t level = 1; level < mipLevels; ++level) {
+        VkImageSubresourceRange srcRange = levelRange;
+        srcRange.baseMipLevel            = level - 1;
+
+        VkImageSubresourceRange dstRange = levelRange;
+        dstRange.baseMipLevel            = level;
+
+        // level - 1 was either written by a copy or by the previous blit
+        const std::vector<VkImageMemoryBarrier> barriers = {
+            GetBarrier (previousLevelLayout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, srcRange),
+            GetBarrier (VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT, dstRange),
+        };
+
+        commandBuffer.Record<CommandPipelineBarrier> (
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            std::vector<VkMemoryBarrier> {},
+            std::vector<VkBufferMemoryBarrier> {},
+            barriers);
+
+        VkImageBlit blit                   = {};
+        blit.srcSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel       = level - 1;
+        blit.srcSubresource.baseArrayLayer = baseArrayLayer;
+        blit.srcSubresource.layerCount     = layerCount;
+        blit.srcOffsets[1]                 = { static_cast<int32_t> (std::max<uint32_t> (width >> (level - 1), 1)),
+                                               static_cast<int32_t> (std::max<uint32_t> (height >> (level - 1), 1)),
+                                               static_cast<int32_t> (std::max<uint32_t> (depth >> (level - 1), 1)) };
+        blit.dstSubresource                = blit.srcSubresource;
+        blit.dstSubresource.mipLevel       = level;
+        blit.dstOffsets[1]                 = { static_cast<int32_t> (std::max<uint32_t> (width >> level, 1)),
+                                               static_cast<int32_t> (std::max<uint32_t> (height >> level, 1)),
+                                               static_cast<int32_t> (std::max<uint32_t> (depth >> level, 1)) };
+
+        commandBuffer.Record<CommandBlitImage> (
+            handle,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            handle,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            std::vector<VkImageBlit> { blit },
+            filter);
+
+        previousLevelLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    }
+
+    // every level but the last one is a blit source by now
+    std::vector<VkImageMemoryBarrier> finalBarriers;
+
+    if (mipLevels > 1) {
+        VkImageSubresourceRange srcRange = levelRange;
+        srcRange.levelCount              = mipLevels - 1;
+        finalBarriers.push_back (GetBarrier (VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, finalLayout, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, srcRange));
+    }
+
+    VkImageSubresourceRange lastRange = levelRange;
+    lastRange.baseMipLevel            = mipLevels - 1;
+    finalBarriers.push_back (GetBarrier (previousLevelLayout, finalLayout, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, lastRange));
+
+    commandBuffer.Record<CommandPipelineBarrier> (
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        std::vector<VkMemoryBarrier> {},
+        std::vector<VkBufferMemoryBarrier> {},
+        finalBarriers);
+}
+
+
 Image ImageBuilder::Build () const
 {
     const bool allSet = imageType.has_value () &&
@@ -238,7 +434,8 @@ Image ImageBuilder::Build () const
         *tiling,
         usage,
         *arrayLayers,
-        *loc);
+        *loc,
+        mipLevels);
 }
 
 } // namespace RG
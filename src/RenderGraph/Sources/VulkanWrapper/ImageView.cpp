@@ -3,7 +3,7 @@
 
 namespace RG {
 
-ImageViewBase::ImageViewBase (VkDevice device, VkImage image, VkFormat format, VkImageViewType viewType, uint32_t layerIndex, uint32_t layerCount)
+ImageViewBase::ImageViewBase (VkDevice device, VkImage image, VkFormat format, VkImageViewType viewType, uint32_t layerIndex, uint32_t layerCount, uint32_t levelCount)
     : device (device)
     , format (format)
     , handle (VK_NULL_HANDLE)
@@ -20,7 +20,7 @@ ImageViewBase::ImageViewBase (VkDevice device, VkImage image, VkFormat format, V
     createInfo.components.a                    = VK_COMPONENT_SWIZZLE_IDENTITY;
     createInfo.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
     createInfo.subresourceRange.baseMipLevel   = 0;
-    createInfo.subresourceRange.levelCount     = 1;
+    createInfo.subresourceRange.levelCount     = levelCount;
     createInfo.subresourceRange.baseArrayLayer = layerIndex;
     createInfo.subresourceRange.layerCount     = layerCount;
 
@@ -32,7 +32,7 @@ ImageViewBase::ImageViewBase (VkDevice device, VkImage image, VkFormat format, V
 
 
 ImageViewBase::ImageViewBase (VkDevice device, const Image2D& image, VkImageViewType viewType, uint32_t layerIndex)
-    : ImageViewBase (device, image, image.GetFormat (), viewType, layerIndex)
+    : ImageViewBase (device, image, image.GetFormat (), viewType, layerIndex, 1, image.GetMipLevels ())
 {
 }
 
@@ -51,7 +51,7 @@ ImageView1D::ImageView1D (VkDevice device, VkImage image, VkFormat format, uint3
 
 
 ImageView1D::ImageView1D (VkDevice device, const Image& image, uint32_t layerIndex)
-    : ImageView1D (device, image, image.GetFormat (), layerIndex)
+    : ImageViewBase (device, image, image.GetFormat (), VK_IMAGE_VIEW_TYPE_1D, layerIndex, 1, image.GetMipLevels ())
 {
 }
 
@@ -63,7 +63,7 @@ ImageView2D::ImageView2D (VkDevice device, VkImage image, VkFormat format, uint3
 
 
 ImageView2D::ImageView2D (VkDevice device, const Image& image, uint32_t layerIndex, uint32_t layerCount)
-    : ImageView2D (device, image, image.GetFormat (), layerIndex, layerCount)
+    : ImageViewBase (device, image, image.GetFormat (), VK_IMAGE_VIEW_TYPE_2D, layerIndex, layerCount, image.GetMipLevels ())
 {
 }
 
@@ -75,7 +75,7 @@ ImageView2DArray::ImageView2DArray (VkDevice device, VkImage image, VkFormat for
 
 
 ImageView2DArray::ImageView2DArray (VkDevice device, const Image& image, uint32_t layerIndex, uint32_t layerCount)
-    : ImageView2DArray (device, image, image.GetFormat (), layerIndex, layerCount)
+    : ImageViewBase (device, image, image.GetFormat (), VK_IMAGE_VIEW_TYPE_2D, layerIndex, layerCount, image.GetMipLevels ())
 {
 }
 
@@ -87,7 +87,7 @@ ImageView3D::ImageView3D (VkDevice device, VkImage image, VkFormat format, uint3
 
 
 ImageView3D::ImageView3D (VkDevice device, const Image& image, uint32_t layerIndex)
-    : ImageView3D (device, image, image.GetFormat (), layerIndex)
+    : ImageViewBase (device, image, image.GetFormat (), VK_IMAGE_VIEW_TYPE_3D, layerIndex, 1, image.GetMipLevels ())
 {
 }
 
@@ -99,7 +99,7 @@ ImageViewCube::ImageViewCube (VkDevice device, VkImage image, VkFormat format, u
 
 
 ImageViewCube::ImageViewCube (VkDevice device, const Image& image, uint32_t layerIndex)
-    : ImageViewCube (device, image, image.GetFormat (), layerIndex)
+    : ImageViewBase (device, image, image.GetFormat (), VK_IMAGE_VIEW_TYPE_CUBE, layerIndex, 1, image.GetMipLevels ())
 {
 }
 
@@ -0,0 +1,101 @@
+#include "MemoryLocation.hpp"
+
+#include "Utils/Assert.hpp"
+
+#include <stdexcept>
+
+
+namespace RG {
+
+VmaAllocationCreateInfo GetAllocationCreateInfo (MemoryLocation location)
+{
+    VmaAllocationCreateInfo allocInfo = {};
+
+    // named by the render graph, see SetAllocationName
+    allocInfo.flags = VMA_ALLOCATION_CREATE_USER_DATA_COPY_STRING_BIT;
+
+    switch (location) {
+        case MemoryLocation::GPU:
+            allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+            break;
+
+        case MemoryLocation::CPU:
+            allocInfo.usage         = VMA_MEMORY_USAGE_CPU_COPY;
+            allocInfo.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+            break;
+
+        // host visible memory is required, device local is only preferred, so vma picks host memory when there is no BAR
+        // written directly by the host without flushing, so it has to be coherent
+        case MemoryLocation::GPUHostVisible:
+            allocInfo.usage          = VMA_MEMORY_USAGE_CPU_TO_GPU;
+            allocInfo.requiredFlags  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+            allocInfo.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+            break;
+
+        // usually write combined, reading it from the host is slow
+        case MemoryLocation::CPUStreaming:
+            allocInfo.usage         = VMA_MEMORY_USAGE_CPU_ONLY;
+            allocInfo.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+            break;
+
+        case MemoryLocation::CPUReadback:
+            allocInfo.usage          = VMA_MEMORY_USAGE_GPU_TO_CPU;
+            allocInfo.requiredFlags  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+            allocInfo.preferredFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+            break;
+
+        case MemoryLocation::GPULazilyAllocated:
+            allocInfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+            break;
+
+        default:
+            RG_BREAK ();
+            throw std::runtime_error ("unhandled MemoryLocation value");
+    }
+
+    return allocInfo;
+}
+
+
+std::optional<MemoryLocation> GetFallbackMemoryLocation (MemoryLocation location)
+{
+    switch (location) {
+        // stays coherent
+        case MemoryLocation::GPUHostVisible:
+            return MemoryLocation::CPUStreaming;
+
+        case MemoryLocation::CPUStreaming:
+        case MemoryLocation::CPUReadback:
+            return MemoryLocation::CPU;
+
+        case MemoryLocation::GPULazilyAllocated:
+            return MemoryLocation::GPU;
+
+        default:
+            return std::nullopt;
+    }
+}
+
+
+bool IsHostVisible (MemoryLocation location)
+{
+    return location != MemoryLocation::GPU && location != MemoryLocation::GPULazilyAllocated;
+}
+
+
+const char* MemoryLocationToString (MemoryLocation location)
+{
+    switch (location) {
+        case MemoryLocation::GPU: return "GPU";
+        case MemoryLocation::CPU: return "CPU";
+        case MemoryLocation::GPUHostVisible: return "GPUHostVisible";
+        case MemoryLocation::CPUStreaming: return "CPUStreaming";
+        case MemoryLocation::CPUReadback: return "CPUReadback";
+        case MemoryLocation::GPULazilyAllocated: return "GPULazilyAllocated";
+        default:
+            RG_BREAK ();
+            return "<unknown>";
+    }
+}
+
+} // namespace RG
@@ -49,6 +49,32 @@ static auto AcceptFirstWithFlag (VkQueueFlagBits flagbits)
 }
 
 
+// prefers families with transfer only, then families without graphics
+static std::optional<uint32_t> AcceptDedicatedTransfer (VkPhysicalDevice, VkSurfaceKHR, const std::vector<VkQueueFamilyProperties>& props)
+{
+    std::optional<uint32_t> withoutGraphics;
+
+    uint32_t i = 0;
+    for (const auto& p : props) {
+        const bool transfer = (p.queueFlags & VK_QUEUE_TRANSFER_BIT) != 0;
+        const bool graphics = (p.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+        const bool compute  = (p.queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+
+        if (transfer && !graphics && !compute) {
+            return i;
+        }
+
+        if (transfer && !graphics && !withoutGraphics.has_value ()) {
+            withoutGraphics = i;
+        }
+
+        ++i;
+    }
+
+    return withoutGraphics;
+}
+
+
 static PhysicalDevice::QueueFamilies FindQueueFamilyIndices (VkPhysicalDevice physicalDevice, VkSurfaceKHR surface)
 {
     PhysicalDevice::QueueFamilies result;
@@ -63,6 +89,8 @@ static PhysicalDevice::QueueFamilies FindQueueFamilyIndices (VkPhysicalDevice ph
     result.compute      = AcceptFirstWithFlag (VK_QUEUE_COMPUTE_BIT) (physicalDevice, surface, queueFamilies);
     result.transfer     = AcceptFirstWithFlag (VK_QUEUE_TRANSFER_BIT) (physicalDevice, surface, queueFamilies);
 
+    result.dedicatedTransfer = AcceptDedicatedTransfer (physicalDevice, surface, queueFamilies);
+
     if (result.presentation) {
         RG_ASSERT (result.graphics == result.presentation); // TODO handle different queue indices ...
     }
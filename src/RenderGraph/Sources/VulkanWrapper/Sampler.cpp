@@ -26,7 +26,7 @@ Sampler::Sampler (VkDevice device, VkFilter filter, VkSamplerAddressMode address
     createInfo.mipmapMode              = VK_SAMPLER_MIPMAP_MODE_LINEAR;
     createInfo.mipLodBias              = 0.0f;
     createInfo.minLod                  = 0.0f;
-    createInfo.maxLod                  = 0.0f;
+    createInfo.maxLod                  = VK_LOD_CLAMP_NONE; // the view limits the levels
 
     if (RG_ERROR (vkCreateSampler (device, &createInfo, nullptr, &handle) != VK_SUCCESS)) {
         throw std::runtime_error ("failed to create texture sampler!");
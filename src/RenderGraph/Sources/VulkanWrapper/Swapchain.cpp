@@ -198,7 +198,8 @@ std::vector<std::unique_ptr<InheritedImage>> RealSwapchain::GetImageObjects () c
             GetHeight (),
             1,
             GetImageFormat (),
-            1));
+            1,
+            ImageUsage));
     }
 
     return result;
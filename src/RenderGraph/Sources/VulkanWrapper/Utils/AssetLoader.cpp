@@ -0,0 +1,316 @@
+#include "AssetLoader.hpp"
+
+#include "ImageFile.hpp"
+#include "UploadBatch.hpp"
+#include "VulkanUtils.hpp"
+
+#include "Utils/Assert.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace RG {
+
+AssetLoader::AssetLoader (const DeviceExtra& device, uint32_t threadCount, size_t batchSize)
+    : device (device)
+    , batchSize (batchSize)
+    , openBatch (nullptr)
+    , runningJobs (0)
+    , stopping (false)
+{
+    // hardware_concurrency may return 0
+    threadCount = std::max<uint32_t> (threadCount, 1);
+
+    workers.reserve (threadCount);
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back (&AssetLoader::WorkerThread, this);
+    }
+}
+
+
+AssetLoader::~AssetLoader ()
+{
+    Wait ();
+
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all ();
+
+    for (std::thread& worker : workers) {
+        worker.join ();
+    }
+}
+
+
+AssetLoader::AssetId AssetLoader::LoadImageFile (const std::filesystem::path& filePath, const Image& image, uint32_t layerIndex, VkImageLayout currentLayout, std::optional<VkImageLayout> nextLayout)
+{
+    AssetId id;
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        id = states.size ();
+        states.push_back (AssetState::Pending);
+        jobs.push_back ({ id, filePath, &image, layerIndex, currentLayout, nextLayout });
+    }
+    jobAvailable.notify_one ();
+
+    return id;
+}
+
+
+void AssetLoader::WorkerThread ()
+{
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+            jobAvailable.wait (lock, [&] { return stopping || !jobs.empty (); });
+
+            if (jobs.empty ()) {
+                return;
+            }
+
+            job = std::move (jobs.front ());
+            jobs.pop_front ();
+            ++runningJobs;
+        }
+
+        RunJob (job);
+
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+            --runningJobs;
+        }
+        decodeFinished.notify_all ();
+    }
+}
+
+
+void AssetLoader::RunJob (const Job& job)
+{
+    // the file is read through page faults of this worker while decoding
+    const ImageFile file (job.filePath);
+
+    const Image& image = *job.image;
+    if (!file.IsValid () || image.GetWidth () != file.GetWidth () || image.GetHeight () != file.GetHeight () || GetEachCompontentSizeFromFormat (image.GetFormat ()) != 1) {
+        spdlog::error ("AssetLoader: {} can not be loaded into the image.", job.filePath.string ());
+
+        std::lock_guard<std::mutex> lock (mutex);
+        states[job.id] = AssetState::Failed;
+        failedAssets.push_back (job.id);
+        return;
+    }
+
+    const uint32_t components = GetCompontentCountFromFormat (image.GetFormat ());
+    const size_t   size       = file.GetDecodedSize (components);
+
+    PendingBatch* pending = nullptr;
+    void*         staging = nullptr;
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+
+        if (openBatch == nullptr) {
+            std::unique_ptr<PendingBatch> newBatch = std::make_unique<PendingBatch> ();
+            newBatch->batch                        = std::make_unique<UploadBatch> (device);
+            newBatch->reservedBytes                = 0;
+            newBatch->unfinishedDecodes            = 0;
+            newBatch->closed                       = false;
+            newBatch->submitted                    = false;
+
+            openBatch = newBatch.get ();
+            batches.push_back (std::move (newBatch));
+        }
+
+        pending = openBatch;
+        staging = pending->batch->ReserveImageUpload (image, job.currentLayout, size, image.GetFullBufferImageCopyLayer (job.layerIndex), job.nextLayout);
+
+        pending->assets.push_back (job.id);
+        pending->reservedBytes += size;
+        ++pending->unfinishedDecodes;
+
+        if (pending->reservedBytes >= batchSize) {
+            pending->closed = true;
+            openBatch       = nullptr;
+        }
+    }
+
+    // other workers decode into other regions of the same batch meanwhile
+    const bool decoded = file.DecodeTo (staging, size, components);
+    if (!decoded) {
+        memset (staging, 0, size);
+    }
+
+    std::lock_guard<std::mutex> lock (mutex);
+
+    --pending->unfinishedDecodes;
+
+    if (!decoded) {
+        states[job.id] = AssetState::Failed;
+        failedAssets.push_back (job.id);
+    }
+}
+
+
+void AssetLoader::Update ()
+{
+    std::vector<std::pair<AssetId, bool>> finishedAssets;
+    std::vector<PendingBatch*>            batchesToSubmit;
+    std::vector<PendingBatch*>            submittedBatches;
+
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+
+        for (const AssetId id : failedAssets) {
+            finishedAssets.emplace_back (id, false);
+        }
+        failedAssets.clear ();
+
+        // nothing else is queued, the last partially filled batch would never be closed by the workers
+        if (openBatch != nullptr && jobs.empty () && runningJobs == 0) {
+            openBatch->closed = true;
+            openBatch         = nullptr;
+        }
+
+        for (const std::unique_ptr<PendingBatch>& pending : batches) {
+            if (pending->submitted) {
+                submittedBatches.push_back (pending.get ());
+            } else if (pending->closed && pending->unfinishedDecodes == 0) {
+                batchesToSubmit.push_back (pending.get ());
+            }
+        }
+    }
+
+    // closed batches with all files decoded are not touched by the workers anymore
+    for (PendingBatch* pending : batchesToSubmit) {
+        pending->batch->Submit ();
+        pending->submitted = true;
+    }
+
+    for (PendingBatch* pending : submittedBatches) {
+        if (!pending->batch->Poll ()) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock (mutex);
+
+        for (const AssetId id : pending->assets) {
+            if (states[id] == AssetState::Pending) {
+                states[id] = AssetState::Uploaded;
+                finishedAssets.emplace_back (id, true);
+            }
+        }
+
+        batches.erase (std::find_if (batches.begin (), batches.end (), [&] (const std::unique_ptr<PendingBatch>& b) { return b.get () == pending; }));
+    }
+
+    for (const auto& [id, success] : finishedAssets) {
+        assetLoaded.Notify (id, success);
+    }
+}
+
+
+void AssetLoader::Wait (AssetId id)
+{
+    while (IsPending (id)) {
+        PendingBatch* pending = nullptr;
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+
+            // until the file of the asset is decoded, together with every other file reserved in its batch
+            decodeFinished.wait (lock, [&] {
+                pending = FindBatch (id);
+                return states[id] != AssetState::Pending || (pending != nullptr && pending->unfinishedDecodes == 0);
+            });
+
+            if (pending != nullptr && !pending->closed) {
+                pending->closed = true;
+                if (openBatch == pending) {
+                    openBatch = nullptr;
+                }
+            }
+        }
+
+        Update ();
+
+        if (!IsPending (id)) {
+            break;
+        }
+
+        // only Update removes batches, it runs on this thread
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+            pending = FindBatch (id);
+        }
+
+        if (pending != nullptr && pending->submitted) {
+            pending->batch->Wait ();
+        }
+    }
+
+    // failures and other finished assets are reported as well
+    Update ();
+}
+
+
+void AssetLoader::Wait ()
+{
+    {
+        std::unique_lock<std::mutex> lock (mutex);
+        decodeFinished.wait (lock, [&] { return jobs.empty () && runningJobs == 0; });
+
+        if (openBatch != nullptr) {
+            openBatch->closed = true;
+            openBatch         = nullptr;
+        }
+    }
+
+    // submits every batch
+    Update ();
+
+    std::vector<PendingBatch*> remainingBatches;
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        for (const std::unique_ptr<PendingBatch>& pending : batches) {
+            remainingBatches.push_back (pending.get ());
+        }
+    }
+
+    for (PendingBatch* pending : remainingBatches) {
+        pending->batch->Wait ();
+    }
+
+    Update ();
+}
+
+
+AssetLoader::AssetState AssetLoader::GetState (AssetId id) const
+{
+    std::lock_guard<std::mutex> lock (mutex);
+
+    RG_ASSERT (id < states.size ());
+    return states[id];
+}
+
+
+AssetLoader::PendingBatch* AssetLoader::FindBatch (AssetId id) const
+{
+    for (const std::unique_ptr<PendingBatch>& pending : batches) {
+        if (std::find (pending->assets.begin (), pending->assets.end (), id) != pending->assets.end ()) {
+            return pending.get ();
+        }
+    }
+
+    return nullptr;
+}
+
+
+bool AssetLoader::IsPending (AssetId id) const
+{
+    return GetState (id) == AssetState::Pending;
+}
+
+} // namespace RG
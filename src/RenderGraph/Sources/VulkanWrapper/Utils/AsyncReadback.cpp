@@ -0,0 +1,179 @@
+#include "AsyncReadback.hpp"
+
+#include "Commands.hpp"
+#include "VulkanUtils.hpp"
+
+#include "Utils/Assert.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <cstring>
+
+
+namespace RG {
+
+AsyncReadback::AsyncReadback (const DeviceExtra& device, StagingBufferPool& pool, size_t size, const Recorder& recorder)
+    : device (device)
+    , pool (pool)
+    , stagingBuffer (pool.Acquire (size))
+    , commandBuffer (std::make_unique<CommandBuffer> (device))
+    , fence (std::make_unique<Fence> (device, false))
+    , size (size)
+    , completed (false)
+    , conversionImage (nullptr)
+{
+    commandBuffer->SetName (device, "AsyncReadback - CommandBuffer");
+
+    commandBuffer->Begin (VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    recorder (*commandBuffer, *stagingBuffer->buffer);
+    commandBuffer->End ();
+
+    device.GetGraphicsQueue ().Submit ({}, {}, { commandBuffer.get () }, {}, *fence);
+}
+
+
+AsyncReadback::~AsyncReadback ()
+{
+    // the copy may still be writing into the staging buffer
+    Wait ();
+
+    pool.Release (std::move (stagingBuffer));
+}
+
+
+bool AsyncReadback::IsReady () const
+{
+    if (completed) {
+        return true;
+    }
+
+    return vkGetFenceStatus (device, *fence) == VK_SUCCESS;
+}
+
+
+void AsyncReadback::Wait () const
+{
+    if (completed) {
+        return;
+    }
+
+    fence->Wait ();
+
+    // staging memory is not guaranteed to be host coherent
+    vmaInvalidateAllocation (device.GetAllocator (), *stagingBuffer->buffer, 0, VK_WHOLE_SIZE);
+
+    completed = true;
+}
+
+
+const void* AsyncReadback::Get () const
+{
+    Wait ();
+    return stagingBuffer->Get ();
+}
+
+
+void AsyncReadback::CopyTo (void* destination, size_t destinationSize) const
+{
+    if (RG_ERROR (destinationSize < size)) {
+        throw std::runtime_error ("readback destination is too small");
+    }
+
+    memcpy (destination, Get (), size);
+}
+
+
+std::unique_ptr<AsyncReadback> AsyncReadback::FromBuffer (const DeviceExtra& device, VkBuffer buffer, VkDeviceSize size, VkDeviceSize offset)
+{
+    return std::make_unique<AsyncReadback> (device, device.GetReadbackPool (), size, [=] (CommandBuffer& commandBuffer, VkBuffer stagingBuffer) {
+        VkBufferCopy copyRegion = {};
+        copyRegion.srcOffset    = offset;
+        copyRegion.dstOffset    = 0;
+        copyRegion.size         = size;
+
+        commandBuffer.Record<CommandCopyBuffer> (buffer, stagingBuffer, std::vector<VkBufferCopy> { copyRegion });
+    });
+}
+
+
+std::unique_ptr<AsyncReadback> AsyncReadback::FromImageLayer (const DeviceExtra& device, const Image& image, uint32_t layerIndex, std::optional<VkImageLayout> currentLayout)
+{
+    const size_t components        = 4;
+    const size_t componentByteSize = GetEachCompontentSizeFromFormat (image.GetFormat ());
+    const size_t size              = image.GetWidth () * image.GetHeight () * image.GetDepth () * components * componentByteSize;
+
+    return std::make_unique<AsyncReadback> (device, device.GetReadbackPool (), size, [&image, layerIndex, currentLayout] (CommandBuffer& commandBuffer, VkBuffer stagingBuffer) {
+        // transitions are recorded into the same submission as the copy
+        if (currentLayout)
+            commandBuffer.Record<CommandTranstionImage> (image, *currentLayout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+        image.CmdCopyLayerToBuffer (commandBuffer, layerIndex, stagingBuffer);
+
+        if (currentLayout)
+            commandBuffer.Record<CommandTranstionImage> (image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, *currentLayout);
+    });
+}
+
+
+bool AsyncReadback::CanConvert (const DeviceExtra& device, VkFormat sourceFormat, VkFormat targetFormat)
+{
+    return (device.GetOptimalTilingFeatures (sourceFormat) & VK_FORMAT_FEATURE_BLIT_SRC_BIT) != 0 &&
+           (device.GetOptimalTilingFeatures (targetFormat) & VK_FORMAT_FEATURE_BLIT_DST_BIT) != 0;
+}
+
+
+std::unique_ptr<AsyncReadback> AsyncReadback::FromImageLayerConverted (const DeviceExtra& device, const Image& image, uint32_t layerIndex, VkFormat targetFormat, std::optional<VkImageLayout> currentLayout)
+{
+    if (RG_ERROR (image.GetDepth () != 1 || !CanConvert (device, image.GetFormat (), targetFormat))) {
+        throw std::runtime_error ("the image can not be converted to the requested format");
+    }
+
+    const size_t components        = GetCompontentCountFromFormat (targetFormat);
+    const size_t componentByteSize = GetEachCompontentSizeFromFormat (targetFormat);
+    const size_t size              = image.GetWidth () * image.GetHeight () * components * componentByteSize;
+
+    std::unique_ptr<Image> conversionImage = std::make_unique<Image2D> (device.GetAllocator (), MemoryLocation::GPU, image.GetWidth (), image.GetHeight (), targetFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+    conversionImage->SetName (device, "AsyncReadback - ConversionImage");
+
+    const Image& conversion = *conversionImage;
+
+    std::unique_ptr<AsyncReadback> result = std::make_unique<AsyncReadback> (device, device.GetReadbackPool (), size, [&image, &conversion, layerIndex, currentLayout] (CommandBuffer& commandBuffer, VkBuffer stagingBuffer) {
+        if (currentLayout)
+            commandBuffer.Record<CommandTranstionImage> (image, *currentLayout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+        commandBuffer.Record<CommandTranstionImage> (conversion, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+        VkImageBlit blit                   = {};
+        blit.srcSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel       = 0;
+        blit.srcSubresource.baseArrayLayer = layerIndex;
+        blit.srcSubresource.layerCount     = 1;
+        blit.srcOffsets[1]                 = { static_cast<int32_t> (image.GetWidth ()), static_cast<int32_t> (image.GetHeight ()), 1 };
+        blit.dstSubresource                = blit.srcSubresource;
+        blit.dstSubresource.baseArrayLayer = 0;
+        blit.dstOffsets[1]                 = blit.srcOffsets[1];
+
+        // same size, so the filter never interpolates
+        commandBuffer.Record<CommandBlitImage> (
+            image,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            conversion,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            std::vector<VkImageBlit> { blit },
+            VK_FILTER_NEAREST);
+
+        commandBuffer.Record<CommandTranstionImage> (conversion, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+        conversion.CmdCopyLayerToBuffer (commandBuffer, 0, stagingBuffer);
+
+        if (currentLayout)
+            commandBuffer.Record<CommandTranstionImage> (image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, *currentLayout);
+    });
+
+    // has to stay alive until the submission finishes
+    result->conversionImage = std::move (conversionImage);
+
+    return result;
+}
+
+} // namespace RG
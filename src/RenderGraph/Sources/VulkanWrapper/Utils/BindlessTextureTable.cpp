@@ -0,0 +1,94 @@
+#include "BindlessTextureTable.hpp"
+
+#include "Utils/Assert.hpp"
+
+#include "spdlog/spdlog.h"
+
+
+namespace RG {
+
+BindlessTextureTable::BindlessTextureTable (VkDevice device, uint32_t capacity)
+    : device (device)
+    , capacity (capacity)
+    , nextIndex (0)
+    , registeredCount (0)
+{
+    RG_ASSERT (capacity > 0);
+
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding                      = 0;
+    binding.descriptorType               = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount              = capacity;
+    binding.stageFlags                   = VK_SHADER_STAGE_ALL;
+    binding.pImmutableSamplers           = nullptr;
+
+    const VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
+
+    layout        = std::make_unique<DescriptorSetLayout> (device, std::vector<VkDescriptorSetLayoutBinding> { binding }, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT, std::vector<VkDescriptorBindingFlags> { bindingFlags });
+    pool          = std::make_unique<DescriptorPool> (device, std::vector<VkDescriptorPoolSize> { { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, capacity } }, 1, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
+    descriptorSet = std::make_unique<DescriptorSet> (device, *pool, *layout);
+
+    spdlog::trace ("BindlessTextureTable: created with {} slots.", capacity);
+}
+
+
+BindlessTextureTable::~BindlessTextureTable () = default;
+
+
+uint32_t BindlessTextureTable::Register (VkImageView imageView, VkSampler sampler)
+{
+    std::lock_guard<std::mutex> lock (mutex);
+
+    uint32_t index = 0;
+    if (!freeIndices.empty ()) {
+        index = freeIndices.back ();
+        freeIndices.pop_back ();
+    } else {
+        if (RG_ERROR (nextIndex >= capacity)) {
+            throw std::runtime_error ("bindless texture table is full");
+        }
+        index = nextIndex++;
+    }
+
+    VkDescriptorImageInfo imageInfo = {};
+    imageInfo.imageLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageInfo.imageView             = imageView;
+    imageInfo.sampler               = sampler;
+
+    VkWriteDescriptorSet descriptorWrite = {};
+    descriptorWrite.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet               = *descriptorSet;
+    descriptorWrite.dstBinding           = 0;
+    descriptorWrite.dstArrayElement      = index;
+    descriptorWrite.descriptorType       = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrite.descriptorCount      = 1;
+    descriptorWrite.pImageInfo           = &imageInfo;
+
+    vkUpdateDescriptorSets (device, 1, &descriptorWrite, 0, nullptr);
+
+    ++registeredCount;
+
+    return index;
+}
+
+
+void BindlessTextureTable::Unregister (uint32_t index)
+{
+    std::lock_guard<std::mutex> lock (mutex);
+
+    RG_ASSERT (index < nextIndex);
+    RG_ASSERT (registeredCount > 0);
+
+    // the slot keeps its stale descriptor, partially bound arrays allow it as long as it is not accessed
+    freeIndices.push_back (index);
+    --registeredCount;
+}
+
+
+uint32_t BindlessTextureTable::GetRegisteredCount ()
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    return registeredCount;
+}
+
+} // namespace RG
@@ -0,0 +1,750 @@
+#include "BlockCompression.hpp"
+
+#include "CommandStream.hpp"
+#include "UploadBatch.hpp"
+#include "VulkanUtils.hpp"
+
+#include "Utils/Assert.hpp"
+#include "Utils/FileSystemUtils.hpp"
+#include "Utils/MappedFile.hpp"
+#include "Utils/MultithreadedFunction.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+
+namespace RG {
+
+static const uint32_t CompressedImageMagic   = 0x43424752; // "RGBC"
+static const uint32_t CompressedImageVersion = 1;
+
+// magic, version, format, width, height and the block count
+static const size_t CompressedImageHeaderSize = 6 * sizeof (uint32_t);
+
+static const std::array<uint32_t, 16> BC7IndexWeights = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+
+namespace {
+
+// RGBA texels of a 4x4 block, row by row
+using TexelBlock = std::array<std::array<uint8_t, 4>, 16>;
+
+using Color = std::array<float, 4>;
+
+
+class BlockBitWriter {
+private:
+    uint8_t* block;
+    uint32_t position;
+
+public:
+    BlockBitWriter (uint8_t* block, size_t size)
+        : block (block)
+        , position (0)
+    {
+        std::memset (block, 0, size);
+    }
+
+    void Write (uint32_t value, uint32_t bitCount)
+    {
+        for (uint32_t i = 0; i < bitCount; ++i, ++position) {
+            block[position / 8] |= static_cast<uint8_t> (((value >> i) & 1) << (position % 8));
+        }
+    }
+};
+
+
+class BlockBitReader {
+private:
+    const uint8_t* block;
+    uint32_t       position;
+
+public:
+    BlockBitReader (const uint8_t* block)
+        : block (block)
+        , position (0)
+    {
+    }
+
+    uint32_t Read (uint32_t bitCount)
+    {
+        uint32_t result = 0;
+        for (uint32_t i = 0; i < bitCount; ++i, ++position) {
+            result |= static_cast<uint32_t> ((block[position / 8] >> (position % 8)) & 1) << i;
+        }
+        return result;
+    }
+};
+
+} // namespace
+
+
+static void FetchBlock (const ImageData& image, uint32_t blockX, uint32_t blockY, TexelBlock& texels)
+{
+    for (uint32_t y = 0; y < 4; ++y) {
+        for (uint32_t x = 0; x < 4; ++x) {
+            const size_t   pixelX = std::min<size_t> (blockX * 4 + x, image.width - 1);
+            const size_t   pixelY = std::min<size_t> (blockY * 4 + y, image.height - 1);
+            const uint8_t* pixel  = &image.data[(pixelY * image.width + pixelX) * image.components];
+
+            for (uint32_t c = 0; c < 4; ++c) {
+                texels[y * 4 + x][c] = (c < image.components) ? pixel[c] : static_cast<uint8_t> (c == 3 ? 255 : 0);
+            }
+        }
+    }
+}
+
+
+// the line through the masked texels along their principal axis, found with a few power iterations
+static void FitEndpoints (const TexelBlock& texels, uint32_t channelCount, uint32_t texelMask, Color& low, Color& high)
+{
+    low  = {};
+    high = {};
+
+    uint32_t texelCount = 0;
+    Color    mean       = {};
+    Color    minimum    = { 255.f, 255.f, 255.f, 255.f };
+    Color    maximum    = {};
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        if ((texelMask & (1 << i)) == 0) {
+            continue;
+        }
+
+        ++texelCount;
+        for (uint32_t c = 0; c < channelCount; ++c) {
+            mean[c] += texels[i][c];
+            minimum[c] = std::min<float> (minimum[c], texels[i][c]);
+            maximum[c] = std::max<float> (maximum[c], texels[i][c]);
+        }
+    }
+
+    if (texelCount == 0) {
+        return;
+    }
+
+    for (uint32_t c = 0; c < channelCount; ++c) {
+        mean[c] /= static_cast<float> (texelCount);
+    }
+
+    std::array<Color, 4> covariance = {};
+    for (uint32_t i = 0; i < 16; ++i) {
+        if ((texelMask & (1 << i)) == 0) {
+            continue;
+        }
+
+        for (uint32_t c0 = 0; c0 < channelCount; ++c0) {
+            for (uint32_t c1 = 0; c1 < channelCount; ++c1) {
+                covariance[c0][c1] += (texels[i][c0] - mean[c0]) * (texels[i][c1] - mean[c1]);
+            }
+        }
+    }
+
+    Color axis = {};
+    for (uint32_t c = 0; c < channelCount; ++c) {
+        axis[c] = maximum[c] - minimum[c];
+    }
+
+    for (uint32_t iteration = 0; iteration < 8; ++iteration) {
+        Color next    = {};
+        float largest = 0.f;
+        for (uint32_t c0 = 0; c0 < channelCount; ++c0) {
+            for (uint32_t c1 = 0; c1 < channelCount; ++c1) {
+                next[c0] += covariance[c0][c1] * axis[c1];
+            }
+            largest = std::max (largest, std::abs (next[c0]));
+        }
+
+        if (largest == 0.f) {
+            break;
+        }
+
+        for (uint32_t c = 0; c < channelCount; ++c) {
+            axis[c] = next[c] / largest;
+        }
+    }
+
+    float axisLengthSquared = 0.f;
+    for (uint32_t c = 0; c < channelCount; ++c) {
+        axisLengthSquared += axis[c] * axis[c];
+    }
+
+    // every texel is the same
+    if (axisLengthSquared == 0.f) {
+        low  = mean;
+        high = mean;
+        return;
+    }
+
+    float minProjection = 0.f;
+    float maxProjection = 0.f;
+    for (uint32_t i = 0; i < 16; ++i) {
+        if ((texelMask & (1 << i)) == 0) {
+            continue;
+        }
+
+        float projection = 0.f;
+        for (uint32_t c = 0; c < channelCount; ++c) {
+            projection += (texels[i][c] - mean[c]) * axis[c];
+        }
+        projection /= axisLengthSquared;
+
+        minProjection = std::min (minProjection, projection);
+        maxProjection = std::max (maxProjection, projection);
+    }
+
+    for (uint32_t c = 0; c < channelCount; ++c) {
+        low[c]  = std::clamp (mean[c] + axis[c] * minProjection, 0.f, 255.f);
+        high[c] = std::clamp (mean[c] + axis[c] * maxProjection, 0.f, 255.f);
+    }
+}
+
+
+template<size_t PaletteSize>
+static uint32_t FindNearestColor (const std::array<uint8_t, 4>& texel, const std::array<std::array<int32_t, 4>, PaletteSize>& palette, uint32_t usedEntries, uint32_t channelCount)
+{
+    uint32_t bestIndex = 0;
+    int32_t  bestError = std::numeric_limits<int32_t>::max ();
+
+    for (uint32_t i = 0; i < usedEntries; ++i) {
+        int32_t error = 0;
+        for (uint32_t c = 0; c < channelCount; ++c) {
+            const int32_t difference = static_cast<int32_t> (texel[c]) - palette[i][c];
+            error += difference * difference;
+        }
+
+        if (error < bestError) {
+            bestError = error;
+            bestIndex = i;
+        }
+    }
+
+    return bestIndex;
+}
+
+
+static uint16_t ToRGB565 (const Color& color)
+{
+    const uint32_t r = static_cast<uint32_t> (std::lround (color[0] * 31.f / 255.f));
+    const uint32_t g = static_cast<uint32_t> (std::lround (color[1] * 63.f / 255.f));
+    const uint32_t b = static_cast<uint32_t> (std::lround (color[2] * 31.f / 255.f));
+    return static_cast<uint16_t> ((r << 11) | (g << 5) | b);
+}
+
+
+static std::array<int32_t, 4> FromRGB565 (uint16_t value)
+{
+    const int32_t r = (value >> 11) & 31;
+    const int32_t g = (value >> 5) & 63;
+    const int32_t b = value & 31;
+    return { (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2), 255 };
+}
+
+
+// 4 colors when color0 > color1, otherwise 3 colors and transparent black
+static std::array<std::array<int32_t, 4>, 4> GetBC1Palette (uint16_t color0, uint16_t color1)
+{
+    const std::array<int32_t, 4> c0 = FromRGB565 (color0);
+    const std::array<int32_t, 4> c1 = FromRGB565 (color1);
+
+    std::array<std::array<int32_t, 4>, 4> palette = { c0, c1 };
+
+    for (uint32_t c = 0; c < 3; ++c) {
+        if (color0 > color1) {
+            palette[2][c] = (2 * c0[c] + c1[c]) / 3;
+            palette[3][c] = (c0[c] + 2 * c1[c]) / 3;
+        } else {
+            palette[2][c] = (c0[c] + c1[c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+
+    palette[2][3] = 255;
+    palette[3][3] = (color0 > color1) ? 255 : 0;
+
+    return palette;
+}
+
+
+static void EncodeBC1Block (const TexelBlock& texels, bool punchThrough, uint8_t* output)
+{
+    uint32_t opaqueMask = 0;
+    for (uint32_t i = 0; i < 16; ++i) {
+        if (!punchThrough || texels[i][3] >= 128) {
+            opaqueMask |= 1 << i;
+        }
+    }
+
+    const bool transparent = opaqueMask != 0xffff;
+
+    Color low;
+    Color high;
+    FitEndpoints (texels, 3, opaqueMask, low, high);
+
+    uint16_t color0 = ToRGB565 (high);
+    uint16_t color1 = ToRGB565 (low);
+
+    // the order of the endpoints selects the mode
+    if ((transparent && color0 > color1) || (!transparent && color0 < color1)) {
+        std::swap (color0, color1);
+    }
+
+    const std::array<std::array<int32_t, 4>, 4> palette = GetBC1Palette (color0, color1);
+
+    uint32_t indices = 0;
+    if (color0 != color1 || transparent) {
+        for (uint32_t i = 0; i < 16; ++i) {
+            const uint32_t index = ((opaqueMask & (1 << i)) == 0) ? 3 : FindNearestColor (texels[i], palette, transparent ? 3 : 4, 3);
+            indices |= index << (i * 2);
+        }
+    }
+
+    std::memcpy (output + 0, &color0, sizeof (uint16_t));
+    std::memcpy (output + 2, &color1, sizeof (uint16_t));
+    std::memcpy (output + 4, &indices, sizeof (uint32_t));
+}
+
+
+// 8 interpolated values when value0 > value1, otherwise 6 values, 0 and 255
+static std::array<std::array<int32_t, 4>, 8> GetBC4Palette (uint8_t value0, uint8_t value1)
+{
+    std::array<std::array<int32_t, 4>, 8> palette = {};
+    palette[0][0]                                 = value0;
+    palette[1][0]                                 = value1;
+
+    if (value0 > value1) {
+        for (int32_t i = 1; i < 7; ++i) {
+            palette[i + 1][0] = ((7 - i) * value0 + i * value1) / 7;
+        }
+    } else {
+        for (int32_t i = 1; i < 5; ++i) {
+            palette[i + 1][0] = ((5 - i) * value0 + i * value1) / 5;
+        }
+        palette[6][0] = 0;
+        palette[7][0] = 255;
+    }
+
+    return palette;
+}
+
+
+static void EncodeBC4Block (const TexelBlock& texels, uint32_t channel, uint8_t* output)
+{
+    std::array<uint8_t, 4> channelTexels[16];
+
+    uint8_t minimum = 255;
+    uint8_t maximum = 0;
+    for (uint32_t i = 0; i < 16; ++i) {
+        channelTexels[i] = { texels[i][channel], 0, 0, 0 };
+        minimum          = std::min (minimum, texels[i][channel]);
+        maximum          = std::max (maximum, texels[i][channel]);
+    }
+
+    const std::array<std::array<int32_t, 4>, 8> palette = GetBC4Palette (maximum, minimum);
+
+    uint64_t indices = 0;
+    if (maximum != minimum) {
+        for (uint32_t i = 0; i < 16; ++i) {
+            indices |= static_cast<uint64_t> (FindNearestColor (channelTexels[i], palette, 8, 1)) << (i * 3);
+        }
+    }
+
+    output[0] = maximum;
+    output[1] = minimum;
+    for (uint32_t i = 0; i < 6; ++i) {
+        output[2 + i] = static_cast<uint8_t> (indices >> (i * 8));
+    }
+}
+
+
+// 7 bit endpoints sharing the lowest bit per endpoint, the p-bit is chosen for the smaller error
+static void QuantizeBC7Endpoint (const Color& endpoint, std::array<uint32_t, 4>& quantized, uint32_t& pBit)
+{
+    float bestError = std::numeric_limits<float>::max ();
+
+    for (uint32_t p = 0; p < 2; ++p) {
+        std::array<uint32_t, 4> candidate = {};
+        float                   error     = 0.f;
+        for (uint32_t c = 0; c < 4; ++c) {
+            candidate[c]              = static_cast<uint32_t> (std::clamp<long> (std::lround ((endpoint[c] - static_cast<float> (p)) / 2.f), 0, 127));
+            const float reconstructed = static_cast<float> ((candidate[c] << 1) | p);
+            error += (reconstructed - endpoint[c]) * (reconstructed - endpoint[c]);
+        }
+
+        if (error < bestError) {
+            bestError = error;
+            quantized = candidate;
+            pBit      = p;
+        }
+    }
+}
+
+
+static std::array<std::array<int32_t, 4>, 16> GetBC7Palette (const std::array<uint32_t, 4>& endpoint0, uint32_t pBit0, const std::array<uint32_t, 4>& endpoint1, uint32_t pBit1)
+{
+    std::array<std::array<int32_t, 4>, 16> palette = {};
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        const uint32_t weight = BC7IndexWeights[i];
+        for (uint32_t c = 0; c < 4; ++c) {
+            const uint32_t e0 = (endpoint0[c] << 1) | pBit0;
+            const uint32_t e1 = (endpoint1[c] << 1) | pBit1;
+            palette[i][c]     = static_cast<int32_t> (((64 - weight) * e0 + weight * e1 + 32) >> 6);
+        }
+    }
+
+    return palette;
+}
+
+
+// mode 6: one subset, RGBA endpoints and 4 bit indices
+static void EncodeBC7Block (const TexelBlock& texels, uint8_t* output)
+{
+    Color low;
+    Color high;
+    FitEndpoints (texels, 4, 0xffff, low, high);
+
+    std::array<uint32_t, 4> endpoint0;
+    std::array<uint32_t, 4> endpoint1;
+    uint32_t                pBit0 = 0;
+    uint32_t                pBit1 = 0;
+    QuantizeBC7Endpoint (low, endpoint0, pBit0);
+    QuantizeBC7Endpoint (high, endpoint1, pBit1);
+
+    const std::array<std::array<int32_t, 4>, 16> palette = GetBC7Palette (endpoint0, pBit0, endpoint1, pBit1);
+
+    std::array<uint32_t, 16> indices;
+    for (uint32_t i = 0; i < 16; ++i) {
+        indices[i] = FindNearestColor (texels[i], palette, 16, 4);
+    }
+
+    // the highest bit of the first index is implicitly 0
+    if (indices[0] >= 8) {
+        std::swap (endpoint0, endpoint1);
+        std::swap (pBit0, pBit1);
+        for (uint32_t& index : indices) {
+            index = 15 - index;
+        }
+    }
+
+    BlockBitWriter writer (output, 16);
+    writer.Write (1 << 6, 7);
+    for (uint32_t c = 0; c < 4; ++c) {
+        writer.Write (endpoint0[c], 7);
+        writer.Write (endpoint1[c], 7);
+    }
+    writer.Write (pBit0, 1);
+    writer.Write (pBit1, 1);
+    writer.Write (indices[0], 3);
+    for (uint32_t i = 1; i < 16; ++i) {
+        writer.Write (indices[i], 4);
+    }
+}
+
+
+static void EncodeBlock (VkFormat format, const TexelBlock& texels, uint8_t* output)
+{
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            EncodeBC1Block (texels, false, output);
+            break;
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            EncodeBC1Block (texels, true, output);
+            break;
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+            EncodeBC4Block (texels, 0, output);
+            break;
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            EncodeBC4Block (texels, 0, output);
+            EncodeBC4Block (texels, 1, output + 8);
+            break;
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            EncodeBC7Block (texels, output);
+            break;
+        default:
+            RG_BREAK ();
+            break;
+    }
+}
+
+
+static void DecodeBC1Block (const uint8_t* input, TexelBlock& texels)
+{
+    uint16_t color0;
+    uint16_t color1;
+    uint32_t indices;
+    std::memcpy (&color0, input + 0, sizeof (uint16_t));
+    std::memcpy (&color1, input + 2, sizeof (uint16_t));
+    std::memcpy (&indices, input + 4, sizeof (uint32_t));
+
+    const std::array<std::array<int32_t, 4>, 4> palette = GetBC1Palette (color0, color1);
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        const uint32_t index = (indices >> (i * 2)) & 3;
+        for (uint32_t c = 0; c < 4; ++c) {
+            texels[i][c] = static_cast<uint8_t> (palette[index][c]);
+        }
+    }
+}
+
+
+static void DecodeBC4Block (const uint8_t* input, uint32_t channel, TexelBlock& texels)
+{
+    const std::array<std::array<int32_t, 4>, 8> palette = GetBC4Palette (input[0], input[1]);
+
+    uint64_t indices = 0;
+    for (uint32_t i = 0; i < 6; ++i) {
+        indices |= static_cast<uint64_t> (input[2 + i]) << (i * 8);
+    }
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        texels[i][channel] = static_cast<uint8_t> (palette[(indices >> (i * 3)) & 7][0]);
+    }
+}
+
+
+static void DecodeBC7Block (const uint8_t* input, TexelBlock& texels)
+{
+    BlockBitReader reader (input);
+
+    // other modes are not written by the encoder, they decode to magenta
+    if (reader.Read (7) != (1 << 6)) {
+        for (std::array<uint8_t, 4>& texel : texels) {
+            texel = { 255, 0, 255, 255 };
+        }
+        return;
+    }
+
+    std::array<uint32_t, 4> endpoint0;
+    std::array<uint32_t, 4> endpoint1;
+    for (uint32_t c = 0; c < 4; ++c) {
+        endpoint0[c] = reader.Read (7);
+        endpoint1[c] = reader.Read (7);
+    }
+    const uint32_t pBit0 = reader.Read (1);
+    const uint32_t pBit1 = reader.Read (1);
+
+    const std::array<std::array<int32_t, 4>, 16> palette = GetBC7Palette (endpoint0, pBit0, endpoint1, pBit1);
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        const uint32_t index = reader.Read (i == 0 ? 3 : 4);
+        for (uint32_t c = 0; c < 4; ++c) {
+            texels[i][c] = static_cast<uint8_t> (palette[index][c]);
+        }
+    }
+}
+
+
+static void DecodeBlock (VkFormat format, const uint8_t* input, TexelBlock& texels)
+{
+    for (std::array<uint8_t, 4>& texel : texels) {
+        texel = { 0, 0, 0, 255 };
+    }
+
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            DecodeBC1Block (input, texels);
+            break;
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+            DecodeBC4Block (input, 0, texels);
+            break;
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            DecodeBC4Block (input, 0, texels);
+            DecodeBC4Block (input + 8, 1, texels);
+            break;
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            DecodeBC7Block (input, texels);
+            break;
+        default:
+            RG_BREAK ();
+            break;
+    }
+}
+
+
+CompressedImageData::CompressedImageData ()
+    : format (VK_FORMAT_UNDEFINED)
+    , width (0)
+    , height (0)
+{
+}
+
+
+CompressedImageData CompressedImageData::Encode (const ImageData& image, VkFormat format, uint32_t threadCount)
+{
+    if (RG_ERROR (!IsBlockCompressedFormat (format))) {
+        throw std::runtime_error ("not a block compressed format");
+    }
+
+    if (RG_ERROR (image.componentByteSize != 1 || image.width == 0 || image.height == 0)) {
+        throw std::runtime_error ("only non-empty 8 bit images can be compressed");
+    }
+
+    CompressedImageData result;
+    result.format = format;
+    result.width  = static_cast<uint32_t> (image.width);
+    result.height = static_cast<uint32_t> (image.height);
+    result.blocks.resize (GetImageByteSize (format, result.width, result.height));
+
+    const uint32_t blocksX   = (result.width + 3) / 4;
+    const uint32_t blocksY   = (result.height + 3) / 4;
+    const uint32_t blockSize = GetBlockByteSize (format);
+
+    // block rows are interleaved between the threads, neighbouring rows take about the same time
+    MultithreadedFunction encoder (std::clamp (threadCount, 1u, blocksY), [&] (uint32_t workerCount, uint32_t workerIndex) {
+        TexelBlock texels;
+        for (uint32_t blockY = workerIndex; blockY < blocksY; blockY += workerCount) {
+            for (uint32_t blockX = 0; blockX < blocksX; ++blockX) {
+                FetchBlock (image, blockX, blockY, texels);
+                EncodeBlock (format, texels, &result.blocks[(static_cast<size_t> (blockY) * blocksX + blockX) * blockSize]);
+            }
+        }
+    });
+
+    encoder.Wait ();
+
+    return result;
+}
+
+
+ImageData CompressedImageData::Decode () const
+{
+    const uint32_t blocksX   = (width + 3) / 4;
+    const uint32_t blocksY   = (height + 3) / 4;
+    const uint32_t blockSize = GetBlockByteSize (format);
+
+    std::vector<uint8_t> texelData (static_cast<size_t> (width) * height * 4);
+
+    TexelBlock texels;
+    for (uint32_t blockY = 0; blockY < blocksY; ++blockY) {
+        for (uint32_t blockX = 0; blockX < blocksX; ++blockX) {
+            DecodeBlock (format, &blocks[(static_cast<size_t> (blockY) * blocksX + blockX) * blockSize], texels);
+
+            for (uint32_t y = 0; y < 4 && blockY * 4 + y < height; ++y) {
+                for (uint32_t x = 0; x < 4 && blockX * 4 + x < width; ++x) {
+                    const size_t pixelIndex = static_cast<size_t> (blockY * 4 + y) * width + blockX * 4 + x;
+                    std::memcpy (&texelData[pixelIndex * 4], texels[y * 4 + x].data (), 4);
+                }
+            }
+        }
+    }
+
+    return ImageData::FromDataUint (texelData, width, height, 4);
+}
+
+
+bool CompressedImageData::SaveToFile (const std::filesystem::path& filePath) const
+{
+    std::vector<uint8_t> data;
+    data.reserve (CompressedImageHeaderSize + blocks.size ());
+
+    CommandStreamWriter writer (data);
+    writer.Write (CompressedImageMagic);
+    writer.Write (CompressedImageVersion);
+    writer.Write (static_cast<uint32_t> (format));
+    writer.Write (width);
+    writer.Write (height);
+    writer.WriteArray (blocks.data (), blocks.size ());
+
+    EnsureParentFolderExists (filePath);
+
+    return WriteBinaryFile (filePath, data);
+}
+
+
+std::optional<CompressedImageData> CompressedImageData::LoadFromFile (const std::filesystem::path& filePath)
+{
+    const MappedFile file (filePath);
+    if (!file.IsValid () || file.GetSize () < CompressedImageHeaderSize) {
+        return std::nullopt;
+    }
+
+    CommandStreamReader reader (file.GetData (), file.GetSize ());
+
+    if (reader.Read<uint32_t> () != CompressedImageMagic || reader.Read<uint32_t> () != CompressedImageVersion) {
+        spdlog::warn ("{} is not a compressed image of the current version.", filePath.string ());
+        return std::nullopt;
+    }
+
+    CompressedImageData result;
+    result.format = static_cast<VkFormat> (reader.Read<uint32_t> ());
+    result.width  = reader.Read<uint32_t> ();
+    result.height = reader.Read<uint32_t> ();
+
+    if (!IsBlockCompressedFormat (result.format)) {
+        return std::nullopt;
+    }
+
+    // a truncated file is treated as missing, the array is only read when it is complete
+    const size_t expectedSize = GetImageByteSize (result.format, result.width, result.height);
+    if (file.GetSize () - CompressedImageHeaderSize != expectedSize) {
+        return std::nullopt;
+    }
+
+    result.blocks = reader.ReadArray<uint8_t> ();
+    if (result.blocks.size () != expectedSize) {
+        return std::nullopt;
+    }
+
+    return result;
+}
+
+
+std::optional<CompressedImageData> CompressedImageData::LoadCached (const std::filesystem::path& sourcePath, const std::filesystem::path& cachePath, VkFormat format, uint32_t threadCount)
+{
+    std::error_code cacheError;
+    std::error_code sourceError;
+
+    const std::filesystem::file_time_type cacheTime  = std::filesystem::last_write_time (cachePath, cacheError);
+    const std::filesystem::file_time_type sourceTime = std::filesystem::last_write_time (sourcePath, sourceError);
+
+    // a cache without its source is still usable
+    if (!cacheError && (sourceError || cacheTime >= sourceTime)) {
+        std::optional<CompressedImageData> cached = LoadFromFile (cachePath);
+        if (cached.has_value () && cached->format == format) {
+            return cached;
+        }
+    }
+
+    if (sourceError) {
+        spdlog::error ("{} does not exist.", sourcePath.string ());
+        return std::nullopt;
+    }
+
+    const ImageData source (sourcePath, 4);
+    if (source.data.empty ()) {
+        return std::nullopt;
+    }
+
+    CompressedImageData result = Encode (source, format, threadCount);
+
+    if (!result.SaveToFile (cachePath)) {
+        spdlog::warn ("Failed to write compressed image cache {}.", cachePath.string ());
+    }
+
+    return result;
+}
+
+
+void CompressedImageData::UploadTo (UploadBatch& batch, const Image& image, VkImageLayout currentLayout, uint32_t layerIndex, std::optional<VkImageLayout> nextLayout) const
+{
+    if (RG_ERROR (image.GetFormat () != format || image.GetWidth () != width || image.GetHeight () != height)) {
+        throw std::runtime_error ("image does not match the compressed data");
+    }
+
+    batch.CopyLayerToImage (image, currentLayout, blocks.data (), blocks.size (), layerIndex, nextLayout);
+}
+
+} // namespace RG
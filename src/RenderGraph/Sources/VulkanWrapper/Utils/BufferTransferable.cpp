@@ -56,10 +56,12 @@ VertexInputInfo::VertexInputInfo (const std::vector<VkFormat>& vertexInputFormat
 
     uint32_t attributeSize = 0;
 
+    const uint32_t binding = (inputRate == VK_VERTEX_INPUT_RATE_INSTANCE) ? InstanceBinding : VertexBinding;
+
     for (VkFormat format : vertexInputFormats) {
         VkVertexInputAttributeDescription attrib;
 
-        attrib.binding  = 0;
+        attrib.binding  = binding;
         attrib.location = location;
         attrib.format   = format;
         attrib.offset   = attributeSize;
@@ -73,7 +75,7 @@ VertexInputInfo::VertexInputInfo (const std::vector<VkFormat>& vertexInputFormat
     VkVertexInputBindingDescription bindingDescription = {};
 
     bindingDescription           = {};
-    bindingDescription.binding   = 0;
+    bindingDescription.binding   = binding;
     bindingDescription.stride    = size;
     bindingDescription.inputRate = inputRate;
 
@@ -81,78 +83,221 @@ VertexInputInfo::VertexInputInfo (const std::vector<VkFormat>& vertexInputFormat
 }
 
 
+BufferTransferable::BufferTransferable (const DeviceExtra& device, size_t bufferSize, VkBufferUsageFlags usageFlags, TransferableUsage usage)
+    : device (device)
+    , bufferSize (bufferSize)
+    , bufferGPU (device.GetAllocator (), bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usageFlags, Buffer::MemoryLocation::GPU)
+{
+    if (usage == TransferableUsage::Dynamic) {
+        bufferCPU        = std::make_unique<Buffer> (device.GetAllocator (), bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | usageFlags, Buffer::MemoryLocation::CPU);
+        bufferCPUMapping = std::make_unique<MemoryMapping> (device.GetAllocator (), *bufferCPU);
+    }
+}
+
+
 void BufferTransferable::TransferFromCPUToGPU (const void* data, size_t size) const
 {
     RG_ASSERT (size == bufferSize);
-    bufferCPUMapping.Copy (data, size);
-    CopyBuffer (device, bufferCPU, bufferGPU, bufferSize);
+
+    // goes through the transfer queue when there is one
+    UploadBatch batch (device);
+
+    if (bufferCPU == nullptr) {
+        batch.CopyToBuffer (bufferGPU, data, size);
+    } else {
+        bufferCPUMapping->Copy (data, size);
+
+        VkBufferCopy copyRegion = {};
+        copyRegion.srcOffset    = 0;
+        copyRegion.dstOffset    = 0;
+        copyRegion.size         = bufferSize;
+
+        batch.CopyBuffer (*bufferCPU, bufferGPU, copyRegion);
+    }
+
+    batch.Wait ();
+}
+
+
+void BufferTransferable::TransferFromCPUToGPU (UploadBatch& batch, const void* data, size_t size) const
+{
+    RG_ASSERT (size == bufferSize);
+    batch.CopyToBuffer (bufferGPU, data, size);
 }
 
 
 void BufferTransferable::TransferFromGPUToCPU () const
 {
-    CopyBuffer (device, bufferGPU, bufferCPU, bufferSize);
+    if (RG_ERROR (bufferCPU == nullptr)) {
+        throw std::runtime_error ("static buffers have no host copy to transfer to");
+    }
+
+    CopyBuffer (device, bufferGPU, *bufferCPU, bufferSize);
 }
 
 
 void BufferTransferable::TransferFromGPUToCPU (VkDeviceSize size, VkDeviceSize offset) const
 {
-    CopyBufferPart (device, bufferGPU, bufferCPU, size, offset);
+    if (RG_ERROR (bufferCPU == nullptr)) {
+        throw std::runtime_error ("static buffers have no host copy to transfer to");
+    }
+
+    CopyBufferPart (device, bufferGPU, *bufferCPU, size, offset);
+}
+
+
+std::unique_ptr<AsyncReadback> BufferTransferable::TransferFromGPUToCPUAsync () const
+{
+    return TransferFromGPUToCPUAsync (bufferSize, 0);
+}
+
+
+std::unique_ptr<AsyncReadback> BufferTransferable::TransferFromGPUToCPUAsync (VkDeviceSize size, VkDeviceSize offset) const
+{
+    return AsyncReadback::FromBuffer (device, bufferGPU, size, offset);
+}
+
+
+std::vector<VmaAllocation> BufferTransferable::GetAllocations () const
+{
+    if (bufferCPU == nullptr) {
+        return { static_cast<VmaAllocation> (bufferGPU) };
+    }
+
+    return { static_cast<VmaAllocation> (bufferGPU), static_cast<VmaAllocation> (*bufferCPU) };
+}
+
+
+ImageTransferable::ImageTransferable (const DeviceExtra& device, size_t bufferSize, TransferableUsage usage)
+    : device (device)
+{
+    if (usage == TransferableUsage::Dynamic) {
+        bufferCPU        = std::make_unique<Buffer> (device.GetAllocator (), bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, Buffer::MemoryLocation::CPU);
+        bufferCPUMapping = std::make_unique<MemoryMapping> (device.GetAllocator (), *bufferCPU);
+    }
 }
 
 
 void ImageTransferable::CopyLayer (VkImageLayout currentImageLayout, const void* data, size_t size, uint32_t layerIndex, std::optional<VkImageLayout> nextLayout) const
 {
-    bufferCPUMapping.Copy (data, size);
+    UploadBatch batch (device);
+
+    if (bufferCPU == nullptr) {
+        batch.CopyLayerToImage (*imageGPU, currentImageLayout, data, size, layerIndex, nextLayout);
+    } else {
+        bufferCPUMapping->Copy (data, size);
+
+        VkBufferImageCopy region               = {};
+        region.bufferOffset                    = 0;
+        region.bufferRowLength                 = 0;
+        region.bufferImageHeight               = 0;
+        region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel       = 0;
+        region.imageSubresource.baseArrayLayer = layerIndex;
+        region.imageSubresource.layerCount     = 1;
+        region.imageOffset                     = { 0, 0, 0 };
+        region.imageExtent                     = { imageGPU->GetWidth (), imageGPU->GetHeight (), imageGPU->GetDepth () };
+
+        batch.CopyBufferToImage (*bufferCPU, *imageGPU, currentImageLayout, region, nextLayout);
+    }
+
+    batch.Wait ();
+}
+
+
+void ImageTransferable::CopyLayer (UploadBatch& batch, VkImageLayout currentImageLayout, const void* data, size_t size, uint32_t layerIndex, std::optional<VkImageLayout> nextLayout) const
+{
+    batch.CopyLayerToImage (*imageGPU, currentImageLayout, data, size, layerIndex, nextLayout);
+}
 
-    SingleTimeCommand commandBuffer (device);
 
-    commandBuffer.Record<CommandTranstionImage> (*imageGPU, currentImageLayout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+void ImageTransferable::CopyRegion (VkImageLayout currentImageLayout, const void* data, size_t size, VkOffset3D offset, VkExtent3D extent, uint32_t layerIndex, std::optional<VkImageLayout> nextLayout) const
+{
+    UploadBatch batch (device);
 
-    VkBufferImageCopy region               = {};
-    region.bufferOffset                    = 0;
-    region.bufferRowLength                 = 0;
-    region.bufferImageHeight               = 0;
-    region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.mipLevel       = 0;
-    region.imageSubresource.baseArrayLayer = layerIndex;
-    region.imageSubresource.layerCount     = 1;
-    region.imageOffset                     = { 0, 0, 0 };
-    region.imageExtent                     = { imageGPU->GetWidth (), imageGPU->GetHeight (), imageGPU->GetDepth () };
+    if (bufferCPU == nullptr) {
+        CopyRegion (batch, currentImageLayout, data, size, offset, extent, layerIndex, nextLayout);
+        batch.Wait ();
+        return;
+    }
 
-    imageGPU->CmdCopyBufferPartToImage (commandBuffer, bufferCPU, region);
+    const VkBufferImageCopy region = imageGPU->GetBufferImageCopyRegion (offset, extent, layerIndex);
+    if (RG_ERROR (!imageGPU->IsInside (region))) {
+        throw std::runtime_error ("region is outside of the image");
+    }
 
-    if (nextLayout.has_value ()) {
-        commandBuffer.Record<CommandTranstionImage> (*imageGPU, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, *nextLayout);
+    if (RG_ERROR (size != GetImageByteSize (imageGPU->GetFormat (), extent.width, extent.height, extent.depth))) {
+        throw std::runtime_error ("data size does not match the region");
     }
+
+    bufferCPUMapping->Copy (data, size);
+
+    batch.CopyBufferToImage (*bufferCPU, *imageGPU, currentImageLayout, region, nextLayout);
+    batch.Wait ();
+}
+
+
+void ImageTransferable::CopyRegion (UploadBatch& batch, VkImageLayout currentImageLayout, const void* data, size_t size, VkOffset3D offset, VkExtent3D extent, uint32_t layerIndex, std::optional<VkImageLayout> nextLayout) const
+{
+    if (RG_ERROR (size != GetImageByteSize (imageGPU->GetFormat (), extent.width, extent.height, extent.depth))) {
+        throw std::runtime_error ("data size does not match the region");
+    }
+
+    CopyRegions (batch, currentImageLayout, data, size, { imageGPU->GetBufferImageCopyRegion (offset, extent, layerIndex) }, nextLayout);
+}
+
+
+void ImageTransferable::CopyRegions (UploadBatch& batch, VkImageLayout currentImageLayout, const void* data, size_t size, const std::vector<VkBufferImageCopy>& regions, std::optional<VkImageLayout> nextLayout) const
+{
+    for (const VkBufferImageCopy& region : regions) {
+        if (RG_ERROR (!imageGPU->IsInside (region))) {
+            throw std::runtime_error ("region is outside of the image");
+        }
+
+        if (RG_ERROR (region.bufferOffset > size || imageGPU->GetBufferImageCopySize (region) > size - region.bufferOffset)) {
+            throw std::runtime_error ("region reads past the end of the data");
+        }
+    }
+
+    batch.CopyToImage (*imageGPU, currentImageLayout, data, size, regions, nextLayout);
+}
+
+
+std::vector<VmaAllocation> ImageTransferable::GetAllocations () const
+{
+    if (bufferCPU == nullptr) {
+        return { static_cast<VmaAllocation> (*imageGPU) };
+    }
+
+    return { static_cast<VmaAllocation> (*imageGPU), static_cast<VmaAllocation> (*bufferCPU) };
 }
 
 
-Image1DTransferable::Image1DTransferable (const DeviceExtra& device, VkFormat format, uint32_t width, VkImageUsageFlags usageFlags)
-    : ImageTransferable (device, width * GetCompontentCountFromFormat (format) * GetEachCompontentSizeFromFormat (format))
+Image1DTransferable::Image1DTransferable (const DeviceExtra& device, VkFormat format, uint32_t width, VkImageUsageFlags usageFlags, TransferableUsage usage, uint32_t mipLevels)
+    : ImageTransferable (device, GetImageByteSize (format, width, 1), usage)
 {
-    imageGPU = std::make_unique<Image1D> (device.GetAllocator (), Image::MemoryLocation::GPU, width, format, VK_IMAGE_TILING_OPTIMAL, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usageFlags);
+    imageGPU = std::make_unique<Image1D> (device.GetAllocator (), Image::MemoryLocation::GPU, width, format, VK_IMAGE_TILING_OPTIMAL, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usageFlags, 1, mipLevels);
 }
 
 
-Image2DTransferable::Image2DTransferable (const DeviceExtra& device, VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usageFlags, uint32_t arrayLayers)
-    : ImageTransferable (device, width * height * GetCompontentCountFromFormat (format) * GetEachCompontentSizeFromFormat (format))
+Image2DTransferable::Image2DTransferable (const DeviceExtra& device, VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usageFlags, uint32_t arrayLayers, TransferableUsage usage, uint32_t mipLevels)
+    : ImageTransferable (device, GetImageByteSize (format, width, height), usage)
 {
-    imageGPU = std::make_unique<Image2D> (device.GetAllocator (), Image::MemoryLocation::GPU, width, height, format, VK_IMAGE_TILING_OPTIMAL, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usageFlags, arrayLayers);
+    imageGPU = std::make_unique<Image2D> (device.GetAllocator (), Image::MemoryLocation::GPU, width, height, format, VK_IMAGE_TILING_OPTIMAL, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usageFlags, arrayLayers, mipLevels);
 }
 
 
-Image2DTransferableLinear::Image2DTransferableLinear (const DeviceExtra& device, VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usageFlags, uint32_t arrayLayers)
-    : ImageTransferable (device, width * height * GetCompontentCountFromFormat (format) * GetEachCompontentSizeFromFormat (format))
+Image2DTransferableLinear::Image2DTransferableLinear (const DeviceExtra& device, VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usageFlags, uint32_t arrayLayers, TransferableUsage usage)
+    : ImageTransferable (device, GetImageByteSize (format, width, height), usage)
 {
     imageGPU = std::make_unique<Image2D> (device.GetAllocator (), Image::MemoryLocation::GPU, width, height, format, VK_IMAGE_TILING_LINEAR, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usageFlags, arrayLayers);
 }
 
 
-Image3DTransferable::Image3DTransferable (const DeviceExtra& device, VkFormat format, uint32_t width, uint32_t height, uint32_t depth, VkImageUsageFlags usageFlags)
-    : ImageTransferable (device, width * height * depth * GetCompontentCountFromFormat (format) * GetEachCompontentSizeFromFormat (format))
+Image3DTransferable::Image3DTransferable (const DeviceExtra& device, VkFormat format, uint32_t width, uint32_t height, uint32_t depth, VkImageUsageFlags usageFlags, TransferableUsage usage, uint32_t mipLevels)
+    : ImageTransferable (device, GetImageByteSize (format, width, height, depth), usage)
 {
-    imageGPU = std::make_unique<Image3D> (device.GetAllocator (), Image::MemoryLocation::GPU, width, height, depth, format, VK_IMAGE_TILING_OPTIMAL, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usageFlags);
+    imageGPU = std::make_unique<Image3D> (device.GetAllocator (), Image::MemoryLocation::GPU, width, height, depth, format, VK_IMAGE_TILING_OPTIMAL, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usageFlags, mipLevels);
 }
 
 }
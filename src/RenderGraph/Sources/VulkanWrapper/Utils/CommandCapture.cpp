@@ -0,0 +1,265 @@
+#include "CommandCapture.hpp"
+
+#include "CommandStream.hpp"
+
+#include "Utils/Assert.hpp"
+#include "Utils/FileSystemUtils.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace RG {
+
+static const uint32_t CaptureMagic   = 0x53434752; // "RGCS"
+static const uint32_t CaptureVersion = 3;
+
+
+void CommandCapture::AddImage (const Image& image)
+{
+    const uint64_t handle = HandleToId (static_cast<VkImage> (image));
+
+    const bool alreadyAdded = std::any_of (images.begin (), images.end (), [&] (const ImageDescriptor& descriptor) { return descriptor.handle == handle; });
+    if (alreadyAdded) {
+        return;
+    }
+
+    images.push_back ({ handle, image.GetFormat (), image.GetUsage (), image.GetWidth (), image.GetHeight (), image.GetDepth (), image.GetArrayLayers (), image.GetMipLevels () });
+}
+
+
+void CommandCapture::AddBuffer (VkBuffer buffer, VkDeviceSize size)
+{
+    const uint64_t handle = HandleToId (buffer);
+
+    const bool alreadyAdded = std::any_of (buffers.begin (), buffers.end (), [&] (const BufferDescriptor& descriptor) { return descriptor.handle == handle; });
+    if (alreadyAdded) {
+        return;
+    }
+
+    buffers.push_back ({ handle, size });
+}
+
+
+void CommandCapture::AddCommandBuffer (const CommandBuffer& commandBuffer)
+{
+    if (RG_ERROR (!commandBuffer.IsRetainingRecordedCommands ())) {
+        throw std::runtime_error ("command buffer does not retain its recorded commands");
+    }
+
+    Stream& stream                = streams.emplace_back ();
+    stream.commandCount           = 0;
+    stream.uncapturedCommandCount = 0;
+
+    CommandStreamWriter streamWriter (stream.data);
+
+    std::vector<uint8_t> payload;
+    for (const Command* command : commandBuffer.recordedAbstractCommands) {
+        payload.clear ();
+
+        CommandStreamWriter payloadWriter (payload);
+        if (!command->Serialize (payloadWriter)) {
+            ++stream.uncapturedCommandCount;
+            continue;
+        }
+
+        // recorded through other captured commands
+        if (payload.empty ()) {
+            continue;
+        }
+
+        streamWriter.WriteArray (payload.data (), payload.size ());
+        ++stream.commandCount;
+    }
+
+    if (stream.uncapturedCommandCount > 0) {
+        spdlog::warn ("CommandCapture: {} commands could not be captured.", stream.uncapturedCommandCount);
+    }
+}
+
+
+std::vector<uint8_t> CommandCapture::Serialize () const
+{
+    std::vector<uint8_t> result;
+
+    CommandStreamWriter writer (result);
+
+    writer.Write (CaptureMagic);
+    writer.Write (CaptureVersion);
+
+    writer.WriteArray (images.data (), images.size ());
+    writer.WriteArray (buffers.data (), buffers.size ());
+
+    writer.Write (static_cast<uint32_t> (streams.size ()));
+    for (const Stream& stream : streams) {
+        writer.Write (stream.commandCount);
+        writer.Write (stream.uncapturedCommandCount);
+        writer.WriteArray (stream.data.data (), stream.data.size ());
+    }
+
+    return result;
+}
+
+
+CommandCapture CommandCapture::Deserialize (const std::vector<uint8_t>& data)
+{
+    CommandStreamReader reader (data.data (), data.size ());
+
+    if (RG_ERROR (reader.Read<uint32_t> () != CaptureMagic)) {
+        throw std::runtime_error ("not a command capture");
+    }
+
+    if (RG_ERROR (reader.Read<uint32_t> () != CaptureVersion)) {
+        throw std::runtime_error ("unsupported command capture version");
+    }
+
+    CommandCapture result;
+
+    result.images  = reader.ReadArray<ImageDescriptor> ();
+    result.buffers = reader.ReadArray<BufferDescriptor> ();
+
+    const uint32_t streamCount = reader.Read<uint32_t> ();
+    for (uint32_t i = 0; i < streamCount; ++i) {
+        Stream& stream                = result.streams.emplace_back ();
+        stream.commandCount           = reader.Read<uint32_t> ();
+        stream.uncapturedCommandCount = reader.Read<uint32_t> ();
+        stream.data                   = reader.ReadArray<uint8_t> ();
+    }
+
+    return result;
+}
+
+
+bool CommandCapture::SaveToFile (const std::filesystem::path& filePath) const
+{
+    return WriteBinaryFile (filePath, Serialize ());
+}
+
+
+std::optional<CommandCapture> CommandCapture::LoadFromFile (const std::filesystem::path& filePath)
+{
+    const std::optional<std::vector<char>> fileData = ReadBinaryFile (filePath);
+    if (!fileData.has_value ()) {
+        return std::nullopt;
+    }
+
+    std::vector<uint8_t> data (fileData->size ());
+    std::memcpy (data.data (), fileData->data (), fileData->size ());
+
+    return Deserialize (data);
+}
+
+
+TransferCommandReplayer::TransferCommandReplayer (const DeviceExtra& device, const CommandCapture& capture)
+    : device (device)
+    , replayedCommandCount (0)
+    , skippedCommandCount (0)
+{
+    const VkBufferUsageFlags bufferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                                           VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+
+    for (const CommandCapture::ImageDescriptor& descriptor : capture.images) {
+        const VkImageType imageType = descriptor.depth > 1 ? VK_IMAGE_TYPE_3D : VK_IMAGE_TYPE_2D;
+
+        std::unique_ptr<Image>& image = images.emplace_back (std::make_unique<Image> (device.GetAllocator (),
+                                                                                      imageType,
+                                                                                      descriptor.width,
+                                                                                      descriptor.height,
+                                                                                      descriptor.depth,
+                                                                                      descriptor.format,
+                                                                                      VK_IMAGE_TILING_OPTIMAL,
+                                                                                      descriptor.usage,
+                                                                                      descriptor.arrayLayers,
+                                                                                      Image::MemoryLocation::GPU,
+                                                                                      descriptor.mipLevels));
+
+        handleMap[descriptor.handle] = HandleToId (static_cast<VkImage> (*image));
+    }
+
+    for (const CommandCapture::BufferDescriptor& descriptor : capture.buffers) {
+        std::unique_ptr<Buffer>& buffer = buffers.emplace_back (std::make_unique<Buffer> (device.GetAllocator (), static_cast<size_t> (descriptor.size), bufferUsage, Buffer::MemoryLocation::GPU));
+
+        handleMap[descriptor.handle] = HandleToId (static_cast<VkBuffer> (*buffer));
+    }
+
+    for (const CommandCapture::Stream& stream : capture.streams) {
+        CommandBuffer& commandBuffer = *commandBuffers.emplace_back (std::make_unique<CommandBuffer> (device));
+        commandBuffer.SetName (device, "TransferCommandReplayer - CommandBuffer");
+
+        // replayed commands are not inspected, the arena can be reused between them
+        commandBuffer.SetRetainRecordedCommands (false);
+
+        CommandReplayState  state;
+        CommandStreamReader streamReader (stream.data.data (), stream.data.size ());
+
+        commandBuffer.Begin ();
+
+        for (uint32_t i = 0; i < stream.commandCount; ++i) {
+            const uint32_t payloadSize = streamReader.Read<uint32_t> ();
+            const uint8_t* payload     = streamReader.Advance (payloadSize);
+
+            CommandStreamReader commandReader (payload, payloadSize, &handleMap);
+            if (RecordSerializedCommand (commandReader, state, commandBuffer)) {
+                ++replayedCommandCount;
+            } else {
+                ++skippedCommandCount;
+            }
+        }
+
+        commandBuffer.End ();
+    }
+
+    spdlog::info ("TransferCommandReplayer: {} images, {} buffers, {} commands replayed, {} skipped.", images.size (), buffers.size (), replayedCommandCount, skippedCommandCount);
+}
+
+
+TransferCommandReplayer::~TransferCommandReplayer () = default;
+
+
+void TransferCommandReplayer::Submit (uint32_t streamIndex, VkFence fenceToSignal) const
+{
+    if (RG_ERROR (streamIndex >= commandBuffers.size ())) {
+        return;
+    }
+
+    device.GetGraphicsQueue ().Submit ({}, {}, { commandBuffers[streamIndex].get () }, {}, fenceToSignal);
+}
+
+
+const Image* TransferCommandReplayer::GetReplayedImage (VkImage capturedImage) const
+{
+    const auto it = handleMap.find (HandleToId (capturedImage));
+    if (it == handleMap.end ()) {
+        return nullptr;
+    }
+
+    for (const std::unique_ptr<Image>& image : images) {
+        if (HandleToId (static_cast<VkImage> (*image)) == it->second) {
+            return image.get ();
+        }
+    }
+
+    return nullptr;
+}
+
+
+const Buffer* TransferCommandReplayer::GetReplayedBuffer (VkBuffer capturedBuffer) const
+{
+    const auto it = handleMap.find (HandleToId (capturedBuffer));
+    if (it == handleMap.end ()) {
+        return nullptr;
+    }
+
+    for (const std::unique_ptr<Buffer>& buffer : buffers) {
+        if (HandleToId (static_cast<VkBuffer> (*buffer)) == it->second) {
+            return buffer.get ();
+        }
+    }
+
+    return nullptr;
+}
+
+} // namespace RG
@@ -0,0 +1,255 @@
+#include "DescriptorAllocator.hpp"
+
+#include "Utils/Assert.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+
+
+namespace RG {
+
+static const uint32_t MinSetsPerPool = 16;
+static const uint32_t MaxSetsPerPool = 1024;
+
+
+// bindings differing only in order describe the same layout
+static std::vector<VkDescriptorSetLayoutBinding> GetCanonicalBindings (std::vector<VkDescriptorSetLayoutBinding> bindings)
+{
+    std::sort (bindings.begin (), bindings.end (), [] (const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+        return std::tie (a.binding, a.stageFlags, a.descriptorType, a.descriptorCount) < std::tie (b.binding, b.stageFlags, b.descriptorType, b.descriptorCount);
+    });
+    return bindings;
+}
+
+
+static bool AreBindingsEqual (const std::vector<VkDescriptorSetLayoutBinding>& a, const std::vector<VkDescriptorSetLayoutBinding>& b)
+{
+    return std::equal (a.begin (), a.end (), b.begin (), b.end (), [] (const VkDescriptorSetLayoutBinding& x, const VkDescriptorSetLayoutBinding& y) {
+        return x.binding == y.binding &&
+               x.descriptorType == y.descriptorType &&
+               x.descriptorCount == y.descriptorCount &&
+               x.stageFlags == y.stageFlags &&
+               x.pImmutableSamplers == y.pImmutableSamplers;
+    });
+}
+
+
+static size_t GetBindingsHash (const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+{
+    size_t result = bindings.size ();
+
+    const auto Combine = [&] (size_t value) {
+        result ^= std::hash<size_t> {}(value) + 0x9e3779b9 + (result << 6) + (result >> 2);
+    };
+
+    for (const VkDescriptorSetLayoutBinding& binding : bindings) {
+        Combine (binding.binding);
+        Combine (binding.descriptorType);
+        Combine (binding.descriptorCount);
+        Combine (binding.stageFlags);
+    }
+
+    return result;
+}
+
+
+static std::vector<VkDescriptorPoolSize> GetPoolSizesPerSet (const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+{
+    std::vector<VkDescriptorPoolSize> result;
+
+    for (const VkDescriptorSetLayoutBinding& binding : bindings) {
+        auto found = std::find_if (result.begin (), result.end (), [&] (const VkDescriptorPoolSize& poolSize) { return poolSize.type == binding.descriptorType; });
+        if (found == result.end ()) {
+            result.push_back ({ binding.descriptorType, binding.descriptorCount });
+        } else {
+            found->descriptorCount += binding.descriptorCount;
+        }
+    }
+
+    return result;
+}
+
+
+DescriptorAllocation::DescriptorAllocation (DescriptorAllocator& allocator, DescriptorAllocator::Pool& pool, std::vector<VkDescriptorSet>&& descriptorSets)
+    : allocator (allocator)
+    , pool (pool)
+    , descriptorSets (std::move (descriptorSets))
+{
+}
+
+
+DescriptorAllocation::~DescriptorAllocation ()
+{
+    allocator.Release (pool);
+}
+
+
+DescriptorAllocator::DescriptorAllocator (VkDevice device)
+    : device (device)
+    , layoutRequestCount (0)
+    , createdPoolCount (0)
+    , poolResetCount (0)
+{
+}
+
+
+DescriptorAllocator::~DescriptorAllocator () = default;
+
+
+const DescriptorSetLayout& DescriptorAllocator::GetLayout (const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+{
+    const std::vector<VkDescriptorSetLayoutBinding> canonicalBindings = GetCanonicalBindings (bindings);
+    const size_t                                    hash              = GetBindingsHash (canonicalBindings);
+
+    std::lock_guard<std::mutex> lock (mutex);
+
+    ++layoutRequestCount;
+
+    const auto range = layoutsByHash.equal_range (hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (AreBindingsEqual (it->second->bindings, canonicalBindings)) {
+            return *it->second->layout;
+        }
+    }
+
+    std::unique_ptr<LayoutEntry> entry = std::make_unique<LayoutEntry> ();
+    entry->bindings                    = canonicalBindings;
+    entry->layout                      = std::make_unique<DescriptorSetLayout> (device, canonicalBindings);
+    entry->poolSizesPerSet             = GetPoolSizesPerSet (canonicalBindings);
+
+    spdlog::trace ("DescriptorAllocator: new layout with {} bindings, {} layouts cached.", canonicalBindings.size (), layoutsByHash.size () + 1);
+
+    const DescriptorSetLayout& result = *entry->layout;
+
+    layoutsByHandle[result] = entry.get ();
+    layoutsByHash.emplace (hash, std::move (entry));
+
+    return result;
+}
+
+
+std::unique_ptr<DescriptorAllocation> DescriptorAllocator::Allocate (const DescriptorSetLayout& layout, uint32_t count)
+{
+    std::lock_guard<std::mutex> lock (mutex);
+
+    auto foundLayout = layoutsByHandle.find (layout);
+    if (RG_ERROR (foundLayout == layoutsByHandle.end ())) {
+        throw std::runtime_error ("descriptor set layout is not owned by this allocator");
+    }
+
+    LayoutEntry& entry = *foundLayout->second;
+
+    if (RG_ERROR (entry.poolSizesPerSet.empty ())) {
+        throw std::runtime_error ("cannot allocate descriptor sets for an empty layout");
+    }
+
+    Pool* pool = nullptr;
+    for (const std::unique_ptr<Pool>& candidate : entry.pools) {
+        if (candidate->capacity - candidate->allocatedSets >= count) {
+            pool = candidate.get ();
+            break;
+        }
+    }
+
+    if (pool == nullptr) {
+        // every new pool is twice as large as the previous one
+        uint32_t capacity = entry.pools.empty () ? MinSetsPerPool : std::min (entry.pools.back ()->capacity * 2, MaxSetsPerPool);
+        capacity          = std::max (capacity, count);
+
+        std::vector<VkDescriptorPoolSize> poolSizes = entry.poolSizesPerSet;
+        for (VkDescriptorPoolSize& poolSize : poolSizes) {
+            poolSize.descriptorCount *= capacity;
+        }
+
+        std::unique_ptr<Pool> newPool = std::make_unique<Pool> ();
+        newPool->descriptorPool       = std::make_unique<DescriptorPool> (device, poolSizes, capacity);
+        newPool->capacity             = capacity;
+        newPool->allocatedSets        = 0;
+        newPool->liveAllocations      = 0;
+
+        pool = newPool.get ();
+        entry.pools.push_back (std::move (newPool));
+
+        ++createdPoolCount;
+
+        spdlog::trace ("DescriptorAllocator: new pool for {} sets.", capacity);
+    }
+
+    const std::vector<VkDescriptorSetLayout> layouts (count, layout);
+
+    std::vector<VkDescriptorSet> descriptorSets (count, VK_NULL_HANDLE);
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool              = *pool->descriptorPool;
+    allocInfo.descriptorSetCount          = count;
+    allocInfo.pSetLayouts                 = layouts.data ();
+
+    if (RG_ERROR (vkAllocateDescriptorSets (device, &allocInfo, descriptorSets.data ()) != VK_SUCCESS)) {
+        throw std::runtime_error ("failed to allocate descriptor sets!");
+    }
+
+    pool->allocatedSets += count;
+    ++pool->liveAllocations;
+
+    return std::make_unique<DescriptorAllocation> (*this, *pool, std::move (descriptorSets));
+}
+
+
+void DescriptorAllocator::Release (Pool& pool)
+{
+    std::lock_guard<std::mutex> lock (mutex);
+
+    RG_ASSERT (pool.liveAllocations > 0);
+
+    if (--pool.liveAllocations == 0) {
+        vkResetDescriptorPool (device, *pool.descriptorPool, 0);
+        pool.allocatedSets = 0;
+        ++poolResetCount;
+    }
+}
+
+
+size_t DescriptorAllocator::GetLayoutCount ()
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    return layoutsByHash.size ();
+}
+
+
+size_t DescriptorAllocator::GetLayoutRequestCount ()
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    return layoutRequestCount;
+}
+
+
+size_t DescriptorAllocator::GetPoolCount ()
+{
+    std::lock_guard<std::mutex> lock (mutex);
+
+    size_t result = 0;
+    for (const auto& [hash, entry] : layoutsByHash) {
+        result += entry->pools.size ();
+    }
+    return result;
+}
+
+
+size_t DescriptorAllocator::GetCreatedPoolCount ()
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    return createdPoolCount;
+}
+
+
+size_t DescriptorAllocator::GetPoolResetCount ()
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    return poolResetCount;
+}
+
+} // namespace RG
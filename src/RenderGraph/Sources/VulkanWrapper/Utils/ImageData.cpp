@@ -1,12 +1,17 @@
 #include "ImageData.hpp"
+#include "AsyncReadback.hpp"
 #include "Commands.hpp"
 #include "DeviceExtra.hpp"
+#include "ImageFile.hpp"
+#include "PixelConversion.hpp"
 #include "SingleTimeCommand.hpp"
+#include "UploadBatch.hpp"
 #include "VulkanUtils.hpp"
 #include "MemoryMapping.hpp"
 
 #include "Utils/Assert.hpp"
 #include "Utils/FileSystemUtils.hpp"
+#include "Utils/SIMD.hpp"
 
 #pragma warning(push, 0)
 #include "stb_image.h"
@@ -15,6 +20,9 @@
 
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
+#include <cmath>
+
 
 namespace RG {
 
@@ -22,9 +30,11 @@ const ImageData ImageData::Empty { 4, 0, 0, {} };
 
 
 ImageData::ImageData ()
-    : components { 0 }
+    : componentByteSize { 1 }
+    , components { 0 }
     , width { 0 }
     , height { 0 }
+    , depth { 1 }
 {
 }
 
@@ -33,9 +43,11 @@ ImageData::ImageData (size_t                      components,
                       size_t                      width,
                       size_t                      height,
                       const std::vector<uint8_t>& data)
-    : components { components }
+    : componentByteSize { 1 }
+    , components { components }
     , width { width }
     , height { height }
+    , depth { 1 }
     , data { data }
 {
 }
@@ -43,82 +55,50 @@ ImageData::ImageData (size_t                      components,
 
 void ImageData::FillBuffer (const DeviceExtra& device, const Image& image, uint32_t layerIndex, std::optional<VkImageLayout> currentLayout, uint8_t* buffer, size_t bufferSize)
 {
-    if (currentLayout)
-        TransitionImageLayout (device, image, *currentLayout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-
-    const size_t components        = 4;
-    const size_t componentByteSize = (GetEachCompontentSizeFromFormat (image.GetFormat ()));
-    const size_t width             = (image.GetWidth ());
-    const size_t height            = (image.GetHeight ());
-
-    RG_ASSERT (bufferSize >= width * height * components * componentByteSize);
-
-    {
-        Buffer dstBuffer (device.GetAllocator (), width * height * components * componentByteSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, Buffer::MemoryLocation::CPU);
-
-        {
-            SingleTimeCommand single (device);
-            image.CmdCopyLayerToBuffer (single, layerIndex, dstBuffer);
-        }
+    std::unique_ptr<AsyncReadback> readback = AsyncReadback::FromImageLayer (device, image, layerIndex, currentLayout);
+    readback->CopyTo (buffer, bufferSize);
+}
 
-        MemoryMapping mapping (device.GetAllocator (), dstBuffer);
-        memcpy (buffer, mapping.Get (), width * height * components * componentByteSize);
-    }
 
-    if (currentLayout)
-        TransitionImageLayout (device, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, *currentLayout);
+ImageData::ImageData (const DeviceExtra& device, const Image& image, uint32_t layerIndex, std::optional<VkImageLayout> currentLayout)
+    : ImageData (*AsyncReadback::FromImageLayer (device, image, layerIndex, currentLayout), image)
+{
 }
 
 
-ImageData::ImageData (const DeviceExtra& device, const Image& image, uint32_t layerIndex, std::optional<VkImageLayout> currentLayout)
+ImageData::ImageData (const AsyncReadback& readback, const Image& image)
     : components (4)
     , componentByteSize (GetEachCompontentSizeFromFormat (image.GetFormat ()))
     , width (image.GetWidth ())
     , height (image.GetHeight ())
+    , depth (image.GetDepth ())
 {
-    if (currentLayout)
-        TransitionImageLayout (device, image, *currentLayout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-
-    auto& dataCopy = data;
-    dataCopy.resize (width * height * components * componentByteSize);
-
-    {
-        Buffer dstBuffer (device.GetAllocator (), width * height * components * componentByteSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, Buffer::MemoryLocation::CPU);
-        
-        {
-            SingleTimeCommand single (device);
-            image.CmdCopyLayerToBuffer (single, layerIndex, dstBuffer);
-        }
-
-        MemoryMapping mapping (device.GetAllocator (), dstBuffer);
-        memcpy (dataCopy.data (), mapping.Get (), width * height * components * componentByteSize);
-    }
-
-    if (currentLayout)
-        TransitionImageLayout (device, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, *currentLayout);
+    // sized by FromImageLayer, which covers every slice of a 3D image
+    data.resize (readback.GetSize ());
+    readback.CopyTo (data.data (), data.size ());
 }
 
 
 ImageData::ImageData (const std::filesystem::path& path, const uint32_t components)
     : components (components)
     , componentByteSize (1)
+    , width (0)
+    , height (0)
+    , depth (1)
 {
-    int            w, h, readComponents;
-    unsigned char* stbiData = stbi_load (path.string ().c_str (), &w, &h, &readComponents, components);
-
-    if (RG_ERROR (stbiData == nullptr)) {
-        width  = 0;
-        height = 0;
+    const ImageFile file (path);
+    if (RG_ERROR (!file.IsValid ())) {
         return;
     }
 
-    width  = w;
-    height = h;
-
-    data.resize (width * height * components);
-    memcpy (data.data (), stbiData, width * height * components);
+    data.resize (file.GetDecodedSize (components));
+    if (RG_ERROR (!file.DecodeTo (data.data (), data.size (), components))) {
+        data.clear ();
+        return;
+    }
 
-    stbi_image_free (stbiData);
+    width  = file.GetWidth ();
+    height = file.GetHeight ();
 }
 
 
@@ -136,34 +116,55 @@ ImageData ImageData::FromDataUint (const std::vector<uint8_t>& data, uint32_t wi
 }
 
 
-static std::vector<uint8_t> ToUint (const std::vector<float>& data)
+ImageData ImageData::FromDataFloat (const std::vector<float>& data, uint32_t width, uint32_t height, uint32_t components)
 {
-    std::vector<uint8_t> result;
-    result.reserve (data.size ());
-    for (float f : data) {
-        uint8_t val;
-        if (f < 0.f) {
-            val = 0;
-        } else if (f > 1.f) {
-            val = 255;
-        } else {
-            val = static_cast<uint8_t> (f * 255.f);
-        }
-        result.push_back (val);
-    }
-    return result;
+    std::vector<uint8_t> converted (data.size ());
+    FloatToUnorm8 (data.data (), converted.data (), data.size ());
+    return FromDataUint (converted, width, height, components);
 }
 
 
-ImageData ImageData::FromDataFloat (const std::vector<float>& data, uint32_t width, uint32_t height, uint32_t components)
+ImageData ImageData::FromImageLayerConverted (const DeviceExtra& device, const Image& image, uint32_t layerIndex, VkFormat targetFormat, std::optional<VkImageLayout> currentLayout)
 {
-    return FromDataUint (ToUint (data), width, height, components);
+    const VkFormat sourceFormat = image.GetFormat ();
+
+    std::unique_ptr<AsyncReadback> readback;
+    bool                           swapRedBlue = false;
+
+    if (sourceFormat == targetFormat) {
+        readback = AsyncReadback::FromImageLayer (device, image, layerIndex, currentLayout);
+    } else if (AsyncReadback::CanConvert (device, sourceFormat, targetFormat)) {
+        readback = AsyncReadback::FromImageLayerConverted (device, image, layerIndex, targetFormat, currentLayout);
+    } else {
+        // without blit support only the channel order is converted, on the CPU
+        if (RG_ERROR (GetRGBAOrderFormat (sourceFormat) != targetFormat)) {
+            throw std::runtime_error ("the image can not be converted to the requested format");
+        }
+
+        readback    = AsyncReadback::FromImageLayer (device, image, layerIndex, currentLayout);
+        swapRedBlue = true;
+    }
+
+    ImageData result;
+    result.components        = GetCompontentCountFromFormat (targetFormat);
+    result.componentByteSize = GetEachCompontentSizeFromFormat (targetFormat);
+    result.width             = image.GetWidth ();
+    result.height            = image.GetHeight ();
+    result.depth             = image.GetDepth ();
+    result.data.resize (readback->GetSize ());
+    readback->CopyTo (result.data.data (), result.data.size ());
+
+    if (swapRedBlue) {
+        SwizzleRGBA8 (result.data.data (), result.width * result.height * result.depth, { 2, 1, 0, 3 });
+    }
+
+    return result;
 }
 
 
 bool ImageData::operator== (const ImageData& other) const
 {
-    if (width != other.width || height != other.height) {
+    if (width != other.width || height != other.height || depth != other.depth) {
         return false;
     }
 
@@ -173,76 +174,320 @@ bool ImageData::operator== (const ImageData& other) const
 }
 
 
+namespace {
+
+struct DifferenceStatistics {
+    uint32_t maxAbsError     = 0;
+    uint64_t squaredErrorSum = 0;
+    size_t   mismatchCount   = 0;
+};
+
+} // namespace
+
+
+// small enough for the 32 bit lane accumulators of the kernels not to overflow
+static const size_t ComparisonChunkPixelCount = 4096;
+
+
+// any pixel size, diff pixels get the largest difference in the first byte and 255 in the fourth of 4 byte pixels
+static void CompareChunkScalar (const uint8_t* first, const uint8_t* second, uint8_t* diff, size_t pixelCount, size_t pixelSize, uint32_t tolerance, DifferenceStatistics& statistics)
+{
+    for (size_t pixel = 0; pixel < pixelCount; ++pixel) {
+        uint32_t differenceSum = 0;
+        uint32_t maxDifference = 0;
+
+        for (size_t component = 0; component < pixelSize; ++component) {
+            const size_t   index      = pixel * pixelSize + component;
+            const uint32_t difference = static_cast<uint32_t> (std::abs (static_cast<int32_t> (first[index]) - static_cast<int32_t> (second[index])));
+
+            differenceSum += difference;
+            maxDifference = std::max (maxDifference, difference);
+            statistics.squaredErrorSum += difference * difference;
+        }
+
+        statistics.maxAbsError = std::max (statistics.maxAbsError, maxDifference);
+
+        if (differenceSum > tolerance) {
+            ++statistics.mismatchCount;
+
+            if (diff != nullptr) {
+                diff[pixel * pixelSize] = static_cast<uint8_t> (maxDifference);
+                if (pixelSize == 4) {
+                    diff[pixel * pixelSize + 3] = 255;
+                }
+            }
+        }
+    }
+}
+
+
+#if defined(SIMD_SSE2)
+
+static void CompareRGBA8ChunkSSE2 (const uint8_t* first, const uint8_t* second, uint8_t* diff, size_t pixelCount, uint32_t tolerance, DifferenceStatistics& statistics)
+{
+    const __m128i zero      = _mm_setzero_si128 ();
+    const __m128i ones      = _mm_set1_epi16 (1);
+    const __m128i threshold = _mm_set1_epi32 (static_cast<int32_t> (std::min (tolerance, 1024u)));
+    const __m128i redMask   = _mm_set1_epi32 (0xff);
+    const __m128i alpha     = _mm_set1_epi32 (static_cast<int32_t> (0xff000000));
+
+    __m128i maxAbsError     = zero;
+    __m128i squaredErrorSum = zero;
+    __m128i mismatchCount   = zero;
+
+    size_t pixel = 0;
+    for (; pixel + 4 <= pixelCount; pixel += 4) {
+        const __m128i a       = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (first + pixel * 4));
+        const __m128i b       = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (second + pixel * 4));
+        const __m128i absDiff = _mm_or_si128 (_mm_subs_epu8 (a, b), _mm_subs_epu8 (b, a));
+
+        maxAbsError = _mm_max_epu8 (maxAbsError, absDiff);
+
+        const __m128i low  = _mm_unpacklo_epi8 (absDiff, zero);
+        const __m128i high = _mm_unpackhi_epi8 (absDiff, zero);
+
+        squaredErrorSum = _mm_add_epi32 (squaredErrorSum, _mm_add_epi32 (_mm_madd_epi16 (low, low), _mm_madd_epi16 (high, high)));
+
+        // madd sums component pairs, the 64 bit shift adds the pairs, pixel sums end up in the even lanes
+        __m128i lowSums  = _mm_madd_epi16 (low, ones);
+        __m128i highSums = _mm_madd_epi16 (high, ones);
+        lowSums          = _mm_add_epi32 (lowSums, _mm_srli_epi64 (lowSums, 32));
+        highSums         = _mm_add_epi32 (highSums, _mm_srli_epi64 (highSums, 32));
+
+        const __m128i pixelSums = _mm_castps_si128 (_mm_shuffle_ps (_mm_castsi128_ps (lowSums), _mm_castsi128_ps (highSums), _MM_SHUFFLE (2, 0, 2, 0)));
+        const __m128i mismatch  = _mm_cmpgt_epi32 (pixelSums, threshold);
+
+        mismatchCount = _mm_sub_epi32 (mismatchCount, mismatch);
+
+        if (diff != nullptr) {
+            __m128i pixelMax = _mm_max_epu8 (absDiff, _mm_srli_epi32 (absDiff, 8));
+            pixelMax         = _mm_max_epu8 (pixelMax, _mm_srli_epi32 (pixelMax, 16));
+
+            const __m128i diffPixels = _mm_and_si128 (mismatch, _mm_or_si128 (_mm_and_si128 (pixelMax, redMask), alpha));
+            _mm_storeu_si128 (reinterpret_cast<__m128i*> (diff + pixel * 4), diffPixels);
+        }
+    }
+
+    alignas (16) uint8_t  maxLanes[16];
+    alignas (16) uint32_t squaredLanes[4];
+    alignas (16) uint32_t mismatchLanes[4];
+    _mm_store_si128 (reinterpret_cast<__m128i*> (maxLanes), maxAbsError);
+    _mm_store_si128 (reinterpret_cast<__m128i*> (squaredLanes), squaredErrorSum);
+    _mm_store_si128 (reinterpret_cast<__m128i*> (mismatchLanes), mismatchCount);
+
+    for (uint32_t lane = 0; lane < 16; ++lane) {
+        statistics.maxAbsError = std::max<uint32_t> (statistics.maxAbsError, maxLanes[lane]);
+    }
+    for (uint32_t lane = 0; lane < 4; ++lane) {
+        statistics.squaredErrorSum += squaredLanes[lane];
+        statistics.mismatchCount += mismatchLanes[lane];
+    }
+
+    CompareChunkScalar (first + pixel * 4, second + pixel * 4, diff != nullptr ? diff + pixel * 4 : nullptr, pixelCount - pixel, 4, tolerance, statistics);
+}
+
+#endif
+
+
+#if defined(SIMD_AVX2)
+
+// same as the SSE2 kernel, unpacking and shuffling stay within 128 bit halves so pixel order is kept
+static void CompareRGBA8ChunkAVX2 (const uint8_t* first, const uint8_t* second, uint8_t* diff, size_t pixelCount, uint32_t tolerance, DifferenceStatistics& statistics)
+{
+    const __m256i zero      = _mm256_setzero_si256 ();
+    const __m256i ones      = _mm256_set1_epi16 (1);
+    const __m256i threshold = _mm256_set1_epi32 (static_cast<int32_t> (std::min (tolerance, 1024u)));
+    const __m256i redMask   = _mm256_set1_epi32 (0xff);
+    const __m256i alpha     = _mm256_set1_epi32 (static_cast<int32_t> (0xff000000));
+
+    __m256i maxAbsError     = zero;
+    __m256i squaredErrorSum = zero;
+    __m256i mismatchCount   = zero;
+
+    size_t pixel = 0;
+    for (; pixel + 8 <= pixelCount; pixel += 8) {
+        const __m256i a       = _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (first + pixel * 4));
+        const __m256i b       = _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (second + pixel * 4));
+        const __m256i absDiff = _mm256_or_si256 (_mm256_subs_epu8 (a, b), _mm256_subs_epu8 (b, a));
+
+        maxAbsError = _mm256_max_epu8 (maxAbsError, absDiff);
+
+        const __m256i low  = _mm256_unpacklo_epi8 (absDiff, zero);
+        const __m256i high = _mm256_unpackhi_epi8 (absDiff, zero);
+
+        squaredErrorSum = _mm256_add_epi32 (squaredErrorSum, _mm256_add_epi32 (_mm256_madd_epi16 (low, low), _mm256_madd_epi16 (high, high)));
+
+        __m256i lowSums  = _mm256_madd_epi16 (low, ones);
+        __m256i highSums = _mm256_madd_epi16 (high, ones);
+        lowSums          = _mm256_add_epi32 (lowSums, _mm256_srli_epi64 (lowSums, 32));
+        highSums         = _mm256_add_epi32 (highSums, _mm256_srli_epi64 (highSums, 32));
+
+        const __m256i pixelSums = _mm256_castps_si256 (_mm256_shuffle_ps (_mm256_castsi256_ps (lowSums), _mm256_castsi256_ps (highSums), _MM_SHUFFLE (2, 0, 2, 0)));
+        const __m256i mismatch  = _mm256_cmpgt_epi32 (pixelSums, threshold);
+
+        mismatchCount = _mm256_sub_epi32 (mismatchCount, mismatch);
+
+        if (diff != nullptr) {
+            __m256i pixelMax = _mm256_max_epu8 (absDiff, _mm256_srli_epi32 (absDiff, 8));
+            pixelMax         = _mm256_max_epu8 (pixelMax, _mm256_srli_epi32 (pixelMax, 16));
+
+            const __m256i diffPixels = _mm256_and_si256 (mismatch, _mm256_or_si256 (_mm256_and_si256 (pixelMax, redMask), alpha));
+            _mm256_storeu_si256 (reinterpret_cast<__m256i*> (diff + pixel * 4), diffPixels);
+        }
+    }
+
+    alignas (32) uint8_t  maxLanes[32];
+    alignas (32) uint32_t squaredLanes[8];
+    alignas (32) uint32_t mismatchLanes[8];
+    _mm256_store_si256 (reinterpret_cast<__m256i*> (maxLanes), maxAbsError);
+    _mm256_store_si256 (reinterpret_cast<__m256i*> (squaredLanes), squaredErrorSum);
+    _mm256_store_si256 (reinterpret_cast<__m256i*> (mismatchLanes), mismatchCount);
+
+    for (uint32_t lane = 0; lane < 32; ++lane) {
+        statistics.maxAbsError = std::max<uint32_t> (statistics.maxAbsError, maxLanes[lane]);
+    }
+    for (uint32_t lane = 0; lane < 8; ++lane) {
+        statistics.squaredErrorSum += squaredLanes[lane];
+        statistics.mismatchCount += mismatchLanes[lane];
+    }
+
+    CompareRGBA8ChunkSSE2 (first + pixel * 4, second + pixel * 4, diff != nullptr ? diff + pixel * 4 : nullptr, pixelCount - pixel, tolerance, statistics);
+}
+
+#endif
+
+
+#if defined(SIMD_NEON)
+
+static void CompareRGBA8ChunkNEON (const uint8_t* first, const uint8_t* second, uint8_t* diff, size_t pixelCount, uint32_t tolerance, DifferenceStatistics& statistics)
+{
+    const uint32x4_t threshold = vdupq_n_u32 (tolerance);
+    const uint32x4_t redMask   = vdupq_n_u32 (0xff);
+    const uint32x4_t alpha     = vdupq_n_u32 (0xff000000);
+
+    uint8x16_t maxAbsError     = vdupq_n_u8 (0);
+    uint32x4_t squaredErrorSum = vdupq_n_u32 (0);
+    uint32x4_t mismatchCount   = vdupq_n_u32 (0);
+
+    size_t pixel = 0;
+    for (; pixel + 4 <= pixelCount; pixel += 4) {
+        const uint8x16_t absDiff = vabdq_u8 (vld1q_u8 (first + pixel * 4), vld1q_u8 (second + pixel * 4));
+
+        maxAbsError = vmaxq_u8 (maxAbsError, absDiff);
+
+        squaredErrorSum = vpadalq_u16 (squaredErrorSum, vmull_u8 (vget_low_u8 (absDiff), vget_low_u8 (absDiff)));
+        squaredErrorSum = vpadalq_u16 (squaredErrorSum, vmull_u8 (vget_high_u8 (absDiff), vget_high_u8 (absDiff)));
+
+        const uint32x4_t pixelSums = vpaddlq_u16 (vpaddlq_u8 (absDiff));
+        const uint32x4_t mismatch  = vcgtq_u32 (pixelSums, threshold);
+
+        mismatchCount = vsubq_u32 (mismatchCount, mismatch);
+
+        if (diff != nullptr) {
+            uint8x16_t pixelMax = vmaxq_u8 (absDiff, vreinterpretq_u8_u32 (vshrq_n_u32 (vreinterpretq_u32_u8 (absDiff), 8)));
+            pixelMax            = vmaxq_u8 (pixelMax, vreinterpretq_u8_u32 (vshrq_n_u32 (vreinterpretq_u32_u8 (pixelMax), 16)));
+
+            const uint32x4_t diffPixels = vandq_u32 (mismatch, vorrq_u32 (vandq_u32 (vreinterpretq_u32_u8 (pixelMax), redMask), alpha));
+            vst1q_u8 (diff + pixel * 4, vreinterpretq_u8_u32 (diffPixels));
+        }
+    }
+
+    statistics.maxAbsError = std::max<uint32_t> (statistics.maxAbsError, vmaxvq_u8 (maxAbsError));
+    statistics.squaredErrorSum += vaddlvq_u32 (squaredErrorSum);
+    statistics.mismatchCount += vaddvq_u32 (mismatchCount);
+
+    CompareChunkScalar (first + pixel * 4, second + pixel * 4, diff != nullptr ? diff + pixel * 4 : nullptr, pixelCount - pixel, 4, tolerance, statistics);
+}
+
+#endif
+
+
+static void CompareChunk (const uint8_t* first, const uint8_t* second, uint8_t* diff, size_t pixelCount, size_t pixelSize, uint32_t tolerance, bool useSIMD, DifferenceStatistics& statistics)
+{
+    // 8 bit RGBA is what readbacks and reference images use, other layouts take the scalar path
+#if defined(SIMD_AVX2)
+    if (useSIMD && pixelSize == 4) {
+        CompareRGBA8ChunkAVX2 (first, second, diff, pixelCount, tolerance, statistics);
+        return;
+    }
+#elif defined(SIMD_SSE2)
+    if (useSIMD && pixelSize == 4) {
+        CompareRGBA8ChunkSSE2 (first, second, diff, pixelCount, tolerance, statistics);
+        return;
+    }
+#elif defined(SIMD_NEON)
+    if (useSIMD && pixelSize == 4) {
+        CompareRGBA8ChunkNEON (first, second, diff, pixelCount, tolerance, statistics);
+        return;
+    }
+#else
+    (void)useSIMD;
+#endif
+
+    CompareChunkScalar (first, second, diff, pixelCount, pixelSize, tolerance, statistics);
+}
+
+
 ImageData::ComparisonResult ImageData::CompareTo (const ImageData& other) const
 {
-    if (RG_ERROR (width != other.width || height != other.height)) {
-        return ComparisonResult { false, nullptr };
+    return CompareTo (other, ComparisonSettings ());
+}
+
+
+ImageData::ComparisonResult ImageData::CompareTo (const ImageData& other, const ComparisonSettings& settings) const
+{
+    const size_t pixelCount = width * height * depth;
+    const size_t pixelSize  = components * componentByteSize;
+
+    if (RG_ERROR (width != other.width || height != other.height || depth != other.depth || data.size () != other.data.size () || data.size () != pixelCount * pixelSize)) {
+        return ComparisonResult ();
     }
 
+    ComparisonResult result;
+    result.equal = true;
+
     if (*this == other) {
-        return ComparisonResult { true, nullptr };
+        return result;
     }
 
-    ComparisonResult result { true, std::make_unique<ImageData> (other) };
-    std::fill (result.diffImage->data.begin (), result.diffImage->data.end (), static_cast<uint8_t> (0));
-
-    if (components == 4) {
-        for (size_t i = 0; i < width * height * components; i += components) {
-            if (memcmp (&data[i], &other.data[i], components) != 0) {
-                const std::array<uint8_t, 4> pixel { data[i + 0], data[i + 1], data[i + 2], data[i + 3] };
-                const std::array<uint8_t, 4> pixelOther { other.data[i + 0], other.data[i + 1], other.data[i + 2], other.data[i + 3] };
-
-                const size_t diffSum = std::abs (pixel[0] - pixelOther[0]) + std::abs (pixel[1] - pixelOther[1]) + std::abs (pixel[2] - pixelOther[2]) + std::abs (pixel[3] - pixelOther[3]);
-
-                if (diffSum > 1) {
-                    const uint8_t diffR = static_cast<uint8_t> (std::abs (other.data[i + 0] - data[i + 0]));
-                    const uint8_t diffG = static_cast<uint8_t> (std::abs (other.data[i + 1] - data[i + 1]));
-                    const uint8_t diffB = static_cast<uint8_t> (std::abs (other.data[i + 2] - data[i + 2]));
-                    const uint8_t diffA = static_cast<uint8_t> (std::abs (other.data[i + 3] - data[i + 3]));
-                    const uint8_t maxDiff = std::max ({ diffR, diffG, diffB, diffA });
-                    const double  maxDiffPerc = static_cast<double> (maxDiff) / 255;
-
-                    result.diffImage->data[i + 0] = static_cast <uint8_t> (255.0 * maxDiffPerc);
-                    result.diffImage->data[i + 1] = 0;
-                    result.diffImage->data[i + 2] = 0;
-                    result.diffImage->data[i + 3] = 255;
-                    result.equal                  = false;
-                }
-            }
-        }
-    } else if (components == 3) {
-        for (size_t i = 0; i < width * height * components; i += components) {
-            if (memcmp (&data[i], &other.data[i], components) != 0) {
-                const std::array<uint8_t, 3> pixel { data[i + 0], data[i + 1], data[i + 2] };
-                const std::array<uint8_t, 3> pixelOther { other.data[i + 0], other.data[i + 1], other.data[i + 2] };
-
-                const size_t diffSum = std::abs (pixel[0] - pixelOther[0]) + std::abs (pixel[1] - pixelOther[1]) + std::abs (pixel[2] - pixelOther[2]);
-
-                if (diffSum > 1) {
-                    const uint8_t diffR       = static_cast<uint8_t> (std::abs (other.data[i + 0] - data[i + 0]));
-                    const uint8_t diffG       = static_cast<uint8_t> (std::abs (other.data[i + 1] - data[i + 1]));
-                    const uint8_t diffB       = static_cast<uint8_t> (std::abs (other.data[i + 2] - data[i + 2]));
-                    const uint8_t maxDiff     = std::max ({ diffR, diffG, diffB });
-                    const double  maxDiffPerc = static_cast<double> (maxDiff) / 255;
-
-                    result.diffImage->data[i + 0] = static_cast<uint8_t> (255.0 * maxDiffPerc);
-                    result.diffImage->data[i + 1] = 0;
-                    result.diffImage->data[i + 2] = 0;
-                    result.equal                  = false;
-                }
-            }
+    if (settings.createDiffImage) {
+        result.diffImage = std::make_unique<ImageData> (other);
+        std::fill (result.diffImage->data.begin (), result.diffImage->data.end (), static_cast<uint8_t> (0));
+    }
+
+    const bool exitEarly = !settings.createDiffImage && !settings.computeMetrics;
+
+    DifferenceStatistics statistics;
+
+    for (size_t chunkStart = 0; chunkStart < pixelCount; chunkStart += ComparisonChunkPixelCount) {
+        const size_t chunkPixelCount = std::min (ComparisonChunkPixelCount, pixelCount - chunkStart);
+        const size_t offset          = chunkStart * pixelSize;
+
+        uint8_t* diff = (result.diffImage != nullptr) ? result.diffImage->data.data () + offset : nullptr;
+
+        CompareChunk (&data[offset], &other.data[offset], diff, chunkPixelCount, pixelSize, settings.tolerance, settings.useSIMD, statistics);
+
+        if (exitEarly && statistics.mismatchCount > 0) {
+            break;
         }
-    } else {
-        RG_BREAK_STR ("not supported components");
     }
-    
+
+    result.equal         = statistics.mismatchCount == 0;
+    result.maxAbsError   = statistics.maxAbsError;
+    result.mismatchCount = statistics.mismatchCount;
+
+    if (statistics.squaredErrorSum > 0) {
+        const double meanSquaredError = static_cast<double> (statistics.squaredErrorSum) / static_cast<double> (data.size ());
+        result.psnr                   = 10.0 * std::log10 (255.0 * 255.0 / meanSquaredError);
+    }
+
     return result;
 }
 
 
 uint32_t ImageData::GetByteCount () const
 {
-    RG_ASSERT (data.size () == width * height * components);
+    RG_ASSERT (data.size () == width * height * depth * components);
     return static_cast<uint32_t> (data.size ());
 }
 
@@ -250,6 +495,7 @@ uint32_t ImageData::GetByteCount () const
 void ImageData::SaveTo (const std::filesystem::path& path) const
 {
     RG::EnsureParentFolderExists (path);
+    RG_ASSERT (depth == 1);
     RG_ASSERT (width * height * components * componentByteSize == data.size ());
 
     const int result = stbi_write_png (path.string ().c_str (),
@@ -269,26 +515,37 @@ void ImageData::SaveTo (const std::filesystem::path& path) const
 
 void ImageData::UploadTo (const DeviceExtra& device, const Image& image, std::optional<VkImageLayout> currentLayout) const
 {
-    if (currentLayout)
-        TransitionImageLayout (device, image, *currentLayout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-    {
-        Buffer stagingCPUMemory (device.GetAllocator (), width * height * components, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, Buffer::MemoryLocation::CPU);
-
-        MemoryMapping bm (device.GetAllocator (), stagingCPUMemory);
-        bm.Copy (data);
+    UploadBatch batch (device);
+    UploadTo (batch, image, currentLayout);
+    batch.Wait ();
+}
 
-        CopyBufferToImage (device, stagingCPUMemory, image, static_cast<uint32_t> (width), static_cast<uint32_t> (height));
-    }
 
-    if (currentLayout)
-        TransitionImageLayout (device, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, *currentLayout);
+void ImageData::UploadTo (UploadBatch& batch, const Image& image, std::optional<VkImageLayout> currentLayout) const
+{
+    VkBufferImageCopy region               = {};
+    region.bufferOffset                    = 0;
+    region.bufferRowLength                 = 0;
+    region.bufferImageHeight               = 0;
+    region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel       = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount     = 1;
+    region.imageOffset                     = { 0, 0, 0 };
+    region.imageExtent                     = { static_cast<uint32_t> (width), static_cast<uint32_t> (height), static_cast<uint32_t> (depth) };
+
+    batch.CopyToImage (image, currentLayout.value_or (VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL), data.data (), data.size (), region, currentLayout);
 }
 
 
 void ImageData::ConvertBGRToRGB ()
 {
-    for (size_t i = 0; i < width * height * components; i += components) {
+    if (components == 4 && componentByteSize == 1) {
+        SwizzleRGBA8 (data.data (), width * height * depth, { 2, 1, 0, 3 });
+        return;
+    }
+
+    for (size_t i = 0; i < width * height * depth * components; i += components) {
         std::swap (data[i + 0], data[i + 2]);
     }
 }
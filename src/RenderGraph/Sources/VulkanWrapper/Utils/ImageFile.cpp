@@ -0,0 +1,162 @@
+#include "ImageFile.hpp"
+
+#include "UploadBatch.hpp"
+#include "VulkanUtils.hpp"
+
+#include "Utils/Assert.hpp"
+
+#pragma warning(push, 0)
+#include "stb_image.h"
+#pragma warning(pop)
+
+#include "spdlog/spdlog.h"
+
+#include <cctype>
+#include <cstring>
+
+
+namespace RG {
+
+static bool ReadPNMHeaderValue (const uint8_t* data, size_t size, size_t& position, uint32_t& value)
+{
+    // whitespace and comments are allowed between header values
+    while (position < size) {
+        if (data[position] == '#') {
+            while (position < size && data[position] != '\n') {
+                ++position;
+            }
+        } else if (std::isspace (data[position])) {
+            ++position;
+        } else {
+            break;
+        }
+    }
+
+    if (position >= size || !std::isdigit (data[position])) {
+        return false;
+    }
+
+    value = 0;
+    while (position < size && std::isdigit (data[position])) {
+        value = value * 10 + static_cast<uint32_t> (data[position] - '0');
+        ++position;
+    }
+
+    return true;
+}
+
+
+// offset of the pixels in a binary PGM (P5) or PPM (P6) file with 8 bit components
+static std::optional<size_t> GetPNMRawPixelsOffset (const uint8_t* data, size_t size, uint32_t width, uint32_t height, uint32_t fileComponents)
+{
+    if (size < 2 || data[0] != 'P' || (data[1] != '5' && data[1] != '6')) {
+        return std::nullopt;
+    }
+
+    size_t   position = 2;
+    uint32_t headerWidth, headerHeight, maxValue;
+    if (!ReadPNMHeaderValue (data, size, position, headerWidth) || !ReadPNMHeaderValue (data, size, position, headerHeight) || !ReadPNMHeaderValue (data, size, position, maxValue)) {
+        return std::nullopt;
+    }
+
+    // exactly one whitespace character separates the header from the pixels
+    ++position;
+
+    if (headerWidth != width || headerHeight != height || maxValue != 255) {
+        return std::nullopt;
+    }
+
+    if (position + static_cast<size_t> (width) * height * fileComponents > size) {
+        return std::nullopt;
+    }
+
+    return position;
+}
+
+
+ImageFile::ImageFile (const std::filesystem::path& filePath)
+    : file (filePath)
+    , width (0)
+    , height (0)
+    , fileComponents (0)
+{
+    if (RG_ERROR (!file.IsValid ())) {
+        return;
+    }
+
+    int w, h, c;
+    if (RG_ERROR (stbi_info_from_memory (file.GetData (), static_cast<int> (file.GetSize ()), &w, &h, &c) != 1)) {
+        spdlog::error ("Unsupported image file {}.", filePath.string ());
+        return;
+    }
+
+    width          = static_cast<uint32_t> (w);
+    height         = static_cast<uint32_t> (h);
+    fileComponents = static_cast<uint32_t> (c);
+
+    rawPixelsOffset = GetPNMRawPixelsOffset (file.GetData (), file.GetSize (), width, height, fileComponents);
+}
+
+
+ImageFile::~ImageFile () = default;
+
+
+size_t ImageFile::GetDecodedSize (uint32_t components) const
+{
+    return static_cast<size_t> (width) * height * components;
+}
+
+
+bool ImageFile::IsRaw (uint32_t components) const
+{
+    return rawPixelsOffset.has_value () && components == fileComponents;
+}
+
+
+bool ImageFile::DecodeTo (void* destination, size_t destinationSize, uint32_t components) const
+{
+    if (RG_ERROR (!IsValid () || destinationSize < GetDecodedSize (components))) {
+        return false;
+    }
+
+    if (IsRaw (components)) {
+        memcpy (destination, file.GetData () + *rawPixelsOffset, GetDecodedSize (components));
+        return true;
+    }
+
+    // stb always decodes into memory of its own, that is released right after the copy
+    int            w, h, readComponents;
+    unsigned char* stbiData = stbi_load_from_memory (file.GetData (), static_cast<int> (file.GetSize ()), &w, &h, &readComponents, static_cast<int> (components));
+    if (RG_ERROR (stbiData == nullptr)) {
+        return false;
+    }
+
+    memcpy (destination, stbiData, GetDecodedSize (components));
+
+    stbi_image_free (stbiData);
+
+    return true;
+}
+
+
+bool ImageFile::UploadTo (UploadBatch& batch, const Image& image, VkImageLayout currentLayout, uint32_t layerIndex, std::optional<VkImageLayout> nextLayout) const
+{
+    if (RG_ERROR (image.GetWidth () != width || image.GetHeight () != height || GetEachCompontentSizeFromFormat (image.GetFormat ()) != 1)) {
+        return false;
+    }
+
+    const uint32_t components = GetCompontentCountFromFormat (image.GetFormat ());
+    const size_t   size       = GetDecodedSize (components);
+
+    void* staging = batch.ReserveImageUpload (image, currentLayout, size, image.GetFullBufferImageCopyLayer (layerIndex), nextLayout);
+
+    if (!DecodeTo (staging, size, components)) {
+        // the reserved region is still copied, keep its content defined
+        memset (staging, 0, size);
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace RG
@@ -0,0 +1,115 @@
+#include "MemoryUsage.hpp"
+
+#include "Utils/Assert.hpp"
+
+#include <map>
+#include <mutex>
+#include <utility>
+
+
+namespace RG {
+
+namespace {
+
+// size of every VkDeviceMemory allocated by the allocators, vma does not tell which allocations own their memory
+std::mutex                                                      deviceMemoryMutex;
+std::map<std::pair<VmaAllocator, VkDeviceMemory>, VkDeviceSize> deviceMemorySizes;
+
+
+VKAPI_ATTR void VKAPI_CALL OnDeviceMemoryAllocated (VmaAllocator allocator, uint32_t, VkDeviceMemory memory, VkDeviceSize size)
+{
+    std::lock_guard<std::mutex> lock (deviceMemoryMutex);
+    deviceMemorySizes[{ allocator, memory }] = size;
+}
+
+
+VKAPI_ATTR void VKAPI_CALL OnDeviceMemoryFreed (VmaAllocator allocator, uint32_t, VkDeviceMemory memory, VkDeviceSize)
+{
+    std::lock_guard<std::mutex> lock (deviceMemoryMutex);
+    deviceMemorySizes.erase ({ allocator, memory });
+}
+
+
+// a block is always larger than the allocations placed in it, so an allocation covering its whole memory is dedicated
+bool OwnsDeviceMemory (VmaAllocator allocator, const VmaAllocationInfo& allocInfo)
+{
+    if (allocInfo.offset != 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock (deviceMemoryMutex);
+
+    auto found = deviceMemorySizes.find ({ allocator, allocInfo.deviceMemory });
+    return found != deviceMemorySizes.end () && found->second == allocInfo.size;
+}
+
+} // namespace
+
+
+extern const VmaDeviceMemoryCallbacks DeviceMemoryCallbacks = { OnDeviceMemoryAllocated, OnDeviceMemoryFreed };
+
+
+void SetAllocationName (VmaAllocator allocator, VmaAllocation allocation, const std::string& name)
+{
+    if (RG_ERROR (allocation == VK_NULL_HANDLE)) {
+        return;
+    }
+
+    vmaSetAllocationUserData (allocator, allocation, const_cast<char*> (name.c_str ()));
+}
+
+
+std::string GetAllocationName (VmaAllocator allocator, VmaAllocation allocation)
+{
+    VmaAllocationInfo allocInfo = {};
+    vmaGetAllocationInfo (allocator, allocation, &allocInfo);
+
+    if (allocInfo.pUserData == nullptr) {
+        return "";
+    }
+
+    return static_cast<const char*> (allocInfo.pUserData);
+}
+
+
+AllocationUsage GetAllocationUsage (VmaAllocator allocator, VmaAllocation allocation)
+{
+    VmaAllocationInfo allocInfo = {};
+    vmaGetAllocationInfo (allocator, allocation, &allocInfo);
+
+    VkMemoryPropertyFlags memoryFlags = 0;
+    vmaGetMemoryTypeProperties (allocator, allocInfo.memoryType, &memoryFlags);
+
+    AllocationUsage result;
+    result.size        = allocInfo.size;
+    result.deviceLocal = (memoryFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0;
+    result.dedicated   = OwnsDeviceMemory (allocator, allocInfo);
+    return result;
+}
+
+
+std::vector<HeapUsage> GetHeapUsages (VmaAllocator allocator)
+{
+    const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+    vmaGetMemoryProperties (allocator, &memoryProperties);
+
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+    vmaGetBudget (allocator, budgets);
+
+    std::vector<HeapUsage> result;
+    for (uint32_t heapIndex = 0; heapIndex < memoryProperties->memoryHeapCount; ++heapIndex) {
+        const VkMemoryHeap& heap = memoryProperties->memoryHeaps[heapIndex];
+
+        HeapUsage& heapUsage      = result.emplace_back ();
+        heapUsage.size            = heap.size;
+        heapUsage.deviceLocal     = (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        heapUsage.blockBytes      = budgets[heapIndex].blockBytes;
+        heapUsage.allocationBytes = budgets[heapIndex].allocationBytes;
+        heapUsage.usage           = budgets[heapIndex].usage;
+        heapUsage.budget          = budgets[heapIndex].budget;
+    }
+
+    return result;
+}
+
+} // namespace RG
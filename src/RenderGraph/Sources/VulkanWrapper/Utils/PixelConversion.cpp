@@ -0,0 +1,455 @@
+#include "PixelConversion.hpp"
+
+#include "Utils/Assert.hpp"
+#include "Utils/SIMD.hpp"
+
+#include <cmath>
+
+
+namespace RG {
+
+// linear values up to this are encoded by the linear segment of the sRGB curve
+static const float SRGBLinearThreshold = 0.0031308f;
+static const float SRGBLinearScale     = 12.92f;
+
+// the power segment is approximated from three successive square roots, sqrt is fast on every instruction set
+static const float SRGBCoefficient1 = 0.662002687f;
+static const float SRGBCoefficient2 = 0.684122060f;
+static const float SRGBCoefficient3 = 0.323583601f;
+static const float SRGBCoefficient4 = 0.0225411470f;
+
+static const float Unorm8Scale = 1.0f / 255.0f;
+
+
+// a table lookup is faster than any arithmetic for 256 possible inputs
+static const std::array<float, 256> SRGBToLinearTable = [] () {
+    std::array<float, 256> table;
+    for (uint32_t value = 0; value < 256; ++value) {
+        const double encoded = value / 255.0;
+        table[value]         = static_cast<float> ((encoded <= 0.04045) ? encoded / 12.92 : std::pow ((encoded + 0.055) / 1.055, 2.4));
+    }
+    return table;
+}();
+
+
+// NaN becomes 0 like with the max instructions of the vectorized paths
+static float ClampUnit (float value)
+{
+    value = (value > 0.0f) ? value : 0.0f;
+    return (value < 1.0f) ? value : 1.0f;
+}
+
+
+static uint8_t UnitToUnorm8 (float unitValue)
+{
+    return static_cast<uint8_t> (unitValue * 255.0f + 0.5f);
+}
+
+
+static float EncodeSRGB (float linear)
+{
+    if (linear <= SRGBLinearThreshold) {
+        return linear * SRGBLinearScale;
+    }
+
+    const float root1 = std::sqrt (linear);
+    const float root2 = std::sqrt (root1);
+    const float root3 = std::sqrt (root2);
+    return SRGBCoefficient1 * root1 + SRGBCoefficient2 * root2 - SRGBCoefficient3 * root3 - SRGBCoefficient4 * linear;
+}
+
+
+#if defined(SIMD_SSE2) && !defined(SIMD_AVX2)
+
+// maxps returns the second operand for NaN
+static __m128 ClampUnitSSE2 (__m128 value)
+{
+    return _mm_min_ps (_mm_max_ps (value, _mm_setzero_ps ()), _mm_set1_ps (1.0f));
+}
+
+
+static __m128 EncodeSRGBSSE2 (__m128 linear)
+{
+    const __m128 root1 = _mm_sqrt_ps (linear);
+    const __m128 root2 = _mm_sqrt_ps (root1);
+    const __m128 root3 = _mm_sqrt_ps (root2);
+
+    __m128 power = _mm_mul_ps (_mm_set1_ps (SRGBCoefficient1), root1);
+    power        = _mm_add_ps (power, _mm_mul_ps (_mm_set1_ps (SRGBCoefficient2), root2));
+    power        = _mm_sub_ps (power, _mm_mul_ps (_mm_set1_ps (SRGBCoefficient3), root3));
+    power        = _mm_sub_ps (power, _mm_mul_ps (_mm_set1_ps (SRGBCoefficient4), linear));
+
+    const __m128 useLinear = _mm_cmple_ps (linear, _mm_set1_ps (SRGBLinearThreshold));
+    return _mm_or_ps (_mm_and_ps (useLinear, _mm_mul_ps (linear, _mm_set1_ps (SRGBLinearScale))), _mm_andnot_ps (useLinear, power));
+}
+
+
+// 16 unit values to bytes
+static void StoreUnorm8SSE2 (uint8_t* destination, const __m128 (&unitValues)[4])
+{
+    __m128i values[4];
+    for (uint32_t i = 0; i < 4; ++i) {
+        values[i] = _mm_cvttps_epi32 (_mm_add_ps (_mm_mul_ps (unitValues[i], _mm_set1_ps (255.0f)), _mm_set1_ps (0.5f)));
+    }
+
+    const __m128i low  = _mm_packs_epi32 (values[0], values[1]);
+    const __m128i high = _mm_packs_epi32 (values[2], values[3]);
+    _mm_storeu_si128 (reinterpret_cast<__m128i*> (destination), _mm_packus_epi16 (low, high));
+}
+
+#endif
+
+
+#if defined(SIMD_AVX2)
+
+static __m256 ClampUnitAVX2 (__m256 value)
+{
+    return _mm256_min_ps (_mm256_max_ps (value, _mm256_setzero_ps ()), _mm256_set1_ps (1.0f));
+}
+
+
+static __m256 EncodeSRGBAVX2 (__m256 linear)
+{
+    const __m256 root1 = _mm256_sqrt_ps (linear);
+    const __m256 root2 = _mm256_sqrt_ps (root1);
+    const __m256 root3 = _mm256_sqrt_ps (root2);
+
+    __m256 power = _mm256_mul_ps (_mm256_set1_ps (SRGBCoefficient1), root1);
+    power        = _mm256_add_ps (power, _mm256_mul_ps (_mm256_set1_ps (SRGBCoefficient2), root2));
+    power        = _mm256_sub_ps (power, _mm256_mul_ps (_mm256_set1_ps (SRGBCoefficient3), root3));
+    power        = _mm256_sub_ps (power, _mm256_mul_ps (_mm256_set1_ps (SRGBCoefficient4), linear));
+
+    const __m256 useLinear = _mm256_cmp_ps (linear, _mm256_set1_ps (SRGBLinearThreshold), _CMP_LE_OQ);
+    return _mm256_blendv_ps (power, _mm256_mul_ps (linear, _mm256_set1_ps (SRGBLinearScale)), useLinear);
+}
+
+
+// 32 unit values to bytes, packing works within 128 bit halves so the 4 byte groups are put back in order
+static void StoreUnorm8AVX2 (uint8_t* destination, const __m256 (&unitValues)[4])
+{
+    __m256i values[4];
+    for (uint32_t i = 0; i < 4; ++i) {
+        values[i] = _mm256_cvttps_epi32 (_mm256_add_ps (_mm256_mul_ps (unitValues[i], _mm256_set1_ps (255.0f)), _mm256_set1_ps (0.5f)));
+    }
+
+    const __m256i low   = _mm256_packs_epi32 (values[0], values[1]);
+    const __m256i high  = _mm256_packs_epi32 (values[2], values[3]);
+    const __m256i bytes = _mm256_packus_epi16 (low, high);
+    _mm256_storeu_si256 (reinterpret_cast<__m256i*> (destination), _mm256_permutevar8x32_epi32 (bytes, _mm256_setr_epi32 (0, 4, 1, 5, 2, 6, 3, 7)));
+}
+
+#endif
+
+
+#if defined(SIMD_NEON)
+
+// the comparison is false for NaN, which selects 0
+static float32x4_t ClampUnitNEON (float32x4_t value)
+{
+    const float32x4_t zero = vdupq_n_f32 (0.0f);
+    return vminq_f32 (vbslq_f32 (vcgtq_f32 (value, zero), value, zero), vdupq_n_f32 (1.0f));
+}
+
+
+static float32x4_t EncodeSRGBNEON (float32x4_t linear)
+{
+    const float32x4_t root1 = vsqrtq_f32 (linear);
+    const float32x4_t root2 = vsqrtq_f32 (root1);
+    const float32x4_t root3 = vsqrtq_f32 (root2);
+
+    float32x4_t power = vmulq_f32 (vdupq_n_f32 (SRGBCoefficient1), root1);
+    power             = vaddq_f32 (power, vmulq_f32 (vdupq_n_f32 (SRGBCoefficient2), root2));
+    power             = vsubq_f32 (power, vmulq_f32 (vdupq_n_f32 (SRGBCoefficient3), root3));
+    power             = vsubq_f32 (power, vmulq_f32 (vdupq_n_f32 (SRGBCoefficient4), linear));
+
+    const uint32x4_t useLinear = vcleq_f32 (linear, vdupq_n_f32 (SRGBLinearThreshold));
+    return vbslq_f32 (useLinear, vmulq_f32 (linear, vdupq_n_f32 (SRGBLinearScale)), power);
+}
+
+
+static void StoreUnorm8NEON (uint8_t* destination, const float32x4_t (&unitValues)[4])
+{
+    uint16x4_t values[4];
+    for (uint32_t i = 0; i < 4; ++i) {
+        values[i] = vmovn_u32 (vcvtq_u32_f32 (vaddq_f32 (vmulq_f32 (unitValues[i], vdupq_n_f32 (255.0f)), vdupq_n_f32 (0.5f))));
+    }
+
+    const uint16x8_t low  = vcombine_u16 (values[0], values[1]);
+    const uint16x8_t high = vcombine_u16 (values[2], values[3]);
+    vst1q_u8 (destination, vcombine_u8 (vmovn_u16 (low), vmovn_u16 (high)));
+}
+
+#endif
+
+
+void SwizzleRGBA8 (uint8_t* pixels, size_t pixelCount, const std::array<uint8_t, 4>& order)
+{
+    RG_ASSERT (order[0] < 4 && order[1] < 4 && order[2] < 4 && order[3] < 4);
+
+    size_t pixel = 0;
+
+#if defined(SIMD_AVX2)
+    alignas (32) int8_t shuffle[32];
+    for (uint32_t i = 0; i < 32; ++i) {
+        shuffle[i] = static_cast<int8_t> ((i % 16) / 4 * 4 + order[i % 4]);
+    }
+    const __m256i shuffleMask = _mm256_load_si256 (reinterpret_cast<const __m256i*> (shuffle));
+
+    for (; pixel + 8 <= pixelCount; pixel += 8) {
+        __m256i* address = reinterpret_cast<__m256i*> (pixels + pixel * 4);
+        _mm256_storeu_si256 (address, _mm256_shuffle_epi8 (_mm256_loadu_si256 (address), shuffleMask));
+    }
+#elif defined(SIMD_SSE2)
+    // no byte shuffle in SSE2, each component is shifted into its place within the 32 bit pixel
+    __m128i sourceShifts[4];
+    __m128i destinationShifts[4];
+    for (uint32_t component = 0; component < 4; ++component) {
+        sourceShifts[component]      = _mm_cvtsi32_si128 (8 * order[component]);
+        destinationShifts[component] = _mm_cvtsi32_si128 (static_cast<int> (8 * component));
+    }
+    const __m128i byteMask = _mm_set1_epi32 (0xff);
+
+    for (; pixel + 4 <= pixelCount; pixel += 4) {
+        __m128i*      address = reinterpret_cast<__m128i*> (pixels + pixel * 4);
+        const __m128i source  = _mm_loadu_si128 (address);
+
+        __m128i result = _mm_setzero_si128 ();
+        for (uint32_t component = 0; component < 4; ++component) {
+            const __m128i value = _mm_and_si128 (_mm_srl_epi32 (source, sourceShifts[component]), byteMask);
+            result              = _mm_or_si128 (result, _mm_sll_epi32 (value, destinationShifts[component]));
+        }
+
+        _mm_storeu_si128 (address, result);
+    }
+#elif defined(SIMD_NEON)
+    uint8_t shuffle[16];
+    for (uint32_t i = 0; i < 16; ++i) {
+        shuffle[i] = static_cast<uint8_t> (i / 4 * 4 + order[i % 4]);
+    }
+    const uint8x16_t shuffleTable = vld1q_u8 (shuffle);
+
+    for (; pixel + 4 <= pixelCount; pixel += 4) {
+        vst1q_u8 (pixels + pixel * 4, vqtbl1q_u8 (vld1q_u8 (pixels + pixel * 4), shuffleTable));
+    }
+#endif
+
+    for (; pixel < pixelCount; ++pixel) {
+        uint8_t* const               address = pixels + pixel * 4;
+        const std::array<uint8_t, 4> source { address[0], address[1], address[2], address[3] };
+        for (uint32_t component = 0; component < 4; ++component) {
+            address[component] = source[order[component]];
+        }
+    }
+}
+
+
+void FloatToUnorm8 (const float* source, uint8_t* destination, size_t count)
+{
+    size_t i = 0;
+
+#if defined(SIMD_AVX2)
+    for (; i + 32 <= count; i += 32) {
+        const __m256 values[4] = {
+            ClampUnitAVX2 (_mm256_loadu_ps (source + i + 0)),
+            ClampUnitAVX2 (_mm256_loadu_ps (source + i + 8)),
+            ClampUnitAVX2 (_mm256_loadu_ps (source + i + 16)),
+            ClampUnitAVX2 (_mm256_loadu_ps (source + i + 24)),
+        };
+        StoreUnorm8AVX2 (destination + i, values);
+    }
+#elif defined(SIMD_SSE2)
+    for (; i + 16 <= count; i += 16) {
+        const __m128 values[4] = {
+            ClampUnitSSE2 (_mm_loadu_ps (source + i + 0)),
+            ClampUnitSSE2 (_mm_loadu_ps (source + i + 4)),
+            ClampUnitSSE2 (_mm_loadu_ps (source + i + 8)),
+            ClampUnitSSE2 (_mm_loadu_ps (source + i + 12)),
+        };
+        StoreUnorm8SSE2 (destination + i, values);
+    }
+#elif defined(SIMD_NEON)
+    for (; i + 16 <= count; i += 16) {
+        const float32x4_t values[4] = {
+            ClampUnitNEON (vld1q_f32 (source + i + 0)),
+            ClampUnitNEON (vld1q_f32 (source + i + 4)),
+            ClampUnitNEON (vld1q_f32 (source + i + 8)),
+            ClampUnitNEON (vld1q_f32 (source + i + 12)),
+        };
+        StoreUnorm8NEON (destination + i, values);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        destination[i] = UnitToUnorm8 (ClampUnit (source[i]));
+    }
+}
+
+
+void Unorm8ToFloat (const uint8_t* source, float* destination, size_t count)
+{
+    size_t i = 0;
+
+#if defined(SIMD_AVX2)
+    const __m256 scale = _mm256_set1_ps (Unorm8Scale);
+    for (; i + 8 <= count; i += 8) {
+        const __m256i values = _mm256_cvtepu8_epi32 (_mm_loadl_epi64 (reinterpret_cast<const __m128i*> (source + i)));
+        _mm256_storeu_ps (destination + i, _mm256_mul_ps (_mm256_cvtepi32_ps (values), scale));
+    }
+#elif defined(SIMD_SSE2)
+    const __m128  scale = _mm_set1_ps (Unorm8Scale);
+    const __m128i zero  = _mm_setzero_si128 ();
+    for (; i + 16 <= count; i += 16) {
+        const __m128i bytes = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (source + i));
+        const __m128i low   = _mm_unpacklo_epi8 (bytes, zero);
+        const __m128i high  = _mm_unpackhi_epi8 (bytes, zero);
+
+        _mm_storeu_ps (destination + i + 0, _mm_mul_ps (_mm_cvtepi32_ps (_mm_unpacklo_epi16 (low, zero)), scale));
+        _mm_storeu_ps (destination + i + 4, _mm_mul_ps (_mm_cvtepi32_ps (_mm_unpackhi_epi16 (low, zero)), scale));
+        _mm_storeu_ps (destination + i + 8, _mm_mul_ps (_mm_cvtepi32_ps (_mm_unpacklo_epi16 (high, zero)), scale));
+        _mm_storeu_ps (destination + i + 12, _mm_mul_ps (_mm_cvtepi32_ps (_mm_unpackhi_epi16 (high, zero)), scale));
+    }
+#elif defined(SIMD_NEON)
+    const float32x4_t scale = vdupq_n_f32 (Unorm8Scale);
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16_t bytes = vld1q_u8 (source + i);
+        const uint16x8_t low   = vmovl_u8 (vget_low_u8 (bytes));
+        const uint16x8_t high  = vmovl_u8 (vget_high_u8 (bytes));
+
+        vst1q_f32 (destination + i + 0, vmulq_f32 (vcvtq_f32_u32 (vmovl_u16 (vget_low_u16 (low))), scale));
+        vst1q_f32 (destination + i + 4, vmulq_f32 (vcvtq_f32_u32 (vmovl_u16 (vget_high_u16 (low))), scale));
+        vst1q_f32 (destination + i + 8, vmulq_f32 (vcvtq_f32_u32 (vmovl_u16 (vget_low_u16 (high))), scale));
+        vst1q_f32 (destination + i + 12, vmulq_f32 (vcvtq_f32_u32 (vmovl_u16 (vget_high_u16 (high))), scale));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        destination[i] = static_cast<float> (source[i]) * Unorm8Scale;
+    }
+}
+
+
+void SRGB8ToLinear (const uint8_t* source, float* destination, size_t pixelCount, uint32_t components)
+{
+    const size_t count = pixelCount * components;
+    for (size_t i = 0; i < count; ++i) {
+        const bool isAlpha = components == 4 && i % 4 == 3;
+        destination[i]     = isAlpha ? static_cast<float> (source[i]) * Unorm8Scale : SRGBToLinearTable[source[i]];
+    }
+}
+
+
+void LinearToSRGB8 (const float* source, uint8_t* destination, size_t pixelCount, uint32_t components)
+{
+    const size_t count = pixelCount * components;
+
+    size_t i = 0;
+
+    // vectors start at multiples of 4 values, alpha is always in the last lane of each 4 lanes
+#if defined(SIMD_AVX2)
+    const __m256 alphaMask = _mm256_castsi256_ps (components == 4 ? _mm256_setr_epi32 (0, 0, 0, -1, 0, 0, 0, -1) : _mm256_setzero_si256 ());
+    for (; i + 32 <= count; i += 32) {
+        __m256 values[4];
+        for (uint32_t j = 0; j < 4; ++j) {
+            const __m256 linear = ClampUnitAVX2 (_mm256_loadu_ps (source + i + j * 8));
+            values[j]           = _mm256_blendv_ps (EncodeSRGBAVX2 (linear), linear, alphaMask);
+        }
+        StoreUnorm8AVX2 (destination + i, values);
+    }
+#elif defined(SIMD_SSE2)
+    const __m128 alphaMask = _mm_castsi128_ps (components == 4 ? _mm_setr_epi32 (0, 0, 0, -1) : _mm_setzero_si128 ());
+    for (; i + 16 <= count; i += 16) {
+        __m128 values[4];
+        for (uint32_t j = 0; j < 4; ++j) {
+            const __m128 linear = ClampUnitSSE2 (_mm_loadu_ps (source + i + j * 4));
+            values[j]           = _mm_or_ps (_mm_and_ps (alphaMask, linear), _mm_andnot_ps (alphaMask, EncodeSRGBSSE2 (linear)));
+        }
+        StoreUnorm8SSE2 (destination + i, values);
+    }
+#elif defined(SIMD_NEON)
+    static const uint32_t alphaLanes[4] = { 0, 0, 0, 0xffffffff };
+    const uint32x4_t      alphaMask     = (components == 4) ? vld1q_u32 (alphaLanes) : vdupq_n_u32 (0);
+    for (; i + 16 <= count; i += 16) {
+        float32x4_t values[4];
+        for (uint32_t j = 0; j < 4; ++j) {
+            const float32x4_t linear = ClampUnitNEON (vld1q_f32 (source + i + j * 4));
+            values[j]                = vbslq_f32 (alphaMask, linear, EncodeSRGBNEON (linear));
+        }
+        StoreUnorm8NEON (destination + i, values);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        const bool  isAlpha = components == 4 && i % 4 == 3;
+        const float linear  = ClampUnit (source[i]);
+        destination[i]      = UnitToUnorm8 (isAlpha ? linear : EncodeSRGB (linear));
+    }
+}
+
+
+void RGB8ToRGBA8 (const uint8_t* source, uint8_t* destination, size_t pixelCount, uint8_t alpha)
+{
+    size_t pixel = 0;
+
+#if defined(SIMD_AVX2)
+    // 4 pixels are loaded into each 128 bit half, the last load ends 4 bytes after the 8th pixel
+    const __m256i shuffleMask = _mm256_setr_epi8 (0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                                  0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i alphaBits   = _mm256_set1_epi32 (static_cast<int32_t> (static_cast<uint32_t> (alpha) << 24));
+
+    for (; pixel + 10 <= pixelCount; pixel += 8) {
+        const uint8_t* address = source + pixel * 3;
+        const __m256i  rgb     = _mm256_inserti128_si256 (_mm256_castsi128_si256 (_mm_loadu_si128 (reinterpret_cast<const __m128i*> (address))),
+                                                          _mm_loadu_si128 (reinterpret_cast<const __m128i*> (address + 12)),
+                                                          1);
+        _mm256_storeu_si256 (reinterpret_cast<__m256i*> (destination + pixel * 4), _mm256_or_si256 (_mm256_shuffle_epi8 (rgb, shuffleMask), alphaBits));
+    }
+#elif defined(SIMD_NEON)
+    const uint8x16_t alphaValues = vdupq_n_u8 (alpha);
+    for (; pixel + 16 <= pixelCount; pixel += 16) {
+        const uint8x16x3_t rgb  = vld3q_u8 (source + pixel * 3);
+        const uint8x16x4_t rgba = { { rgb.val[0], rgb.val[1], rgb.val[2], alphaValues } };
+        vst4q_u8 (destination + pixel * 4, rgba);
+    }
+#endif
+
+    // SSE2 has no byte shuffle, the scalar loop is used there
+    for (; pixel < pixelCount; ++pixel) {
+        destination[pixel * 4 + 0] = source[pixel * 3 + 0];
+        destination[pixel * 4 + 1] = source[pixel * 3 + 1];
+        destination[pixel * 4 + 2] = source[pixel * 3 + 2];
+        destination[pixel * 4 + 3] = alpha;
+    }
+}
+
+
+void RGBA8ToRGB8 (const uint8_t* source, uint8_t* destination, size_t pixelCount)
+{
+    size_t pixel = 0;
+
+#if defined(SIMD_AVX2)
+    // each half is packed to 12 bytes, the second store overwrites the 4 unused bytes of the first one
+    const __m256i shuffleMask = _mm256_setr_epi8 (0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                                  0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+    for (; pixel + 10 <= pixelCount; pixel += 8) {
+        const __m256i rgb     = _mm256_shuffle_epi8 (_mm256_loadu_si256 (reinterpret_cast<const __m256i*> (source + pixel * 4)), shuffleMask);
+        uint8_t*      address = destination + pixel * 3;
+        _mm_storeu_si128 (reinterpret_cast<__m128i*> (address), _mm256_castsi256_si128 (rgb));
+        _mm_storeu_si128 (reinterpret_cast<__m128i*> (address + 12), _mm256_extracti128_si256 (rgb, 1));
+    }
+#elif defined(SIMD_NEON)
+    for (; pixel + 16 <= pixelCount; pixel += 16) {
+        const uint8x16x4_t rgba = vld4q_u8 (source + pixel * 4);
+        const uint8x16x3_t rgb  = { { rgba.val[0], rgba.val[1], rgba.val[2] } };
+        vst3q_u8 (destination + pixel * 3, rgb);
+    }
+#endif
+
+    for (; pixel < pixelCount; ++pixel) {
+        destination[pixel * 3 + 0] = source[pixel * 4 + 0];
+        destination[pixel * 3 + 1] = source[pixel * 4 + 1];
+        destination[pixel * 3 + 2] = source[pixel * 4 + 2];
+    }
+}
+
+} // namespace RG
@@ -0,0 +1,112 @@
+#include "StagingBufferPool.hpp"
+
+#include "Utils/Assert.hpp"
+
+#include "spdlog/spdlog.h"
+
+
+namespace RG {
+
+static const size_t MinStagingBufferSize = 4 * 1024;
+
+// larger buffers are only requested by single big uploads or readbacks, they are freed on release instead of kept
+static const size_t MaxPooledStagingBufferSize = 16 * 1024 * 1024;
+
+
+// rounding up lets differently sized requests share the same buffers
+static size_t GetStagingBufferSize (size_t requestedSize)
+{
+    size_t result = MinStagingBufferSize;
+    while (result < requestedSize) {
+        result *= 2;
+    }
+    return result;
+}
+
+
+StagingBufferPool::StagingBuffer::StagingBuffer (VmaAllocator allocator, size_t size, VkBufferUsageFlags usageFlags, MemoryLocation location)
+    : buffer (std::make_unique<Buffer> (allocator, size, usageFlags, location))
+    , mapping (std::make_unique<MemoryMapping> (allocator, *buffer))
+    , size (size)
+{
+}
+
+
+StagingBufferPool::StagingBufferPool (VmaAllocator allocator, VkBufferUsageFlags usageFlags, MemoryLocation location)
+    : allocator (allocator)
+    , usageFlags (usageFlags)
+    , location (location)
+    , createdCount (0)
+{
+}
+
+
+StagingBufferPool::~StagingBufferPool () = default;
+
+
+std::unique_ptr<StagingBufferPool::StagingBuffer> StagingBufferPool::Acquire (size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+
+        // best fit
+        auto found = freeBuffers.end ();
+        for (auto it = freeBuffers.begin (); it != freeBuffers.end (); ++it) {
+            if ((*it)->size >= size && (found == freeBuffers.end () || (*it)->size < (*found)->size)) {
+                found = it;
+            }
+        }
+
+        if (found != freeBuffers.end ()) {
+            std::unique_ptr<StagingBuffer> result = std::move (*found);
+            freeBuffers.erase (found);
+            return result;
+        }
+
+        ++createdCount;
+    }
+
+    const size_t createdSize = GetStagingBufferSize (size);
+
+    spdlog::trace ("StagingBufferPool: creating staging buffer of {} bytes.", createdSize);
+
+    return std::make_unique<StagingBuffer> (allocator, createdSize, usageFlags, location);
+}
+
+
+void StagingBufferPool::Release (std::unique_ptr<StagingBuffer>&& stagingBuffer)
+{
+    if (RG_ERROR (stagingBuffer == nullptr)) {
+        return;
+    }
+
+    if (stagingBuffer->size > MaxPooledStagingBufferSize) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock (mutex);
+    freeBuffers.push_back (std::move (stagingBuffer));
+}
+
+
+void StagingBufferPool::Clear ()
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    freeBuffers.clear ();
+}
+
+
+size_t StagingBufferPool::GetFreeCount ()
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    return freeBuffers.size ();
+}
+
+
+size_t StagingBufferPool::GetCreatedCount ()
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    return createdCount;
+}
+
+} // namespace RG
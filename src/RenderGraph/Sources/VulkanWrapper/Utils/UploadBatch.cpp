@@ -0,0 +1,625 @@
+#include "UploadBatch.hpp"
+
+#include "Commands.hpp"
+
+#include "Utils/Assert.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+
+
+namespace RG {
+
+static const VkDeviceSize StagingChunkSize = 16 * 1024 * 1024;
+
+// satisfies the texel size of every uncompressed format, the block size of BC formats and the 4 byte rule of buffer to image copies
+static const VkDeviceSize StagingAlignment = 16;
+
+static const VkAccessFlags AnyAccess = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+
+static VkDeviceSize AlignUp (VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+
+namespace {
+
+// one layout transition per disjoint range of the mip levels and array layers touched by the regions of an image
+// untouched subresources are never part of a range, so they keep their layout and contents
+// when only level 0 of a mipmapped image is uploaded, the other levels of the touched layers are generated from it
+struct ImageTransition {
+    const Image*                 image;
+    VkImageLayout                currentLayout;
+    std::optional<VkImageLayout> nextLayout;
+    VkImageSubresourceRange      subresourceRange;
+    bool                         generatesMipLevels;
+
+    VkImageLayout GetFinalLayout () const { return nextLayout.value_or (VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL); }
+
+    bool GeneratesMipLevels () const { return generatesMipLevels; }
+
+    // layout of the uploaded range after the copies, generation moves every level to the final layout itself
+    VkImageLayout GetLayoutAfterCopies () const { return GeneratesMipLevels () ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : GetFinalLayout (); }
+};
+
+
+struct TouchedImage {
+    const Image*                            image;
+    VkImageLayout                           currentLayout;
+    std::optional<VkImageLayout>            nextLayout;
+    VkImageAspectFlags                      aspectMask;
+    std::set<std::pair<uint32_t, uint32_t>> subresources; // mip level and array layer
+};
+
+} // namespace
+
+
+// splits the touched subresources into rectangles: contiguous layers of one level first,
+// then equal layer runs of consecutive levels, the resulting ranges never overlap
+static std::vector<VkImageSubresourceRange> GetDisjointSubresourceRanges (const TouchedImage& touched)
+{
+    std::vector<VkImageSubresourceRange> layerRuns;
+
+    for (const auto& [mipLevel, arrayLayer] : touched.subresources) {
+        if (!layerRuns.empty () && layerRuns.back ().baseMipLevel == mipLevel && layerRuns.back ().baseArrayLayer + layerRuns.back ().layerCount == arrayLayer) {
+            ++layerRuns.back ().layerCount;
+            continue;
+        }
+
+        VkImageSubresourceRange run = {};
+        run.aspectMask              = touched.aspectMask;
+        run.baseMipLevel            = mipLevel;
+        run.levelCount              = 1;
+        run.baseArrayLayer          = arrayLayer;
+        run.layerCount              = 1;
+        layerRuns.push_back (run);
+    }
+
+    std::vector<VkImageSubresourceRange> result;
+
+    for (const VkImageSubresourceRange& run : layerRuns) {
+        auto below = std::find_if (result.begin (), result.end (), [&] (const VkImageSubresourceRange& r) {
+            return r.baseArrayLayer == run.baseArrayLayer && r.layerCount == run.layerCount && r.baseMipLevel + r.levelCount == run.baseMipLevel;
+        });
+
+        if (below != result.end ()) {
+            ++below->levelCount;
+        } else {
+            result.push_back (run);
+        }
+    }
+
+    return result;
+}
+
+
+template<typename UploadType>
+static std::vector<ImageTransition> GetImageTransitions (const std::vector<UploadType>& imageUploads)
+{
+    std::vector<TouchedImage> touchedImages;
+
+    for (const UploadType& upload : imageUploads) {
+        auto found = std::find_if (touchedImages.begin (), touchedImages.end (), [&] (const TouchedImage& t) { return t.image == upload.image; });
+        if (found == touchedImages.end ()) {
+            touchedImages.push_back ({ upload.image, upload.currentLayout, upload.nextLayout, 0, {} });
+            found = touchedImages.end () - 1;
+        } else if (upload.nextLayout.has_value ()) {
+            found->nextLayout = upload.nextLayout;
+        }
+
+        const VkImageSubresourceLayers& subresource = upload.region.imageSubresource;
+
+        found->aspectMask |= subresource.aspectMask;
+        for (uint32_t layer = subresource.baseArrayLayer; layer < subresource.baseArrayLayer + subresource.layerCount; ++layer) {
+            found->subresources.insert ({ subresource.mipLevel, layer });
+        }
+    }
+
+    std::vector<ImageTransition> result;
+
+    for (const TouchedImage& touched : touchedImages) {
+        // the set is ordered by mip level, so the last element holds the highest touched level
+        const bool generatesMipLevels = touched.image->GetMipLevels () > 1 && touched.subresources.rbegin ()->first == 0;
+
+        for (const VkImageSubresourceRange& range : GetDisjointSubresourceRanges (touched)) {
+            result.push_back ({ touched.image, touched.currentLayout, touched.nextLayout, range, generatesMipLevels });
+        }
+    }
+
+    return result;
+}
+
+
+template<typename UploadType>
+static std::vector<VkBuffer> GetDestinationBuffers (const std::vector<UploadType>& bufferUploads)
+{
+    std::vector<VkBuffer> result;
+
+    for (const UploadType& upload : bufferUploads) {
+        if (std::find (result.begin (), result.end (), upload.dstBuffer) == result.end ()) {
+            result.push_back (upload.dstBuffer);
+        }
+    }
+
+    return result;
+}
+
+
+static VkBufferMemoryBarrier GetBufferBarrier (VkBuffer buffer, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, uint32_t srcQueueFamilyIndex, uint32_t dstQueueFamilyIndex)
+{
+    VkBufferMemoryBarrier barrier = {};
+    barrier.sType                 = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask         = srcAccessMask;
+    barrier.dstAccessMask         = dstAccessMask;
+    barrier.srcQueueFamilyIndex   = srcQueueFamilyIndex;
+    barrier.dstQueueFamilyIndex   = dstQueueFamilyIndex;
+    barrier.buffer                = buffer;
+    barrier.offset                = 0;
+    barrier.size                  = VK_WHOLE_SIZE;
+    return barrier;
+}
+
+
+static VkImageMemoryBarrier GetImageBarrier (const ImageTransition& transition, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, uint32_t srcQueueFamilyIndex, uint32_t dstQueueFamilyIndex)
+{
+    VkImageMemoryBarrier barrier = transition.image->GetBarrier (oldLayout, newLayout, srcAccessMask, dstAccessMask, transition.subresourceRange);
+    barrier.srcQueueFamilyIndex  = srcQueueFamilyIndex;
+    barrier.dstQueueFamilyIndex  = dstQueueFamilyIndex;
+    return barrier;
+}
+
+
+static VkFilter GetMipLevelFilter (const DeviceExtra& device, VkFormat format)
+{
+    const VkFormatFeatureFlags features = device.GetOptimalTilingFeatures (format);
+    return (features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+}
+
+
+static void RecordMipLevelGeneration (const DeviceExtra& device, CommandBuffer& commandBuffer, const std::vector<ImageTransition>& transitions)
+{
+    for (const ImageTransition& t : transitions) {
+        if (t.GeneratesMipLevels ()) {
+            t.image->CmdGenerateMipLevels (commandBuffer,
+                                           t.subresourceRange.baseArrayLayer,
+                                           t.subresourceRange.layerCount,
+                                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                           t.GetFinalLayout (),
+                                           GetMipLevelFilter (device, t.image->GetFormat ()));
+        }
+    }
+}
+
+
+UploadBatch::UploadBatch (const DeviceExtra& device)
+    : device (device)
+    , fence (std::make_unique<Fence> (device, false))
+    , submitted (false)
+    , completed (false)
+    , uploadedBytes (0)
+    , recordedCopies (0)
+{
+}
+
+
+UploadBatch::~UploadBatch ()
+{
+    // submitting here would let the copies run after the sources and destinations declared later in the same scope are destroyed
+    if (RG_ERROR (!submitted && !IsEmpty ())) {
+        return;
+    }
+
+    // the staging memory has to outlive the submitted copies
+    Wait ();
+}
+
+
+UploadBatch::StagingAllocation UploadBatch::Allocate (size_t size)
+{
+    if (RG_ERROR (submitted)) {
+        throw std::runtime_error ("UploadBatch is already submitted");
+    }
+
+    if (chunks.empty () || AlignUp (chunks.back ().used, StagingAlignment) + size > chunks.back ().stagingBuffer->size) {
+        StagingChunk newChunk;
+        newChunk.stagingBuffer = device.GetUploadPool ().Acquire (std::max<size_t> (StagingChunkSize, size));
+        newChunk.used          = 0;
+        chunks.push_back (std::move (newChunk));
+    }
+
+    StagingChunk& chunk = chunks.back ();
+
+    StagingAllocation result;
+    result.buffer = *chunk.stagingBuffer->buffer;
+    result.offset = AlignUp (chunk.used, StagingAlignment);
+    result.mapped = reinterpret_cast<uint8_t*> (chunk.stagingBuffer->Get ()) + result.offset;
+
+    chunk.used = result.offset + size;
+
+    uploadedBytes += size;
+
+    return result;
+}
+
+
+UploadBatch::StagingAllocation UploadBatch::Allocate (const void* data, size_t size)
+{
+    const StagingAllocation result = Allocate (size);
+
+    memcpy (result.mapped, data, size);
+
+    return result;
+}
+
+
+void UploadBatch::CopyToBuffer (VkBuffer dstBuffer, const void* data, size_t size, VkDeviceSize dstOffset)
+{
+    const StagingAllocation staging = Allocate (data, size);
+
+    VkBufferCopy copyRegion = {};
+    copyRegion.srcOffset    = staging.offset;
+    copyRegion.dstOffset    = dstOffset;
+    copyRegion.size         = size;
+
+    CopyBuffer (staging.buffer, dstBuffer, copyRegion);
+}
+
+
+void UploadBatch::CopyToImage (const Image& image, VkImageLayout currentLayout, const void* data, size_t size, const VkBufferImageCopy& region, std::optional<VkImageLayout> nextLayout)
+{
+    VkBufferImageCopy stagingRegion = region;
+    stagingRegion.bufferOffset      = 0;
+
+    if (RG_ERROR (image.GetBufferImageCopySize (stagingRegion) > size)) {
+        throw std::runtime_error ("region reads past the end of the data");
+    }
+
+    const StagingAllocation staging = Allocate (data, size);
+
+    stagingRegion.bufferOffset = staging.offset;
+
+    CopyBufferToImage (staging.buffer, image, currentLayout, stagingRegion, nextLayout);
+}
+
+
+void UploadBatch::CopyToImage (const Image& image, VkImageLayout currentLayout, const void* data, size_t size, const std::vector<VkBufferImageCopy>& regions, std::optional<VkImageLayout> nextLayout)
+{
+    for (const VkBufferImageCopy& region : regions) {
+        if (RG_ERROR (region.bufferOffset > size || image.GetBufferImageCopySize (region) > size - region.bufferOffset)) {
+            throw std::runtime_error ("region reads past the end of the data");
+        }
+    }
+
+    const StagingAllocation staging = Allocate (data, size);
+
+    for (const VkBufferImageCopy& region : regions) {
+        VkBufferImageCopy stagingRegion = region;
+        stagingRegion.bufferOffset      = staging.offset + region.bufferOffset;
+
+        CopyBufferToImage (staging.buffer, image, currentLayout, stagingRegion, nextLayout);
+    }
+}
+
+
+void UploadBatch::CopyLayerToImage (const Image& image, VkImageLayout currentLayout, const void* data, size_t size, uint32_t layerIndex, std::optional<VkImageLayout> nextLayout)
+{
+    CopyToImage (image, currentLayout, data, size, image.GetFullBufferImageCopyLayer (layerIndex), nextLayout);
+}
+
+
+void* UploadBatch::ReserveImageUpload (const Image& image, VkImageLayout currentLayout, size_t size, const VkBufferImageCopy& region, std::optional<VkImageLayout> nextLayout)
+{
+    const StagingAllocation staging = Allocate (size);
+
+    VkBufferImageCopy stagingRegion = region;
+    stagingRegion.bufferOffset      = staging.offset;
+
+    CopyBufferToImage (staging.buffer, image, currentLayout, stagingRegion, nextLayout);
+
+    return staging.mapped;
+}
+
+
+void UploadBatch::CopyBuffer (VkBuffer srcBuffer, VkBuffer dstBuffer, const VkBufferCopy& region)
+{
+    if (RG_ERROR (submitted)) {
+        throw std::runtime_error ("UploadBatch is already submitted");
+    }
+
+    bufferUploads.push_back ({ srcBuffer, dstBuffer, region });
+    ++recordedCopies;
+}
+
+
+void UploadBatch::CopyBufferToImage (VkBuffer srcBuffer, const Image& image, VkImageLayout currentLayout, const VkBufferImageCopy& region, std::optional<VkImageLayout> nextLayout)
+{
+    if (RG_ERROR (submitted)) {
+        throw std::runtime_error ("UploadBatch is already submitted");
+    }
+
+    imageUploads.push_back ({ &image, currentLayout, nextLayout, srcBuffer, region });
+    ++recordedCopies;
+}
+
+
+CommandBuffer& UploadBatch::CreateCommandBuffer (VkCommandPool commandPool, const char* name)
+{
+    commandBuffers.push_back (std::make_unique<CommandBuffer> (device, commandPool));
+
+    CommandBuffer& commandBuffer = *commandBuffers.back ();
+    commandBuffer.SetName (device, name);
+    commandBuffer.Begin (VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    return commandBuffer;
+}
+
+
+void UploadBatch::Submit ()
+{
+    if (submitted) {
+        return;
+    }
+
+    if (IsEmpty ()) {
+        submitted = true;
+        completed = true;
+        return;
+    }
+
+    // staging memory is not guaranteed to be host coherent
+    for (const StagingChunk& chunk : chunks) {
+        vmaFlushAllocation (device.GetAllocator (), *chunk.stagingBuffer->buffer, 0, VK_WHOLE_SIZE);
+    }
+
+    if (device.HasDedicatedTransferQueue ()) {
+        SubmitOnTransferQueue ();
+    } else {
+        SubmitOnGraphicsQueue ();
+    }
+
+    submitted = true;
+
+    spdlog::trace ("UploadBatch submitted {} copies, {} bytes.", recordedCopies, uploadedBytes);
+}
+
+
+void UploadBatch::SubmitOnGraphicsQueue ()
+{
+    const std::vector<ImageTransition> transitions = GetImageTransitions (imageUploads);
+
+    CommandBuffer& commandBuffer = CreateCommandBuffer (device.GetCommandPool (), "UploadBatch - CommandBuffer");
+
+    {
+        // previous work may still read or write the destinations
+        VkMemoryBarrier anyToTransfer = {};
+        anyToTransfer.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        anyToTransfer.srcAccessMask   = AnyAccess;
+        anyToTransfer.dstAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        std::vector<VkImageMemoryBarrier> imageBarriers;
+        for (const ImageTransition& t : transitions) {
+            if (t.currentLayout != VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
+                imageBarriers.push_back (t.image->GetBarrier (t.currentLayout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, AnyAccess, VK_ACCESS_TRANSFER_WRITE_BIT, t.subresourceRange));
+            }
+        }
+
+        commandBuffer.Record<CommandPipelineBarrier> (VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                                      VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                                      std::vector<VkMemoryBarrier> { anyToTransfer },
+                                                      std::vector<VkBufferMemoryBarrier> {},
+                                                      imageBarriers);
+    }
+
+    for (const BufferUpload& upload : bufferUploads) {
+        commandBuffer.Record<CommandCopyBuffer> (upload.srcBuffer, upload.dstBuffer, std::vector<VkBufferCopy> { upload.region });
+    }
+
+    for (const ImageUpload& upload : imageUploads) {
+        upload.image->CmdCopyBufferPartToImage (commandBuffer, upload.srcBuffer, upload.region);
+    }
+
+    {
+        // make the copies visible to everything recorded after this batch
+        VkMemoryBarrier transferToAll = {};
+        transferToAll.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        transferToAll.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
+        transferToAll.dstAccessMask   = AnyAccess;
+
+        std::vector<VkImageMemoryBarrier> imageBarriers;
+        for (const ImageTransition& t : transitions) {
+            if (t.GetLayoutAfterCopies () != VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
+                imageBarriers.push_back (t.image->GetBarrier (VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, t.GetLayoutAfterCopies (), VK_ACCESS_TRANSFER_WRITE_BIT, AnyAccess, t.subresourceRange));
+            }
+        }
+
+        commandBuffer.Record<CommandPipelineBarrier> (VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                                      VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                                      std::vector<VkMemoryBarrier> { transferToAll },
+                                                      std::vector<VkBufferMemoryBarrier> {},
+                                                      imageBarriers);
+    }
+
+    RecordMipLevelGeneration (device, commandBuffer, transitions);
+
+    commandBuffer.End ();
+
+    device.GetGraphicsQueue ().Submit ({}, {}, { &commandBuffer }, {}, *fence);
+}
+
+
+void UploadBatch::SubmitOnTransferQueue ()
+{
+    const uint32_t graphicsFamily = device.GetGraphicsQueueFamilyIndex ();
+    const uint32_t transferFamily = device.GetTransferQueueFamilyIndex ();
+
+    const std::vector<ImageTransition> transitions = GetImageTransitions (imageUploads);
+    const std::vector<VkBuffer>        dstBuffers  = GetDestinationBuffers (bufferUploads);
+
+    // release from the graphics family
+    // images with undefined contents are not transferred, the transfer queue simply takes them over
+
+    std::vector<VkBufferMemoryBarrier> bufferReleases;
+    std::vector<VkImageMemoryBarrier>  imageReleases;
+
+    for (VkBuffer buffer : dstBuffers) {
+        bufferReleases.push_back (GetBufferBarrier (buffer, AnyAccess, 0, graphicsFamily, transferFamily));
+    }
+
+    for (const ImageTransition& t : transitions) {
+        if (t.currentLayout != VK_IMAGE_LAYOUT_UNDEFINED) {
+            imageReleases.push_back (GetImageBarrier (t, t.currentLayout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, AnyAccess, 0, graphicsFamily, transferFamily));
+        }
+    }
+
+    const bool needsRelease = !bufferReleases.empty () || !imageReleases.empty ();
+
+    std::vector<VkSemaphore>          transferWaitSemaphores;
+    std::vector<VkPipelineStageFlags> transferWaitStages;
+
+    if (needsRelease) {
+        CommandBuffer& releaseCommandBuffer = CreateCommandBuffer (device.GetCommandPool (), "UploadBatch - Release CommandBuffer");
+
+        releaseCommandBuffer.Record<CommandPipelineBarrier> (VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                                             VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                                             std::vector<VkMemoryBarrier> {},
+                                                             bufferReleases,
+                                                             imageReleases);
+        releaseCommandBuffer.End ();
+
+        semaphores.push_back (std::make_unique<Semaphore> (device));
+
+        device.GetGraphicsQueue ().Submit ({}, {}, { &releaseCommandBuffer }, { *semaphores.back () }, VK_NULL_HANDLE);
+
+        transferWaitSemaphores.push_back (*semaphores.back ());
+        transferWaitStages.push_back (VK_PIPELINE_STAGE_TRANSFER_BIT);
+    }
+
+    // acquire on the transfer family, copy, then release back to the graphics family
+
+    CommandBuffer& transferCommandBuffer = CreateCommandBuffer (device.GetTransferCommandPool (), "UploadBatch - Transfer CommandBuffer");
+
+    {
+        std::vector<VkBufferMemoryBarrier> bufferAcquires;
+        std::vector<VkImageMemoryBarrier>  imageAcquires;
+
+        for (VkBuffer buffer : dstBuffers) {
+            bufferAcquires.push_back (GetBufferBarrier (buffer, 0, VK_ACCESS_TRANSFER_WRITE_BIT, graphicsFamily, transferFamily));
+        }
+
+        for (const ImageTransition& t : transitions) {
+            if (t.currentLayout != VK_IMAGE_LAYOUT_UNDEFINED) {
+                imageAcquires.push_back (GetImageBarrier (t, t.currentLayout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT, graphicsFamily, transferFamily));
+            } else {
+                imageAcquires.push_back (GetImageBarrier (t, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED));
+            }
+        }
+
+        transferCommandBuffer.Record<CommandPipelineBarrier> (VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                                              VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                                              std::vector<VkMemoryBarrier> {},
+                                                              bufferAcquires,
+                                                              imageAcquires);
+    }
+
+    for (const BufferUpload& upload : bufferUploads) {
+        transferCommandBuffer.Record<CommandCopyBuffer> (upload.srcBuffer, upload.dstBuffer, std::vector<VkBufferCopy> { upload.region });
+    }
+
+    for (const ImageUpload& upload : imageUploads) {
+        upload.image->CmdCopyBufferPartToImage (transferCommandBuffer, upload.srcBuffer, upload.region);
+    }
+
+    std::vector<VkBufferMemoryBarrier> bufferTransfersBack;
+    std::vector<VkImageMemoryBarrier>  imageTransfersBack;
+
+    for (VkBuffer buffer : dstBuffers) {
+        bufferTransfersBack.push_back (GetBufferBarrier (buffer, VK_ACCESS_TRANSFER_WRITE_BIT, 0, transferFamily, graphicsFamily));
+    }
+
+    // blits need a graphics queue, mip levels are generated after the acquire
+    for (const ImageTransition& t : transitions) {
+        imageTransfersBack.push_back (GetImageBarrier (t, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, t.GetLayoutAfterCopies (), VK_ACCESS_TRANSFER_WRITE_BIT, 0, transferFamily, graphicsFamily));
+    }
+
+    transferCommandBuffer.Record<CommandPipelineBarrier> (VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                                          VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                                          std::vector<VkMemoryBarrier> {},
+                                                          bufferTransfersBack,
+                                                          imageTransfersBack);
+    transferCommandBuffer.End ();
+
+    semaphores.push_back (std::make_unique<Semaphore> (device));
+
+    device.GetTransferQueue ().Submit (transferWaitSemaphores, transferWaitStages, { &transferCommandBuffer }, { *semaphores.back () }, VK_NULL_HANDLE);
+
+    // acquire on the graphics family, the acquire barriers must match the release barriers exactly
+    // except for the access masks
+
+    for (VkBufferMemoryBarrier& barrier : bufferTransfersBack) {
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = AnyAccess;
+    }
+
+    for (VkImageMemoryBarrier& barrier : imageTransfersBack) {
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = AnyAccess;
+    }
+
+    CommandBuffer& acquireCommandBuffer = CreateCommandBuffer (device.GetCommandPool (), "UploadBatch - Acquire CommandBuffer");
+
+    acquireCommandBuffer.Record<CommandPipelineBarrier> (VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                                         std::vector<VkMemoryBarrier> {},
+                                                         bufferTransfersBack,
+                                                         imageTransfersBack);
+
+    RecordMipLevelGeneration (device, acquireCommandBuffer, transitions);
+
+    acquireCommandBuffer.End ();
+
+    // the fence is signaled last, so it covers all three submissions
+    device.GetGraphicsQueue ().Submit ({ *semaphores.back () }, { VK_PIPELINE_STAGE_ALL_COMMANDS_BIT }, { &acquireCommandBuffer }, {}, *fence);
+}
+
+
+void UploadBatch::Wait ()
+{
+    if (completed) {
+        return;
+    }
+
+    Submit ();
+
+    fence->Wait ();
+
+    for (StagingChunk& chunk : chunks) {
+        device.GetUploadPool ().Release (std::move (chunk.stagingBuffer));
+    }
+    chunks.clear ();
+
+    commandBuffers.clear ();
+    semaphores.clear ();
+
+    completed = true;
+}
+
+
+bool UploadBatch::Poll ()
+{
+    if (completed) {
+        return true;
+    }
+
+    if (!submitted || !fence->IsSignaled ()) {
+        return false;
+    }
+
+    Wait ();
+    return true;
+}
+
+} // namespace RG
@@ -103,21 +103,27 @@ uint32_t GetCompontentCountFromFormat (VkFormat format)
         case VK_FORMAT_R32_UINT:
         case VK_FORMAT_R8_SRGB:
         case VK_FORMAT_R8_UINT:
+        case VK_FORMAT_R8_UNORM:
             return 1;
         case VK_FORMAT_R32G32_SFLOAT:
         case VK_FORMAT_R8G8_SRGB:
         case VK_FORMAT_R32G32_UINT:
         case VK_FORMAT_R8G8_UINT:
+        case VK_FORMAT_R8G8_UNORM:
             return 2;
         case VK_FORMAT_R32G32B32_SFLOAT:
         case VK_FORMAT_R8G8B8_SRGB:
         case VK_FORMAT_R32G32B32_UINT:
         case VK_FORMAT_R8G8B8_UINT:
+        case VK_FORMAT_R8G8B8_UNORM:
             return 3;
         case VK_FORMAT_R32G32B32A32_SFLOAT:
         case VK_FORMAT_R8G8B8A8_SRGB:
         case VK_FORMAT_R32G32B32A32_UINT:
         case VK_FORMAT_R8G8B8A8_UINT:
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
             return 4;
         default:
             RG_BREAK ();
@@ -142,6 +148,7 @@ uint32_t GetEachCompontentSizeFromFormat (VkFormat format)
         case VK_FORMAT_R8G8B8_UNORM:
         case VK_FORMAT_R8G8B8A8_UNORM:
         case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
             return 1;
 
         case VK_FORMAT_R32_UINT:
@@ -160,4 +167,69 @@ uint32_t GetEachCompontentSizeFromFormat (VkFormat format)
     }
 }
 
+
+VkFormat GetRGBAOrderFormat (VkFormat format)
+{
+    switch (format) {
+        case VK_FORMAT_B8G8R8A8_UNORM:
+            return VK_FORMAT_R8G8B8A8_UNORM;
+        case VK_FORMAT_B8G8R8A8_SRGB:
+            return VK_FORMAT_R8G8B8A8_SRGB;
+        default:
+            return format;
+    }
+}
+
+
+bool IsBlockCompressedFormat (VkFormat format)
+{
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+uint32_t GetBlockByteSize (VkFormat format)
+{
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+            return 8;
+
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            return 16;
+
+        default:
+            RG_BREAK ();
+            return 16;
+    }
+}
+
+
+size_t GetImageByteSize (VkFormat format, uint32_t width, uint32_t height, uint32_t depth)
+{
+    if (IsBlockCompressedFormat (format)) {
+        const size_t blocksX = (width + 3) / 4;
+        const size_t blocksY = (height + 3) / 4;
+        return blocksX * blocksY * depth * GetBlockByteSize (format);
+    }
+
+    return static_cast<size_t> (width) * height * depth * GetCompontentCountFromFormat (format) * GetEachCompontentSizeFromFormat (format);
+}
+
 } // namespace RG
\ No newline at end of file
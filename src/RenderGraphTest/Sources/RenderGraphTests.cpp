@@ -1,7 +1,9 @@
 #include "TestEnvironment.hpp"
 
 #include "RenderGraph/BufferView.hpp"
+#include "RenderGraph/Drawable/CallbackDrawable.hpp"
 #include "RenderGraph/Drawable/FullscreenQuad.hpp"
+#include "RenderGraph/Drawable/IndirectDrawable.hpp"
 #include "RenderGraph/GraphRenderer.hpp"
 #include "RenderGraph/GraphSettings.hpp"
 #include "RenderGraph/Operation.hpp"
@@ -13,6 +15,7 @@
 #include "RenderGraph/Window/GLFWWindow.hpp"
 
 
+#include "RenderGraph/Utils/FileSystemUtils.hpp"
 #include "RenderGraph/Utils/SourceLocation.hpp"
 #include "RenderGraph/Utils/Timer.hpp"
 #include "RenderGraph/Utils/Utils.hpp"
@@ -20,14 +23,29 @@
 #include "RenderGraph/VulkanWrapper/Allocator.hpp"
 #include "RenderGraph/VulkanWrapper/Commands.hpp"
 #include "RenderGraph/VulkanWrapper/DeviceExtra.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/AssetLoader.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/AsyncReadback.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/BlockCompression.hpp"
 #include "RenderGraph/VulkanWrapper/Utils/ImageData.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/ImageFile.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/MemoryUsage.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/PixelConversion.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/UploadBatch.hpp"
 #include "RenderGraph/VulkanWrapper/Utils/VulkanUtils.hpp"
 #include "RenderGraph/VulkanWrapper/VulkanWrapper.hpp"
 
 
 #include <glm/glm.hpp>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <optional>
 #include <string>
@@ -1011,7 +1029,2286 @@ void main()
     std::vector<glm::uvec4> randomsBufferOut;
     randomsBufferOut.resize (randomsBuffer->GetBufferSize () / sizeof (glm::uvec4));
 
-    memcpy (randomsBufferOut.data (), randomsBuffer->buffers[checkedResourceIndex]->bufferCPUMapping.Get (), randomsBuffer->GetBufferSize ());
+    memcpy (randomsBufferOut.data (), randomsBuffer->buffers[checkedResourceIndex]->bufferCPUMapping->Get (), randomsBuffer->GetBufferSize ());
+}
+
+
+TEST_F (HeadlessTestEnvironment, BufferTransferable_StaticHasNoPersistentStaging)
+{
+    std::vector<uint32_t> values (256);
+    for (uint32_t i = 0; i < values.size (); ++i) {
+        values[i] = i * 3;
+    }
+
+    const size_t bufferSize = values.size () * sizeof (uint32_t);
+
+    RG::BufferTransferable staticBuffer (GetDeviceExtra (), bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    RG::BufferTransferable dynamicBuffer (GetDeviceExtra (), bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, RG::TransferableUsage::Dynamic);
+
+    EXPECT_FALSE (staticBuffer.IsDynamic ());
+    EXPECT_EQ (1, staticBuffer.GetAllocations ().size ());
+    EXPECT_TRUE (dynamicBuffer.IsDynamic ());
+    EXPECT_EQ (2, dynamicBuffer.GetAllocations ().size ());
+
+    // uploaded through transient staging memory
+    staticBuffer.TransferFromCPUToGPU (values.data (), bufferSize);
+
+    std::unique_ptr<RG::AsyncReadback> readback = staticBuffer.TransferFromGPUToCPUAsync ();
+    readback->Wait ();
+    EXPECT_EQ (0, memcmp (readback->Get (), values.data (), bufferSize));
+
+    RG::ReadOnlyImageResource image (VK_FORMAT_R8G8B8A8_UINT, 16, 16);
+    image.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+
+    EXPECT_FALSE (image.image->IsDynamic ());
+    EXPECT_EQ (1, image.GetAllocations ().size ());
+}
+
+
+TEST_F (HeadlessTestEnvironment, MemoryLocation_FallsBackWhenUnavailable)
+{
+    const RG::Buffer bar (GetDeviceExtra ().GetAllocator (), 256, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, RG::MemoryLocation::GPUHostVisible);
+    EXPECT_TRUE (RG::IsHostVisible (bar.GetMemoryLocation ()));
+
+    const RG::Buffer readback (GetDeviceExtra ().GetAllocator (), 256, VK_BUFFER_USAGE_TRANSFER_DST_BIT, RG::MemoryLocation::CPUReadback);
+    EXPECT_TRUE (RG::IsHostVisible (readback.GetMemoryLocation ()));
+
+    // buffers can not be placed in lazily allocated memory
+    const RG::Buffer lazy (GetDeviceExtra ().GetAllocator (), 256, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, RG::MemoryLocation::GPULazilyAllocated);
+    EXPECT_EQ (RG::MemoryLocation::GPU, lazy.GetMemoryLocation ());
+
+    std::shared_ptr<RG::CPUBufferResource> uniform = std::make_unique<RG::CPUBufferResource> (static_cast<uint32_t> (sizeof (glm::vec4)), RG::MemoryLocation::GPUHostVisible);
+    uniform->Compile (RG::GraphSettings (GetDeviceExtra (), 2));
+
+    uniform->GetMapping (1).Copy (glm::vec4 (1.f, 0.f, 0.f, 1.f));
+    EXPECT_EQ (2, uniform->GetAllocations ().size ());
+}
+
+
+TEST_F (HeadlessTestEnvironment, ImageData_CompareTo)
+{
+    // odd size so the vectorized path also goes through its scalar tail
+    constexpr uint32_t width  = 37;
+    constexpr uint32_t height = 19;
+
+    std::vector<uint8_t> texels (width * height * 4);
+    for (uint32_t i = 0; i < texels.size (); ++i) {
+        texels[i] = static_cast<uint8_t> (i * 31 % 251);
+    }
+
+    std::vector<uint8_t> otherTexels = texels;
+
+    // red of pixel 5 differs by 10, green of pixel 100 by 1 and alpha of pixel 700 by 200
+    texels[5 * 4 + 0]        = 50;
+    otherTexels[5 * 4 + 0]   = 60;
+    texels[100 * 4 + 1]      = 100;
+    otherTexels[100 * 4 + 1] = 101;
+    texels[700 * 4 + 3]      = 250;
+    otherTexels[700 * 4 + 3] = 50;
+
+    const RG::ImageData image      = RG::ImageData::FromDataUint (texels, width, height, 4);
+    const RG::ImageData otherImage = RG::ImageData::FromDataUint (otherTexels, width, height, 4);
+
+    const RG::ImageData::ComparisonResult result = image.CompareTo (otherImage);
+    EXPECT_FALSE (result.equal);
+    EXPECT_EQ (uint32_t { 200 }, result.maxAbsError);
+    EXPECT_EQ (size_t { 2 }, result.mismatchCount);
+    EXPECT_NEAR (10.0 * std::log10 (255.0 * 255.0 / ((100.0 + 1.0 + 40000.0) / texels.size ())), result.psnr, 1e-9);
+
+    ASSERT_TRUE (result.diffImage != nullptr);
+    const std::vector<uint8_t>& diff = result.diffImage->data;
+    EXPECT_EQ (uint8_t { 10 }, diff[5 * 4 + 0]);
+    EXPECT_EQ (uint8_t { 255 }, diff[5 * 4 + 3]);
+    EXPECT_EQ (uint8_t { 0 }, diff[100 * 4 + 1]);
+    EXPECT_EQ (uint8_t { 0 }, diff[100 * 4 + 3]);
+    EXPECT_EQ (uint8_t { 200 }, diff[700 * 4 + 0]);
+    EXPECT_EQ (uint8_t { 255 }, diff[700 * 4 + 3]);
+
+    // the scalar path gives the same result
+    RG::ImageData::ComparisonSettings scalarSettings;
+    scalarSettings.useSIMD = false;
+
+    const RG::ImageData::ComparisonResult scalarResult = image.CompareTo (otherImage, scalarSettings);
+    EXPECT_EQ (result.maxAbsError, scalarResult.maxAbsError);
+    EXPECT_EQ (result.mismatchCount, scalarResult.mismatchCount);
+    EXPECT_EQ (result.psnr, scalarResult.psnr);
+    ASSERT_TRUE (scalarResult.diffImage != nullptr);
+    EXPECT_TRUE (diff == scalarResult.diffImage->data);
+
+    RG::ImageData::ComparisonSettings tolerantSettings;
+    tolerantSettings.tolerance = 10;
+    EXPECT_EQ (size_t { 1 }, image.CompareTo (otherImage, tolerantSettings).mismatchCount);
+
+    // stops at the first mismatch
+    RG::ImageData::ComparisonSettings earlyExitSettings;
+    earlyExitSettings.createDiffImage = false;
+    earlyExitSettings.computeMetrics  = false;
+
+    const RG::ImageData::ComparisonResult earlyExitResult = image.CompareTo (otherImage, earlyExitSettings);
+    EXPECT_FALSE (earlyExitResult.equal);
+    EXPECT_TRUE (earlyExitResult.diffImage == nullptr);
+
+    const RG::ImageData::ComparisonResult sameResult = image.CompareTo (image);
+    EXPECT_TRUE (sameResult.equal);
+    EXPECT_EQ (uint32_t { 0 }, sameResult.maxAbsError);
+    EXPECT_TRUE (std::isinf (sameResult.psnr));
+    EXPECT_TRUE (sameResult.diffImage == nullptr);
+
+    // 3 component images take the scalar path
+    std::vector<uint8_t> rgbTexels (width * height * 3, 0);
+    std::vector<uint8_t> otherRgbTexels = rgbTexels;
+    otherRgbTexels[10 * 3 + 2]          = 30;
+
+    const RG::ImageData::ComparisonResult rgbResult = RG::ImageData::FromDataUint (rgbTexels, width, height, 3).CompareTo (RG::ImageData::FromDataUint (otherRgbTexels, width, height, 3));
+    EXPECT_FALSE (rgbResult.equal);
+    EXPECT_EQ (size_t { 1 }, rgbResult.mismatchCount);
+    ASSERT_TRUE (rgbResult.diffImage != nullptr);
+    EXPECT_EQ (uint8_t { 30 }, rgbResult.diffImage->data[10 * 3 + 0]);
+}
+
+
+TEST_F (HeadlessTestEnvironment, PixelConversion_Kernels)
+{
+    // odd count so the vectorized paths also go through their scalar tails
+    constexpr size_t pixelCount = 37;
+
+    std::vector<uint8_t> pixels (pixelCount * 4);
+    for (size_t i = 0; i < pixels.size (); ++i) {
+        pixels[i] = static_cast<uint8_t> (i * 7 % 256);
+    }
+
+    std::vector<uint8_t> swizzled = pixels;
+    RG::SwizzleRGBA8 (swizzled.data (), pixelCount, { 2, 1, 0, 3 });
+    for (size_t i = 0; i < pixelCount; ++i) {
+        EXPECT_EQ (pixels[i * 4 + 2], swizzled[i * 4 + 0]);
+        EXPECT_EQ (pixels[i * 4 + 1], swizzled[i * 4 + 1]);
+        EXPECT_EQ (pixels[i * 4 + 0], swizzled[i * 4 + 2]);
+        EXPECT_EQ (pixels[i * 4 + 3], swizzled[i * 4 + 3]);
+    }
+
+    std::vector<uint8_t> rotated = pixels;
+    RG::SwizzleRGBA8 (rotated.data (), pixelCount, { 3, 0, 1, 2 });
+    for (size_t i = 0; i < pixelCount; ++i) {
+        EXPECT_EQ (pixels[i * 4 + 3], rotated[i * 4 + 0]);
+        EXPECT_EQ (pixels[i * 4 + 0], rotated[i * 4 + 1]);
+    }
+
+    std::vector<float> floats (pixelCount * 4);
+    for (size_t i = 0; i < floats.size (); ++i) {
+        floats[i] = static_cast<float> (i) / static_cast<float> (floats.size ()) * 1.5f - 0.25f;
+    }
+    floats[3] = std::nanf ("");
+
+    std::vector<uint8_t> unorm (floats.size ());
+    RG::FloatToUnorm8 (floats.data (), unorm.data (), floats.size ());
+    EXPECT_EQ (uint8_t { 0 }, unorm[0]);
+    EXPECT_EQ (uint8_t { 0 }, unorm[3]);
+    EXPECT_EQ (uint8_t { 255 }, unorm.back ());
+    for (size_t i = 4; i < floats.size (); ++i) {
+        const float clamped = std::min (std::max (floats[i], 0.f), 1.f);
+        EXPECT_EQ (static_cast<uint8_t> (clamped * 255.f + 0.5f), unorm[i]);
+    }
+
+    std::vector<uint8_t> allValues (256);
+    for (size_t i = 0; i < allValues.size (); ++i) {
+        allValues[i] = static_cast<uint8_t> (i);
+    }
+
+    std::vector<float> normalized (allValues.size ());
+    RG::Unorm8ToFloat (allValues.data (), normalized.data (), allValues.size ());
+    EXPECT_EQ (0.f, normalized[0]);
+    EXPECT_EQ (1.f, normalized[255]);
+
+    std::vector<uint8_t> roundTrip (allValues.size ());
+    RG::FloatToUnorm8 (normalized.data (), roundTrip.data (), normalized.size ());
+    EXPECT_TRUE (allValues == roundTrip);
+
+    // 64 pixels with 4 components, alpha is not encoded
+    std::vector<float> linear (allValues.size ());
+    RG::SRGB8ToLinear (allValues.data (), linear.data (), allValues.size () / 4, 4);
+    for (size_t i = 0; i < allValues.size (); ++i) {
+        const double encoded  = allValues[i] / 255.0;
+        const double expected = (i % 4 == 3) ? encoded : (encoded <= 0.04045 ? encoded / 12.92 : std::pow ((encoded + 0.055) / 1.055, 2.4));
+        EXPECT_NEAR (expected, linear[i], 1e-6);
+    }
+
+    std::vector<uint8_t> srgbRoundTrip (allValues.size ());
+    RG::LinearToSRGB8 (linear.data (), srgbRoundTrip.data (), allValues.size () / 4, 4);
+    EXPECT_TRUE (allValues == srgbRoundTrip);
+
+    std::vector<uint8_t> rgb (pixelCount * 3);
+    RG::RGBA8ToRGB8 (pixels.data (), rgb.data (), pixelCount);
+    for (size_t i = 0; i < pixelCount; ++i) {
+        EXPECT_EQ (pixels[i * 4 + 0], rgb[i * 3 + 0]);
+        EXPECT_EQ (pixels[i * 4 + 2], rgb[i * 3 + 2]);
+    }
+
+    std::vector<uint8_t> rgba (pixelCount * 4);
+    RG::RGB8ToRGBA8 (rgb.data (), rgba.data (), pixelCount, 128);
+    for (size_t i = 0; i < pixelCount; ++i) {
+        EXPECT_EQ (pixels[i * 4 + 1], rgba[i * 4 + 1]);
+        EXPECT_EQ (uint8_t { 128 }, rgba[i * 4 + 3]);
+    }
+}
+
+
+TEST_F (HeadlessTestEnvironment, ImageData_FromImageLayerConverted)
+{
+    RG::ReadOnlyImageResource image (VK_FORMAT_B8G8R8A8_UNORM, 4, 4);
+    image.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+
+    // B = 10, G = 20, R = 30, A = 40
+    image.CopyTransitionTransfer (std::vector<uint32_t> (4 * 4, 0x281E140A));
+
+    const RG::ImageData converted = RG::ImageData::FromImageLayerConverted (GetDeviceExtra (), *image.image->imageGPU, 0, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    ASSERT_EQ (size_t { 4 * 4 * 4 }, converted.data.size ());
+    for (size_t i = 0; i < converted.data.size (); i += 4) {
+        EXPECT_EQ (uint8_t { 30 }, converted.data[i + 0]);
+        EXPECT_EQ (uint8_t { 20 }, converted.data[i + 1]);
+        EXPECT_EQ (uint8_t { 10 }, converted.data[i + 2]);
+        EXPECT_EQ (uint8_t { 40 }, converted.data[i + 3]);
+    }
+}
+
+
+TEST_F (HeadlessTestEnvironment, ImageData_VolumeReadback)
+{
+    constexpr uint32_t size = 8;
+
+    RG::ReadOnlyImageResource volume (VK_FORMAT_R8G8B8A8_UNORM, size, size, size);
+    volume.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+
+    // every texel holds its own index, so a slice read from the wrong depth is detected
+    std::vector<uint32_t> texels (size * size * size);
+    for (uint32_t i = 0; i < texels.size (); ++i) {
+        texels[i] = i;
+    }
+    volume.CopyTransitionTransfer (texels);
+
+    const RG::ImageData data (GetDeviceExtra (), *volume.image->imageGPU, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    EXPECT_EQ (size_t { size }, data.width);
+    EXPECT_EQ (size_t { size }, data.height);
+    EXPECT_EQ (size_t { size }, data.depth);
+    ASSERT_EQ (texels.size () * sizeof (uint32_t), data.data.size ());
+    EXPECT_EQ (0, memcmp (texels.data (), data.data.data (), data.data.size ()));
+}
+
+
+TEST_F (HeadlessTestEnvironment, ImageFile_DecodesIntoStagingMemory)
+{
+    // binary PPM, copied from the mapping without decoding
+    std::vector<uint8_t> ppm;
+    for (const char c : std::string ("P6\n# comment\n4 2\n255\n")) {
+        ppm.push_back (static_cast<uint8_t> (c));
+    }
+    for (uint8_t i = 0; i < 4 * 2 * 3; ++i) {
+        ppm.push_back (static_cast<uint8_t> (i * 10));
+    }
+
+    const std::filesystem::path ppmPath = std::filesystem::temp_directory_path () / "RenderGraph_ImageFile.ppm";
+    ASSERT_TRUE (RG::WriteBinaryFile (ppmPath, ppm));
+
+    {
+        const RG::ImageFile rawFile (ppmPath);
+        ASSERT_TRUE (rawFile.IsValid ());
+        EXPECT_EQ (uint32_t { 4 }, rawFile.GetWidth ());
+        EXPECT_EQ (uint32_t { 2 }, rawFile.GetHeight ());
+        EXPECT_TRUE (rawFile.IsRaw (3));
+        EXPECT_FALSE (rawFile.IsRaw (4));
+
+        std::vector<uint8_t> pixels (rawFile.GetDecodedSize (3));
+        ASSERT_TRUE (rawFile.DecodeTo (pixels.data (), pixels.size (), 3));
+        EXPECT_EQ (0, memcmp (pixels.data (), ppm.data () + ppm.size () - pixels.size (), pixels.size ()));
+
+        EXPECT_TRUE (RG::ImageData::FromDataUint (pixels, 4, 2, 3) == RG::ImageData (ppmPath, 3));
+
+        // expanded by the decoder
+        const RG::ImageData rgba (ppmPath, 4);
+        EXPECT_EQ (uint8_t { 255 }, rgba.data[3]);
+        EXPECT_EQ (pixels[3], rgba.data[4]);
+    }
+
+    std::filesystem::remove (ppmPath);
+
+    const RG::ImageFile pngFile (ReferenceImagesFolder / "blue_32x32.png");
+    const RG::ImageData referenceImage (ReferenceImagesFolder / "blue_32x32.png");
+    ASSERT_TRUE (pngFile.IsValid ());
+    EXPECT_FALSE (pngFile.IsRaw (4));
+
+    RG::ReadOnlyImageResource image (VK_FORMAT_R8G8B8A8_UINT, pngFile.GetWidth (), pngFile.GetHeight ());
+    image.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+
+    {
+        RG::UploadBatch batch (GetDeviceExtra ());
+        EXPECT_TRUE (image.CopyLayer (batch, pngFile, 0));
+        EXPECT_EQ (pngFile.GetDecodedSize (4), batch.GetUploadedBytes ());
+        batch.Wait ();
+    }
+
+    EXPECT_TRUE (RG::ImageData (GetDeviceExtra (), *image.image->imageGPU, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) == referenceImage);
+}
+
+
+TEST_F (HeadlessTestEnvironment, AssetLoader_ReportsEveryAsset)
+{
+    constexpr uint32_t assetCount = 8;
+
+    std::vector<std::filesystem::path>                      filePaths;
+    std::vector<std::shared_ptr<RG::ReadOnlyImageResource>> images;
+
+    for (uint32_t assetIndex = 0; assetIndex < assetCount; ++assetIndex) {
+        std::vector<uint8_t> pgm;
+        for (const char c : std::string ("P5 16 16 255\n")) {
+            pgm.push_back (static_cast<uint8_t> (c));
+        }
+        pgm.resize (pgm.size () + 16 * 16, static_cast<uint8_t> (assetIndex * 20));
+
+        const std::filesystem::path& filePath = filePaths.emplace_back (std::filesystem::temp_directory_path () / ("RenderGraph_AssetLoader_" + std::to_string (assetIndex) + ".pgm"));
+        ASSERT_TRUE (RG::WriteBinaryFile (filePath, pgm));
+
+        images.push_back (std::make_unique<RG::ReadOnlyImageResource> (VK_FORMAT_R8_UINT, 16, 16));
+        images.back ()->Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+    }
+
+    // does not match the size of the files
+    RG::ReadOnlyImageResource wrongSize (VK_FORMAT_R8_UINT, 8, 8);
+    wrongSize.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+
+    std::vector<RG::AssetLoader::AssetId> uploaded;
+    std::vector<RG::AssetLoader::AssetId> failed;
+
+    {
+        // tiny batches, so several of them are in flight
+        RG::AssetLoader loader (GetDeviceExtra (), 4, 512);
+
+        RG::EventObserver observer;
+        observer.Observe (loader.assetLoaded, [&] (RG::AssetLoader::AssetId id, bool success) {
+            (success ? uploaded : failed).push_back (id);
+        });
+
+        std::vector<RG::AssetLoader::AssetId> ids;
+        for (uint32_t assetIndex = 0; assetIndex < assetCount; ++assetIndex) {
+            ids.push_back (loader.LoadImageFile (filePaths[assetIndex], *images[assetIndex]->image->imageGPU, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+        }
+        const RG::AssetLoader::AssetId wrongSizeId = loader.LoadImageFile (filePaths[0], *wrongSize.image->imageGPU, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        loader.Wait (ids[0]);
+        EXPECT_EQ (RG::AssetLoader::AssetState::Uploaded, loader.GetState (ids[0]));
+
+        loader.Wait ();
+
+        for (const RG::AssetLoader::AssetId id : ids) {
+            EXPECT_EQ (RG::AssetLoader::AssetState::Uploaded, loader.GetState (id));
+        }
+        EXPECT_EQ (RG::AssetLoader::AssetState::Failed, loader.GetState (wrongSizeId));
+    }
+
+    EXPECT_EQ (size_t { assetCount }, uploaded.size ());
+    EXPECT_EQ (size_t { 1 }, failed.size ());
+
+    for (uint32_t assetIndex = 0; assetIndex < assetCount; ++assetIndex) {
+        std::unique_ptr<RG::AsyncReadback> readback = RG::AsyncReadback::FromImageLayer (GetDeviceExtra (), *images[assetIndex]->image->imageGPU, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        readback->Wait ();
+
+        const uint8_t* pixels = reinterpret_cast<const uint8_t*> (readback->Get ());
+        EXPECT_EQ (static_cast<uint8_t> (assetIndex * 20), pixels[0]);
+        EXPECT_EQ (static_cast<uint8_t> (assetIndex * 20), pixels[16 * 16 - 1]);
+
+        std::filesystem::remove (filePaths[assetIndex]);
+    }
+}
+
+
+TEST_F (HeadlessTestEnvironment, AssetLoader_UpdateSubmitsLastBatch)
+{
+    std::vector<uint8_t> pgm;
+    for (const char c : std::string ("P5 16 16 255\n")) {
+        pgm.push_back (static_cast<uint8_t> (c));
+    }
+    pgm.resize (pgm.size () + 16 * 16, static_cast<uint8_t> (100));
+
+    const std::filesystem::path filePath = std::filesystem::temp_directory_path () / "RenderGraph_AssetLoader_Polled.pgm";
+    ASSERT_TRUE (RG::WriteBinaryFile (filePath, pgm));
+
+    RG::ReadOnlyImageResource image (VK_FORMAT_R8_UINT, 16, 16);
+    image.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+
+    bool loaded = false;
+
+    {
+        // the single asset never fills the default batch, only Update can close it
+        RG::AssetLoader loader (GetDeviceExtra (), 2);
+
+        RG::EventObserver observer;
+        observer.Observe (loader.assetLoaded, [&] (RG::AssetLoader::AssetId, bool success) {
+            EXPECT_TRUE (success);
+            loaded = true;
+        });
+
+        loader.LoadImageFile (filePath, *image.image->imageGPU, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        const auto deadline = std::chrono::steady_clock::now () + std::chrono::seconds (10);
+        while (!loaded && std::chrono::steady_clock::now () < deadline) {
+            loader.Update ();
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+        }
+
+        // checked before the destructor waits for the asset
+        EXPECT_TRUE (loaded);
+    }
+
+    std::unique_ptr<RG::AsyncReadback> readback = RG::AsyncReadback::FromImageLayer (GetDeviceExtra (), *image.image->imageGPU, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    readback->Wait ();
+
+    EXPECT_EQ (uint8_t { 100 }, reinterpret_cast<const uint8_t*> (readback->Get ())[0]);
+
+    std::filesystem::remove (filePath);
+}
+
+
+TEST_F (HeadlessTestEnvironment, ReadOnlyImageResource_RegionUpload)
+{
+    constexpr uint32_t size = 16;
+
+    RG::ReadOnlyImageResource volume (VK_FORMAT_R8_UINT, size, size, size);
+    volume.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+
+    volume.CopyTransitionTransfer (std::vector<uint8_t> (size * size * size, 0));
+
+    // one 4x4x4 brick in the middle of the volume
+    volume.CopyRegion (std::vector<uint8_t> (4 * 4 * 4, 200), { 4, 8, 12 }, { 4, 4, 4 });
+
+    // the same brick read from a whole volume, the last row is not padded
+    VkBufferImageCopy brick = volume.image->imageGPU->GetBufferImageCopyRegion ({ 4, 8, 12 }, { 4, 4, 4 }, 0);
+    EXPECT_EQ (size_t { 4 * 4 * 4 }, volume.image->imageGPU->GetBufferImageCopySize (brick));
+    brick.bufferRowLength   = size;
+    brick.bufferImageHeight = size;
+    EXPECT_EQ (size_t { 3 * size * size + 3 * size + 4 }, volume.image->imageGPU->GetBufferImageCopySize (brick));
+
+    // two slices of an array texture from one source, only layer 2 is touched
+    RG::ReadOnlyImageResource array (VK_FORMAT_R8_UINT, size, size, 1, 4);
+    array.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+
+    std::vector<uint8_t> columns (size * 2);
+    for (uint32_t i = 0; i < columns.size (); ++i) {
+        columns[i] = static_cast<uint8_t> (i);
+    }
+
+    std::vector<VkBufferImageCopy> regions;
+    for (uint32_t half = 0; half < 2; ++half) {
+        VkBufferImageCopy region = array.image->imageGPU->GetBufferImageCopyRegion ({ static_cast<int32_t> (half * size / 2), 0, 0 }, { size / 2, 1, 1 }, 2);
+        region.bufferOffset      = half * size;
+        regions.push_back (region);
+    }
+
+    {
+        RG::UploadBatch batch (GetDeviceExtra ());
+        array.CopyRegions (batch, columns, regions);
+        batch.Wait ();
+    }
+
+    std::unique_ptr<RG::AsyncReadback> volumeReadback = RG::AsyncReadback::FromImageLayer (GetDeviceExtra (), *volume.image->imageGPU, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    std::unique_ptr<RG::AsyncReadback> arrayReadback  = RG::AsyncReadback::FromImageLayer (GetDeviceExtra (), *array.image->imageGPU, 2, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    volumeReadback->Wait ();
+    arrayReadback->Wait ();
+
+    const uint8_t* volumeTexels = reinterpret_cast<const uint8_t*> (volumeReadback->Get ());
+    EXPECT_EQ (uint8_t { 200 }, volumeTexels[12 * size * size + 8 * size + 4]);
+    EXPECT_EQ (uint8_t { 200 }, volumeTexels[15 * size * size + 11 * size + 7]);
+    EXPECT_EQ (uint8_t { 0 }, volumeTexels[12 * size * size + 8 * size + 8]);
+    EXPECT_EQ (uint8_t { 0 }, volumeTexels[0]);
+
+    const uint8_t* arrayTexels = reinterpret_cast<const uint8_t*> (arrayReadback->Get ());
+    EXPECT_EQ (uint8_t { 0 }, arrayTexels[0]);
+    EXPECT_EQ (uint8_t { 7 }, arrayTexels[7]);
+    EXPECT_EQ (uint8_t { 16 }, arrayTexels[8]);
+    EXPECT_EQ (uint8_t { 23 }, arrayTexels[15]);
+}
+
+
+TEST_F (HeadlessTestEnvironment, ReadOnlyImageResource_MipLevels)
+{
+    constexpr uint32_t size = 16;
+
+    RG::ReadOnlyImageResource texture (VK_FORMAT_R8G8B8A8_UNORM, size, size);
+    texture.EnableMipLevels ();
+    texture.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+
+    // blitting is mandatory for this format
+    ASSERT_EQ (uint32_t { 5 }, texture.GetMipLevels ());
+
+    // alternating columns of 0 and 200 in the red channel, every other level averages to 100
+    std::vector<uint32_t> texels (size * size);
+    for (uint32_t i = 0; i < texels.size (); ++i) {
+        texels[i] = (i % 2 == 0) ? 0xff000000 : 0xff0000c8;
+    }
+
+    texture.CopyTransitionTransfer (texels);
+
+    const RG::Image& image = *texture.image->imageGPU;
+
+    RG::AsyncReadback lastLevelReadback (GetDeviceExtra (), GetDeviceExtra ().GetReadbackPool (), 4, [&] (RG::CommandBuffer& commandBuffer, VkBuffer stagingBuffer) {
+        VkBufferImageCopy region         = image.GetBufferImageCopyRegion ({ 0, 0, 0 }, { 1, 1, 1 }, 0);
+        region.imageSubresource.mipLevel = 4;
+
+        commandBuffer.Record<RG::CommandTranstionImage> (image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        commandBuffer.Record<RG::CommandCopyImageToBuffer> (image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, stagingBuffer, std::vector<VkBufferImageCopy> { region });
+        commandBuffer.Record<RG::CommandTranstionImage> (image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    });
+
+    std::unique_ptr<RG::AsyncReadback> levelZeroReadback = RG::AsyncReadback::FromImageLayer (GetDeviceExtra (), image, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    const uint8_t* lastLevel = lastLevelReadback.GetAs<uint8_t> ();
+    EXPECT_NEAR (100, lastLevel[0], 2);
+    EXPECT_EQ (uint8_t { 255 }, lastLevel[3]);
+
+    const uint8_t* levelZero = levelZeroReadback->GetAs<uint8_t> ();
+    EXPECT_EQ (uint8_t { 0 }, levelZero[0]);
+    EXPECT_EQ (uint8_t { 200 }, levelZero[4]);
+}
+
+
+TEST_F (HeadlessTestEnvironment, ReadOnlyImageResource_BlockCompressed)
+{
+    constexpr uint32_t size = 32;
+
+    // diagonal gradient in red and green, opaque
+    std::vector<uint8_t> texels (size * size * 4);
+    for (uint32_t y = 0; y < size; ++y) {
+        for (uint32_t x = 0; x < size; ++x) {
+            const uint8_t value            = static_cast<uint8_t> ((x + y) * 4);
+            texels[(y * size + x) * 4 + 0] = value;
+            texels[(y * size + x) * 4 + 1] = value;
+            texels[(y * size + x) * 4 + 2] = 0;
+            texels[(y * size + x) * 4 + 3] = 255;
+        }
+    }
+
+    const RG::ImageData source = RG::ImageData::FromDataUint (texels, size, size, 4);
+
+    const auto GetMaxError = [&] (const RG::ImageData& decoded, uint32_t componentCount) {
+        int maxError = 0;
+        for (size_t texel = 0; texel < size * size; ++texel) {
+            for (uint32_t component = 0; component < componentCount; ++component) {
+                maxError = std::max (maxError, std::abs (static_cast<int> (decoded.data[texel * 4 + component]) - static_cast<int> (texels[texel * 4 + component])));
+            }
+        }
+        return maxError;
+    };
+
+    const RG::CompressedImageData bc1 = RG::CompressedImageData::Encode (source, VK_FORMAT_BC1_RGB_UNORM_BLOCK);
+    const RG::CompressedImageData bc4 = RG::CompressedImageData::Encode (source, VK_FORMAT_BC4_UNORM_BLOCK);
+    const RG::CompressedImageData bc5 = RG::CompressedImageData::Encode (source, VK_FORMAT_BC5_UNORM_BLOCK);
+    const RG::CompressedImageData bc7 = RG::CompressedImageData::Encode (source, VK_FORMAT_BC7_UNORM_BLOCK);
+
+    // 64 blocks of 8 or 16 bytes
+    EXPECT_EQ (size_t { 512 }, bc1.blocks.size ());
+    EXPECT_EQ (size_t { 512 }, bc4.blocks.size ());
+    EXPECT_EQ (size_t { 1024 }, bc5.blocks.size ());
+    EXPECT_EQ (size_t { 1024 }, bc7.blocks.size ());
+
+    EXPECT_LE (GetMaxError (bc1.Decode (), 3), 8);
+    EXPECT_LE (GetMaxError (bc4.Decode (), 1), 4);
+    EXPECT_LE (GetMaxError (bc5.Decode (), 2), 4);
+    EXPECT_LE (GetMaxError (bc7.Decode (), 4), 4);
+
+    const std::filesystem::path cachePath = std::filesystem::temp_directory_path () / "RenderGraphTest" / "gradient.bc7";
+    ASSERT_TRUE (bc7.SaveToFile (cachePath));
+
+    const std::optional<RG::CompressedImageData> loaded = RG::CompressedImageData::LoadFromFile (cachePath);
+    ASSERT_TRUE (loaded.has_value ());
+    EXPECT_EQ (VK_FORMAT_BC7_UNORM_BLOCK, loaded->format);
+    EXPECT_EQ (size, loaded->width);
+    EXPECT_EQ (size, loaded->height);
+    EXPECT_TRUE (loaded->blocks == bc7.blocks);
+
+    std::filesystem::remove (cachePath);
+
+    // sampling BC formats is an optional feature
+    if ((GetDeviceExtra ().GetOptimalTilingFeatures (VK_FORMAT_BC7_UNORM_BLOCK) & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) == 0) {
+        GTEST_SKIP () << "BC7 is not supported by the device, skipping upload";
+    }
+
+    RG::ReadOnlyImageResource texture (VK_FORMAT_BC7_UNORM_BLOCK, size, size);
+    texture.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+
+    {
+        RG::UploadBatch batch (GetDeviceExtra ());
+        texture.CopyLayer (batch, bc7, 0);
+        batch.Wait ();
+    }
+
+    const RG::Image& image = *texture.image->imageGPU;
+
+    RG::AsyncReadback readback (GetDeviceExtra (), GetDeviceExtra ().GetReadbackPool (), bc7.blocks.size (), [&] (RG::CommandBuffer& commandBuffer, VkBuffer stagingBuffer) {
+        const VkBufferImageCopy region = image.GetFullBufferImageCopy ();
+
+        commandBuffer.Record<RG::CommandTranstionImage> (image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        commandBuffer.Record<RG::CommandCopyImageToBuffer> (image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, stagingBuffer, std::vector<VkBufferImageCopy> { region });
+        commandBuffer.Record<RG::CommandTranstionImage> (image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    });
+
+    EXPECT_EQ (0, memcmp (readback.GetAs<uint8_t> (), bc7.blocks.data (), bc7.blocks.size ()));
+}
+
+
+TEST_F (HeadlessTestEnvironment, CompressedImageData_LoadCached)
+{
+    constexpr uint32_t size = 16;
+
+    std::vector<uint8_t> texels (size * size * 4);
+    for (size_t i = 0; i < texels.size (); ++i) {
+        texels[i] = static_cast<uint8_t> ((i % 4 == 3) ? 255 : i);
+    }
+
+    const std::filesystem::path folder     = std::filesystem::temp_directory_path () / "RenderGraphTest";
+    const std::filesystem::path sourcePath = folder / "LoadCached_source.png";
+    const std::filesystem::path cachePath  = folder / "LoadCached_source.bc";
+
+    std::filesystem::create_directories (folder);
+    std::filesystem::remove (cachePath);
+
+    RG::ImageData::FromDataUint (texels, size, size, 4).SaveTo (sourcePath);
+
+    const RG::CompressedImageData encodedBC1 = RG::CompressedImageData::Encode (RG::ImageData (sourcePath, 4), VK_FORMAT_BC1_RGB_UNORM_BLOCK);
+    const RG::CompressedImageData encodedBC4 = RG::CompressedImageData::Encode (RG::ImageData (sourcePath, 4), VK_FORMAT_BC4_UNORM_BLOCK);
+
+    // a cache with different content than the source, it is returned only when the cache is used
+    const RG::CompressedImageData marker = RG::CompressedImageData::Encode (RG::ImageData::FromDataUint (std::vector<uint8_t> (size * size * 4, 255), size, size, 4), VK_FORMAT_BC1_RGB_UNORM_BLOCK);
+    ASSERT_FALSE (marker.blocks == encodedBC1.blocks);
+
+    const std::filesystem::file_time_type sourceTime = std::filesystem::last_write_time (sourcePath);
+
+    // no cache yet, the source is encoded and the cache is written
+    {
+        const std::optional<RG::CompressedImageData> loaded = RG::CompressedImageData::LoadCached (sourcePath, cachePath, VK_FORMAT_BC1_RGB_UNORM_BLOCK);
+        ASSERT_TRUE (loaded.has_value ());
+        EXPECT_TRUE (loaded->blocks == encodedBC1.blocks);
+        EXPECT_TRUE (std::filesystem::exists (cachePath));
+    }
+
+    // cache hit, the cache is newer than the source
+    {
+        ASSERT_TRUE (marker.SaveToFile (cachePath));
+        std::filesystem::last_write_time (cachePath, sourceTime + std::chrono::hours (1));
+
+        const std::optional<RG::CompressedImageData> loaded = RG::CompressedImageData::LoadCached (sourcePath, cachePath, VK_FORMAT_BC1_RGB_UNORM_BLOCK);
+        ASSERT_TRUE (loaded.has_value ());
+        EXPECT_TRUE (loaded->blocks == marker.blocks);
+    }
+
+    // the source is newer than the cache, it is encoded again and the cache is overwritten
+    {
+        ASSERT_TRUE (marker.SaveToFile (cachePath));
+        std::filesystem::last_write_time (cachePath, sourceTime - std::chrono::hours (1));
+
+        const std::optional<RG::CompressedImageData> loaded = RG::CompressedImageData::LoadCached (sourcePath, cachePath, VK_FORMAT_BC1_RGB_UNORM_BLOCK);
+        ASSERT_TRUE (loaded.has_value ());
+        EXPECT_TRUE (loaded->blocks == encodedBC1.blocks);
+
+        const std::optional<RG::CompressedImageData> cached = RG::CompressedImageData::LoadFromFile (cachePath);
+        ASSERT_TRUE (cached.has_value ());
+        EXPECT_TRUE (cached->blocks == encodedBC1.blocks);
+    }
+
+    // the cache has another format, it is encoded again in the requested one
+    {
+        ASSERT_TRUE (marker.SaveToFile (cachePath));
+        std::filesystem::last_write_time (cachePath, sourceTime + std::chrono::hours (1));
+
+        const std::optional<RG::CompressedImageData> loaded = RG::CompressedImageData::LoadCached (sourcePath, cachePath, VK_FORMAT_BC4_UNORM_BLOCK);
+        ASSERT_TRUE (loaded.has_value ());
+        EXPECT_EQ (VK_FORMAT_BC4_UNORM_BLOCK, loaded->format);
+        EXPECT_TRUE (loaded->blocks == encodedBC4.blocks);
+    }
+
+    std::filesystem::remove (sourcePath);
+
+    // a missing source, the cache is still usable, without it nothing can be loaded
+    {
+        const std::optional<RG::CompressedImageData> loaded = RG::CompressedImageData::LoadCached (sourcePath, cachePath, VK_FORMAT_BC4_UNORM_BLOCK);
+        ASSERT_TRUE (loaded.has_value ());
+        EXPECT_TRUE (loaded->blocks == encodedBC4.blocks);
+
+        std::filesystem::remove (cachePath);
+
+        EXPECT_FALSE (RG::CompressedImageData::LoadCached (sourcePath, cachePath, VK_FORMAT_BC4_UNORM_BLOCK).has_value ());
+    }
+}
+
+
+TEST_F (HeadlessTestEnvironment, GPUBufferResource_AsyncReadback)
+{
+    std::vector<uint32_t> values (1024);
+    for (uint32_t i = 0; i < values.size (); ++i) {
+        values[i] = i * 7;
+    }
+
+    RG::GPUBufferResource buffer (values.size () * sizeof (uint32_t));
+    buffer.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+
+    buffer.TransferFromCPUToGPU (0, values.data (), values.size () * sizeof (uint32_t));
+
+    RG::StagingBufferPool& pool = GetDeviceExtra ().GetReadbackPool ();
+
+    {
+        std::unique_ptr<RG::AsyncReadback> readback = buffer.TransferFromGPUToCPUAsync (0);
+        readback->Wait ();
+        EXPECT_TRUE (readback->IsReady ());
+        EXPECT_EQ (0, memcmp (readback->Get (), values.data (), readback->GetSize ()));
+    }
+
+    const size_t createdCount = pool.GetCreatedCount ();
+
+    {
+        // second readback reuses the released staging buffer
+        std::unique_ptr<RG::AsyncReadback> readback = buffer.TransferFromGPUToCPUAsync (0, 16 * sizeof (uint32_t), 16 * sizeof (uint32_t));
+        EXPECT_EQ (values[16], readback->GetAs<uint32_t> ()[0]);
+        EXPECT_EQ (values[31], readback->GetAs<uint32_t> ()[15]);
+    }
+
+    EXPECT_EQ (createdCount, pool.GetCreatedCount ());
+}
+
+
+TEST_F (HeadlessTestEnvironment, UploadBatch_SingleSubmission)
+{
+    std::vector<uint32_t> first (256, 3);
+    std::vector<uint32_t> second (512, 5);
+
+    RG::GPUBufferResource firstBuffer (first.size () * sizeof (uint32_t));
+    RG::GPUBufferResource secondBuffer (second.size () * sizeof (uint32_t));
+    firstBuffer.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+    secondBuffer.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+
+    {
+        RG::UploadBatch batch (GetDeviceExtra ());
+        firstBuffer.buffers[0]->TransferFromCPUToGPU (batch, first.data (), first.size () * sizeof (uint32_t));
+        secondBuffer.buffers[0]->TransferFromCPUToGPU (batch, second.data (), second.size () * sizeof (uint32_t));
+        RG::FullscreenQuad quad (GetDeviceExtra (), batch);
+
+        EXPECT_EQ (size_t { 4 }, batch.GetRecordedCopyCount ());
+
+        // quad buffers must outlive the submission
+        batch.Wait ();
+    }
+
+    EXPECT_EQ (0, memcmp (firstBuffer.TransferFromGPUToCPUAsync (0)->Get (), first.data (), first.size () * sizeof (uint32_t)));
+    EXPECT_EQ (0, memcmp (secondBuffer.TransferFromGPUToCPUAsync (0)->Get (), second.data (), second.size () * sizeof (uint32_t)));
+}
+
+
+TEST_F (HeadlessTestEnvironment, UploadBatch_PartialUploadKeepsContents)
+{
+    // with a dedicated transfer queue the buffer changes queue family ownership on every upload
+
+    std::vector<uint32_t> values (256, 1);
+    std::vector<uint32_t> patch (16, 9);
+
+    RG::GPUBufferResource buffer (values.size () * sizeof (uint32_t));
+    buffer.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+
+    buffer.TransferFromCPUToGPU (0, values.data (), values.size () * sizeof (uint32_t));
+
+    {
+        RG::UploadBatch batch (GetDeviceExtra ());
+        batch.CopyToBuffer (buffer.buffers[0]->bufferGPU, patch.data (), patch.size () * sizeof (uint32_t), 32 * sizeof (uint32_t));
+        batch.Wait ();
+    }
+
+    std::copy (patch.begin (), patch.end (), values.begin () + 32);
+
+    EXPECT_EQ (0, memcmp (buffer.TransferFromGPUToCPUAsync (0)->Get (), values.data (), values.size () * sizeof (uint32_t)));
+}
+
+
+TEST_F (HeadlessTestEnvironment, UploadBatch_UntouchedLayersKeepContents)
+{
+    constexpr uint32_t layerCount = 3;
+
+    RG::ReadOnlyImageResource image (VK_FORMAT_R8G8B8A8_UINT, 8, 8, 1, layerCount);
+    image.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+
+    {
+        RG::UploadBatch batch (GetDeviceExtra ());
+        for (uint32_t layerIndex = 0; layerIndex < layerCount; ++layerIndex) {
+            const std::vector<uint8_t> pixels (8 * 8 * 4, static_cast<uint8_t> (layerIndex + 1));
+            image.image->CopyLayer (batch, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, pixels.data (), pixels.size (), layerIndex, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        }
+        batch.Wait ();
+    }
+
+    // layer 1 lies between the uploaded layers, it must not be transitioned from an undefined layout
+    {
+        const std::vector<uint8_t> pixels (8 * 8 * 4, 9);
+
+        RG::UploadBatch batch (GetDeviceExtra ());
+        image.image->CopyLayer (batch, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, pixels.data (), pixels.size (), 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        image.image->CopyLayer (batch, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, pixels.data (), pixels.size (), 2, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        batch.Wait ();
+    }
+
+    const RG::ImageData layer0 (GetDeviceExtra (), *image.image->imageGPU, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    const RG::ImageData layer1 (GetDeviceExtra (), *image.image->imageGPU, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    const RG::ImageData layer2 (GetDeviceExtra (), *image.image->imageGPU, 2, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    const RG::ImageData uploaded = RG::ImageData::FromDataUint (std::vector<uint8_t> (8 * 8 * 4, 9), 8, 8, 4);
+    const RG::ImageData kept     = RG::ImageData::FromDataUint (std::vector<uint8_t> (8 * 8 * 4, 2), 8, 8, 4);
+
+    EXPECT_TRUE (layer0 == uploaded);
+    EXPECT_TRUE (layer1 == kept);
+    EXPECT_TRUE (layer2 == uploaded);
+}
+
+
+TEST_F (HeadlessTestEnvironment, DescriptorAllocator_LayoutCacheAndPoolReuse)
+{
+    RG::DescriptorAllocator allocator (GetDevice ());
+
+    VkDescriptorSetLayoutBinding uniformBinding = {};
+    uniformBinding.binding                      = 0;
+    uniformBinding.descriptorType               = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    uniformBinding.descriptorCount              = 1;
+    uniformBinding.stageFlags                   = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutBinding samplerBinding = {};
+    samplerBinding.binding                      = 1;
+    samplerBinding.descriptorType               = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    samplerBinding.descriptorCount              = 1;
+    samplerBinding.stageFlags                   = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    const RG::DescriptorSetLayout& layout      = allocator.GetLayout ({ uniformBinding, samplerBinding });
+    const RG::DescriptorSetLayout& sameLayout  = allocator.GetLayout ({ samplerBinding, uniformBinding });
+    const RG::DescriptorSetLayout& otherLayout = allocator.GetLayout ({ uniformBinding });
+
+    EXPECT_EQ (&layout, &sameLayout);
+    EXPECT_NE (&layout, &otherLayout);
+    EXPECT_EQ (size_t { 2 }, allocator.GetLayoutCount ());
+
+    {
+        std::unique_ptr<RG::DescriptorAllocation> first  = allocator.Allocate (layout, 3);
+        std::unique_ptr<RG::DescriptorAllocation> second = allocator.Allocate (layout, 3);
+
+        EXPECT_EQ (size_t { 3 }, first->GetSize ());
+        EXPECT_NE ((*first)[0], (*second)[0]);
+        EXPECT_EQ (size_t { 1 }, allocator.GetCreatedPoolCount ());
+    }
+
+    EXPECT_EQ (size_t { 1 }, allocator.GetPoolResetCount ());
+
+    // a recompile gets its sets from the recycled pool
+    std::unique_ptr<RG::DescriptorAllocation> recompiled = allocator.Allocate (layout, 3);
+    EXPECT_EQ (size_t { 1 }, allocator.GetCreatedPoolCount ());
+}
+
+
+TEST_F (HeadlessTestEnvironment, ReadOnlyImageResource_BindlessRegistration)
+{
+    if (!GetDeviceExtra ().HasBindlessTextures ()) {
+        GTEST_SKIP () << "descriptor indexing is not supported";
+    }
+
+    RG::BindlessTextureTable& bindlessTextures = GetDeviceExtra ().GetBindlessTextureTable ();
+
+    const uint32_t registeredBefore = bindlessTextures.GetRegisteredCount ();
+
+    {
+        RG::ReadOnlyImageResource first (VK_FORMAT_R8G8B8A8_UNORM, 16, 16);
+        RG::ReadOnlyImageResource second (VK_FORMAT_R8G8B8A8_UNORM, 16, 16);
+        RG::ReadOnlyImageResource regular (VK_FORMAT_R8G8B8A8_UNORM, 16, 16);
+
+        first.EnableBindless ();
+        second.EnableBindless ();
+
+        first.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+        second.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+        regular.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+
+        EXPECT_TRUE (first.IsBindless ());
+        EXPECT_FALSE (regular.IsBindless ());
+        EXPECT_NE (first.GetBindlessIndex (), second.GetBindlessIndex ());
+        EXPECT_EQ (registeredBefore + 2, bindlessTextures.GetRegisteredCount ());
+    }
+
+    EXPECT_EQ (registeredBefore, bindlessTextures.GetRegisteredCount ());
+}
+
+
+TEST_F (HeadlessTestEnvironment, CommandBuffer_ArenaReleasedOnReset)
+{
+    RG::CommandBuffer commandBuffer (GetDeviceExtra ());
+
+    VkMemoryBarrier memoryBarrier = {};
+    memoryBarrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    memoryBarrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT;
+
+    commandBuffer.Begin ();
+    for (uint32_t i = 0; i < 100; ++i) {
+        commandBuffer.Record<RG::CommandPipelineBarrier> (VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, std::vector<VkMemoryBarrier> { memoryBarrier }).SetName ("Barrier");
+    }
+    commandBuffer.End ();
+
+    // every command and its barrier array comes from the arena
+    EXPECT_EQ (size_t { 100 }, commandBuffer.recordedAbstractCommands.size ());
+    EXPECT_EQ (size_t { 200 }, commandBuffer.GetArena ().GetAllocationCount ());
+    EXPECT_TRUE (commandBuffer.recordedAbstractCommands[0]->IsEquivalent (*commandBuffer.recordedAbstractCommands[99]));
+
+    const size_t usedBytes     = commandBuffer.GetArena ().GetUsedBytes ();
+    const size_t reservedBytes = commandBuffer.GetArena ().GetReservedBytes ();
+
+    commandBuffer.Reset (false);
+
+    EXPECT_TRUE (commandBuffer.recordedAbstractCommands.empty ());
+    EXPECT_EQ (size_t { 0 }, commandBuffer.GetArena ().GetUsedBytes ());
+    EXPECT_EQ (reservedBytes, commandBuffer.GetArena ().GetReservedBytes ());
+
+    commandBuffer.SetRetainRecordedCommands (false);
+
+    commandBuffer.Begin ();
+    for (uint32_t i = 0; i < 100; ++i) {
+        commandBuffer.Record<RG::CommandPipelineBarrier> (VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, std::vector<VkMemoryBarrier> { memoryBarrier }).SetName ("Barrier");
+    }
+    commandBuffer.End ();
+
+    // only the last command is alive
+    EXPECT_TRUE (commandBuffer.recordedAbstractCommands.empty ());
+    EXPECT_LT (commandBuffer.GetArena ().GetUsedBytes () * 50, usedBytes);
+}
+
+
+TEST_F (HeadlessTestEnvironment, CommandBuffer_RedundantBindsElided)
+{
+    RG::Buffer vertexBuffer (*env->allocator, 256, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, RG::Buffer::MemoryLocation::GPU);
+    RG::Buffer indexBuffer (*env->allocator, 256, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, RG::Buffer::MemoryLocation::GPU);
+
+    RG::CommandBuffer commandBuffer (GetDeviceExtra ());
+
+    commandBuffer.Begin ();
+    for (uint32_t i = 0; i < 10; ++i) {
+        commandBuffer.Record<RG::CommandBindVertexBuffers> (0, 1, std::vector<VkBuffer> { vertexBuffer }, std::vector<VkDeviceSize> { 0 });
+        commandBuffer.Record<RG::CommandBindIndexBuffer> (indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+    }
+
+    // a different offset is a real state change
+    commandBuffer.Record<RG::CommandBindIndexBuffer> (indexBuffer, 64, VK_INDEX_TYPE_UINT16);
+
+    // anything may be bound by a generic command
+    commandBuffer.Record<RG::CommandGeneric> ([] (VkCommandBuffer) {});
+    commandBuffer.Record<RG::CommandBindIndexBuffer> (indexBuffer, 64, VK_INDEX_TYPE_UINT16);
+    commandBuffer.End ();
+
+    EXPECT_EQ (size_t { 18 }, commandBuffer.GetElidedCommandCount ());
+    EXPECT_EQ (size_t { 5 }, commandBuffer.recordedAbstractCommands.size ());
+
+    commandBuffer.Begin ();
+    EXPECT_EQ (size_t { 0 }, commandBuffer.GetElidedCommandCount ());
+    commandBuffer.Record<RG::CommandBindIndexBuffer> (indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+    commandBuffer.End ();
+
+    EXPECT_EQ (size_t { 1 }, commandBuffer.recordedAbstractCommands.size ());
+}
+
+
+namespace {
+
+const std::string redFillFragmentShader = R"(
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (location = 0) out vec4 outColor;
+
+void main () {
+    outColor = vec4 (1, 0, 0, 1);
+}
+    )";
+
+
+// copies inputColor to outColor texel by texel
+const std::string copyFragmentShader = R"(
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (binding = 0) uniform sampler2D inputColor;
+
+layout (location = 0) out vec4 outColor;
+
+void main () {
+    outColor = texelFetch (inputColor, ivec2 (gl_FragCoord.xy), 0);
+}
+    )";
+
+
+class AccumulatingTimer final : public RG::TimerObserver {
+public:
+    Duration total { 0.0 };
+
+    void TimerEnded (Duration delta) override
+    {
+        total += delta;
+    }
+};
+
+
+// prerecorded command buffers are not simultaneous use, a frame index is only submitted again after its previous submission finished
+class FrameSubmitter final {
+private:
+    RG::RenderGraph&                        graph;
+    std::vector<std::unique_ptr<RG::Fence>> frameFences;
+
+public:
+    FrameSubmitter (const RG::Device& device, RG::RenderGraph& graph, uint32_t framesInFlight)
+        : graph (graph)
+    {
+        for (uint32_t frameIndex = 0; frameIndex < framesInFlight; ++frameIndex) {
+            frameFences.push_back (std::make_unique<RG::Fence> (device, true));
+        }
+    }
+
+    void Submit (uint32_t frameIndex)
+    {
+        const RG::Fence& frameFence = *frameFences[frameIndex];
+        frameFence.Wait ();
+        frameFence.Reset ();
+
+        graph.Submit (frameIndex, {}, {}, frameFence);
+    }
+};
+
+
+// the components of an 8 bit image at the pixel
+std::vector<uint8_t> GetPixel (const RG::ImageData& image, size_t x, size_t y)
+{
+    const size_t offset = (y * image.width + x) * image.components;
+    return std::vector<uint8_t> (image.data.begin () + offset, image.data.begin () + offset + image.components);
+}
+
+
+// independent red fill operations, each writing its own image
+std::vector<std::shared_ptr<RG::WritableImageResource>> AddRedFillOperations (RG::GraphSettings& settings, const RG::Device& device, uint32_t operationCount, uint32_t size)
+{
+    std::vector<std::shared_ptr<RG::WritableImageResource>> result;
+
+    for (uint32_t i = 0; i < operationCount; ++i) {
+        std::shared_ptr<RG::RenderOperation> redFillOperation = RG::RenderOperation::Builder (device)
+                                                                    .SetVertices (std::make_unique<RG::DrawableInfo> (1, 6))
+                                                                    .SetPrimitiveTopology (VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+                                                                    .SetVertexShader (passThroughVertexShader)
+                                                                    .SetFragmentShader (redFillFragmentShader)
+                                                                    .Build ();
+
+        std::shared_ptr<RG::WritableImageResource> red = std::make_unique<RG::WritableImageResource> (size, size);
+
+        redFillOperation->compileSettings.attachmentProvider->table.push_back ({ "outColor", RG::ShaderKind::Fragment, { red->GetFormatProvider (), VK_ATTACHMENT_LOAD_OP_CLEAR, red->GetImageViewForFrameProvider (), red->GetInitialLayout (), red->GetFinalLayout () } });
+
+        settings.connectionSet.Add (redFillOperation, red);
+
+        result.push_back (red);
+    }
+
+    return result;
+}
+
+
+std::shared_ptr<RG::WritableImageResource> AddCopyOperation (RG::GraphSettings& settings, const RG::Device& device, const std::shared_ptr<RG::WritableImageResource>& input)
+{
+    std::shared_ptr<RG::RenderOperation> copyOperation = RG::RenderOperation::Builder (device)
+                                                             .SetVertices (std::make_unique<RG::DrawableInfo> (1, 6))
+                                                             .SetPrimitiveTopology (VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+                                                             .SetVertexShader (passThroughVertexShader)
+                                                             .SetFragmentShader (copyFragmentShader)
+                                                             .Build ();
+
+    std::shared_ptr<RG::WritableImageResource> copy = std::make_unique<RG::WritableImageResource> (input->width, input->height);
+
+    copyOperation->compileSettings.descriptorWriteProvider->imageInfos.push_back ({ "inputColor", RG::ShaderKind::Fragment, input->GetSamplerProvider (), input->GetImageViewForFrameProvider (), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+    copyOperation->compileSettings.attachmentProvider->table.push_back ({ "outColor", RG::ShaderKind::Fragment, { copy->GetFormatProvider (), VK_ATTACHMENT_LOAD_OP_CLEAR, copy->GetImageViewForFrameProvider (), copy->GetInitialLayout (), copy->GetFinalLayout () } });
+
+    settings.connectionSet.Add (input, copyOperation);
+    settings.connectionSet.Add (copyOperation, copy);
+
+    return copy;
+}
+
+} // namespace
+
+
+TEST_F (HeadlessTestEnvironment, RenderGraph_RecordEveryFrame)
+{
+    RG::GraphSettings s (GetDeviceExtra (), 3);
+    s.recordEveryFrame = true;
+
+    const std::vector<std::shared_ptr<RG::WritableImageResource>> images = AddRedFillOperations (s, GetDevice (), 2, 512);
+
+    RG::RenderGraph graph;
+    graph.Compile (std::move (s));
+
+    EXPECT_TRUE (graph.IsRecordingEveryFrame ());
+
+    RG::Fence fence (GetDevice (), false);
+
+    // every frame index is submitted twice, the second round reuses the reset pools
+    for (uint32_t frameIndex = 0; frameIndex < 6; ++frameIndex) {
+        graph.Submit (frameIndex % 3, {}, {}, frameIndex == 5 ? static_cast<VkFence> (fence) : VK_NULL_HANDLE);
+    }
+
+    fence.Wait ();
+
+    env->Wait ();
+
+    for (const std::shared_ptr<RG::WritableImageResource>& image : images) {
+        CompareImages ("red", *image->GetImages ()[0], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        CompareImages ("red", *image->GetImages ()[2], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    }
+}
+
+
+TEST_F (HeadlessTestEnvironment, RenderGraph_RecordEveryFrame_ChangingDraws)
+{
+    RG::GraphSettings s (GetDeviceExtra (), 1);
+    s.recordEveryFrame = true;
+
+    // the whole quad first, then only its first triangle
+    uint32_t vertexCount = 6;
+
+    std::shared_ptr<RG::RenderOperation> redFillOperation = RG::RenderOperation::Builder (GetDevice ())
+                                                                .SetVertices (std::make_unique<RG::CallbackDrawable> ([&] (RG::CommandBuffer& commandBuffer, uint32_t) {
+                                                                    commandBuffer.Record<RG::CommandDraw> (vertexCount, 1, 0, 0);
+                                                                }))
+                                                                .SetPrimitiveTopology (VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+                                                                .SetVertexShader (passThroughVertexShader)
+                                                                .SetFragmentShader (redFillFragmentShader)
+                                                                .Build ();
+
+    std::shared_ptr<RG::WritableImageResource> red = std::make_unique<RG::WritableImageResource> (512, 512);
+
+    redFillOperation->compileSettings.attachmentProvider->table.push_back ({ "outColor", RG::ShaderKind::Fragment, { red->GetFormatProvider (), VK_ATTACHMENT_LOAD_OP_CLEAR, red->GetImageViewForFrameProvider (), red->GetInitialLayout (), red->GetFinalLayout () } });
+
+    s.connectionSet.Add (redFillOperation, red);
+
+    RG::RenderGraph graph;
+    graph.Compile (std::move (s));
+
+    const auto RenderFrame = [&] () {
+        graph.Submit (0);
+        env->Wait ();
+
+        return RG::ImageData (GetDeviceExtra (), *red->GetImages ()[0], 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    };
+
+    const RG::ImageData referenceImage (ReferenceImagesFolder / "red_reference.png");
+
+    EXPECT_TRUE (RenderFrame () == referenceImage);
+
+    vertexCount = 3;
+
+    const RG::ImageData halfFilled = RenderFrame ();
+
+    // the second frame was recorded again with the new vertex count, the top right half is left cleared
+    EXPECT_EQ (GetPixel (referenceImage, 16, 496), GetPixel (halfFilled, 16, 496));
+    EXPECT_EQ ((std::vector<uint8_t> { 0, 0, 0, 255 }), GetPixel (halfFilled, 496, 16));
+}
+
+
+TEST_F (HeadlessTestEnvironment, DISABLED_RenderGraph_RecordEveryFrame_Benchmark)
+{
+    constexpr uint32_t operationCount = 128;
+    constexpr uint32_t frameCount     = 1000;
+
+    const auto MeasureSubmits = [&] (bool recordEveryFrame) {
+        RG::GraphSettings s (GetDeviceExtra (), 3);
+        s.recordEveryFrame = recordEveryFrame;
+
+        const std::vector<std::shared_ptr<RG::WritableImageResource>> images = AddRedFillOperations (s, GetDevice (), operationCount, 64);
+
+        RG::RenderGraph graph;
+        graph.Compile (std::move (s));
+
+        FrameSubmitter submitter (GetDevice (), graph, 3);
+
+        AccumulatingTimer timer;
+        {
+            RG::TimerScope scope (timer);
+            for (uint32_t frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+                submitter.Submit (frameIndex % 3);
+            }
+            env->Wait ();
+        }
+
+        return timer.total.count () * 1000.0 / frameCount;
+    };
+
+    const double prerecordedMs = MeasureSubmits (false);
+    const double rerecordedMs  = MeasureSubmits (true);
+
+    std::cout << operationCount << " operations: prerecorded " << prerecordedMs << " ms/frame, recorded every frame " << rerecordedMs << " ms/frame" << std::endl;
+}
+
+
+TEST_F (HeadlessTestEnvironment, DISABLED_RenderGraph_UniformBufferPlacement_Benchmark)
+{
+    constexpr uint32_t operationCount = 64;
+    constexpr uint32_t frameCount     = 1000;
+
+    const std::string uniformColorFragmentShader = R"(
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (set = 0, binding = 0) uniform Color {
+    vec4 color;
+};
+
+layout (location = 0) out vec4 outColor;
+
+void main () {
+    outColor = color;
+}
+    )";
+
+    // every operation reads its own uniform buffer, all of them are rewritten every frame
+    const auto MeasureSubmits = [&] (RG::MemoryLocation location) {
+        RG::GraphSettings s (GetDeviceExtra (), 3);
+
+        std::vector<std::shared_ptr<RG::CPUBufferResource>> colors;
+        for (uint32_t i = 0; i < operationCount; ++i) {
+            std::shared_ptr<RG::CPUBufferResource>& color = colors.emplace_back (std::make_unique<RG::CPUBufferResource> (static_cast<uint32_t> (sizeof (glm::vec4)), location));
+
+            std::shared_ptr<RG::RenderOperation> operation = RG::RenderOperation::Builder (GetDevice ())
+                                                                 .SetVertices (std::make_unique<RG::DrawableInfo> (1, 6))
+                                                                 .SetPrimitiveTopology (VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+                                                                 .SetVertexShader (passThroughVertexShader)
+                                                                 .SetFragmentShader (uniformColorFragmentShader)
+                                                                 .Build ();
+
+            operation->compileSettings.descriptorWriteProvider->bufferInfos.push_back ({ "Color", RG::ShaderKind::Fragment, color->GetBufferForFrameProvider (), 0, sizeof (glm::vec4) });
+
+            std::shared_ptr<RG::WritableImageResource> image = std::make_unique<RG::WritableImageResource> (64, 64);
+
+            operation->compileSettings.attachmentProvider->table.push_back ({ "outColor", RG::ShaderKind::Fragment, { image->GetFormatProvider (), VK_ATTACHMENT_LOAD_OP_CLEAR, image->GetImageViewForFrameProvider (), image->GetInitialLayout (), image->GetFinalLayout () } });
+
+            s.connectionSet.Add (color, operation);
+            s.connectionSet.Add (operation, image);
+        }
+
+        RG::RenderGraph graph;
+        graph.Compile (std::move (s));
+
+        FrameSubmitter submitter (GetDevice (), graph, 3);
+
+        AccumulatingTimer timer;
+        {
+            RG::TimerScope scope (timer);
+            for (uint32_t frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+                const uint32_t resourceIndex = frameIndex % 3;
+                for (uint32_t i = 0; i < operationCount; ++i) {
+                    colors[i]->GetMapping (resourceIndex).Copy (glm::vec4 (1.f, static_cast<float> (frameIndex % 256) / 255.f, 0.f, 1.f));
+                }
+                submitter.Submit (resourceIndex);
+            }
+            env->Wait ();
+        }
+
+        return timer.total.count () * 1000.0 / frameCount;
+    };
+
+    for (const RG::MemoryLocation location : { RG::MemoryLocation::CPU, RG::MemoryLocation::CPUStreaming, RG::MemoryLocation::GPUHostVisible }) {
+        const double ms = MeasureSubmits (location);
+        std::cout << operationCount << " uniform buffers in " << RG::MemoryLocationToString (location) << " memory: " << ms << " ms/frame" << std::endl;
+    }
+}
+
+
+TEST_F (HeadlessTestEnvironment, DISABLED_ReadOnlyImageResource_MinifiedSampling_Benchmark)
+{
+    constexpr uint32_t volumeSize = 256;
+    constexpr uint32_t targetSize = 64;
+    constexpr uint32_t frameCount = 1000;
+
+    // the averaging raymarch of the VizHF volume, every ray steps through the whole depth
+    const std::string raymarchFragmentShader = R"(
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (binding = 0) uniform sampler3D volume;
+
+layout (location = 0) in vec2 textureCoords;
+
+layout (location = 0) out vec4 outColor;
+
+void main () {
+    const int stepCount = 64;
+
+    float accumulated = 0.0;
+    for (int i = 0; i < stepCount; ++i) {
+        accumulated += texture (volume, vec3 (textureCoords, (float (i) + 0.5) / stepCount)).r / stepCount;
+    }
+
+    outColor = vec4 (vec3 (accumulated), 1.0);
+}
+    )";
+
+    // the file holds the 256 slices of the volume as a 16x16 grid, as in the VizHF tests
+    const std::vector<uint8_t> brainData = RG::ImageData (std::filesystem::current_path () / "TestData" / "VizHF" / "brain.jpg", 1).data;
+    ASSERT_EQ (size_t { volumeSize * volumeSize * volumeSize }, brainData.size ());
+
+    // a 4x minified volume, without mip levels neighbouring fragments and steps touch texels far apart
+    const auto MeasureSubmits = [&] (bool mipLevels) {
+        RG::GraphSettings s (GetDeviceExtra (), 3);
+
+        std::shared_ptr<RG::ReadOnlyImageResource> volume = std::make_unique<RG::ReadOnlyImageResource> (VK_FORMAT_R8_UNORM, volumeSize, volumeSize, volumeSize);
+        if (mipLevels) {
+            volume->EnableMipLevels ();
+        }
+
+        std::shared_ptr<RG::RenderOperation> operation = RG::RenderOperation::Builder (GetDevice ())
+                                                             .SetVertices (std::make_unique<RG::DrawableInfo> (1, 6))
+                                                             .SetPrimitiveTopology (VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+                                                             .SetVertexShader (passThroughVertexShader)
+                                                             .SetFragmentShader (raymarchFragmentShader)
+                                                             .Build ();
+
+        operation->compileSettings.descriptorWriteProvider->imageInfos.push_back ({ "volume", RG::ShaderKind::Fragment, volume->GetSamplerProvider (), volume->GetImageViewForFrameProvider (), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+
+        std::shared_ptr<RG::WritableImageResource> image = std::make_unique<RG::WritableImageResource> (targetSize, targetSize);
+
+        operation->compileSettings.attachmentProvider->table.push_back ({ "outColor", RG::ShaderKind::Fragment, { image->GetFormatProvider (), VK_ATTACHMENT_LOAD_OP_CLEAR, image->GetImageViewForFrameProvider (), image->GetInitialLayout (), image->GetFinalLayout () } });
+
+        s.connectionSet.Add (volume, operation);
+        s.connectionSet.Add (operation, image);
+
+        RG::RenderGraph graph;
+        graph.Compile (std::move (s));
+
+        EXPECT_EQ (mipLevels, volume->GetMipLevels () > 1);
+
+        std::vector<VkBufferImageCopy> slices;
+        for (uint32_t sliceIndex = 0; sliceIndex < volumeSize; ++sliceIndex) {
+            VkBufferImageCopy slice = volume->image->imageGPU->GetBufferImageCopyRegion ({ 0, 0, static_cast<int32_t> (sliceIndex) }, { volumeSize, volumeSize, 1 }, 0);
+            slice.bufferOffset      = (sliceIndex / 16) * volumeSize * 4096 + (sliceIndex % 16) * volumeSize;
+            slice.bufferRowLength   = 4096;
+            slice.bufferImageHeight = volumeSize;
+            slices.push_back (slice);
+        }
+
+        {
+            RG::UploadBatch batch (GetDeviceExtra ());
+            volume->CopyRegions (batch, brainData, slices);
+            batch.Wait ();
+        }
+
+        FrameSubmitter submitter (GetDevice (), graph, 3);
+
+        AccumulatingTimer timer;
+        {
+            RG::TimerScope scope (timer);
+            for (uint32_t frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+                submitter.Submit (frameIndex % 3);
+            }
+            env->Wait ();
+        }
+
+        return timer.total.count () * 1000.0 / frameCount;
+    };
+
+    const double singleLevelMs = MeasureSubmits (false);
+    const double mipLevelsMs   = MeasureSubmits (true);
+
+    std::cout << volumeSize << "^3 volume raymarched into " << targetSize << "x" << targetSize << ": single level " << singleLevelMs << " ms/frame, mip levels " << mipLevelsMs << " ms/frame" << std::endl;
+}
+
+
+// the comparison before it was vectorized, baseline of the benchmark below
+static bool LegacyCompareTo (const RG::ImageData& image, const RG::ImageData& other, std::vector<uint8_t>& diff)
+{
+    bool equal = true;
+    for (size_t i = 0; i < image.width * image.height * image.components; i += image.components) {
+        if (memcmp (&image.data[i], &other.data[i], image.components) != 0) {
+            const std::array<uint8_t, 4> pixel { image.data[i + 0], image.data[i + 1], image.data[i + 2], image.data[i + 3] };
+            const std::array<uint8_t, 4> pixelOther { other.data[i + 0], other.data[i + 1], other.data[i + 2], other.data[i + 3] };
+
+            const size_t diffSum = std::abs (pixel[0] - pixelOther[0]) + std::abs (pixel[1] - pixelOther[1]) + std::abs (pixel[2] - pixelOther[2]) + std::abs (pixel[3] - pixelOther[3]);
+
+            if (diffSum > 1) {
+                const uint8_t maxDiff = std::max ({ static_cast<uint8_t> (std::abs (other.data[i + 0] - image.data[i + 0])),
+                                                    static_cast<uint8_t> (std::abs (other.data[i + 1] - image.data[i + 1])),
+                                                    static_cast<uint8_t> (std::abs (other.data[i + 2] - image.data[i + 2])),
+                                                    static_cast<uint8_t> (std::abs (other.data[i + 3] - image.data[i + 3])) });
+
+                diff[i + 0] = maxDiff;
+                diff[i + 1] = 0;
+                diff[i + 2] = 0;
+                diff[i + 3] = 255;
+                equal       = false;
+            }
+        }
+    }
+    return equal;
+}
+
+
+TEST_F (HeadlessTestEnvironment, DISABLED_ImageData_CompareTo_Benchmark)
+{
+    constexpr uint32_t width           = 1920;
+    constexpr uint32_t height          = 1080;
+    constexpr uint32_t comparisonCount = 50;
+
+    std::vector<uint8_t> texels (width * height * 4);
+    for (uint32_t i = 0; i < texels.size (); ++i) {
+        texels[i] = static_cast<uint8_t> (i * 31 % 251);
+    }
+
+    // a few scattered mismatches, like a render that is slightly off
+    std::vector<uint8_t> otherTexels = texels;
+    for (uint32_t i = 0; i < otherTexels.size (); i += 4 * 997) {
+        otherTexels[i] = static_cast<uint8_t> (otherTexels[i] ^ 0x40);
+    }
+
+    const RG::ImageData image      = RG::ImageData::FromDataUint (texels, width, height, 4);
+    const RG::ImageData otherImage = RG::ImageData::FromDataUint (otherTexels, width, height, 4);
+
+    const auto Measure = [&] (const std::function<void ()>& compare) {
+        AccumulatingTimer timer;
+        {
+            RG::TimerScope scope (timer);
+            for (uint32_t i = 0; i < comparisonCount; ++i) {
+                compare ();
+            }
+        }
+        return timer.total.count () * 1000.0 / comparisonCount;
+    };
+
+    const double legacyMs = Measure ([&] () {
+        std::vector<uint8_t> diff (texels.size (), 0);
+        EXPECT_FALSE (LegacyCompareTo (image, otherImage, diff));
+    });
+
+    RG::ImageData::ComparisonSettings scalarSettings;
+    scalarSettings.useSIMD = false;
+
+    RG::ImageData::ComparisonSettings earlyExitSettings;
+    earlyExitSettings.createDiffImage = false;
+    earlyExitSettings.computeMetrics  = false;
+
+    const double scalarMs    = Measure ([&] () { EXPECT_FALSE (image.CompareTo (otherImage, scalarSettings).equal); });
+    const double simdMs      = Measure ([&] () { EXPECT_FALSE (image.CompareTo (otherImage).equal); });
+    const double earlyExitMs = Measure ([&] () { EXPECT_FALSE (image.CompareTo (otherImage, earlyExitSettings).equal); });
+
+    std::cout << width << "x" << height << ": previous " << legacyMs << " ms, scalar " << scalarMs << " ms, SIMD " << simdMs << " ms, SIMD without diff image and metrics " << earlyExitMs << " ms" << std::endl;
+}
+
+
+TEST_F (HeadlessTestEnvironment, DISABLED_PixelConversion_Benchmark)
+{
+    constexpr size_t   pixelCount      = 1920 * 1080;
+    constexpr uint32_t conversionCount = 50;
+
+    std::vector<uint8_t> pixels (pixelCount * 4);
+    for (size_t i = 0; i < pixels.size (); ++i) {
+        pixels[i] = static_cast<uint8_t> (i * 31 % 251);
+    }
+
+    std::vector<float> floats (pixelCount * 4);
+    for (size_t i = 0; i < floats.size (); ++i) {
+        floats[i] = static_cast<float> (i % 1000) / 999.f;
+    }
+
+    std::vector<uint8_t> unorm (floats.size ());
+
+    const auto Measure = [&] (const std::function<void ()>& convert) {
+        AccumulatingTimer timer;
+        {
+            RG::TimerScope scope (timer);
+            for (uint32_t i = 0; i < conversionCount; ++i) {
+                convert ();
+            }
+        }
+        return timer.total.count () * 1000.0 / conversionCount;
+    };
+
+    // the loops ImageData used before
+    const double legacySwapMs = Measure ([&] () {
+        for (size_t i = 0; i < pixels.size (); i += 4) {
+            std::swap (pixels[i], pixels[i + 2]);
+        }
+    });
+
+    const double swizzleMs = Measure ([&] () { RG::SwizzleRGBA8 (pixels.data (), pixelCount, { 2, 1, 0, 3 }); });
+
+    const double legacyFloatMs = Measure ([&] () {
+        for (size_t i = 0; i < floats.size (); ++i) {
+            unorm[i] = static_cast<uint8_t> (floats[i] * 255.f);
+        }
+    });
+
+    const double floatMs = Measure ([&] () { RG::FloatToUnorm8 (floats.data (), unorm.data (), floats.size ()); });
+
+    std::cout << pixelCount << " pixels: swap loop " << legacySwapMs << " ms, SwizzleRGBA8 " << swizzleMs << " ms, float loop " << legacyFloatMs << " ms, FloatToUnorm8 " << floatMs << " ms" << std::endl;
+}
+
+
+TEST_F (HeadlessTestEnvironment, RenderGraph_CommandCaptureReplay)
+{
+    RG::GraphSettings s (GetDeviceExtra (), 2);
+
+    const std::vector<std::shared_ptr<RG::WritableImageResource>> images = AddRedFillOperations (s, GetDevice (), 2, 64);
+
+    RG::RenderGraph graph;
+    graph.Compile (std::move (s));
+
+    if (!graph.commandBuffers[0].IsRetainingRecordedCommands ()) {
+        GTEST_SKIP () << "recorded commands are discarded, nothing to capture";
+    }
+
+    const RG::CommandCapture capture = graph.CaptureCommandStream ();
+
+    EXPECT_EQ (size_t { 4 }, capture.images.size ());
+    for (const RG::CommandCapture::ImageDescriptor& descriptor : capture.images) {
+        // the barriers move the images to COLOR_ATTACHMENT_OPTIMAL, the replayed images have to allow it
+        EXPECT_NE (0u, descriptor.usage & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+    }
+    EXPECT_EQ (size_t { 2 }, capture.streams.size ());
+    EXPECT_EQ (uint32_t { 0 }, capture.streams[0].uncapturedCommandCount);
+
+    const std::vector<uint8_t> serialized = capture.Serialize ();
+    const RG::CommandCapture   loaded     = RG::CommandCapture::Deserialize (serialized);
+
+    EXPECT_EQ (serialized, loaded.Serialize ());
+
+    RG::TransferCommandReplayer replayer (GetDeviceExtra (), loaded);
+
+    EXPECT_EQ (size_t { 2 }, replayer.GetStreamCount ());
+
+    // barriers are replayed, render passes and draws need pipeline state that is not captured
+    EXPECT_LT (size_t { 0 }, replayer.GetReplayedCommandCount ());
+    EXPECT_LT (size_t { 0 }, replayer.GetSkippedCommandCount ());
+
+    replayer.Submit (0);
+    replayer.Submit (1);
+
+    env->Wait ();
+}
+
+
+TEST_F (HeadlessTestEnvironment, RenderOperation_SamplesBindlessTexture)
+{
+    if (!GetDeviceExtra ().HasBindlessTextures ()) {
+        GTEST_SKIP () << "descriptor indexing is not supported";
+    }
+
+    const std::string bindlessFragmentShader = R"(
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout (set = 1, binding = 0) uniform sampler2D textures[];
+
+layout (std140, binding = 0) uniform BindlessIndices {
+    uint textureIndex;
+};
+
+layout (location = 0) in vec2 textureCoords;
+layout (location = 0) out vec4 outColor;
+
+void main () {
+    outColor = texture (textures[textureIndex], textureCoords);
+}
+    )";
+
+    RG::ReadOnlyImageResource red (VK_FORMAT_R8G8B8A8_UNORM, 16, 16);
+    RG::ReadOnlyImageResource green (VK_FORMAT_R8G8B8A8_UNORM, 16, 16);
+
+    red.EnableBindless ();
+    green.EnableBindless ();
+
+    red.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+    green.Compile (RG::GraphSettings (GetDeviceExtra (), 1));
+
+    red.CopyTransitionTransfer (std::vector<uint32_t> (16 * 16, 0xFF0000FF));
+    green.CopyTransitionTransfer (std::vector<uint32_t> (16 * 16, 0xFF00FF00));
+
+    std::shared_ptr<RG::RenderOperation> sampleOperation = RG::RenderOperation::Builder (GetDevice ())
+                                                               .SetVertices (std::make_unique<RG::DrawableInfo> (1, 6))
+                                                               .SetPrimitiveTopology (VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+                                                               .SetVertexShader (passThroughVertexShader)
+                                                               .SetFragmentShader (bindlessFragmentShader)
+                                                               .Build ();
+
+    std::shared_ptr<RG::WritableImageResource> target = std::make_unique<RG::WritableImageResource> (64, 64);
+
+    sampleOperation->compileSettings.attachmentProvider->table.push_back ({ "outColor", RG::ShaderKind::Fragment, { target->GetFormatProvider (), VK_ATTACHMENT_LOAD_OP_CLEAR, target->GetImageViewForFrameProvider (), target->GetInitialLayout (), target->GetFinalLayout () } });
+
+    RG::GraphSettings s (GetDeviceExtra (), 1);
+    s.connectionSet.Add (sampleOperation, target);
+
+    // the index uniform is reflected like any other, the texture array itself is not bound by the operation
+    RG::UniformReflection refl (s.connectionSet);
+
+    RG::RenderGraph graph;
+    graph.Compile (std::move (s));
+
+    EXPECT_NE (nullptr, sampleOperation->compileResult.descriptors.bindlessLayout);
+
+    // the second registered texture, so a shader ignoring the index would sample red
+    refl[sampleOperation][RG::ShaderKind::Fragment]["BindlessIndices"]["textureIndex"] = green.GetBindlessIndex ();
+    refl.Flush (0);
+
+    graph.Submit (0);
+    env->Wait ();
+
+    const RG::ImageData actual (GetDeviceExtra (), *target->GetImages ()[0], 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+    for (const glm::uvec2 pixel : { glm::uvec2 (0, 0), glm::uvec2 (31, 17), glm::uvec2 (63, 63) }) {
+        EXPECT_EQ ((std::vector<uint8_t> { 0, 255, 0, 255 }), GetPixel (actual, pixel.x, pixel.y));
+    }
+}
+
+
+TEST_F (HeadlessTestEnvironment, CommandCapture_ReplayedCopy)
+{
+    const size_t             valueCount = 256;
+    const VkDeviceSize       bufferSize = valueCount * sizeof (uint32_t);
+    const VkBufferUsageFlags usage      = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    RG::Buffer srcBuffer (GetDeviceExtra ().GetAllocator (), bufferSize, usage, RG::Buffer::MemoryLocation::GPU);
+    RG::Buffer dstBuffer (GetDeviceExtra ().GetAllocator (), bufferSize, usage, RG::Buffer::MemoryLocation::GPU);
+
+    RG::CommandBuffer commandBuffer (GetDeviceExtra ());
+    if (!commandBuffer.IsRetainingRecordedCommands ()) {
+        GTEST_SKIP () << "recorded commands are discarded, nothing to capture";
+    }
+
+    // the second half of the source lands in the first half of the destination and vice versa
+    const VkDeviceSize halfSize = bufferSize / 2;
+
+    commandBuffer.Begin ();
+    commandBuffer.Record<RG::CommandCopyBuffer> (static_cast<VkBuffer> (srcBuffer), static_cast<VkBuffer> (dstBuffer), std::vector<VkBufferCopy> { { halfSize, 0, halfSize }, { 0, halfSize, halfSize } });
+    commandBuffer.End ();
+
+    RG::CommandCapture capture;
+    capture.AddBuffer (srcBuffer, bufferSize);
+    capture.AddBuffer (dstBuffer, bufferSize);
+    capture.AddCommandBuffer (commandBuffer);
+
+    const RG::CommandCapture loaded = RG::CommandCapture::Deserialize (capture.Serialize ());
+
+    RG::TransferCommandReplayer replayer (GetDeviceExtra (), loaded);
+
+    EXPECT_EQ (size_t { 1 }, replayer.GetReplayedCommandCount ());
+    EXPECT_EQ (size_t { 0 }, replayer.GetSkippedCommandCount ());
+
+    const RG::Buffer* replayedSrc = replayer.GetReplayedBuffer (srcBuffer);
+    const RG::Buffer* replayedDst = replayer.GetReplayedBuffer (dstBuffer);
+    ASSERT_NE (nullptr, replayedSrc);
+    ASSERT_NE (nullptr, replayedDst);
+    EXPECT_NE (static_cast<VkBuffer> (srcBuffer), static_cast<VkBuffer> (*replayedSrc));
+
+    std::vector<uint32_t> values (valueCount);
+    for (uint32_t i = 0; i < values.size (); ++i) {
+        values[i] = i * 3 + 1;
+    }
+
+    RG::UploadBatch batch (GetDeviceExtra ());
+    batch.CopyToBuffer (*replayedSrc, values.data (), bufferSize);
+    batch.Wait ();
+
+    replayer.Submit (0);
+    env->Wait ();
+
+    std::unique_ptr<RG::AsyncReadback> readback = RG::AsyncReadback::FromBuffer (GetDeviceExtra (), *replayedDst, bufferSize);
+    readback->Wait ();
+
+    ASSERT_EQ (static_cast<size_t> (bufferSize), readback->GetSize ());
+
+    const uint32_t* result = readback->GetAs<uint32_t> ();
+    for (size_t i = 0; i < valueCount / 2; ++i) {
+        EXPECT_EQ (values[valueCount / 2 + i], result[i]);
+        EXPECT_EQ (values[i], result[valueCount / 2 + i]);
+    }
+}
+
+
+TEST_F (HeadlessTestEnvironment, RenderGraph_IndirectDrawFromComputeOperation)
+{
+    const std::string cullSrc = R"(
+#version 450
+
+layout (local_size_x = 1) in;
+
+struct DrawIndexedIndirectCommand {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int  vertexOffset;
+    uint firstInstance;
+};
+
+layout (set = 0, binding = 0) buffer DrawCommands {
+    DrawIndexedIndirectCommand draws[2];
+};
+
+layout (set = 0, binding = 1) buffer DrawCount {
+    uint drawCount;
+};
+
+void main ()
+{
+    // one triangle of the quad each, the count leaves out the second one
+    draws[0]  = DrawIndexedIndirectCommand (3, 1, 0, 0, 0);
+    draws[1]  = DrawIndexedIndirectCommand (3, 1, 3, 0, 0);
+    drawCount = 1;
+}
+    )";
+
+    if (!GetDeviceExtra ().SupportsMultiDrawIndirect ()) {
+        GTEST_SKIP () << "multiDrawIndirect is not supported";
+    }
+
+    RG::IndexBufferTransferable ib (GetDeviceExtra (), 6);
+    ib.data = { 0, 1, 2, 3, 4, 5 };
+    ib.Flush ();
+
+    const auto RenderIndirect = [&] (bool useDrawCount) {
+        std::shared_ptr<RG::GPUBufferResource> drawCommands = std::make_unique<RG::GPUBufferResource> (2 * sizeof (VkDrawIndexedIndirectCommand));
+        std::shared_ptr<RG::GPUBufferResource> drawCount    = std::make_unique<RG::GPUBufferResource> (sizeof (uint32_t));
+
+        std::shared_ptr<RG::ComputeOperation> cullOperation  = std::make_unique<RG::ComputeOperation> (1, 1, 1);
+        cullOperation->compileSettings.computeShaderPipeline = std::make_unique<RG::ComputeShaderPipeline> (GetDevice (), cullSrc);
+        cullOperation->compileSettings.descriptorWriteProvider->bufferInfos.push_back ({ "DrawCommands", RG::ShaderKind::Compute, drawCommands->GetBufferForFrameProvider (), 0, drawCommands->GetBufferSize () });
+        cullOperation->compileSettings.descriptorWriteProvider->bufferInfos.push_back ({ "DrawCount", RG::ShaderKind::Compute, drawCount->GetBufferForFrameProvider (), 0, drawCount->GetBufferSize () });
+
+        std::shared_ptr<RG::RenderOperation> redFillOperation = RG::RenderOperation::Builder (GetDevice ())
+                                                                    .SetVertices (std::make_unique<RG::IndirectDrawable> (RG::VertexBufferList {}, ib.buffer.GetBufferToBind (), drawCommands, 2, useDrawCount ? drawCount : nullptr))
+                                                                    .SetPrimitiveTopology (VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+                                                                    .SetVertexShader (passThroughVertexShader)
+                                                                    .SetFragmentShader (redFillFragmentShader)
+                                                                    .Build ();
+
+        std::shared_ptr<RG::WritableImageResource> red = std::make_unique<RG::WritableImageResource> (512, 512);
+
+        redFillOperation->compileSettings.attachmentProvider->table.push_back ({ "outColor", RG::ShaderKind::Fragment, { red->GetFormatProvider (), VK_ATTACHMENT_LOAD_OP_CLEAR, red->GetImageViewForFrameProvider (), red->GetInitialLayout (), red->GetFinalLayout () } });
+
+        RG::GraphSettings s (GetDeviceExtra (), 1);
+        s.connectionSet.Add (cullOperation, drawCommands);
+        s.connectionSet.Add (cullOperation, drawCount);
+        s.connectionSet.Add (drawCommands, redFillOperation);
+        s.connectionSet.Add (drawCount, redFillOperation);
+        s.connectionSet.Add (redFillOperation, red);
+
+        RG::RenderGraph graph;
+        graph.Compile (std::move (s));
+
+        EXPECT_EQ (2, graph.GetPassCount ());
+
+        graph.Submit (0);
+        env->Wait ();
+
+        return RG::ImageData (GetDeviceExtra (), *red->GetImages ()[0], 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    };
+
+    const RG::ImageData referenceImage (ReferenceImagesFolder / "red_reference.png");
+
+    // both records are drawn
+    EXPECT_TRUE (RenderIndirect (false) == referenceImage);
+
+    if (GetDeviceExtra ().SupportsDrawIndirectCount ()) {
+        const RG::ImageData counted = RenderIndirect (true);
+
+        // only the first triangle, covering the bottom left half, is drawn
+        EXPECT_EQ (GetPixel (referenceImage, 16, 496), GetPixel (counted, 16, 496));
+        EXPECT_EQ ((std::vector<uint8_t> { 0, 0, 0, 255 }), GetPixel (counted, 496, 16));
+    }
+}
+
+
+TEST_F (HeadlessTestEnvironment, RenderOperation_InstancedVertexAttributes)
+{
+    const std::string instancedVertexShader = R"(
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 instanceOffset;
+
+void main ()
+{
+    gl_Position = vec4 (position * 0.5 + instanceOffset, 0.0, 1.0);
+}
+    )";
+
+    RG::VertexBufferTransferable<glm::vec2> vertices (GetDeviceExtra (), 4, { VK_FORMAT_R32G32_SFLOAT }, VK_VERTEX_INPUT_RATE_VERTEX);
+    vertices = {
+        glm::vec2 (-1.f, -1.f),
+        glm::vec2 (-1.f, +1.f),
+        glm::vec2 (+1.f, +1.f),
+        glm::vec2 (+1.f, -1.f),
+    };
+    vertices.Flush ();
+
+    RG::IndexBufferTransferable indices (GetDeviceExtra (), 6);
+    indices.data = { 0, 1, 2, 0, 3, 2 };
+    indices.Flush ();
+
+    // one instance per quarter of the image
+    RG::VertexBufferTransferable<glm::vec2> instances (GetDeviceExtra (), 4, { VK_FORMAT_R32G32_SFLOAT }, VK_VERTEX_INPUT_RATE_INSTANCE);
+    instances = {
+        glm::vec2 (-0.5f, -0.5f),
+        glm::vec2 (-0.5f, +0.5f),
+        glm::vec2 (+0.5f, -0.5f),
+        glm::vec2 (+0.5f, +0.5f),
+    };
+    instances.Flush ();
+
+    EXPECT_EQ (RG::VertexInputInfo::InstanceBinding, instances.info.bindings[0].binding);
+
+    std::shared_ptr<RG::RenderOperation> redFillOperation = RG::RenderOperation::Builder (GetDevice ())
+                                                                .SetVertices (std::make_unique<RG::DrawableInfo> (4, vertices, indices, instances))
+                                                                .SetPrimitiveTopology (VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+                                                                .SetVertexShader (instancedVertexShader)
+                                                                .SetFragmentShader (redFillFragmentShader)
+                                                                .Build ();
+
+    EXPECT_TRUE (redFillOperation->GetShaderPipeline ()->IsInputInstanced ("instanceOffset"));
+    EXPECT_FALSE (redFillOperation->GetShaderPipeline ()->IsInputInstanced ("position"));
+
+    std::shared_ptr<RG::WritableImageResource> red = std::make_unique<RG::WritableImageResource> (512, 512);
+
+    redFillOperation->compileSettings.attachmentProvider->table.push_back ({ "outColor", RG::ShaderKind::Fragment, { red->GetFormatProvider (), VK_ATTACHMENT_LOAD_OP_CLEAR, red->GetImageViewForFrameProvider (), red->GetInitialLayout (), red->GetFinalLayout () } });
+
+    RG::GraphSettings s (GetDeviceExtra (), 1);
+    s.connectionSet.Add (redFillOperation, red);
+
+    RG::RenderGraph graph;
+    graph.Compile (std::move (s));
+
+    graph.Submit (0);
+    env->Wait ();
+
+    CompareImages ("red", *red->GetImages ()[0], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+}
+
+
+TEST_F (HeadlessTestEnvironment, RenderOperation_MultipleDrawables)
+{
+    const std::string positionVertexShader = R"(
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (location = 0) in vec2 position;
+
+void main ()
+{
+    gl_Position = vec4 (position, 0.0, 1.0);
+}
+    )";
+
+    const std::string uniformColorFragmentShader = R"(
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (set = 0, binding = 0) uniform Color {
+    vec4 color;
+};
+
+layout (location = 0) out vec4 outColor;
+
+void main () {
+    outColor = color;
+}
+    )";
+
+    RG::IndexBufferTransferable indices (GetDeviceExtra (), 6);
+    indices.data = { 0, 1, 2, 0, 3, 2 };
+    indices.Flush ();
+
+    // one quad per quarter of the image
+    std::vector<std::unique_ptr<RG::VertexBufferTransferable<glm::vec2>>> quads;
+    for (const glm::vec2 corner : { glm::vec2 (-1.f, -1.f), glm::vec2 (-1.f, 0.f), glm::vec2 (0.f, -1.f), glm::vec2 (0.f, 0.f) }) {
+        std::unique_ptr<RG::VertexBufferTransferable<glm::vec2>>& quad = quads.emplace_back (std::make_unique<RG::VertexBufferTransferable<glm::vec2>> (GetDeviceExtra (), 4, std::vector<VkFormat> { VK_FORMAT_R32G32_SFLOAT }, VK_VERTEX_INPUT_RATE_VERTEX));
+        *quad = {
+            corner + glm::vec2 (0.f, 0.f),
+            corner + glm::vec2 (0.f, 1.f),
+            corner + glm::vec2 (1.f, 1.f),
+            corner + glm::vec2 (1.f, 0.f),
+        };
+        quad->Flush ();
+    }
+
+    std::shared_ptr<RG::CPUBufferResource> color         = std::make_unique<RG::CPUBufferResource> (static_cast<uint32_t> (sizeof (glm::vec4)));
+    std::shared_ptr<RG::CPUBufferResource> overrideColor = std::make_unique<RG::CPUBufferResource> (static_cast<uint32_t> (sizeof (glm::vec4)));
+
+    std::unique_ptr<RG::FromShaderReflection::DescriptorWriteInfoTable> overrideDescriptors = std::make_unique<RG::FromShaderReflection::DescriptorWriteInfoTable> ();
+    overrideDescriptors->bufferInfos.push_back ({ "Color", RG::ShaderKind::Fragment, overrideColor->GetBufferForFrameProvider (), 0, sizeof (glm::vec4) });
+
+    // the first quad is drawn twice, keyed by quad the sorted draw list records those next to each other
+    std::shared_ptr<RG::RenderOperation> fillOperation = RG::RenderOperation::Builder (GetDevice ())
+                                                             .AddDrawable (std::make_unique<RG::DrawableInfo> (1, *quads[0], indices), nullptr, 0)
+                                                             .AddDrawable (std::make_unique<RG::DrawableInfo> (1, *quads[1], indices), nullptr, 1)
+                                                             .AddDrawable (std::make_unique<RG::DrawableInfo> (1, *quads[0], indices), nullptr, 0)
+                                                             .AddDrawable (std::make_unique<RG::DrawableInfo> (1, *quads[2], indices), nullptr, 2)
+                                                             .AddDrawable (std::make_unique<RG::DrawableInfo> (1, *quads[3], indices), std::move (overrideDescriptors), 3)
+                                                             .SetSortDrawItems ()
+                                                             .SetPrimitiveTopology (VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+                                                             .SetVertexShader (positionVertexShader)
+                                                             .SetFragmentShader (uniformColorFragmentShader)
+                                                             .Build ();
+
+    fillOperation->compileSettings.descriptorWriteProvider->bufferInfos.push_back ({ "Color", RG::ShaderKind::Fragment, color->GetBufferForFrameProvider (), 0, sizeof (glm::vec4) });
+
+    std::shared_ptr<RG::WritableImageResource> red = std::make_unique<RG::WritableImageResource> (512, 512);
+
+    fillOperation->compileSettings.attachmentProvider->table.push_back ({ "outColor", RG::ShaderKind::Fragment, { red->GetFormatProvider (), VK_ATTACHMENT_LOAD_OP_CLEAR, red->GetImageViewForFrameProvider (), red->GetInitialLayout (), red->GetFinalLayout () } });
+
+    RG::GraphSettings s (GetDeviceExtra (), 1);
+    s.connectionSet.Add (color, fillOperation);
+    s.connectionSet.Add (overrideColor, fillOperation);
+    s.connectionSet.Add (fillOperation, red);
+
+    RG::RenderGraph graph;
+    graph.Compile (std::move (s));
+
+    EXPECT_EQ (1, graph.GetPassCount ());
+
+    // stable, draws with equal keys keep the order they were added in
+    const std::vector<size_t> expectedDrawOrder = { 0, 2, 1, 3, 4 };
+    EXPECT_EQ (expectedDrawOrder, fillOperation->compileResult.drawOrder);
+
+    EXPECT_TRUE (fillOperation->compileResult.drawItemDescriptors[0].descriptorSets == nullptr);
+    EXPECT_TRUE (fillOperation->compileResult.drawItemDescriptors[4].descriptorSets != nullptr);
+
+    color->GetMapping (0).Copy (glm::vec4 (1.f, 0.f, 0.f, 1.f));
+    overrideColor->GetMapping (0).Copy (glm::vec4 (0.f, 1.f, 0.f, 1.f));
+
+    graph.Submit (0);
+    env->Wait ();
+
+    // red, except the last quad (bottom right quarter) which reads its color through the overriding descriptor set
+    std::vector<uint8_t> expectedTexels (512 * 512 * 4);
+    for (uint32_t y = 0; y < 512; ++y) {
+        for (uint32_t x = 0; x < 512; ++x) {
+            const bool overridden = x >= 256 && y >= 256;
+
+            expectedTexels[(y * 512 + x) * 4 + 0] = overridden ? 0 : 255;
+            expectedTexels[(y * 512 + x) * 4 + 1] = overridden ? 255 : 0;
+            expectedTexels[(y * 512 + x) * 4 + 2] = 0;
+            expectedTexels[(y * 512 + x) * 4 + 3] = 255;
+        }
+    }
+
+    const RG::ImageData expected = RG::ImageData::FromDataUint (expectedTexels, 512, 512, 4);
+    const RG::ImageData actual (GetDeviceExtra (), *red->GetImages ()[0], 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+    const RG::ImageData::ComparisonResult comparison = expected.CompareTo (actual);
+    EXPECT_TRUE (comparison.equal);
+    EXPECT_EQ (size_t { 0 }, comparison.mismatchCount);
+}
+
+
+TEST_F (HeadlessTestEnvironment, RenderOperation_DrawsShareBuffersInOrder)
+{
+    const std::string positionVertexShader = R"(
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (location = 0) in vec2 position;
+
+void main ()
+{
+    gl_Position = vec4 (position, 0.0, 1.0);
+}
+    )";
+
+    const std::string uniformColorFragmentShader = R"(
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (set = 0, binding = 0) uniform Color {
+    vec4 color;
+};
+
+layout (location = 0) out vec4 outColor;
+
+void main () {
+    outColor = color;
+}
+    )";
+
+    // a fullscreen quad followed by a quad on the left half, both in the same buffers
+    std::shared_ptr<RG::VertexBufferTransferable<glm::vec2>> vertices = std::make_shared<RG::VertexBufferTransferable<glm::vec2>> (GetDeviceExtra (), 8, std::vector<VkFormat> { VK_FORMAT_R32G32_SFLOAT }, VK_VERTEX_INPUT_RATE_VERTEX);
+    *vertices = {
+        glm::vec2 (-1.f, -1.f),
+        glm::vec2 (-1.f, 1.f),
+        glm::vec2 (1.f, 1.f),
+        glm::vec2 (1.f, -1.f),
+        glm::vec2 (-1.f, -1.f),
+        glm::vec2 (-1.f, 1.f),
+        glm::vec2 (0.f, 1.f),
+        glm::vec2 (0.f, -1.f),
+    };
+    vertices->Flush ();
+
+    // the indices of the second quad are relative to its first vertex
+    RG::IndexBufferTransferable indices (GetDeviceExtra (), 12);
+    indices.data = { 0, 1, 2, 0, 3, 2, 0, 1, 2, 0, 3, 2 };
+    indices.Flush ();
+
+    std::shared_ptr<RG::CPUBufferResource> color         = std::make_unique<RG::CPUBufferResource> (static_cast<uint32_t> (sizeof (glm::vec4)));
+    std::shared_ptr<RG::CPUBufferResource> overrideColor = std::make_unique<RG::CPUBufferResource> (static_cast<uint32_t> (sizeof (glm::vec4)));
+
+    std::unique_ptr<RG::FromShaderReflection::DescriptorWriteInfoTable> overrideDescriptors = std::make_unique<RG::FromShaderReflection::DescriptorWriteInfoTable> ();
+    overrideDescriptors->bufferInfos.push_back ({ "Color", RG::ShaderKind::Fragment, overrideColor->GetBufferForFrameProvider (), 0, sizeof (glm::vec4) });
+
+    // the green fullscreen quad is painted over by the red one on the left half, only in the order they were added
+    std::shared_ptr<RG::RenderOperation> fillOperation = RG::RenderOperation::Builder (GetDevice ())
+                                                             .AddDrawable (std::make_unique<RG::DrawableInfo> (1, 4, RG::VertexBufferList ({ vertices }), 6, indices.buffer.GetBufferToBind (), 0, 0, 0), std::move (overrideDescriptors))
+                                                             .AddDrawable (std::make_unique<RG::DrawableInfo> (1, 4, RG::VertexBufferList ({ vertices }), 6, indices.buffer.GetBufferToBind (), 0, 6, 4))
+                                                             .SetPrimitiveTopology (VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+                                                             .SetVertexShader (positionVertexShader)
+                                                             .SetFragmentShader (uniformColorFragmentShader)
+                                                             .Build ();
+
+    fillOperation->compileSettings.descriptorWriteProvider->bufferInfos.push_back ({ "Color", RG::ShaderKind::Fragment, color->GetBufferForFrameProvider (), 0, sizeof (glm::vec4) });
+
+    std::shared_ptr<RG::WritableImageResource> target = std::make_unique<RG::WritableImageResource> (64, 64);
+
+    fillOperation->compileSettings.attachmentProvider->table.push_back ({ "outColor", RG::ShaderKind::Fragment, { target->GetFormatProvider (), VK_ATTACHMENT_LOAD_OP_CLEAR, target->GetImageViewForFrameProvider (), target->GetInitialLayout (), target->GetFinalLayout () } });
+
+    RG::GraphSettings s (GetDeviceExtra (), 1);
+    s.connectionSet.Add (color, fillOperation);
+    s.connectionSet.Add (overrideColor, fillOperation);
+    s.connectionSet.Add (fillOperation, target);
+
+    RG::RenderGraph graph;
+    graph.Compile (std::move (s));
+
+    const std::vector<size_t> expectedDrawOrder = { 0, 1 };
+    EXPECT_EQ (expectedDrawOrder, fillOperation->compileResult.drawOrder);
+
+    color->GetMapping (0).Copy (glm::vec4 (1.f, 0.f, 0.f, 1.f));
+    overrideColor->GetMapping (0).Copy (glm::vec4 (0.f, 1.f, 0.f, 1.f));
+
+    graph.Submit (0);
+    env->Wait ();
+
+    const RG::ImageData actual (GetDeviceExtra (), *target->GetImages ()[0], 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+    EXPECT_EQ ((std::vector<uint8_t> { 255, 0, 0, 255 }), GetPixel (actual, 16, 32));
+    EXPECT_EQ ((std::vector<uint8_t> { 0, 255, 0, 255 }), GetPixel (actual, 48, 32));
+}
+
+
+TEST_F (HeadlessTestEnvironment, RenderGraph_OperationsSortedByState)
+{
+    // red as well, but compiles to a different binary
+    const std::string fragCoordRedFillFragmentShader = R"(
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (location = 0) out vec4 outColor;
+
+void main () {
+    outColor = vec4 (gl_FragCoord.xy * 0.0, 0, 1) + vec4 (1, 0, 0, 0);
+}
+    )";
+
+    // independent operations alternating between two pipelines
+    const auto CreateSettings = [&] (std::vector<std::shared_ptr<RG::WritableImageResource>>& images) {
+        RG::GraphSettings s (GetDeviceExtra (), 1);
+
+        for (uint32_t i = 0; i < 4; ++i) {
+            std::shared_ptr<RG::RenderOperation> redFillOperation = RG::RenderOperation::Builder (GetDevice ())
+                                                                        .SetVertices (std::make_unique<RG::DrawableInfo> (1, 6))
+                                                                        .SetPrimitiveTopology (VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+                                                                        .SetVertexShader (passThroughVertexShader)
+                                                                        .SetFragmentShader (i % 2 == 0 ? redFillFragmentShader : fragCoordRedFillFragmentShader)
+                                                                        .Build ();
+
+            std::shared_ptr<RG::WritableImageResource> red = std::make_unique<RG::WritableImageResource> (64, 64);
+
+            redFillOperation->compileSettings.attachmentProvider->table.push_back ({ "outColor", RG::ShaderKind::Fragment, { red->GetFormatProvider (), VK_ATTACHMENT_LOAD_OP_CLEAR, red->GetImageViewForFrameProvider (), red->GetInitialLayout (), red->GetFinalLayout () } });
+
+            s.connectionSet.Add (redFillOperation, red);
+
+            images.push_back (red);
+        }
+
+        return s;
+    };
+
+    std::vector<std::shared_ptr<RG::WritableImageResource>> unsortedImages;
+
+    RG::GraphSettings unsortedSettings = CreateSettings (unsortedImages);
+    unsortedSettings.sortOperations    = false;
+
+    RG::RenderGraph unsortedGraph;
+    unsortedGraph.Compile (std::move (unsortedSettings));
+
+    // operations with the same shaders bind the same pipeline, but in insertion order every bind changes it
+    EXPECT_EQ (size_t { 4 }, unsortedGraph.GetCommandStatistics ().pipelineBinds);
+    EXPECT_EQ (size_t { 4 }, unsortedGraph.GetCommandStatistics ().renderPassBegins);
+
+    std::vector<std::shared_ptr<RG::WritableImageResource>> images;
+
+    RG::RenderGraph graph;
+    graph.Compile (CreateSettings (images));
+
+    EXPECT_EQ (1, graph.GetPassCount ());
+
+    // sorted, the second operation of each pipeline continues with the bound one and its bind is elided
+    EXPECT_EQ (size_t { 2 }, graph.GetCommandStatistics ().pipelineBinds);
+    EXPECT_EQ (size_t { 2 }, graph.GetElidedCommandCount () - unsortedGraph.GetElidedCommandCount ());
+
+    // every operation writes another image, so each still begins its own render pass
+    EXPECT_EQ (size_t { 4 }, graph.GetCommandStatistics ().renderPassBegins);
+
+    graph.Submit (0);
+
+    env->Wait ();
+
+    for (const std::shared_ptr<RG::WritableImageResource>& image : images) {
+        CompareImages ("red", *image->GetImages ()[0], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    }
+}
+
+
+TEST_F (HeadlessTestEnvironment, Operation_StateKeyComparesFullState)
+{
+    RG::Operation::StateKey key;
+    key.bindPoint     = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    key.renderPass    = 1;
+    key.pipeline      = 2;
+    key.pipelineState = { 3, 4 };
+
+    // same hashes, different state, as for a hash collision
+    RG::Operation::StateKey colliding = key;
+    colliding.pipelineState           = { 4, 3 };
+
+    const RG::Operation::StateKey copy = key;
+    EXPECT_TRUE (key == copy);
+    EXPECT_FALSE (key == colliding);
+    EXPECT_NE (key < colliding, colliding < key);
+
+    // a map keyed by them, as used for sharing pipelines, keeps both
+    std::map<RG::Operation::StateKey, int> keys;
+    keys.emplace (key, 0);
+    keys.emplace (colliding, 1);
+    EXPECT_EQ (size_t { 2 }, keys.size ());
+}
+
+
+TEST_F (HeadlessTestEnvironment, RenderGraph_OperationsSharingInputInOnePass)
+{
+    RG::GraphSettings s (GetDeviceExtra (), 2);
+
+    const std::shared_ptr<RG::WritableImageResource> red = AddRedFillOperations (s, GetDevice (), 1, 64)[0];
+
+    // both copies read red in the same pass, its transition is batched once
+    const std::vector<std::shared_ptr<RG::WritableImageResource>> copies {
+        AddCopyOperation (s, GetDevice (), red),
+        AddCopyOperation (s, GetDevice (), red),
+    };
+
+    RG::RenderGraph graph;
+    graph.Compile (std::move (s));
+
+    EXPECT_EQ (2, graph.GetPassCount ());
+
+    // nothing independent of the copies is recorded after the fill
+    EXPECT_EQ (0, graph.GetSplitBarrierCount ());
+
+    // one merged barrier in front of each pass and the final transition, instead of one per operation
+    const std::vector<RG::Command*>& recordedCommands = graph.commandBuffers[0].recordedAbstractCommands;
+
+    const auto barrierCount = std::count_if (recordedCommands.begin (), recordedCommands.end (), [] (const RG::Command* command) {
+        return dynamic_cast<const RG::CommandPipelineBarrier*> (command) != nullptr;
+    });
+    EXPECT_EQ (3, barrierCount);
+
+    graph.Submit (0);
+
+    env->Wait ();
+
+    for (const std::shared_ptr<RG::WritableImageResource>& copy : copies) {
+        CompareImages ("red", *copy->GetImages ()[0], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    }
+}
+
+
+TEST_F (HeadlessTestEnvironment, RenderGraph_SplitBarrierAroundIndependentOperation)
+{
+    RG::GraphSettings s (GetDeviceExtra (), 2);
+
+    // the copy only depends on the first fill, the second one is recorded in between
+    const std::vector<std::shared_ptr<RG::WritableImageResource>> images = AddRedFillOperations (s, GetDevice (), 2, 64);
+    const std::shared_ptr<RG::WritableImageResource>              copy   = AddCopyOperation (s, GetDevice (), images[0]);
+
+    RG::RenderGraph graph;
+    graph.Compile (std::move (s));
+
+    EXPECT_EQ (2, graph.GetPassCount ());
+    EXPECT_EQ (1, graph.GetSplitBarrierCount ());
+
+    FrameSubmitter submitter (GetDevice (), graph, 2);
+
+    for (uint32_t frameIndex = 0; frameIndex < 4; ++frameIndex) {
+        submitter.Submit (frameIndex % 2);
+    }
+
+    env->Wait ();
+
+    CompareImages ("red", *copy->GetImages ()[0], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    CompareImages ("red", *copy->GetImages ()[1], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    CompareImages ("red", *images[1]->GetImages ()[0], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+}
+
+
+TEST_F (HeadlessTestEnvironment, RenderGraph_MemoryReport)
+{
+    RG::GraphSettings s (GetDeviceExtra (), 2);
+
+    const std::shared_ptr<RG::WritableImageResource> red = AddRedFillOperations (s, GetDevice (), 1, 64)[0];
+    red->SetName ("red");
+
+    const std::shared_ptr<RG::GPUBufferResource> buffer = std::make_shared<RG::GPUBufferResource> (256);
+    buffer->SetName ("buffer");
+    s.connectionSet.Add (buffer);
+
+    RG::RenderGraph graph;
+    graph.Compile (std::move (s));
+
+    const RG::RenderGraph::MemoryReport report = graph.GetMemoryReport ();
+
+    ASSERT_EQ (2, report.nodes.size ());
+
+    const VkDeviceSize imageBytes  = 64 * 64 * 4;
+    const VkDeviceSize bufferBytes = 256;
+
+    // one image per frame in flight
+    const RG::RenderGraph::NodeMemoryUsage& redUsage = report.nodes[0];
+    EXPECT_EQ ("red", redUsage.name);
+    EXPECT_EQ (2, redUsage.allocationCount);
+    EXPECT_LE (2 * imageBytes, redUsage.deviceLocalBytes);
+    EXPECT_EQ (0, redUsage.hostBytes);
+
+    // a device local and a host visible buffer per frame in flight, host visible memory may be device local as well
+    const RG::RenderGraph::NodeMemoryUsage& bufferUsage = report.nodes[1];
+    EXPECT_EQ ("buffer", bufferUsage.name);
+    EXPECT_EQ (4, bufferUsage.allocationCount);
+    EXPECT_LE (4 * bufferBytes, bufferUsage.deviceLocalBytes + bufferUsage.hostBytes);
+
+    for (VmaAllocation allocation : red->GetAllocations ()) {
+        EXPECT_EQ ("red (" + red->GetUUID ().GetValue () + ")", RG::GetAllocationName (GetDeviceExtra ().GetAllocator (), allocation));
+    }
+
+    ASSERT_FALSE (report.heaps.empty ());
+
+    VkDeviceSize allocationBytes = 0;
+    for (const RG::HeapUsage& heap : report.heaps) {
+        EXPECT_LE (heap.allocationBytes, heap.blockBytes);
+        allocationBytes += heap.allocationBytes;
+    }
+
+    EXPECT_LE (redUsage.deviceLocalBytes + bufferUsage.deviceLocalBytes + bufferUsage.hostBytes, allocationBytes);
 }
 
 
@@ -143,6 +143,8 @@ void TestEnvironmentBase::CompareImages (const std::string& name, const RG::Imag
         actualImage.SaveTo (outPath);
 
         if (comparison.has_value ()) {
+            std::cout << "Max abs error " << comparison->maxAbsError << ", " << comparison->mismatchCount << " mismatching pixels, PSNR " << comparison->psnr << " dB" << std::endl;
+
             if (RG_VERIFY (comparison->diffImage != nullptr)) {
                 const std::filesystem::path outPathDiff = TempFolder / (name + "_Diff.png");
                 std::cout << "Saving " << outPathDiff.string () << "..." << std::endl;
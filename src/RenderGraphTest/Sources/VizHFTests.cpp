@@ -17,7 +17,6 @@
 #include "RenderGraph/Window/SDLWindow.hpp"
 
 #include "RenderGraph/Utils/Assert.hpp"
-#include "RenderGraph/Utils/MultithreadedFunction.hpp"
 #include "RenderGraph/Utils/Noncopyable.hpp"
 #include "RenderGraph/Utils/Time.hpp"
 #include "RenderGraph/Utils/Timer.hpp"
@@ -26,7 +25,9 @@
 
 #include "RenderGraph/VulkanWrapper/DeviceExtra.hpp"
 #include "RenderGraph/VulkanWrapper/ShaderReflection.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/AssetLoader.hpp"
 #include "RenderGraph/VulkanWrapper/Utils/ImageData.hpp"
+#include "RenderGraph/VulkanWrapper/Utils/UploadBatch.hpp"
 #include "RenderGraph/VulkanWrapper/VulkanWrapper.hpp"
 
 #pragma warning(push, 0)
@@ -378,35 +379,29 @@ void main ()
 
     graph.Compile (std::move (s));
 
-    matcap->CopyTransitionTransfer (RG::ImageData (std::filesystem::current_path () / "TestData" / "VizHF" / "matcap.jpg").data);
+    // the matcap is decoded and uploaded in the background while the volume is prepared
+    RG::AssetLoader assetLoader (GetDeviceExtra ());
+    assetLoader.LoadImageFile (std::filesystem::current_path () / "TestData" / "VizHF" / "matcap.jpg", *matcap->image->imageGPU, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
     std::vector<uint8_t> rawBrainData = RG::ImageData (std::filesystem::current_path () / "TestData" / "VizHF" / "brain.jpg", 1).data;
 
-    std::vector<uint8_t> transformedBrainData (256 * 256 * 256);
-
-    auto BrainDataIndexMapping = [] (uint32_t oirignalDataIndex) {
-        const uint32_t x = oirignalDataIndex % 4096;
-        const uint32_t y = oirignalDataIndex / 4096;
-
-        const uint32_t row        = x % 256;
-        const uint32_t column     = y % 256;
-        const uint32_t sliceIndex = 16 * (y / 256) + (x / 256);
-
-        return sliceIndex * 256 * 256 + row + column * 256;
-    };
+    // the file holds the 256 slices of the volume as a 16x16 grid, every slice is copied as a brick straight from it
+    std::vector<VkBufferImageCopy> brainSlices;
+    for (uint32_t sliceIndex = 0; sliceIndex < 256; ++sliceIndex) {
+        VkBufferImageCopy slice = agy3d->image->imageGPU->GetBufferImageCopyRegion ({ 0, 0, static_cast<int32_t> (sliceIndex) }, { 256, 256, 1 }, 0);
+        slice.bufferOffset      = (sliceIndex / 16) * 256 * 4096 + (sliceIndex % 16) * 256;
+        slice.bufferRowLength   = 4096;
+        slice.bufferImageHeight = 256;
+        brainSlices.push_back (slice);
+    }
 
     {
-        // RG::DebugTimerLogger l ("transforming volume data");
-        // RG::TimerScope       s (l);
-        MultithreadedFunction d ([&] (uint32_t threadCount, uint32_t threadIndex) {
-            const uint32_t pixelCount = 4096 * 4096;
-            for (uint32_t bidx = pixelCount / threadCount * threadIndex; bidx < pixelCount / threadCount * (threadIndex + 1); ++bidx) {
-                transformedBrainData[BrainDataIndexMapping (bidx)] = rawBrainData[bidx];
-            }
-        });
+        RG::UploadBatch batch (GetDeviceExtra ());
+        agy3d->CopyRegions (batch, rawBrainData, brainSlices);
+        batch.Wait ();
     }
 
-    agy3d->CopyTransitionTransfer (transformedBrainData);
+    assetLoader.Wait ();
 
 
     // ========================= RENDERING =========================
@@ -494,8 +489,9 @@ void main ()
     renderer.RenderNextRecreatableFrame (graph);
     renderer.RenderNextRecreatableFrame (graph);
 
-    RG::ImageData sw (GetDeviceExtra (), *swapchain.GetImageObjects ()[0], 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
-    sw.ConvertBGRToRGB ();
+    const std::vector<std::unique_ptr<RG::InheritedImage>> swapchainImages = swapchain.GetImageObjects ();
+
+    const RG::ImageData sw = RG::ImageData::FromImageLayerConverted (GetDeviceExtra (), *swapchainImages[0], 0, RG::GetRGBAOrderFormat (swapchainImages[0]->GetFormat ()), VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
 
     CompareImages ("VizHF1_InitialState", sw);
 }
@@ -1017,8 +1013,9 @@ void main ()
     renderer.RenderNextRecreatableFrame (graph);
     renderer.RenderNextRecreatableFrame (graph);
 
-    RG::ImageData sw (GetDeviceExtra (), *swapchain.GetImageObjects ()[0], 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
-    sw.ConvertBGRToRGB ();
+    const std::vector<std::unique_ptr<RG::InheritedImage>> swapchainImages = swapchain.GetImageObjects ();
+
+    const RG::ImageData sw = RG::ImageData::FromImageLayerConverted (GetDeviceExtra (), *swapchainImages[0], 0, RG::GetRGBAOrderFormat (swapchainImages[0]->GetFormat ()), VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
 
     CompareImages ("VizHF2_InitialState", sw);
 }